@@ -0,0 +1,57 @@
+/*
+  Footprint report
+
+ This sketch prints the size of the SSLClient context structures for the
+ footprint tier selected with SSLCLIENT_FOOTPRINT in SSLClientConfig.h
+ (FULL, SMALL or TINY). It does not use the network, so it runs on any
+ board with a serial port.
+
+ Change SSLCLIENT_FOOTPRINT (in SSLClientConfig.h, or with your build
+ system for the whole library) and upload again to compare the tiers.
+
+ */
+
+#include <SSLClient.h>
+
+static void printSize(const char* name, size_t size) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((unsigned long)size);
+  Serial.println(" bytes");
+}
+
+static void printLimit(const char* name, unsigned long value) {
+  Serial.print("  ");
+  Serial.print(name);
+  Serial.print(" = ");
+  Serial.println(value);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial);
+
+  Serial.print("Footprint tier: ");
+#if SSLCLIENT_FOOTPRINT == SSLCLIENT_FOOTPRINT_TINY
+  Serial.println("TINY");
+#elif SSLCLIENT_FOOTPRINT == SSLCLIENT_FOOTPRINT_SMALL
+  Serial.println("SMALL");
+#else
+  Serial.println("FULL");
+#endif
+
+  Serial.println("Limits:");
+  printLimit("BR_MAX_CIPHER_SUITES", BR_MAX_CIPHER_SUITES);
+  printLimit("BR_SSL_BUFSIZE_PAD", BR_SSL_BUFSIZE_PAD);
+  printLimit("BR_X509_BUFSIZE_KEY", BR_X509_BUFSIZE_KEY);
+  printLimit("BR_X509_BUFSIZE_SIG", BR_X509_BUFSIZE_SIG);
+  printLimit("BR_X509_BUFSIZE_HASH", BR_X509_BUFSIZE_HASH);
+
+  Serial.println("Context sizes:");
+  printSize("br_ssl_engine_context", sizeof(br_ssl_engine_context));
+  printSize("br_ssl_client_context", sizeof(br_ssl_client_context));
+  printSize("br_x509_minimal_context", sizeof(br_x509_minimal_context));
+  printSize("SSLClient", sizeof(SSLClient));
+}
+
+void loop() {}
@@ -0,0 +1,217 @@
+#include "loopback.h"
+#include "test_cert.h"
+
+LoopbackServer::LoopbackServer()
+    : m_protocols(nullptr)
+    , m_protocols_num(0)
+    , m_handler(nullptr)
+    , m_handler_ctx(nullptr)
+    , m_open(false)
+    , m_hung_up(false)
+    , m_refuse(false)
+    , m_close_pending(false)
+    , m_pumping(false)
+    , m_read_limit(0)
+    , m_connects(0)
+    , m_offered_len(0)
+    , m_hello_seen(false)
+    , m_to_server_pos(0)
+    , m_to_server_len(0)
+    , m_to_client_pos(0)
+    , m_to_client_len(0)
+    , m_out_pos(0)
+    , m_out_len(0)
+    , m_out_marks_num(0)
+    , m_received_len(0) {
+    br_ssl_server_init_full_ec(&m_sc, TEST_CHAIN, 1, BR_KEYTYPE_EC, &TEST_SKEY);
+    br_ssl_session_cache_lru_init(&m_cache, m_cache_buf, sizeof m_cache_buf);
+    br_ssl_server_set_cache(&m_sc, &m_cache.vtable);
+    br_ssl_engine_set_buffer(&m_sc.eng, m_iobuf, sizeof m_iobuf, 1);
+}
+
+void LoopbackServer::setProtocols(const char** names, size_t num) {
+    m_protocols = names;
+    m_protocols_num = num;
+}
+
+bool LoopbackServer::send(const void* data, size_t len) {
+    if (len > sizeof m_out - m_out_len || m_out_marks_num == sizeof m_out_marks / sizeof m_out_marks[0])
+        return false;
+    memcpy(m_out + m_out_len, data, len);
+    m_out_len += len;
+    m_out_marks[m_out_marks_num++] = m_out_len;
+    m_pump();
+    return true;
+}
+
+void LoopbackServer::drop() {
+    m_open = false;
+    m_to_server_pos = m_to_server_len = 0;
+    m_to_client_pos = m_to_client_len = 0;
+}
+
+bool LoopbackServer::resumed() {
+    br_ssl_session_parameters params;
+    br_ssl_engine_get_session_parameters(&m_sc.eng, &params);
+    return m_offered_len > 0 && params.session_id_len == m_offered_len
+        && memcmp(params.session_id, m_offered, m_offered_len) == 0;
+}
+
+int LoopbackServer::connect(IPAddress /* ip */, uint16_t /* port */) {
+    return connect("localhost", 443);
+}
+
+int LoopbackServer::connect(const char* /* host */, uint16_t /* port */) {
+    if (m_refuse) return 0;
+    drop();
+    m_hung_up = false;
+    m_close_pending = false;
+    m_hello_seen = false;
+    m_offered_len = 0;
+    m_out_pos = m_out_len = m_out_marks_num = 0;
+    m_received_len = 0;
+    br_ssl_engine_set_protocol_names(&m_sc.eng, m_protocols, m_protocols_num);
+    if (!br_ssl_server_reset(&m_sc)) return 0;
+    // the tests must not depend on the host having a random source
+    static const char seed[] = "SSLClient loopback server";
+    br_ssl_engine_inject_entropy(&m_sc.eng, seed, sizeof seed);
+    m_open = true;
+    m_connects++;
+    return 1;
+}
+
+size_t LoopbackServer::write(const uint8_t* buf, size_t size) {
+    if (!m_open) return 0;
+    // the peer is gone, so the data goes nowhere
+    if (m_hung_up) return size;
+    if (size > sizeof m_to_server - m_to_server_len) {
+        memmove(m_to_server, m_to_server + m_to_server_pos, m_to_server_len - m_to_server_pos);
+        m_to_server_len -= m_to_server_pos;
+        m_to_server_pos = 0;
+        if (size > sizeof m_to_server - m_to_server_len) size = sizeof m_to_server - m_to_server_len;
+    }
+    memcpy(m_to_server + m_to_server_len, buf, size);
+    m_to_server_len += size;
+    // remember the session ID of the ClientHello: after the record header (5),
+    // handshake header (4), version (2) and random (32)
+    if (!m_hello_seen && m_to_server_len >= 44) {
+        m_hello_seen = true;
+        m_offered_len = m_to_server[43] <= 32 ? m_to_server[43] : 0;
+        if (m_to_server_len >= 44 + m_offered_len) memcpy(m_offered, m_to_server + 44, m_offered_len);
+    }
+    // the server answers when the client next looks for data, as if the
+    // answer had to travel back over a network
+    return size;
+}
+
+size_t LoopbackServer::m_readable() const {
+    if (!m_open) return 0;
+    const size_t len = m_to_client_len - m_to_client_pos;
+    return m_read_limit > 0 && len > m_read_limit ? m_read_limit : len;
+}
+
+int LoopbackServer::available() {
+    m_pump();
+    return static_cast<int>(m_readable());
+}
+
+int LoopbackServer::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int LoopbackServer::read(uint8_t* buf, size_t size) {
+    m_pump();
+    const size_t len = m_readable();
+    if (len == 0) return -1;
+    if (size > len) size = len;
+    memcpy(buf, m_to_client + m_to_client_pos, size);
+    m_to_client_pos += size;
+    return static_cast<int>(size);
+}
+
+int LoopbackServer::peek() {
+    m_pump();
+    return m_readable() > 0 ? m_to_client[m_to_client_pos] : -1;
+}
+
+void LoopbackServer::stop() {
+    drop();
+}
+
+uint8_t LoopbackServer::connected() {
+    m_pump();
+    return m_open && (!m_hung_up || m_to_client_pos < m_to_client_len);
+}
+
+void LoopbackServer::m_pump() {
+    br_ssl_engine_context* eng = &m_sc.eng;
+    // a handler that sends data is called from here
+    if (!m_open || m_pumping) return;
+    m_pumping = true;
+    for (;;) {
+        const unsigned state = br_ssl_engine_current_state(eng);
+        // like a real server, close the socket once TLS is closed
+        if (state & BR_SSL_CLOSED) {
+            m_hung_up = true;
+            break;
+        }
+        if (state & BR_SSL_SENDREC) {
+            if (m_to_client_pos > 0) {
+                memmove(m_to_client, m_to_client + m_to_client_pos, m_to_client_len - m_to_client_pos);
+                m_to_client_len -= m_to_client_pos;
+                m_to_client_pos = 0;
+            }
+            size_t len;
+            unsigned char* buf = br_ssl_engine_sendrec_buf(eng, &len);
+            if (len > sizeof m_to_client - m_to_client_len) len = sizeof m_to_client - m_to_client_len;
+            if (len > 0) {
+                memcpy(m_to_client + m_to_client_len, buf, len);
+                m_to_client_len += len;
+                br_ssl_engine_sendrec_ack(eng, len);
+                continue;
+            }
+        }
+        if (state & BR_SSL_RECVAPP) {
+            size_t len;
+            unsigned char* buf = br_ssl_engine_recvapp_buf(eng, &len);
+            const size_t start = m_received_len;
+            const size_t keep = len < sizeof m_received - start ? len : sizeof m_received - start;
+            memcpy(m_received + start, buf, keep);
+            m_received_len += keep;
+            br_ssl_engine_recvapp_ack(eng, len);
+            if (m_handler != nullptr) m_handler(*this, m_received + start, keep, m_handler_ctx);
+            continue;
+        }
+        if ((state & BR_SSL_RECVREC) && m_to_server_pos < m_to_server_len) {
+            size_t len;
+            unsigned char* buf = br_ssl_engine_recvrec_buf(eng, &len);
+            if (len > m_to_server_len - m_to_server_pos) len = m_to_server_len - m_to_server_pos;
+            memcpy(buf, m_to_server + m_to_server_pos, len);
+            m_to_server_pos += len;
+            br_ssl_engine_recvrec_ack(eng, len);
+            continue;
+        }
+        if ((state & BR_SSL_SENDAPP) && m_out_pos < m_out_len) {
+            size_t len;
+            unsigned char* buf = br_ssl_engine_sendapp_buf(eng, &len);
+            // send up to the end of the current send() call, then flush
+            size_t mark = 0;
+            while (m_out_marks[mark] <= m_out_pos) mark++;
+            if (len > m_out_marks[mark] - m_out_pos) len = m_out_marks[mark] - m_out_pos;
+            memcpy(buf, m_out + m_out_pos, len);
+            m_out_pos += len;
+            br_ssl_engine_sendapp_ack(eng, len);
+            if (m_out_pos == m_out_marks[mark]) br_ssl_engine_flush(eng, 0);
+            if (m_out_pos == m_out_len) m_out_pos = m_out_len = m_out_marks_num = 0;
+            continue;
+        }
+        if ((state & BR_SSL_SENDAPP) && m_close_pending) {
+            m_close_pending = false;
+            br_ssl_engine_close(eng);
+            continue;
+        }
+        break;
+    }
+    m_pumping = false;
+}
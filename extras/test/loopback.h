@@ -0,0 +1,140 @@
+/**
+ * loopback.h
+ *
+ * A network client for the host tests that is connected to a TLS server
+ * running in the same process, on BearSSL's server engine. Every call from
+ * SSLClient runs the server until it has nothing more to do, so the tests are
+ * deterministic and need no sockets.
+ */
+
+#ifndef LOOPBACK_H_
+#define LOOPBACK_H_
+
+#include "Client.h"
+#include "bearssl.h"
+
+/**
+ * @brief A Client whose other end is a TLS server in the same process.
+ *
+ * The server uses the certificate in test_cert.h, and keeps a session cache
+ * across connections, so reconnecting resumes the session. What the client
+ * sends is collected in received(), and a handler can answer it with send().
+ * The object is large, so tests should make it static.
+ *
+ * Nothing here allocates memory, so it can be used by the tests that check
+ * that SSLClient does not.
+ */
+class LoopbackServer : public Client {
+public:
+    /** Called with each piece of application data the server receives */
+    typedef void (*Handler)(LoopbackServer& server, const uint8_t* data, size_t len, void* ctx);
+
+    LoopbackServer();
+
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    /** @brief Set the function that answers the client, or nullptr. */
+    void setHandler(Handler handler, void* ctx = nullptr) { m_handler = handler; m_handler_ctx = ctx; }
+
+    /** @brief Set the ALPN protocols the server accepts, most preferred first. */
+    void setProtocols(const char** names, size_t num);
+
+    /** @brief Hand the client at most len bytes per read() or available(), or any amount if 0. */
+    void setReadLimit(size_t len) { m_read_limit = len; }
+
+    /** @brief Make the next connect() calls fail, or succeed again. */
+    void setRefuse(bool refuse) { m_refuse = refuse; }
+
+    /**
+     * @brief Send application data to the client. Each call ends with a flush, so
+     * the data goes in records of its own (more than one if it is long).
+     * @returns false if the data does not fit in the queue.
+     */
+    bool send(const void* data, size_t len);
+    bool send(const char* str) { return send(str, strlen(str)); }
+
+    /** @brief Send close_notify once the queued data has been sent. */
+    void closeNotify() { m_close_pending = true; m_pump(); }
+
+    /** @brief Close the TCP connection without close_notify, once the client has read everything. */
+    void hangUp() { m_hung_up = true; }
+
+    /** @brief Lose the connection now, as if the network failed. */
+    void drop();
+
+    /** @brief The application data received since the last connect() or clearReceived(). */
+    const uint8_t* received() const { return m_received; }
+    size_t receivedLen() const { return m_received_len; }
+    void clearReceived() { m_received_len = 0; }
+
+    /** @brief The number of successful connect() calls. */
+    unsigned connects() const { return m_connects; }
+
+    /** @brief Length of the session ID the client offered in its last ClientHello. */
+    size_t offeredSessionIdLen() const { return m_offered_len; }
+
+    /** @brief Returns true if the last handshake resumed a session. */
+    bool resumed();
+
+    /** @brief The server engine, to check or change its state. */
+    br_ssl_engine_context* engine() { return &m_sc.eng; }
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return m_open; }
+
+private:
+    /** run the server engine until it cannot progress */
+    void m_pump();
+    /** bytes the client may read now */
+    size_t m_readable() const;
+
+    br_ssl_server_context m_sc;
+    br_ssl_session_cache_lru m_cache;
+    unsigned char m_cache_buf[4096];
+    unsigned char m_iobuf[BR_SSL_BUFSIZE_BIDI];
+    const char** m_protocols;
+    size_t m_protocols_num;
+    Handler m_handler;
+    void* m_handler_ctx;
+    bool m_open;
+    bool m_hung_up;
+    bool m_refuse;
+    bool m_close_pending;
+    bool m_pumping;
+    size_t m_read_limit;
+    unsigned m_connects;
+    // the session ID from the last ClientHello
+    unsigned char m_offered[32];
+    size_t m_offered_len;
+    bool m_hello_seen;
+    // bytes from the client, not yet taken by the server engine
+    unsigned char m_to_server[BR_SSL_BUFSIZE_INPUT];
+    size_t m_to_server_pos;
+    size_t m_to_server_len;
+    // bytes from the server, not yet read by the client
+    unsigned char m_to_client[2 * BR_SSL_BUFSIZE_OUTPUT];
+    size_t m_to_client_pos;
+    size_t m_to_client_len;
+    // application data to send, with the end of each send() call
+    unsigned char m_out[32768];
+    size_t m_out_pos;
+    size_t m_out_len;
+    size_t m_out_marks[64];
+    size_t m_out_marks_num;
+    // application data received
+    unsigned char m_received[32768];
+    size_t m_received_len;
+};
+
+#endif /* LOOPBACK_H_ */
@@ -0,0 +1,121 @@
+/**
+ * Arduino.h
+ *
+ * The parts of the Arduino core that SSLClient uses, for building the library
+ * and its tests on a desktop host.
+ */
+
+#ifndef ARDUINO_STUB_H_
+#define ARDUINO_STUB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+inline unsigned long millis() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long)(t.tv_sec * 1000UL + t.tv_nsec / 1000000UL);
+}
+
+inline unsigned long micros() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long)(t.tv_sec * 1000000UL + t.tv_nsec / 1000UL);
+}
+
+inline void delay(unsigned long ms) { usleep(ms * 1000); }
+inline void yield() {}
+inline int analogRead(int /* pin */) { return rand(); }
+
+#define A7 7
+
+class String {
+public:
+    String(const char* s = "") : m_s(s ? s : "") {}
+    bool equals(const char* o) const { return m_s == o; }
+    bool equals(const String& o) const { return m_s == o.m_s; }
+    const char* c_str() const { return m_s.c_str(); }
+    unsigned length() const { return m_s.size(); }
+    bool operator==(const String& o) const { return m_s == o.m_s; }
+private:
+    std::string m_s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t* b, size_t n) {
+        size_t i = 0;
+        for (; i < n; i++) if (!write(b[i])) break;
+        return i;
+    }
+    virtual int availableForWrite() { return 0; }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    int getWriteError() { return write_error; }
+    void clearWriteError() { write_error = 0; }
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(long v) { char b[24]; snprintf(b, sizeof b, "%ld", v); return write(b); }
+    size_t print(unsigned long v) { char b[24]; snprintf(b, sizeof b, "%lu", v); return write(b); }
+    size_t print(int v) { return print((long)v); }
+    size_t print(unsigned v) { return print((unsigned long)v); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(double v) { char b[32]; snprintf(b, sizeof b, "%.2f", v); return write(b); }
+    template<class T> size_t println(const T& v) { size_t n = print(v); return n + write("\r\n"); }
+    size_t println() { return write("\r\n"); }
+protected:
+    void setWriteError(int e = 1) { write_error = e; }
+private:
+    int write_error = 0;
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long t) { _timeout = t; }
+    size_t readBytes(uint8_t* buf, size_t len) {
+        size_t n = 0;
+        while (n < len) {
+            int c = read();
+            if (c < 0) break;
+            buf[n++] = (uint8_t)c;
+        }
+        return n;
+    }
+protected:
+    unsigned long _timeout = 1000;
+};
+
+/** Serial prints to stderr, and is only "connected" if SSL_SERIAL is set in the environment */
+class HardwareSerial : public Stream {
+public:
+    size_t write(uint8_t c) override { fputc(c, stderr); return 1; }
+    size_t write(const uint8_t* b, size_t n) override { return fwrite(b, 1, n, stderr); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    explicit operator bool() const { return getenv("SSL_SERIAL") != nullptr; }
+};
+
+extern HardwareSerial Serial;
+
+#include "IPAddress.h"
+
+#endif /* __cplusplus */
+
+#endif /* ARDUINO_STUB_H_ */
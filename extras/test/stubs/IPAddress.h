@@ -0,0 +1,19 @@
+/**
+ * IPAddress.h
+ *
+ * A minimal IPv4 address type, for building SSLClient on a desktop host.
+ */
+
+#ifndef IPADDRESS_STUB_H_
+#define IPADDRESS_STUB_H_
+
+#include <stdint.h>
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) { m[0] = a; m[1] = b; m[2] = c; m[3] = d; }
+    uint8_t operator[](int i) const { return m[i]; }
+    uint8_t m[4];
+};
+
+#endif /* IPADDRESS_STUB_H_ */
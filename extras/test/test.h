@@ -0,0 +1,56 @@
+/**
+ * test.h
+ *
+ * A few macros for the host tests. Each test file is its own program: main()
+ * runs its test functions with RUN, and returns TEST_RESULT, which is 0 if
+ * every check passed. A test that cannot run on this host returns TEST_SKIP.
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+static int test_failures = 0;
+
+/** Exit status of a test that could not run, for `make check` */
+#define TEST_SKIP 77
+
+/** Record a failure, with its location, if cond is false */
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+/** Record a failure if two integers are not equal, printing both */
+#define CHECK_EQ(a, b) do { \
+    const long long a_ = (long long)(a), b_ = (long long)(b); \
+    if (a_ != b_) { \
+        fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", \
+            __FILE__, __LINE__, #a, #b, a_, b_); \
+        test_failures++; \
+    } \
+} while (0)
+
+/** Record a failure if two buffers of len bytes differ */
+#define CHECK_MEM(a, b, len) do { \
+    if (memcmp((a), (b), (len)) != 0) { \
+        fprintf(stderr, "%s:%d: check failed: %s and %s differ\n", \
+            __FILE__, __LINE__, #a, #b); \
+        test_failures++; \
+    } \
+} while (0)
+
+/** Run a test function */
+#define RUN(test) do { \
+    const int before_ = test_failures; \
+    test(); \
+    printf("%s %s\n", test_failures == before_ ? "ok  " : "FAIL", #test); \
+} while (0)
+
+#define TEST_RESULT (test_failures == 0 ? 0 : 1)
+
+#endif /* TEST_H_ */
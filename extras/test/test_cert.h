@@ -0,0 +1,88 @@
+#ifndef TEST_CERT_H_
+#define TEST_CERT_H_
+
+/* Certificate and key for the host tests: a self-signed P-256 certificate for
+ * localhost, a.test and b.test, valid from 2020 to 2120, which is also its own
+ * trust anchor. The same certificate and key are in certs/ as PEM, for the tests
+ * that run against openssl s_server.
+ */
+
+static const unsigned char TEST_CERT[] = {
+    0x30, 0x82, 0x01, 0x6b, 0x30, 0x82, 0x01, 0x11, 0xa0, 0x03, 0x02, 0x01,
+    0x02, 0x02, 0x01, 0x01, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce,
+    0x3d, 0x04, 0x03, 0x02, 0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03,
+    0x55, 0x04, 0x03, 0x0c, 0x09, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x68, 0x6f,
+    0x73, 0x74, 0x30, 0x20, 0x17, 0x0d, 0x32, 0x30, 0x30, 0x31, 0x30, 0x31,
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a, 0x18, 0x0f, 0x32, 0x31, 0x32,
+    0x30, 0x30, 0x31, 0x30, 0x31, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x5a,
+    0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c,
+    0x09, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x68, 0x6f, 0x73, 0x74, 0x30, 0x59,
+    0x30, 0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06,
+    0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00,
+    0x04, 0xfa, 0xe2, 0x9e, 0x3b, 0x7a, 0x83, 0x41, 0x24, 0x52, 0xac, 0xb5,
+    0xee, 0x7a, 0x79, 0xea, 0x20, 0x33, 0xa7, 0xa4, 0x3f, 0xa7, 0x34, 0x8f,
+    0x0c, 0x33, 0x24, 0x6a, 0xc5, 0xc9, 0x25, 0x7b, 0xca, 0xbc, 0xab, 0x52,
+    0x1c, 0x85, 0xdc, 0xb1, 0x22, 0x67, 0xe3, 0xa7, 0x11, 0xe8, 0x11, 0xc0,
+    0x42, 0x0a, 0x3e, 0x6f, 0xdf, 0xc0, 0xb1, 0x3e, 0x02, 0x54, 0xda, 0x1b,
+    0x3b, 0x5f, 0x02, 0x78, 0xe6, 0xa3, 0x52, 0x30, 0x50, 0x30, 0x24, 0x06,
+    0x03, 0x55, 0x1d, 0x11, 0x04, 0x1d, 0x30, 0x1b, 0x82, 0x09, 0x6c, 0x6f,
+    0x63, 0x61, 0x6c, 0x68, 0x6f, 0x73, 0x74, 0x82, 0x06, 0x61, 0x2e, 0x74,
+    0x65, 0x73, 0x74, 0x82, 0x06, 0x62, 0x2e, 0x74, 0x65, 0x73, 0x74, 0x30,
+    0x09, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x04, 0x02, 0x30, 0x00, 0x30, 0x1d,
+    0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0xed, 0x46, 0xb3,
+    0x32, 0x8e, 0x7b, 0xbe, 0xcb, 0x82, 0x35, 0x1b, 0xbe, 0x11, 0xa9, 0x77,
+    0x04, 0xbd, 0x51, 0xa4, 0x1f, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48,
+    0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x21,
+    0x00, 0xe2, 0x1d, 0xf4, 0x10, 0x60, 0xbf, 0x83, 0x8b, 0xb9, 0xe6, 0x0c,
+    0xa0, 0x5e, 0x89, 0x85, 0x34, 0x8a, 0x24, 0xf2, 0x50, 0x0f, 0x9b, 0x46,
+    0x14, 0xd3, 0x71, 0xe3, 0x92, 0xaf, 0x49, 0x40, 0x1e, 0x02, 0x20, 0x58,
+    0xbf, 0x30, 0xd2, 0x6a, 0x73, 0x0b, 0x46, 0xa1, 0x55, 0xac, 0x36, 0x2e,
+    0xee, 0x54, 0xfb, 0x94, 0x5c, 0x27, 0xee, 0x55, 0xcd, 0x17, 0x7c, 0x90,
+    0xdd, 0xdd, 0x26, 0x27, 0x7f, 0x69, 0xc4,
+};
+
+static const unsigned char TEST_DN[] = {
+    0x30, 0x14, 0x31, 0x12, 0x30, 0x10, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c,
+    0x09, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x68, 0x6f, 0x73, 0x74,
+};
+
+static const unsigned char TEST_EC_Q[] = {
+    0x04, 0xfa, 0xe2, 0x9e, 0x3b, 0x7a, 0x83, 0x41, 0x24, 0x52, 0xac, 0xb5,
+    0xee, 0x7a, 0x79, 0xea, 0x20, 0x33, 0xa7, 0xa4, 0x3f, 0xa7, 0x34, 0x8f,
+    0x0c, 0x33, 0x24, 0x6a, 0xc5, 0xc9, 0x25, 0x7b, 0xca, 0xbc, 0xab, 0x52,
+    0x1c, 0x85, 0xdc, 0xb1, 0x22, 0x67, 0xe3, 0xa7, 0x11, 0xe8, 0x11, 0xc0,
+    0x42, 0x0a, 0x3e, 0x6f, 0xdf, 0xc0, 0xb1, 0x3e, 0x02, 0x54, 0xda, 0x1b,
+    0x3b, 0x5f, 0x02, 0x78, 0xe6,
+};
+
+static const unsigned char TEST_EC_X[] = {
+    0x0f, 0x31, 0xdb, 0x7a, 0x3f, 0x69, 0x7f, 0x51, 0x85, 0x0c, 0xa2, 0xb1,
+    0x1f, 0xaf, 0x09, 0x81, 0x29, 0x2d, 0xdf, 0x66, 0xde, 0x37, 0x37, 0x6f,
+    0x91, 0xff, 0x83, 0xd1, 0xe7, 0xca, 0x9e, 0xf8,
+};
+
+static const br_x509_certificate TEST_CHAIN[] = {
+    { (unsigned char *)TEST_CERT, sizeof TEST_CERT },
+};
+
+static const br_ec_private_key TEST_SKEY = {
+    BR_EC_secp256r1, (unsigned char *)TEST_EC_X, sizeof TEST_EC_X,
+};
+
+static const br_x509_trust_anchor TEST_TAs[] = {
+    {
+        { (unsigned char *)TEST_DN, sizeof TEST_DN },
+        BR_X509_TA_CA,
+        {
+            BR_KEYTYPE_EC,
+            { .ec = {
+                BR_EC_secp256r1,
+                (unsigned char *)TEST_EC_Q, sizeof TEST_EC_Q,
+            } }
+        }
+    },
+};
+
+#define TEST_TAs_NUM 1
+
+#endif /* TEST_CERT_H_ */
@@ -0,0 +1,114 @@
+/**
+ * The Extended Master Secret (RFC 7627) against a real server: openssl
+ * s_server, with the extension on (OpenSSL's default) and off. The full
+ * handshake and the resumption must both work either way, and the session
+ * must record whether the extension was used. The cases that must fail
+ * (a server that drops or adds the extension on resumption) are in
+ * test_server_hello.c, since no well-behaved server does that.
+ *
+ * Skipped if openssl cannot be run.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "SSLClient.h"
+#include "SSLPosixClient.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+/** Start openssl s_server on port, and wait until it accepts connections. */
+static pid_t start_server(uint16_t port, bool ems) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+        char port_str[8];
+        snprintf(port_str, sizeof port_str, "%u", port);
+        if (!ems) setenv("OPENSSL_CONF", "no_ems.cnf", 1);
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execlp("openssl", "openssl", "s_server", "-accept", port_str,
+            "-cert", "certs/test_cert.pem", "-key", "certs/test_key.pem",
+            "-tls1_2", "-www", (char*)nullptr);
+        _exit(127);
+    }
+    for (int i = 0; i < 50; i++) {
+        SSLPosixClient probe;
+        if (probe.connect("localhost", port)) return pid;
+        usleep(100000);
+    }
+    fprintf(stderr, "openssl s_server did not start\n");
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return -1;
+}
+
+static void stop_server(pid_t pid) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+}
+
+/**
+ * Fetch the status page of s_server -www. Returns false if it could not be
+ * read, and sets resumed to whether it says that the session was resumed.
+ */
+static bool get_status(SSLClient& client, uint16_t port, bool* resumed) {
+    if (!client.connect("localhost", port)) return false;
+    static const char request[] = "GET / HTTP/1.0\r\n\r\n";
+    client.write((const uint8_t*)request, sizeof request - 1);
+    client.flush();
+    static char page[16384];
+    size_t len = 0;
+    const unsigned long start = millis();
+    while ((client.connected() || client.available() > 0) && millis() - start < 10000) {
+        const int got = client.read((uint8_t*)page + len, sizeof page - 1 - len);
+        if (got > 0) len += got;
+    }
+    page[len] = '\0';
+    client.stop();
+    *resumed = strstr(page, "\nReused, ") != nullptr;
+    return strstr(page, "\nNew, ") != nullptr || *resumed;
+}
+
+static void check_server(bool ems) {
+    const uint16_t port = 20000 + getpid() % 20000;
+    const pid_t pid = start_server(port, ems);
+    CHECK(pid > 0);
+    if (pid <= 0) return;
+
+    SSLPosixClient socket;
+    SSLClient client(socket, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    bool resumed = true;
+    CHECK(get_status(client, port, &resumed));
+    CHECK(!resumed);
+    SSLSession* session = client.getSession("localhost");
+    CHECK(session != nullptr);
+    if (session != nullptr) CHECK_EQ(session->extended_master_secret, ems);
+
+    CHECK(get_status(client, port, &resumed));
+    CHECK(resumed);
+    session = client.getSession("localhost");
+    CHECK(session != nullptr);
+    if (session != nullptr) CHECK_EQ(session->extended_master_secret, ems);
+    stop_server(pid);
+}
+
+static void test_ems_server() { check_server(true); }
+static void test_no_ems_server() { check_server(false); }
+
+int main() {
+    if (system("openssl version > /dev/null 2>&1") != 0) {
+        printf("openssl not found\n");
+        return TEST_SKIP;
+    }
+    // a write to a socket that s_server closed must not kill the test
+    signal(SIGPIPE, SIG_IGN);
+    RUN(test_ems_server);
+    RUN(test_no_ems_server);
+    return TEST_RESULT;
+}
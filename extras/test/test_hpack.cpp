@@ -0,0 +1,263 @@
+/**
+ * SSLHpack's decoder, against the examples of RFC 7541 appendix C: requests
+ * and responses, with and without Huffman coding, where the responses are
+ * decoded with a 256-byte table so that entries get evicted. Then malformed
+ * Huffman strings, table size updates, fields too large to keep, and a round
+ * trip through the encoder.
+ */
+
+#include "SSLHpack.h"
+#include "test.h"
+
+/** Collects the fields of a header block as "name: value\n" lines */
+class Fields : public SSLHpack::Handler {
+public:
+    Fields() : m_len(0) { m_text[0] = '\0'; }
+    void field(const char* name, const char* value) override {
+        m_len += snprintf(m_text + m_len, sizeof m_text - m_len, "%s: %s\n", name, value);
+    }
+    const char* text() const { return m_text; }
+private:
+    char m_text[1024];
+    size_t m_len;
+};
+
+/** A Print that keeps what is written to it */
+class Buffer : public Print {
+public:
+    Buffer() : len(0) {}
+    size_t write(uint8_t b) override {
+        if (len == sizeof data) return 0;
+        data[len++] = b;
+        return 1;
+    }
+    using Print::write;
+    uint8_t data[1024];
+    size_t len;
+};
+
+// parse a hex dump, ignoring spaces
+static size_t from_hex(const char* hex, uint8_t* out) {
+    size_t len = 0;
+    while (*hex) {
+        if (*hex == ' ') {
+            hex++;
+            continue;
+        }
+        unsigned b;
+        sscanf(hex, "%2x", &b);
+        out[len++] = static_cast<uint8_t>(b);
+        hex += 2;
+    }
+    return len;
+}
+
+// decode a header block given in hex, and check the fields it gave
+static void check_block(SSLHpack& hpack, const char* hex, const char* expected) {
+    uint8_t block[1024];
+    const size_t len = from_hex(hex, block);
+    Fields fields;
+    CHECK(hpack.decode(block, len, fields));
+    if (strcmp(fields.text(), expected) != 0)
+        fprintf(stderr, "got:\n%sexpected:\n%s", fields.text(), expected);
+    CHECK(strcmp(fields.text(), expected) == 0);
+}
+
+static bool decodes(SSLHpack& hpack, const char* hex) {
+    uint8_t block[1024];
+    const size_t len = from_hex(hex, block);
+    Fields fields;
+    return hpack.decode(block, len, fields);
+}
+
+static const char REQUEST_1[] =
+    ":method: GET\n:scheme: http\n:path: /\n:authority: www.example.com\n";
+static const char REQUEST_2[] =
+    ":method: GET\n:scheme: http\n:path: /\n:authority: www.example.com\ncache-control: no-cache\n";
+static const char REQUEST_3[] =
+    ":method: GET\n:scheme: https\n:path: /index.html\n:authority: www.example.com\ncustom-key: custom-value\n";
+// the dynamic table after the third request, newest first
+static const char REQUEST_TABLE[] =
+    "custom-key: custom-value\ncache-control: no-cache\n:authority: www.example.com\n";
+
+static const char RESPONSE_1[] =
+    ":status: 302\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:21 GMT\n"
+    "location: https://www.example.com\n";
+static const char RESPONSE_2[] =
+    ":status: 307\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:21 GMT\n"
+    "location: https://www.example.com\n";
+static const char RESPONSE_3[] =
+    ":status: 200\ncache-control: private\ndate: Mon, 21 Oct 2013 20:13:22 GMT\n"
+    "location: https://www.example.com\ncontent-encoding: gzip\n"
+    "set-cookie: foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1\n";
+static const char RESPONSE_TABLE[] =
+    "set-cookie: foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; max-age=3600; version=1\n"
+    "content-encoding: gzip\ndate: Mon, 21 Oct 2013 20:13:22 GMT\n";
+// the responses use a 256-byte table, which their encoder set with an update
+static const char TABLE_256[] = "3fe101 ";
+
+// RFC 7541 appendix C.3
+static void test_requests() {
+    SSLHpack hpack;
+    check_block(hpack, "828684410f7777772e6578616d706c652e636f6d", REQUEST_1);
+    check_block(hpack, "828684be58086e6f2d6361636865", REQUEST_2);
+    check_block(hpack, "828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565", REQUEST_3);
+    check_block(hpack, "bebfc0", REQUEST_TABLE);
+    CHECK(!decodes(hpack, "c1"));
+}
+
+// RFC 7541 appendix C.4
+static void test_requests_huffman() {
+    SSLHpack hpack;
+    check_block(hpack, "828684418cf1e3c2e5f23a6ba0ab90f4ff", REQUEST_1);
+    check_block(hpack, "828684be5886a8eb10649cbf", REQUEST_2);
+    check_block(hpack, "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf", REQUEST_3);
+    check_block(hpack, "bebfc0", REQUEST_TABLE);
+    CHECK(!decodes(hpack, "c1"));
+}
+
+// RFC 7541 appendix C.5: each response evicts the oldest entries
+static void test_responses() {
+    SSLHpack hpack;
+    char block[512];
+    snprintf(block, sizeof block, "%s%s", TABLE_256,
+        "4803333032580770726976617465611d4d6f6e2c203231204f637420323031332032303a31333a323120474d54"
+        "6e1768747470733a2f2f7777772e6578616d706c652e636f6d");
+    check_block(hpack, block, RESPONSE_1);
+    // :status 302 is evicted to make room for 307
+    check_block(hpack, "4803333037c1c0bf", RESPONSE_2);
+    CHECK(!decodes(hpack, "c2"));
+    check_block(hpack,
+        "88c1611d4d6f6e2c203231204f637420323031332032303a31333a323220474d54c05a04677a69707738666f6f3d"
+        "4153444a4b48514b425a584f5157454f50495541585157454f49553b206d61782d6167653d333630303b2076657273696f6e3d31",
+        RESPONSE_3);
+    check_block(hpack, "bebfc0", RESPONSE_TABLE);
+    CHECK(!decodes(hpack, "c1"));
+}
+
+// RFC 7541 appendix C.6
+static void test_responses_huffman() {
+    SSLHpack hpack;
+    char block[512];
+    snprintf(block, sizeof block, "%s%s", TABLE_256,
+        "488264025885aec3771a4b6196d07abe941054d444a8200595040b8166e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3");
+    check_block(hpack, block, RESPONSE_1);
+    check_block(hpack, "4883640effc1c0bf", RESPONSE_2);
+    CHECK(!decodes(hpack, "c2"));
+    check_block(hpack,
+        "88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a839bd9ab77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f3672c1ab270fb5291f9587316065c003ed4ee5b1063d5007",
+        RESPONSE_3);
+    check_block(hpack, "bebfc0", RESPONSE_TABLE);
+    CHECK(!decodes(hpack, "c1"));
+}
+
+// literal field "a" without indexing, whose value is the given Huffman string
+static bool decodes_huffman(const char* hex_value) {
+    SSLHpack hpack;
+    char block[64];
+    snprintf(block, sizeof block, "000161%02x%s", 0x80 | static_cast<unsigned>(strlen(hex_value) / 2), hex_value);
+    return decodes(hpack, block);
+}
+
+static void test_huffman_invalid() {
+    // "a" (00011) padded with ones, and then with zeros
+    CHECK(decodes_huffman("1f"));
+    CHECK(!decodes_huffman("18"));
+    // more than 7 bits of padding
+    CHECK(!decodes_huffman("1fff"));
+    // EOS, thirty ones
+    CHECK(!decodes_huffman("ffffffff"));
+    // the string runs past the end of the block
+    SSLHpack hpack;
+    CHECK(!decodes(hpack, "0001618a1f"));
+}
+
+static void test_table_size() {
+    SSLHpack hpack;
+    // an update to the size we advertised, and past it
+    char block[16];
+    snprintf(block, sizeof block, "3f%02x%02x", (unsigned)((SSLHpack::TABLE_SIZE - 31) & 0x7F) | 0x80,
+        (unsigned)((SSLHpack::TABLE_SIZE - 31) >> 7));
+    CHECK(decodes(hpack, block));
+    snprintf(block, sizeof block, "3f%02x%02x", (unsigned)((SSLHpack::TABLE_SIZE - 30) & 0x7F) | 0x80,
+        (unsigned)((SSLHpack::TABLE_SIZE - 30) >> 7));
+    CHECK(!decodes(hpack, block));
+
+    // shrinking the table to 0 evicts everything
+    check_block(hpack, "400161017a", "a: z\n");
+    check_block(hpack, "be", "a: z\n");
+    check_block(hpack, "20", "");
+    CHECK(!decodes(hpack, "be"));
+
+    // with room for 58 bytes, adding a second entry evicts the first one
+    check_block(hpack, "3f1b", "");
+    check_block(hpack, "400161017a", "a: z\n");
+    check_block(hpack, "400162027a7a", "b: zz\n");
+    check_block(hpack, "be", "b: zz\n");
+    CHECK(!decodes(hpack, "bf"));
+
+    // and an entry larger than the table empties it
+    check_block(hpack, "4001631a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a7a",
+        "c: zzzzzzzzzzzzzzzzzzzzzzzzzz\n");
+    CHECK(!decodes(hpack, "be"));
+}
+
+// a field larger than the table is decoded, but not handed out or kept
+static void test_large_field() {
+    SSLHpack hpack;
+    static char block[2 * (SSLHpack::TABLE_SIZE + 32)];
+    const size_t value_len = SSLHpack::TABLE_SIZE;
+    size_t len = 0;
+    // "big" = TABLE_SIZE x's, with incremental indexing, then "a" = z
+    len += snprintf(block + len, sizeof block - len, "40036269677f%02x%02x",
+        (unsigned)((value_len - 127) & 0x7F) | 0x80, (unsigned)((value_len - 127) >> 7));
+    for (size_t i = 0; i < value_len; i++) len += snprintf(block + len, sizeof block - len, "78");
+    snprintf(block + len, sizeof block - len, "000161017a");
+    check_block(hpack, "400161017a", "a: z\n");
+    check_block(hpack, block, "a: z\n");
+    CHECK(!decodes(hpack, "be"));
+}
+
+// what the encoder writes decodes to the same fields, with indexes into its table
+static void test_round_trip() {
+    SSLHpack encoder, decoder;
+    static const char* const fields[][2] = {
+        { ":method", "GET" },
+        { ":path", "/a" },
+        { "Authorization", "Bearer abc" },
+        { "x-token", "12345" },
+    };
+    for (int block = 0; block < 3; block++) {
+        Buffer out;
+        encoder.beginBlock(out);
+        for (const auto& f : fields)
+            encoder.encode(out, f[0], strlen(f[0]), f[1], strlen(f[1]), strcmp(f[0], ":path") != 0);
+        Fields decoded;
+        CHECK(decoder.decode(out.data, out.len, decoded));
+        CHECK(strcmp(decoded.text(), ":method: GET\n:path: /a\nauthorization: Bearer abc\nx-token: 12345\n") == 0);
+        // after the first block, a byte for each field but :path, which takes four
+        if (block > 0) CHECK_EQ(out.len, 7);
+    }
+
+    // a smaller limit is announced, and evicts what no longer fits
+    encoder.setEncoderLimit(64);
+    Buffer out;
+    encoder.beginBlock(out);
+    encoder.encode(out, "x-token", 7, "12345", 5);
+    CHECK_EQ(out.data[0], 0x3f);
+    Fields decoded;
+    CHECK(decoder.decode(out.data, out.len, decoded));
+    CHECK(strcmp(decoded.text(), "x-token: 12345\n") == 0);
+}
+
+int main() {
+    RUN(test_requests);
+    RUN(test_requests_huffman);
+    RUN(test_responses);
+    RUN(test_responses_huffman);
+    RUN(test_huffman_invalid);
+    RUN(test_table_size);
+    RUN(test_large_field);
+    RUN(test_round_trip);
+    return TEST_RESULT;
+}
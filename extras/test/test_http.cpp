@@ -0,0 +1,238 @@
+/**
+ * SSLHttpClient's response parser, against scripted responses from the
+ * loopback server: Content-Length and chunked bodies, responses split across
+ * TLS records at awkward places, lengths too large to hold, and servers that
+ * close the connection before the response is complete.
+ */
+
+#include <limits.h>
+
+#include "SSLClient.h"
+#include "SSLHttpClient.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+static LoopbackServer server;
+
+// in a response's parts, end the connection instead of sending data
+static const char CLOSE_NOTIFY[] = "<close_notify>";
+static const char HANG_UP[] = "<hang up>";
+
+// the answer to each request, in order: the parts of a response, each sent in
+// a TLS record of its own, and ended by nullptr
+static const char* const* answers[8];
+static size_t answers_next;
+static unsigned request_matched;
+
+static void http_server(LoopbackServer& server, const uint8_t* data, size_t len, void* /* ctx */) {
+    for (size_t i = 0; i < len; i++) {
+        // each request ends with an empty line
+        request_matched = data[i] == "\r\n\r\n"[request_matched] ? request_matched + 1 : (data[i] == '\r' ? 1 : 0);
+        if (request_matched < 4) continue;
+        request_matched = 0;
+        if (answers_next == sizeof answers / sizeof answers[0] || answers[answers_next] == nullptr) continue;
+        for (const char* const* part = answers[answers_next++]; *part != nullptr; part++) {
+            if (*part == CLOSE_NOTIFY) server.closeNotify();
+            else if (*part == HANG_UP) server.hangUp();
+            else server.send(*part);
+        }
+    }
+}
+
+static void set_answers(std::initializer_list<const char* const*> list) {
+    size_t i = 0;
+    for (const char* const* answer : list) answers[i++] = answer;
+    while (i < sizeof answers / sizeof answers[0]) answers[i++] = nullptr;
+    answers_next = 0;
+    request_matched = 0;
+}
+
+// read the whole body of the current response
+static size_t read_body(SSLHttpClient& http, char* body, size_t size) {
+    size_t total = 0, len;
+    while (const uint8_t* data = http.readBody(len)) {
+        if (len > size - 1 - total) len = size - 1 - total;
+        memcpy(body + total, data, len);
+        total += len;
+    }
+    body[total] = '\0';
+    return total;
+}
+
+static void test_content_length() {
+    static const char* const first[] = { "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello", nullptr };
+    static const char* const second[] = { "HTTP/1.1 404 Not Found\r\ncontent-length: 0\r\n\r\n", nullptr };
+    set_answers({ first, second });
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttpClient http(client, "localhost");
+    http.setTimeout(1000);
+    CHECK(http.get("/a"));
+    CHECK(http.get("/b"));
+    char body[64];
+    CHECK(http.readResponse());
+    CHECK_EQ(http.status(), 200);
+    CHECK_EQ(http.contentLength(), 5);
+    CHECK(http.keepAlive());
+    CHECK_EQ(read_body(http, body, sizeof body), 5);
+    CHECK(strcmp(body, "hello") == 0);
+    CHECK(http.bodyComplete());
+    CHECK(http.readResponse());
+    CHECK_EQ(http.status(), 404);
+    CHECK_EQ(http.contentLength(), 0);
+    CHECK(http.bodyComplete());
+    CHECK(!http.readResponse());
+    http.stop();
+}
+
+static void test_chunked() {
+    // chunk sizes in either case, an extension, trailers, and the framing split
+    // across records; a second response checks that all of it was consumed
+    static const char* const first[] = {
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r", "\nhel", "lo\r\n",
+        "A;name=value\r\n, chunked ", "\r\n1", "\r\n!\r\n0\r\nX-Trailer: 1\r\n", "\r\n", nullptr
+    };
+    static const char* const second[] = { "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok", nullptr };
+    set_answers({ first, second });
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttpClient http(client, "localhost");
+    http.setTimeout(1000);
+    CHECK(http.get("/a"));
+    CHECK(http.get("/b"));
+    char body[64];
+    CHECK(http.readResponse());
+    CHECK(http.isChunked());
+    CHECK_EQ(http.contentLength(), -1);
+    CHECK_EQ(read_body(http, body, sizeof body), 16);
+    CHECK(strcmp(body, "hello, chunked !") == 0);
+    CHECK(http.bodyComplete());
+    CHECK(http.keepAlive());
+    CHECK(http.readResponse());
+    CHECK_EQ(read_body(http, body, sizeof body), 2);
+    CHECK(strcmp(body, "ok") == 0);
+    http.stop();
+}
+
+static void test_split_headers() {
+    static const char* const answer[] = {
+        "HTTP/1.", "1 2", "00 OK\r", "\nConte", "nt-Len", "gth: 1", "2\r\nTransfer-Encoding: identity\r\nConnection: cl",
+        "ose\r\n\r", "\nhello", " world!", nullptr
+    };
+    set_answers({ answer });
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttpClient http(client, "localhost");
+    http.setTimeout(1000);
+    CHECK(http.get("/"));
+    char body[64];
+    CHECK(http.readResponse());
+    CHECK_EQ(http.status(), 200);
+    CHECK_EQ(http.contentLength(), 12);
+    CHECK(!http.isChunked());
+    CHECK(!http.keepAlive());
+    CHECK_EQ(read_body(http, body, sizeof body), 12);
+    CHECK(strcmp(body, "hello world!") == 0);
+    CHECK(http.bodyComplete());
+    http.stop();
+}
+
+static void test_content_length_limit() {
+    static char at_limit[96], over_limit[96];
+    snprintf(at_limit, sizeof at_limit, "HTTP/1.1 200 OK\r\nContent-Length: %ld\r\n\r\n", LONG_MAX);
+    snprintf(over_limit, sizeof over_limit, "HTTP/1.1 200 OK\r\nContent-Length: %lu\r\n\r\n",
+        static_cast<unsigned long>(LONG_MAX) + 1);
+    static const char* const at[] = { at_limit, "body", nullptr };
+    static const char* const over[] = { over_limit, "body", nullptr };
+    static const char* const huge[] = { "HTTP/1.1 200 OK\r\nContent-Length: 100000000000000000000000\r\n\r\n", nullptr };
+
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttpClient http(client, "localhost");
+    http.setTimeout(1000);
+
+    set_answers({ at });
+    CHECK(http.get("/"));
+    CHECK(http.readResponse());
+    CHECK_EQ(http.status(), 200);
+    CHECK_EQ(http.contentLength(), LONG_MAX);
+    uint8_t buf[8];
+    CHECK_EQ(http.readBody(buf, sizeof buf), 4);
+    CHECK(!http.bodyComplete());
+    http.stop();
+
+    // the response fails, rather than having its body cut short
+    set_answers({ over });
+    CHECK(http.get("/"));
+    CHECK(!http.readResponse());
+    CHECK_EQ(http.status(), 0);
+    CHECK_EQ(http.pending(), 0);
+
+    set_answers({ huge });
+    CHECK(http.get("/"));
+    CHECK(!http.readResponse());
+    CHECK_EQ(http.status(), 0);
+    http.stop();
+}
+
+static void test_early_close() {
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    // flush() waits for an answer that will not come, for the read timeout
+    client.setReadTimeout(200);
+    SSLHttpClient http(client, "localhost");
+    http.setTimeout(1000);
+    char body[64];
+
+    // closed before the end of the body: what came is handed out, but the
+    // response is not complete, and the one pipelined after it is lost
+    static const char* const short_body[] = { "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nhello", HANG_UP, nullptr };
+    set_answers({ short_body });
+    CHECK(http.get("/a"));
+    CHECK(http.get("/b"));
+    CHECK(http.readResponse());
+    CHECK_EQ(read_body(http, body, sizeof body), 5);
+    CHECK(!http.bodyComplete());
+    CHECK(!http.readResponse());
+
+    // closed in the middle of the headers
+    static const char* const short_head[] = { "HTTP/1.1 200 OK\r\nContent-Len", CLOSE_NOTIFY, nullptr };
+    set_answers({ short_head });
+    CHECK(http.get("/"));
+    CHECK(!http.readResponse());
+    CHECK_EQ(http.status(), 0);
+
+    // closed without any answer
+    static const char* const nothing[] = { HANG_UP, nullptr };
+    set_answers({ nothing });
+    CHECK(http.get("/"));
+    CHECK(!http.readResponse());
+
+    // a body without a length ends with the connection, and then it is complete
+    static const char* const until_close[] = { "HTTP/1.0 200 OK\r\n\r\nuntil ", "the end", CLOSE_NOTIFY, nullptr };
+    set_answers({ until_close });
+    CHECK(http.get("/"));
+    CHECK(http.readResponse());
+    CHECK(!http.keepAlive());
+    CHECK_EQ(read_body(http, body, sizeof body), 13);
+    CHECK(strcmp(body, "until the end") == 0);
+    CHECK(http.bodyComplete());
+
+    // and the next request reconnects
+    static const char* const again[] = { "HTTP/1.1 204 No Content\r\n\r\n", nullptr };
+    set_answers({ again });
+    const unsigned connects = server.connects();
+    CHECK(http.get("/"));
+    CHECK_EQ(server.connects(), connects + 1);
+    CHECK(http.readResponse());
+    CHECK_EQ(http.status(), 204);
+    http.stop();
+}
+
+int main() {
+    server.setHandler(http_server);
+    RUN(test_content_length);
+    RUN(test_chunked);
+    RUN(test_split_headers);
+    RUN(test_content_length_limit);
+    RUN(test_early_close);
+    return TEST_RESULT;
+}
@@ -0,0 +1,226 @@
+/**
+ * SSLHttp2Client against a scripted HTTP/2 server on the loopback: response
+ * header blocks split over HEADERS and CONTINUATION frames, and the frames that
+ * may not come in the middle of a header block, which fail the connection.
+ */
+
+#include "SSLClient.h"
+#include "SSLHttp2Client.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+static const uint8_t DATA = 0x0;
+static const uint8_t HEADERS = 0x1;
+static const uint8_t SETTINGS = 0x4;
+static const uint8_t PING = 0x6;
+static const uint8_t CONTINUATION = 0x9;
+static const uint8_t END_STREAM = 0x1;
+static const uint8_t END_HEADERS = 0x4;
+
+static LoopbackServer server;
+
+// answers a request on a stream with frames
+typedef void (*Responder)(uint32_t stream);
+
+static Responder respond;
+// what the client sent on this connection, and how much of it was handled
+static uint8_t client_data[8192];
+static size_t client_len;
+static size_t client_pos;
+
+static void send_frame(uint8_t type, uint8_t flags, uint32_t stream, const void* payload, size_t len) {
+    uint8_t frame[9 + 2048];
+    frame[0] = static_cast<uint8_t>(len >> 16);
+    frame[1] = static_cast<uint8_t>(len >> 8);
+    frame[2] = static_cast<uint8_t>(len);
+    frame[3] = type;
+    frame[4] = flags;
+    frame[5] = static_cast<uint8_t>(stream >> 24);
+    frame[6] = static_cast<uint8_t>(stream >> 16);
+    frame[7] = static_cast<uint8_t>(stream >> 8);
+    frame[8] = static_cast<uint8_t>(stream);
+    memcpy(frame + 9, payload, len);
+    server.send(frame, 9 + len);
+}
+
+static void h2_server(LoopbackServer& server, const uint8_t* data, size_t len, void* /* ctx */) {
+    static const size_t PREFACE_LEN = 24;
+    memcpy(client_data + client_len, data, len);
+    client_len += len;
+    if (client_pos == 0) {
+        if (client_len < PREFACE_LEN) return;
+        client_pos = PREFACE_LEN;
+        send_frame(SETTINGS, 0, 0, nullptr, 0);
+    }
+    while (client_len - client_pos >= 9) {
+        const uint8_t* frame = client_data + client_pos;
+        const size_t frame_len = (static_cast<size_t>(frame[0]) << 16) | (frame[1] << 8) | frame[2];
+        if (client_len - client_pos < 9 + frame_len) return;
+        const uint32_t stream = (static_cast<uint32_t>(frame[5] & 0x7F) << 24) | (frame[6] << 16)
+            | (frame[7] << 8) | frame[8];
+        if (frame[3] == HEADERS && respond != nullptr) respond(stream);
+        client_pos += 9 + frame_len;
+    }
+}
+
+/** Collects the headers and body of the responses */
+class Listener : public SSLHttp2Listener {
+public:
+    void onHeader(int /* stream */, const char* name, const char* value) override {
+        headers_len += snprintf(headers + headers_len, sizeof headers - headers_len, "%s: %s\n", name, value);
+    }
+    void onData(int /* stream */, const uint8_t* data, size_t len) override {
+        memcpy(body + body_len, data, len);
+        body_len += len;
+        body[body_len] = '\0';
+    }
+    char headers[512] = "";
+    size_t headers_len = 0;
+    char body[64] = "";
+    size_t body_len = 0;
+};
+
+// start a test with a new connection, answered by responder
+static void start(Responder responder) {
+    respond = responder;
+    client_len = 0;
+    client_pos = 0;
+}
+
+// ":status: 200", "content-length: 5" and "x-a: b", with incremental indexing
+static const uint8_t BLOCK[] = { 0x88, 0x0f, 0x0d, 0x01, 0x35, 0x40, 0x03, 0x78, 0x2d, 0x61, 0x01, 0x62 };
+
+// the block over three frames, split in the middle of fields, and a body
+static void respond_split(uint32_t stream) {
+    if (stream == 1) {
+        send_frame(HEADERS, 0, stream, BLOCK, 2);
+        send_frame(CONTINUATION, 0, stream, BLOCK + 2, 5);
+        send_frame(CONTINUATION, END_HEADERS, stream, BLOCK + 7, sizeof BLOCK - 7);
+        send_frame(DATA, END_STREAM, stream, "hello", 5);
+    }
+    else {
+        // "x-a: b" from the dynamic table
+        static const uint8_t block[] = { 0x89, 0xbe };
+        send_frame(HEADERS, END_HEADERS | END_STREAM, stream, block, sizeof block);
+    }
+}
+
+static void test_continuation() {
+    start(respond_split);
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttp2Client http(client, "localhost");
+    http.setTimeout(1000);
+    Listener listener;
+    http.setListener(&listener);
+    const int stream = http.get("/");
+    CHECK(stream >= 0);
+    CHECK(http.wait(stream));
+    CHECK(!http.failed(stream));
+    CHECK_EQ(http.status(stream), 200);
+    CHECK_EQ(http.contentLength(stream), 5);
+    CHECK(strcmp(listener.headers, ":status: 200\ncontent-length: 5\nx-a: b\n") == 0);
+    CHECK(strcmp(listener.body, "hello") == 0);
+    http.release(stream);
+
+    // the block was decoded as a whole, so the tables are still in step
+    listener.headers_len = 0;
+    const int next = http.get("/");
+    CHECK(http.wait(next));
+    CHECK_EQ(http.status(next), 204);
+    CHECK(strcmp(listener.headers, ":status: 204\nx-a: b\n") == 0);
+    http.release(next);
+    http.stop();
+}
+
+// END_STREAM on the HEADERS frame ends the stream after its last CONTINUATION
+static void respond_end_stream(uint32_t stream) {
+    send_frame(HEADERS, END_STREAM, stream, BLOCK, 5);
+    send_frame(CONTINUATION, END_HEADERS, stream, BLOCK + 5, sizeof BLOCK - 5);
+}
+
+static void test_continuation_end_stream() {
+    start(respond_end_stream);
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttp2Client http(client, "localhost");
+    http.setTimeout(1000);
+    Listener listener;
+    http.setListener(&listener);
+    const int stream = http.get("/");
+    CHECK(http.wait(stream));
+    CHECK(!http.failed(stream));
+    CHECK_EQ(http.status(stream), 200);
+    CHECK(strcmp(listener.headers, ":status: 200\ncontent-length: 5\nx-a: b\n") == 0);
+    CHECK_EQ(listener.body_len, 0);
+    http.release(stream);
+    http.stop();
+}
+
+static void respond_ping_between(uint32_t stream) {
+    send_frame(HEADERS, 0, stream, BLOCK, 5);
+    send_frame(PING, 0, 0, "12345678", 8);
+    send_frame(CONTINUATION, END_HEADERS, stream, BLOCK + 5, sizeof BLOCK - 5);
+}
+
+static void respond_data_between(uint32_t stream) {
+    send_frame(HEADERS, 0, stream, BLOCK, 5);
+    send_frame(DATA, 0, stream, "hello", 5);
+    send_frame(CONTINUATION, END_HEADERS, stream, BLOCK + 5, sizeof BLOCK - 5);
+}
+
+static void respond_other_stream(uint32_t stream) {
+    send_frame(HEADERS, 0, stream, BLOCK, 5);
+    send_frame(CONTINUATION, END_HEADERS, stream + 2, BLOCK + 5, sizeof BLOCK - 5);
+}
+
+static void respond_lone_continuation(uint32_t stream) {
+    send_frame(CONTINUATION, END_HEADERS, stream, BLOCK, sizeof BLOCK);
+}
+
+// a block larger than SSLCLIENT_H2_MAX_HEADER_BLOCK, over several frames
+static void respond_too_large(uint32_t stream) {
+    static const uint8_t filler[SSLCLIENT_H2_MAX_HEADER_BLOCK / 2] = {};
+    send_frame(HEADERS, 0, stream, BLOCK, 5);
+    send_frame(CONTINUATION, 0, stream, filler, sizeof filler);
+    send_frame(CONTINUATION, 0, stream, filler, sizeof filler);
+    send_frame(CONTINUATION, END_HEADERS, stream, BLOCK + 5, sizeof BLOCK - 5);
+}
+
+// the request fails, and so does the connection
+static void check_failure(Responder responder) {
+    start(responder);
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLHttp2Client http(client, "localhost");
+    http.setTimeout(1000);
+    const int stream = http.get("/");
+    CHECK(stream >= 0);
+    CHECK(!http.wait(stream));
+    CHECK(http.failed(stream));
+    CHECK_EQ(http.status(stream), 0);
+    CHECK(!client.connected());
+    http.release(stream);
+}
+
+static void test_interrupted_block() {
+    check_failure(respond_ping_between);
+    check_failure(respond_data_between);
+    check_failure(respond_other_stream);
+    check_failure(respond_lone_continuation);
+}
+
+static void test_block_too_large() {
+    check_failure(respond_too_large);
+}
+
+int main() {
+    static const char* protocols[] = { "h2" };
+    server.setProtocols(protocols, 1);
+    server.setHandler(h2_server);
+    RUN(test_continuation);
+    RUN(test_continuation_end_stream);
+    RUN(test_interrupted_block);
+    RUN(test_block_too_large);
+    return TEST_RESULT;
+}
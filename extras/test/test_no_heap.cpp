@@ -0,0 +1,190 @@
+/**
+ * SSLCLIENT_NO_HEAP at run time: with the library built in heap-free mode, whole
+ * sessions (construction, handshake, resumption, reads, writes, close_notify and
+ * destruction) must not allocate. malloc and operator new are replaced with
+ * versions that count calls, which also sees allocations made by templates
+ * compiled here (SSLClientFor, SSLFileSource), by inline code in headers, and by
+ * the C++ library on the library's behalf, none of which the poisoning in the
+ * library sources can check.
+ *
+ * This file is compiled with SSLCLIENT_NO_HEAP, like a sketch would be.
+ */
+
+#include <new>
+#include <stdlib.h>
+
+static bool counting = false;
+static unsigned long allocations = 0;
+
+#ifdef __GLIBC__
+// glibc lets a program replace malloc, and call its own through these
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size) {
+    if (counting) allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size) {
+    if (counting) allocations++;
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+#endif
+
+void* operator new(size_t size) {
+    if (counting) allocations++;
+    void* ptr = malloc(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+
+#include "SSLClient.h"
+#include "SSLHttpClient.h"
+#include "SSLSessionCache.h"
+#include "SSLSource.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static LoopbackServer server;
+
+// SSLClient::flush waits for an answer, so the server echoes what it gets
+static void echo(LoopbackServer& server, const uint8_t* data, size_t len, void* /* ctx */) {
+    server.send(data, len);
+}
+
+// answer every request (each ends with an empty line) with a short response
+static void http(LoopbackServer& server, const uint8_t* data, size_t len, void* ctx) {
+    unsigned& matched = *static_cast<unsigned*>(ctx);
+    for (size_t i = 0; i < len; i++) {
+        matched = data[i] == "\r\n\r\n"[matched] ? matched + 1 : (data[i] == '\r' ? 1 : 0);
+        if (matched == 4) {
+            matched = 0;
+            server.send("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello");
+        }
+    }
+}
+
+static void session(SSLClient& client) {
+    static const uint8_t upload[300] = {};
+    for (int round = 0; round < 3; round++) {
+        CHECK(client.connect("localhost", 443));
+        CHECK_EQ(round == 0 || server.resumed(), true);
+        CHECK_EQ(client.write((const uint8_t*)"ping", 4), 4);
+        client.flush();
+        uint8_t buf[16];
+        CHECK_EQ(client.available(), 4);
+        CHECK_EQ(client.read(buf, sizeof buf), 4);
+        SSLMemorySource source(upload, sizeof upload);
+        CHECK_EQ(client.writeFrom(source), sizeof upload);
+        client.flush();
+        while (client.available() > 0) client.read(buf, sizeof buf);
+        client.stop();
+    }
+}
+
+// make sure the counting works, or every other test would pass for nothing
+static void test_counting() {
+    static void* volatile keep;
+    counting = true;
+#ifdef __GLIBC__
+    keep = malloc(16);
+    free(keep);
+#endif
+    keep = new int(1);
+    delete static_cast<int*>(keep);
+    counting = false;
+#ifdef __GLIBC__
+    CHECK(allocations >= 2);
+#else
+    CHECK(allocations >= 1);
+#endif
+}
+
+static void test_client() {
+    allocations = 0;
+    server.setHandler(echo);
+    counting = true;
+    {
+        SSLClient client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, SSLClient::SSL_NONE);
+        session(client);
+    }
+    counting = false;
+    CHECK_EQ(allocations, 0);
+}
+
+static void test_client_for() {
+    allocations = 0;
+    server.setHandler(echo);
+    counting = true;
+    {
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, SSLClient::SSL_NONE);
+        session(client);
+    }
+    counting = false;
+    CHECK_EQ(allocations, 0);
+}
+
+static void test_shared_cache() {
+    allocations = 0;
+    server.setHandler(echo);
+    counting = true;
+    {
+        SSLSessionCache cache(2);
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, SSLClient::SSL_NONE);
+        client.setSessionCache(&cache);
+        session(client);
+    }
+    counting = false;
+    CHECK_EQ(allocations, 0);
+}
+
+static void test_http() {
+    allocations = 0;
+    unsigned matched = 0;
+    server.setHandler(http, &matched);
+    counting = true;
+    {
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, SSLClient::SSL_NONE);
+        SSLHttpClient http(client, "localhost");
+        for (int i = 0; i < 4; i++) CHECK(http.get("/"));
+        CHECK(http.flush());
+        for (int i = 0; i < 4; i++) {
+            CHECK(http.readResponse());
+            CHECK_EQ(http.status(), 200);
+            uint8_t body[8];
+            CHECK_EQ(http.readBody(body, sizeof body), 5);
+        }
+        http.stop();
+    }
+    counting = false;
+    CHECK_EQ(allocations, 0);
+}
+
+int main() {
+#ifndef __GLIBC__
+    printf("malloc is not replaced on this host, only operator new is checked\n");
+#endif
+    RUN(test_counting);
+    RUN(test_client);
+    RUN(test_client_for);
+    RUN(test_shared_cache);
+    RUN(test_http);
+    return TEST_RESULT;
+}
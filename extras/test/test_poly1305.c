@@ -0,0 +1,116 @@
+/*
+ * ChaCha20+Poly1305 against the RFC 8439 AEAD test vector (section
+ * 2.8.2), through br_poly1305_ctmul_run() and through the incremental
+ * br_poly1305_ctmul_init() / update() / final() that the record layer
+ * uses for records that arrive in pieces.
+ */
+
+#include "inner.h"
+#include "test.h"
+
+static const unsigned char KEY[32] = {
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+	0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f
+};
+static const unsigned char NONCE[12] = {
+	0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43,
+	0x44, 0x45, 0x46, 0x47
+};
+static const unsigned char AAD[12] = {
+	0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3,
+	0xc4, 0xc5, 0xc6, 0xc7
+};
+static const char PLAIN[] = "Ladies and Gentlemen of the class of '99:"
+	" If I could offer you only one tip for the future,"
+	" sunscreen would be it.";
+static const unsigned char CIPHER[114] = {
+	0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb,
+	0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+	0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+	0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+	0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12,
+	0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+	0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29,
+	0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+	0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+	0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+	0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94,
+	0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+	0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d,
+	0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+	0x61, 0x16
+};
+static const unsigned char TAG[16] = {
+	0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a,
+	0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91
+};
+
+static void
+test_run(void)
+{
+	unsigned char buf[sizeof CIPHER], tag[16];
+
+	memcpy(buf, PLAIN, sizeof buf);
+	br_poly1305_ctmul_run(KEY, NONCE, buf, sizeof buf,
+		AAD, sizeof AAD, tag, &br_chacha20_ct_run, 1);
+	CHECK_MEM(buf, CIPHER, sizeof CIPHER);
+	CHECK_MEM(tag, TAG, sizeof TAG);
+
+	br_poly1305_ctmul_run(KEY, NONCE, buf, sizeof buf,
+		AAD, sizeof AAD, tag, &br_chacha20_ct_run, 0);
+	CHECK_MEM(buf, PLAIN, sizeof buf);
+	CHECK_MEM(tag, TAG, sizeof TAG);
+}
+
+/*
+ * Authenticate the ciphertext in pieces of 'chunk' bytes (a multiple
+ * of 16), the last one being shorter, as the record layer does.
+ */
+static void
+incremental_tag(size_t chunk, unsigned char *tag)
+{
+	br_poly1305_ctmul_state st;
+	unsigned char pkey[32];
+	size_t off, len;
+
+	memset(pkey, 0, sizeof pkey);
+	br_chacha20_ct_run(KEY, NONCE, 0, pkey, sizeof pkey);
+	br_poly1305_ctmul_init(&st, pkey);
+	br_poly1305_ctmul_update(&st, AAD, sizeof AAD);
+	for (off = 0; off < sizeof CIPHER; off += len) {
+		len = sizeof CIPHER - off;
+		if (len > chunk) {
+			len = chunk;
+		}
+		br_poly1305_ctmul_update(&st, CIPHER + off, len);
+	}
+	br_poly1305_ctmul_final(&st, sizeof AAD, sizeof CIPHER, tag);
+}
+
+static void
+test_incremental(void)
+{
+	size_t chunk;
+
+	/*
+	 * The ciphertext is 114 bytes, so every split ends with a piece
+	 * that is not a multiple of 16, down to the 2 bytes after 112;
+	 * the last one is the whole ciphertext at once.
+	 */
+	for (chunk = 16; chunk < sizeof CIPHER + 16; chunk += 16) {
+		unsigned char tag[16];
+
+		incremental_tag(chunk, tag);
+		CHECK_MEM(tag, TAG, sizeof TAG);
+	}
+}
+
+int
+main(void)
+{
+	RUN(test_run);
+	RUN(test_incremental);
+	return TEST_RESULT;
+}
@@ -0,0 +1,325 @@
+/*
+ * Decryption of GCM and ChaCha20+Poly1305 records while they are being
+ * received (br_sslrec_in_gcm_update() and br_sslrec_in_chapol_update()).
+ * Each record is decrypted once in one go, then again with its bytes
+ * handed over in pieces, split at every possible place, the way the
+ * engine does when the record arrives over several reads; both must
+ * give the plaintext, and a record whose tag or ciphertext was changed
+ * must still be rejected. Records encrypted with a precomputed keystream
+ * (br_sslrec_out_gcm_precompute(), br_sslrec_out_chapol_precompute())
+ * must be the same as the others.
+ */
+
+#include "inner.h"
+#include "test.h"
+
+#define RECORD_TYPE   23
+#define RECORD_MAX    (5 + 8 + 1100 + 16)
+
+typedef union {
+	const br_sslrec_in_class *in;
+	const br_sslrec_out_class *out;
+	br_sslrec_gcm_context gcm;
+	br_sslrec_chapol_context chapol;
+} record_context;
+
+typedef struct {
+	const char *name;
+	/* set up the decrypting and encrypting sides with the same keys */
+	void (*init)(record_context *in, record_context *out);
+	void (*update)(record_context *in, void *data, size_t len, size_t rlen);
+	size_t (*precompute)(record_context *out, void *buf, size_t len);
+} record_suite;
+
+static const unsigned char KEY[32] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f
+};
+static const unsigned char IV[12] = {
+	0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5,
+	0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab
+};
+
+static void
+gcm_init(record_context *in, record_context *out)
+{
+	br_sslrec_in_gcm_vtable.init(&in->gcm.vtable.in,
+		&br_aes_ct_ctr_vtable, KEY, 16, &br_ghash_ctmul, IV);
+	br_sslrec_out_gcm_vtable.init(&out->gcm.vtable.out,
+		&br_aes_ct_ctr_vtable, KEY, 16, &br_ghash_ctmul, IV);
+}
+
+static void
+gcm_update(record_context *in, void *data, size_t len, size_t rlen)
+{
+	br_sslrec_in_gcm_update(&in->gcm, RECORD_TYPE, BR_TLS12,
+		data, len, rlen);
+}
+
+static size_t
+gcm_precompute(record_context *out, void *buf, size_t len)
+{
+	return br_sslrec_out_gcm_precompute(&out->gcm, buf, len);
+}
+
+static void
+chapol_ctmul_init(record_context *in, record_context *out)
+{
+	br_sslrec_in_chapol_vtable.init(&in->chapol.vtable.in,
+		&br_chacha20_ct_run, &br_poly1305_ctmul_run, KEY, IV);
+	br_sslrec_out_chapol_vtable.init(&out->chapol.vtable.out,
+		&br_chacha20_ct_run, &br_poly1305_ctmul_run, KEY, IV);
+}
+
+/*
+ * The pieces are always authenticated with the ctmul code, so a
+ * different Poly1305 implementation for whole records checks one
+ * against the other.
+ */
+static void
+chapol_i15_init(record_context *in, record_context *out)
+{
+	br_sslrec_in_chapol_vtable.init(&in->chapol.vtable.in,
+		&br_chacha20_ct_run, &br_poly1305_i15_run, KEY, IV);
+	br_sslrec_out_chapol_vtable.init(&out->chapol.vtable.out,
+		&br_chacha20_ct_run, &br_poly1305_i15_run, KEY, IV);
+}
+
+static void
+chapol_update(record_context *in, void *data, size_t len, size_t rlen)
+{
+	br_sslrec_in_chapol_update(&in->chapol, RECORD_TYPE, BR_TLS12,
+		data, len, rlen);
+}
+
+static size_t
+chapol_precompute(record_context *out, void *buf, size_t len)
+{
+	return br_sslrec_out_chapol_precompute(&out->chapol, buf, len);
+}
+
+static const record_suite SUITES[] = {
+	{ "AES-128/GCM", &gcm_init, &gcm_update, &gcm_precompute },
+	{ "ChaCha20+Poly1305 (ctmul)", &chapol_ctmul_init, &chapol_update,
+		&chapol_precompute },
+	{ "ChaCha20+Poly1305 (i15)", &chapol_i15_init, &chapol_update,
+		&chapol_precompute }
+};
+
+/*
+ * Payload lengths: empty, around one block (16 bytes for GCM, 64 for
+ * ChaCha20), and longer ones that end with a partial block.
+ */
+static const size_t LENGTHS[] = {
+	0, 1, 15, 16, 17, 63, 64, 65, 100, 300, 1100
+};
+
+/*
+ * Encrypt 'len' bytes of plaintext into a whole record, header
+ * included, at 'rec'. Returned value is the record length.
+ */
+static size_t
+encrypt_record(record_context *out, const unsigned char *plain, size_t len,
+	unsigned char *rec)
+{
+	size_t start, end;
+	unsigned char *buf;
+
+	start = 5;
+	end = RECORD_MAX;
+	out->out->max_plaintext(&out->out, &start, &end);
+	memcpy(rec + start, plain, len);
+	buf = out->out->encrypt(&out->out, RECORD_TYPE, BR_TLS12,
+		rec + start, &len);
+	CHECK(buf == rec);
+	return len;
+}
+
+/*
+ * Decrypt the record payload in 'payload' (record header excluded),
+ * first handing over its first 'step' bytes, then 2*step, and so on
+ * while the record is incomplete (or only its first 'step' bytes if
+ * 'once' is set). With a step of 0 the record is decrypted in one go.
+ * Returned value is the plaintext, or NULL if the record was rejected.
+ */
+static unsigned char *
+decrypt_record(const record_suite *suite, record_context *in,
+	unsigned char *payload, size_t rlen, size_t step, int once,
+	size_t *len)
+{
+	size_t got;
+
+	if (step > 0) {
+		for (got = step; got < rlen; got += step) {
+			suite->update(in, payload, got, rlen);
+			if (once) {
+				break;
+			}
+		}
+	}
+	*len = rlen;
+	return in->in->decrypt(&in->in, RECORD_TYPE, BR_TLS12,
+		payload, len);
+}
+
+static void
+test_split_records(void)
+{
+	static unsigned char plain[1100];
+	static unsigned char rec[RECORD_MAX];
+	static unsigned char payload[RECORD_MAX];
+	size_t u, v, w;
+
+	for (u = 0; u < sizeof plain; u ++) {
+		plain[u] = (unsigned char)(u * 7 + 1);
+	}
+	for (u = 0; u < sizeof SUITES / sizeof SUITES[0]; u ++) {
+		const record_suite *suite;
+
+		suite = &SUITES[u];
+		for (v = 0; v < sizeof LENGTHS / sizeof LENGTHS[0]; v ++) {
+			record_context in, out, next;
+			size_t plen, rlen, step, len;
+			unsigned char *dec;
+			int once, failed;
+
+			/*
+			 * The first record is decrypted in one go, so that the
+			 * pieces are tried on a record with a non-zero
+			 * sequence number.
+			 */
+			plen = LENGTHS[v];
+			suite->init(&in, &out);
+			rlen = encrypt_record(&out, plain, plen, rec) - 5;
+			memcpy(payload, rec + 5, rlen);
+			dec = decrypt_record(suite, &in, payload, rlen,
+				0, 0, &len);
+			CHECK(dec != NULL && len == plen);
+			rlen = encrypt_record(&out, plain, plen, rec) - 5;
+			next = in;
+
+			failed = 0;
+			for (step = 0; step < rlen; step ++) {
+				for (once = 0; once <= (step > 0); once ++) {
+					in = next;
+					memcpy(payload, rec + 5, rlen);
+					dec = decrypt_record(suite, &in,
+						payload, rlen, step, once, &len);
+					if (dec == NULL || len != plen
+						|| memcmp(dec, plain, plen) != 0)
+					{
+						fprintf(stderr, "%s: %u bytes,"
+							" step %u%s: wrong"
+							" plaintext\n",
+							suite->name,
+							(unsigned)plen,
+							(unsigned)step,
+							once ? " (once)" : "");
+						failed ++;
+					}
+				}
+			}
+
+			/*
+			 * A changed tag, or a changed first ciphertext byte,
+			 * must be caught however the record was split.
+			 */
+			for (w = 0; w < 2; w ++) {
+				size_t pos;
+
+				pos = (w == 0) ? rlen - 1 : rlen - plen - 16;
+				if (w == 1 && plen == 0) {
+					continue;
+				}
+				for (step = 0; step < rlen; step ++) {
+					in = next;
+					memcpy(payload, rec + 5, rlen);
+					payload[pos] ^= 0x01;
+					dec = decrypt_record(suite, &in,
+						payload, rlen, step, 0, &len);
+					if (dec != NULL) {
+						fprintf(stderr, "%s: %u bytes,"
+							" step %u: changed byte"
+							" %u accepted\n",
+							suite->name,
+							(unsigned)plen,
+							(unsigned)step,
+							(unsigned)pos);
+						failed ++;
+					}
+				}
+			}
+			CHECK_EQ(failed, 0);
+		}
+	}
+}
+
+/*
+ * Encrypt three records of each length with and without a precomputed
+ * keystream. The keystream covers the start of the longer records only,
+ * so the rest is encrypted the usual way. The middle record gets none,
+ * and must not be encrypted with what is left from the first one.
+ */
+static void
+test_precomputed_keystream(void)
+{
+	static unsigned char plain[1100];
+	static unsigned char rec1[RECORD_MAX], rec2[RECORD_MAX];
+	static unsigned char ks[256];
+	size_t u, v, w;
+
+	for (u = 0; u < sizeof plain; u ++) {
+		plain[u] = (unsigned char)(u * 13 + 5);
+	}
+	for (u = 0; u < sizeof SUITES / sizeof SUITES[0]; u ++) {
+		const record_suite *suite;
+
+		suite = &SUITES[u];
+		for (v = 0; v < sizeof LENGTHS / sizeof LENGTHS[0]; v ++) {
+			record_context in1, out1, in2, out2;
+			size_t plen;
+
+			plen = LENGTHS[v];
+			suite->init(&in1, &out1);
+			suite->init(&in2, &out2);
+			for (w = 0; w < 3; w ++) {
+				size_t len1, len2, len;
+				unsigned char *dec;
+
+				if (w != 1) {
+					CHECK(suite->precompute(&out2,
+						ks, sizeof ks) > 0);
+				}
+				len1 = encrypt_record(&out1, plain, plen, rec1);
+				len2 = encrypt_record(&out2, plain, plen, rec2);
+				CHECK_EQ(len1, len2);
+				CHECK_MEM(rec1, rec2, len1);
+				dec = decrypt_record(suite, &in2, rec2 + 5,
+					len2 - 5, 0, 0, &len);
+				CHECK(dec != NULL && len == plen
+					&& memcmp(dec, plain, plen) == 0);
+			}
+		}
+
+		/*
+		 * A buffer too small for the tag mask and one block is
+		 * not used.
+		 */
+		{
+			record_context in, out;
+
+			suite->init(&in, &out);
+			CHECK_EQ(suite->precompute(&out, ks, 16), 0);
+		}
+	}
+}
+
+int
+main(void)
+{
+	RUN(test_split_records);
+	RUN(test_precomputed_keystream);
+	return TEST_RESULT;
+}
@@ -0,0 +1,124 @@
+/**
+ * Automatic reconnect (SSLClient::setAutoReconnect): a connection whose network
+ * client drops is reopened by SSLClient::connected, resuming the session, and
+ * the data that was written but not sent is replayed on the new connection.
+ * Run for both SSLClient and SSLClientFor, which check the connection through
+ * different code.
+ */
+
+#include "SSLClient.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+static LoopbackServer server;
+
+static bool received(const char* expected) {
+    return server.receivedLen() == strlen(expected)
+        && memcmp(server.received(), expected, server.receivedLen()) == 0;
+}
+
+// SSLClient::flush waits for an answer, so the server echoes what it gets
+static void echo(LoopbackServer& server, const uint8_t* data, size_t len, void* /* ctx */) {
+    server.send(data, len);
+}
+
+// read len bytes of echo, and check that they match expected
+static void check_echo(SSLClient& client, const char* expected) {
+    char buf[32] = {};
+    const size_t len = strlen(expected);
+    CHECK_EQ(client.available(), len);
+    CHECK_EQ(client.read((uint8_t*)buf, sizeof buf), len);
+    CHECK(strcmp(buf, expected) == 0);
+}
+
+static void check_reconnect(SSLClient& client) {
+    client.setAutoReconnect(true, 256);
+    CHECK(client.connect("localhost", 443));
+    const unsigned connects = server.connects();
+    client.resetReconnectStats();
+
+    // written to the server before the drop, so not replayed
+    CHECK_EQ(client.write((const uint8_t*)"sent ", 5), 5);
+    client.flush();
+    CHECK(received("sent "));
+    check_echo(client, "sent ");
+    server.clearReceived();
+
+    // still in SSLClient's write buffer when the network drops
+    CHECK_EQ(client.write((const uint8_t*)"unsent", 6), 6);
+    server.drop();
+
+    // the replay is sent by connected() itself, so it is not answered: SSLClient
+    // would discard an answer that arrived while it was still sending
+    server.setHandler(nullptr);
+    CHECK_EQ(client.connected(), 1);
+    CHECK_EQ(server.connects(), connects + 1);
+    CHECK(server.resumed());
+    CHECK(received("unsent"));
+    server.setHandler(echo);
+    CHECK_EQ(client.getReconnectStats().reconnects, 1);
+    CHECK_EQ(client.getReconnectStats().replayed, 6);
+    CHECK_EQ(client.getReconnectStats().dropped, 0);
+
+    // the new connection is used from then on
+    server.clearReceived();
+    CHECK_EQ(client.write((const uint8_t*)"more", 4), 4);
+    client.flush();
+    check_echo(client, "more");
+    CHECK_EQ(server.connects(), connects + 1);
+
+    // a connection closed on purpose stays closed
+    client.stop();
+    CHECK_EQ(client.connected(), 0);
+    CHECK_EQ(server.connects(), connects + 1);
+}
+
+static void check_reconnect_fails(SSLClient& client) {
+    client.setAutoReconnect(true, 256);
+    CHECK(client.connect("localhost", 443));
+    client.resetReconnectStats();
+    CHECK_EQ(client.write((const uint8_t*)"kept", 4), 4);
+    server.drop();
+    server.setRefuse(true);
+    CHECK_EQ(client.connected(), 0);
+    CHECK_EQ(client.getReconnectStats().failures, 1);
+    // the data is kept for the next attempt
+    server.setRefuse(false);
+    server.setHandler(nullptr);
+    CHECK_EQ(client.connected(), 1);
+    CHECK(received("kept"));
+    server.setHandler(echo);
+    client.stop();
+}
+
+static void test_reconnect_base() {
+    SSLClient client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    check_reconnect(client);
+    check_reconnect_fails(client);
+}
+
+static void test_reconnect_templated() {
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    check_reconnect(client);
+    check_reconnect_fails(client);
+}
+
+static void test_no_reconnect_by_default() {
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    CHECK(client.connect("localhost", 443));
+    const unsigned connects = server.connects();
+    server.drop();
+    CHECK_EQ(client.connected(), 0);
+    CHECK_EQ(server.connects(), connects);
+}
+
+int main() {
+    server.setHandler(echo);
+    RUN(test_reconnect_base);
+    RUN(test_reconnect_templated);
+    RUN(test_no_reconnect_by_default);
+    return TEST_RESULT;
+}
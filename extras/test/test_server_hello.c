@@ -0,0 +1,297 @@
+/*
+ * How the client handles the extensions of a ServerHello: a bare client
+ * engine sends its ClientHello, and is then given a ServerHello built
+ * here, so that servers that misbehave can be tried as well as the ones
+ * that do not. This covers the Extended Master Secret (RFC 7627) and
+ * the Record Size Limit (RFC 8449).
+ */
+
+#include "inner.h"
+#include "test.h"
+#include "test_cert.h"
+
+/*
+ * With room for 2048-byte records only, the client asks for both a
+ * Max Fragment Length and a Record Size Limit.
+ */
+#define BUFFER_SIZE   (2048 + 325)
+
+static br_ssl_client_context cc;
+static br_x509_minimal_context xc;
+static unsigned char iobuf[BUFFER_SIZE];
+
+static const unsigned char SESSION_ID[32] = {
+	0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51,
+	0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51,
+	0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51,
+	0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51, 0x51
+};
+static const unsigned char OTHER_ID[32] = {
+	0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52,
+	0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52,
+	0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52,
+	0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52, 0x52
+};
+
+static const unsigned char EXT_EMS[] = { 0x00, 0x17, 0x00, 0x00 };
+
+/*
+ * Start a handshake, and throw away the ClientHello. If 'ems_session'
+ * is 0 or 1, the client offers to resume a session (SESSION_ID) whose
+ * extended_master_secret flag has that value; if it is -1, it offers
+ * no session.
+ */
+static void
+start(int ems_session)
+{
+	static const char seed[] = "SSLClient test_server_hello";
+
+	br_ssl_client_init_full(&cc, &xc, TEST_TAs, TEST_TAs_NUM);
+	br_ssl_engine_set_buffer(&cc.eng, iobuf, sizeof iobuf, 0);
+	br_ssl_engine_inject_entropy(&cc.eng, seed, sizeof seed);
+	if (ems_session >= 0) {
+		br_ssl_session_parameters params;
+
+		memset(&params, 0, sizeof params);
+		memcpy(params.session_id, SESSION_ID, sizeof SESSION_ID);
+		params.session_id_len = sizeof SESSION_ID;
+		params.version = BR_TLS12;
+		params.cipher_suite = BR_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256;
+		params.extended_master_secret = (unsigned char)ems_session;
+		br_ssl_engine_set_session_parameters(&cc.eng, &params);
+	}
+	CHECK(br_ssl_client_reset(&cc, "localhost", ems_session >= 0));
+	while (br_ssl_engine_current_state(&cc.eng) & BR_SSL_SENDREC) {
+		size_t len;
+
+		br_ssl_engine_sendrec_buf(&cc.eng, &len);
+		br_ssl_engine_sendrec_ack(&cc.eng, len);
+	}
+}
+
+/*
+ * Give the client a ServerHello for the ECDHE_ECDSA_WITH_AES_128_GCM
+ * suite, with the provided session ID and extensions. If 'ext' is NULL,
+ * the message has no extension block at all. Returned value is the
+ * engine error code once the message has been processed.
+ */
+static int
+server_hello(const unsigned char *id, const unsigned char *ext, size_t ext_len)
+{
+	unsigned char rec[128];
+	size_t len, off;
+
+	len = 9;
+	memcpy(rec + len, "\x03\x03", 2);
+	len += 2;
+	memset(rec + len, 0x33, 32);
+	len += 32;
+	rec[len ++] = 32;
+	memcpy(rec + len, id, 32);
+	len += 32;
+	br_enc16be(rec + len, BR_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256);
+	len += 2;
+	rec[len ++] = 0;
+	if (ext != NULL) {
+		br_enc16be(rec + len, ext_len);
+		len += 2;
+		memcpy(rec + len, ext, ext_len);
+		len += ext_len;
+	}
+	/* record header, then ServerHello (type 2) header */
+	rec[0] = BR_SSL_HANDSHAKE;
+	br_enc16be(rec + 1, BR_TLS12);
+	br_enc16be(rec + 3, len - 5);
+	br_enc32be(rec + 5, (uint32_t)2 << 24 | (uint32_t)(len - 9));
+
+	off = 0;
+	while (off < len
+		&& (br_ssl_engine_current_state(&cc.eng) & BR_SSL_RECVREC))
+	{
+		unsigned char *buf;
+		size_t blen;
+
+		buf = br_ssl_engine_recvrec_buf(&cc.eng, &blen);
+		if (blen > len - off) {
+			blen = len - off;
+		}
+		memcpy(buf, rec + off, blen);
+		br_ssl_engine_recvrec_ack(&cc.eng, blen);
+		off += blen;
+	}
+	return br_ssl_engine_last_error(&cc.eng);
+}
+
+static void
+test_ems_full_handshake(void)
+{
+	start(-1);
+	CHECK_EQ(server_hello(OTHER_ID, EXT_EMS, sizeof EXT_EMS), BR_ERR_OK);
+	CHECK_EQ(cc.eng.session.extended_master_secret, 1);
+
+	start(-1);
+	CHECK_EQ(server_hello(OTHER_ID, EXT_EMS, 0), BR_ERR_OK);
+	CHECK_EQ(cc.eng.session.extended_master_secret, 0);
+
+	start(-1);
+	CHECK_EQ(server_hello(OTHER_ID, NULL, 0), BR_ERR_OK);
+	CHECK_EQ(cc.eng.session.extended_master_secret, 0);
+
+	/*
+	 * The extension must be empty.
+	 */
+	{
+		static const unsigned char ext[] = {
+			0x00, 0x17, 0x00, 0x01, 0x00
+		};
+
+		start(-1);
+		CHECK_EQ(server_hello(OTHER_ID, ext, sizeof ext),
+			BR_ERR_BAD_EMS);
+	}
+}
+
+/*
+ * RFC 7627, section 5.3: a resumed session must use the Extended
+ * Master Secret if and only if the original session did.
+ */
+static void
+test_ems_resume(void)
+{
+	start(1);
+	CHECK_EQ(server_hello(SESSION_ID, EXT_EMS, sizeof EXT_EMS),
+		BR_ERR_OK);
+	CHECK_EQ(cc.eng.session.extended_master_secret, 1);
+
+	/* dropped on resumption */
+	start(1);
+	CHECK_EQ(server_hello(SESSION_ID, EXT_EMS, 0), BR_ERR_BAD_EMS);
+	start(1);
+	CHECK_EQ(server_hello(SESSION_ID, NULL, 0), BR_ERR_BAD_EMS);
+
+	/* added on resumption */
+	start(0);
+	CHECK_EQ(server_hello(SESSION_ID, EXT_EMS, sizeof EXT_EMS),
+		BR_ERR_BAD_EMS);
+	start(0);
+	CHECK_EQ(server_hello(SESSION_ID, NULL, 0), BR_ERR_OK);
+
+	/*
+	 * A server that does not resume starts a new session, which
+	 * may differ from the old one.
+	 */
+	start(1);
+	CHECK_EQ(server_hello(OTHER_ID, NULL, 0), BR_ERR_OK);
+	CHECK_EQ(cc.eng.session.extended_master_secret, 0);
+}
+
+/*
+ * Record Size Limit (RFC 8449) extension with the provided value, after
+ * a Max Fragment Length extension if 'with_mfl' is 1, or before it if it
+ * is 2. Returned value is the extensions length.
+ */
+static size_t
+make_rsl(unsigned char *ext, unsigned limit, int with_mfl)
+{
+	static const unsigned char mfl[] = { 0x00, 0x01, 0x00, 0x01, 0x03 };
+	size_t len;
+
+	len = 0;
+	if (with_mfl == 1) {
+		memcpy(ext, mfl, sizeof mfl);
+		len += sizeof mfl;
+	}
+	br_enc16be(ext + len, 0x001C);
+	br_enc16be(ext + len + 2, 2);
+	br_enc16be(ext + len + 4, limit);
+	len += 6;
+	if (with_mfl == 2) {
+		memcpy(ext + len, mfl, sizeof mfl);
+		len += sizeof mfl;
+	}
+	return len;
+}
+
+static void
+test_rsl(void)
+{
+	unsigned char ext[16];
+	size_t len;
+
+	start(-1);
+	CHECK_EQ(cc.eng.max_frag_len, 2048);
+	len = make_rsl(ext, 1000, 0);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_OK);
+	CHECK_EQ(cc.eng.max_frag_len, 1000);
+
+	/* the limit was for that server only */
+	CHECK(br_ssl_client_reset(&cc, "localhost", 0));
+	CHECK_EQ(cc.eng.max_frag_len, 2048);
+
+	/* the smallest allowed limit */
+	start(-1);
+	len = make_rsl(ext, 64, 0);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_OK);
+	CHECK_EQ(cc.eng.max_frag_len, 64);
+
+	/* a limit above our own changes nothing */
+	start(-1);
+	len = make_rsl(ext, 16385, 0);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_OK);
+	CHECK_EQ(cc.eng.max_frag_len, 2048);
+}
+
+static void
+test_rsl_invalid(void)
+{
+	unsigned char ext[16];
+	size_t len;
+
+	start(-1);
+	len = make_rsl(ext, 63, 0);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_BAD_FRAGLEN);
+
+	start(-1);
+	len = make_rsl(ext, 0, 0);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_BAD_FRAGLEN);
+
+	/* the extension holds exactly two bytes */
+	start(-1);
+	len = make_rsl(ext, 1000, 0);
+	ext[3] = 3;
+	ext[len ++] = 0;
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_BAD_FRAGLEN);
+
+	/* RFC 8449, section 5: not together with Max Fragment Length */
+	start(-1);
+	len = make_rsl(ext, 1000, 1);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_UNEXPECTED);
+	start(-1);
+	len = make_rsl(ext, 1000, 2);
+	CHECK_EQ(server_hello(OTHER_ID, ext, len), BR_ERR_UNEXPECTED);
+}
+
+/*
+ * Max Fragment Length alone is still accepted, and keeps the length
+ * that was asked for.
+ */
+static void
+test_mfl(void)
+{
+	static const unsigned char ext[] = { 0x00, 0x01, 0x00, 0x01, 0x03 };
+
+	start(-1);
+	CHECK_EQ(server_hello(OTHER_ID, ext, sizeof ext), BR_ERR_OK);
+	CHECK_EQ(cc.eng.max_frag_len, 2048);
+}
+
+int
+main(void)
+{
+	RUN(test_ems_full_handshake);
+	RUN(test_ems_resume);
+	RUN(test_rsl);
+	RUN(test_rsl_invalid);
+	RUN(test_mfl);
+	return TEST_RESULT;
+}
@@ -0,0 +1,70 @@
+/**
+ * Sessions shared between clients through an SSLSessionCache: a client resumes
+ * the session another client negotiated with the same host, and never offers a
+ * session to a host it was not negotiated with, even though the loopback server
+ * (which is every host at once) would accept it.
+ */
+
+#include "SSLClient.h"
+#include "SSLSessionCache.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+static LoopbackServer server;
+
+static void test_shared_session() {
+    SSLSessionCache cache(2);
+    SSLClientFor<LoopbackServer> first(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLClientFor<LoopbackServer> second(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    first.setSessionCache(&cache);
+    second.setSessionCache(&cache);
+
+    CHECK(first.connect("a.test", 443));
+    CHECK_EQ(server.offeredSessionIdLen(), 0);
+    CHECK(!server.resumed());
+    first.stop();
+
+    CHECK(second.connect("a.test", 443));
+    CHECK_EQ(server.offeredSessionIdLen(), 32);
+    CHECK(server.resumed());
+    second.stop();
+}
+
+static void test_cache_miss() {
+    SSLSessionCache cache(2);
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    client.setSessionCache(&cache);
+
+    CHECK(client.connect("a.test", 443));
+    client.stop();
+
+    // the engine still has the session with a.test, but there is none for b.test
+    CHECK(client.connect("b.test", 443));
+    CHECK_EQ(server.offeredSessionIdLen(), 0);
+    CHECK(!server.resumed());
+    client.stop();
+
+    // and each host now resumes its own
+    CHECK(client.connect("a.test", 443));
+    CHECK_EQ(server.offeredSessionIdLen(), 32);
+    CHECK(server.resumed());
+    client.stop();
+    CHECK(client.connect("b.test", 443));
+    CHECK(server.resumed());
+    client.stop();
+
+    // a host that was dropped from the cache gets a full handshake again
+    cache.clear();
+    CHECK(client.connect("b.test", 443));
+    CHECK_EQ(server.offeredSessionIdLen(), 0);
+    client.stop();
+}
+
+int main() {
+    RUN(test_shared_session);
+    RUN(test_cache_miss);
+    return TEST_RESULT;
+}
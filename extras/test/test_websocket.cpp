@@ -0,0 +1,429 @@
+/**
+ * SSLWebSocket against a scripted server on the loopback: messages in
+ * fragments, with control frames between them, payload lengths in each of the
+ * three forms (in both directions), the close handshake and its status codes,
+ * and fragments that break the protocol.
+ */
+
+#include "SSLClient.h"
+#include "SSLWebSocket.h"
+#include "loopback.h"
+#include "test.h"
+#include "test_cert.h"
+
+static const SSLClient::DebugLevel DEBUG = getenv("SSL_SERIAL") ? SSLClient::SSL_INFO : SSLClient::SSL_NONE;
+
+static const uint8_t FIN = 0x80;
+static const uint8_t OP_CONT = SSLWebSocket::OP_CONTINUATION;
+static const uint8_t OP_TEXT = SSLWebSocket::OP_TEXT;
+static const uint8_t OP_BINARY = SSLWebSocket::OP_BINARY;
+static const uint8_t OP_CLOSE = SSLWebSocket::OP_CLOSE;
+static const uint8_t OP_PING = SSLWebSocket::OP_PING;
+static const uint8_t OP_PONG = SSLWebSocket::OP_PONG;
+
+// longest message of the tests, the shortest that needs the 64-bit length form
+static const size_t LONG_LEN = 65536;
+
+static LoopbackServer server;
+static uint8_t pattern[LONG_LEN];
+
+// the server side: the upgrade request, then the client frame being received
+static char request[1024];
+static size_t request_len;
+static bool upgraded;
+static uint8_t frame_header[14];
+static size_t frame_header_len;
+static bool in_payload;
+// the last frame from the client, with its 7-bit length field, and the number of pongs
+static uint8_t frame_first;
+static uint8_t frame_len7;
+static uint8_t frame_payload[LONG_LEN];
+static uint64_t frame_len;
+static uint64_t frame_pos;
+static unsigned frames;
+static unsigned pongs;
+// the code to answer a close frame with, 0 for a close frame without one, or -1
+// to leave it unanswered
+static long close_reply;
+
+/**
+ * Send a frame to the client. Payloads longer than 256 bytes are not sent, only
+ * their length, and the test sends them with send_payload().
+ */
+static void send_frame(uint8_t first, const void* payload, size_t len) {
+    uint8_t frame[10 + 256];
+    size_t header_len = 2;
+    frame[0] = first;
+    if (len < 126) frame[1] = static_cast<uint8_t>(len);
+    else if (len <= 0xFFFF) {
+        frame[1] = 126;
+        frame[2] = static_cast<uint8_t>(len >> 8);
+        frame[3] = static_cast<uint8_t>(len);
+        header_len = 4;
+    }
+    else {
+        frame[1] = 127;
+        for (size_t i = 0; i < 8; i++) frame[2 + i] = static_cast<uint8_t>(static_cast<uint64_t>(len) >> (56 - 8 * i));
+        header_len = 10;
+    }
+    if (len > 256) len = 0;
+    if (len > 0) memcpy(frame + header_len, payload, len);
+    server.send(frame, header_len + len);
+}
+
+// send a long payload in pieces, letting the client read whatever does not fit
+static void send_payload(SSLWebSocket& ws, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        const size_t n = len < 8192 ? len : 8192;
+        if (!server.send(data, n)) {
+            if (!ws.poll()) {
+                CHECK(!"the WebSocket closed");
+                return;
+            }
+            continue;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+static void base64(const uint8_t* in, size_t len, char* out) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (; len > 0; in += 3, len = len > 3 ? len - 3 : 0) {
+        const uint32_t v = (in[0] << 16) | (len > 1 ? in[1] << 8 : 0) | (len > 2 ? in[2] : 0);
+        *out++ = chars[v >> 18];
+        *out++ = chars[(v >> 12) & 0x3F];
+        *out++ = len > 1 ? chars[(v >> 6) & 0x3F] : '=';
+        *out++ = len > 2 ? chars[v & 0x3F] : '=';
+    }
+    *out = '\0';
+}
+
+// answer the upgrade request with the accept value for its key
+static void accept_upgrade() {
+    static const char header[] = "Sec-WebSocket-Key: ";
+    const char* key = strstr(request, header);
+    CHECK(key != nullptr);
+    if (key == nullptr) return;
+    key += sizeof header - 1;
+    br_sha1_context sha;
+    uint8_t digest[br_sha1_SIZE];
+    br_sha1_init(&sha);
+    br_sha1_update(&sha, key, strcspn(key, "\r"));
+    br_sha1_update(&sha, "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", 36);
+    br_sha1_out(&sha, digest);
+    char accept[29];
+    base64(digest, sizeof digest, accept);
+    char response[160];
+    snprintf(response, sizeof response,
+        "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+    server.send(response);
+    upgraded = true;
+}
+
+static void end_frame() {
+    in_payload = false;
+    frames++;
+    if ((frame_first & 0x0F) == OP_PONG) pongs++;
+    if ((frame_first & 0x0F) == OP_CLOSE && close_reply >= 0) {
+        const uint8_t payload[2] = { static_cast<uint8_t>(close_reply >> 8), static_cast<uint8_t>(close_reply) };
+        send_frame(FIN | OP_CLOSE, payload, close_reply > 0 ? 2 : 0);
+    }
+}
+
+static void ws_server(LoopbackServer& server, const uint8_t* data, size_t len, void* /* ctx */) {
+    for (size_t i = 0; i < len; i++) {
+        if (!upgraded) {
+            if (request_len < sizeof request - 1) request[request_len++] = static_cast<char>(data[i]);
+            request[request_len] = '\0';
+            if (request_len >= 4 && strcmp(request + request_len - 4, "\r\n\r\n") == 0) accept_upgrade();
+            continue;
+        }
+        if (in_payload) {
+            const uint8_t* mask = frame_header + frame_header_len - 4;
+            if (frame_pos < sizeof frame_payload) frame_payload[frame_pos] = data[i] ^ mask[frame_pos % 4];
+            if (++frame_pos == frame_len) {
+                end_frame();
+                frame_header_len = 0;
+            }
+            continue;
+        }
+        frame_header[frame_header_len++] = data[i];
+        if (frame_header_len < 2) continue;
+        // every frame from a client is masked
+        const uint8_t len7 = frame_header[1] & 0x7F;
+        const size_t header_len = (len7 == 127 ? 10 : len7 == 126 ? 4 : 2) + 4;
+        if (frame_header_len < header_len) continue;
+        CHECK(frame_header[1] & 0x80);
+        frame_first = frame_header[0];
+        frame_len7 = len7;
+        frame_len = len7;
+        if (len7 >= 126) {
+            frame_len = 0;
+            for (size_t j = 2; j < header_len - 4; j++) frame_len = (frame_len << 8) | frame_header[j];
+        }
+        frame_pos = 0;
+        in_payload = true;
+        if (frame_len == 0) end_frame();
+        frame_header_len = in_payload ? header_len : 0;
+    }
+    // client frames can be larger than the server keeps
+    server.clearReceived();
+}
+
+/** Collects the messages of the WebSocket */
+class Listener : public SSLWebSocketListener {
+public:
+    void onMessage(const uint8_t* data, size_t len, bool text, bool last) override {
+        if (this->len + len <= sizeof message) memcpy(message + this->len, data, len);
+        this->len += len;
+        this->text = text;
+        pieces++;
+        if (last) messages++;
+    }
+    void onClose(uint16_t code) override { close_code = code; }
+    void clear() {
+        len = 0;
+        pieces = 0;
+        messages = 0;
+    }
+    uint8_t message[LONG_LEN];
+    size_t len;
+    unsigned pieces;
+    unsigned messages;
+    bool text;
+    long close_code;
+};
+
+static Listener listener;
+
+// start a test, with a new connection
+static void start() {
+    request_len = 0;
+    upgraded = false;
+    frame_header_len = 0;
+    in_payload = false;
+    frames = 0;
+    pongs = 0;
+    close_reply = 1000;
+    listener.clear();
+    listener.close_code = -1;
+}
+
+static void test_fragments() {
+    start();
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLWebSocket ws(client, "localhost");
+    ws.setTimeout(1000);
+    ws.setListener(&listener);
+    CHECK(ws.connect("/"));
+
+    send_frame(OP_TEXT, "hel", 3);
+    send_frame(OP_CONT, "lo ", 3);
+    send_frame(FIN | OP_CONT, "world", 5);
+    CHECK(ws.wait());
+    CHECK_EQ(listener.messages, 1);
+    CHECK_EQ(listener.pieces, 3);
+    CHECK(listener.text);
+    CHECK_EQ(listener.len, 11);
+    CHECK_MEM(listener.message, "hello world", 11);
+
+    // a message can end with an empty fragment
+    listener.clear();
+    send_frame(OP_BINARY, "\x01\x02", 2);
+    send_frame(FIN | OP_CONT, nullptr, 0);
+    CHECK(ws.wait());
+    CHECK_EQ(listener.messages, 1);
+    CHECK(!listener.text);
+    CHECK_EQ(listener.len, 2);
+    CHECK_MEM(listener.message, "\x01\x02", 2);
+    ws.close();
+}
+
+static void test_control_between_fragments() {
+    start();
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLWebSocket ws(client, "localhost");
+    ws.setTimeout(1000);
+    ws.setListener(&listener);
+    CHECK(ws.connect("/"));
+
+    // the ping is answered, and the message goes on
+    send_frame(OP_TEXT, "ab", 2);
+    send_frame(FIN | OP_PING, "p1", 2);
+    send_frame(FIN | OP_PONG, nullptr, 0);
+    send_frame(FIN | OP_CONT, "cd", 2);
+    CHECK(ws.wait());
+    CHECK(ws.poll());
+    CHECK_EQ(listener.messages, 1);
+    CHECK_EQ(listener.len, 4);
+    CHECK_MEM(listener.message, "abcd", 4);
+    CHECK_EQ(pongs, 1);
+    CHECK_EQ(frame_first, FIN | OP_PONG);
+    CHECK_EQ(frame_len, 2);
+    CHECK_MEM(frame_payload, "p1", 2);
+
+    // a close frame ends the WebSocket, and the message with it
+    listener.clear();
+    send_frame(OP_TEXT, "ef", 2);
+    send_frame(FIN | OP_CLOSE, "\x03\xe9", 2);
+    CHECK(!ws.wait());
+    CHECK_EQ(listener.messages, 0);
+    CHECK_EQ(listener.close_code, 1001);
+    CHECK(!ws.connected());
+    CHECK_EQ(frame_first, FIN | OP_CLOSE);
+    CHECK_EQ(frame_len, 2);
+    CHECK_MEM(frame_payload, "\x03\xe9", 2);
+}
+
+// payloads at the edges of the 7-bit, 16-bit and 64-bit length forms
+static const size_t LENGTHS[] = { 0, 125, 126, 65535, LONG_LEN };
+
+static uint8_t length_form(size_t len) { return len < 126 ? static_cast<uint8_t>(len) : len <= 0xFFFF ? 126 : 127; }
+
+static void test_lengths() {
+    start();
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLWebSocket ws(client, "localhost");
+    ws.setTimeout(1000);
+    ws.setListener(&listener);
+    CHECK(ws.connect("/"));
+
+    for (size_t len : LENGTHS) {
+        listener.clear();
+        send_frame(FIN | OP_BINARY, pattern, len);
+        if (len > 256) send_payload(ws, pattern, len);
+        if (listener.messages == 0) CHECK(ws.wait());
+        CHECK_EQ(listener.messages, 1);
+        CHECK_EQ(listener.len, len);
+        CHECK_MEM(listener.message, pattern, len);
+
+        const unsigned before = frames;
+        CHECK(ws.sendBinary(pattern, len));
+        CHECK(ws.poll());
+        CHECK_EQ(frames, before + 1);
+        CHECK_EQ(frame_first, FIN | OP_BINARY);
+        CHECK_EQ(frame_len7, length_form(len));
+        CHECK_EQ(frame_len, len);
+        CHECK_MEM(frame_payload, pattern, len);
+    }
+    ws.close();
+}
+
+static void test_close_codes() {
+    // the server closes with a code and a reason, and gets the code back
+    {
+        start();
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+        SSLWebSocket ws(client, "localhost");
+        ws.setTimeout(1000);
+        ws.setListener(&listener);
+        CHECK(ws.connect("/"));
+        send_frame(FIN | OP_CLOSE, "\x03\xe9" "bye", 5);
+        CHECK(!ws.poll());
+        CHECK_EQ(listener.close_code, 1001);
+        CHECK_EQ(frame_first, FIN | OP_CLOSE);
+        CHECK_EQ(frame_len, 2);
+        CHECK_MEM(frame_payload, "\x03\xe9", 2);
+        CHECK(!ws.sendText("late"));
+    }
+    // the server closes without a code, and gets none back
+    {
+        start();
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+        SSLWebSocket ws(client, "localhost");
+        ws.setTimeout(1000);
+        ws.setListener(&listener);
+        CHECK(ws.connect("/"));
+        send_frame(FIN | OP_CLOSE, nullptr, 0);
+        CHECK(!ws.poll());
+        CHECK_EQ(listener.close_code, 1005);
+        CHECK_EQ(frame_first, FIN | OP_CLOSE);
+        CHECK_EQ(frame_len, 0);
+    }
+    // the client closes, and reports the code of the server's answer
+    {
+        start();
+        close_reply = 1000;
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+        SSLWebSocket ws(client, "localhost");
+        ws.setTimeout(1000);
+        ws.setListener(&listener);
+        CHECK(ws.connect("/"));
+        ws.close(4000);
+        CHECK(!ws.connected());
+        CHECK_EQ(listener.close_code, 1000);
+        CHECK_EQ(frame_first, FIN | OP_CLOSE);
+        CHECK_EQ(frame_len, 2);
+        CHECK_MEM(frame_payload, "\x0f\xa0", 2);
+    }
+    // a server that does not answer is given up on with our own code
+    {
+        start();
+        close_reply = -1;
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+        SSLWebSocket ws(client, "localhost");
+        ws.setTimeout(100);
+        ws.setListener(&listener);
+        CHECK(ws.connect("/"));
+        ws.close(4000);
+        CHECK(!ws.connected());
+        CHECK_EQ(listener.close_code, 4000);
+    }
+    // a connection lost without a close frame
+    {
+        start();
+        SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+        SSLWebSocket ws(client, "localhost");
+        ws.setTimeout(1000);
+        ws.setListener(&listener);
+        CHECK(ws.connect("/"));
+        server.hangUp();
+        CHECK(!ws.poll());
+        CHECK_EQ(listener.close_code, 1006);
+    }
+}
+
+// frames that cannot come where they do, each of which fails the WebSocket
+static void check_protocol_error(uint8_t first1, const char* payload1, size_t len1,
+                                 uint8_t first2, const char* payload2, size_t len2) {
+    start();
+    SSLClientFor<LoopbackServer> client(server, TEST_TAs, TEST_TAs_NUM, A7, 1, DEBUG);
+    SSLWebSocket ws(client, "localhost");
+    ws.setTimeout(1000);
+    ws.setListener(&listener);
+    CHECK(ws.connect("/"));
+    send_frame(first1, payload1, len1);
+    if (payload2 != nullptr) send_frame(first2, payload2, len2);
+    CHECK(!ws.poll());
+    CHECK_EQ(listener.close_code, 1002);
+    CHECK(!ws.connected());
+}
+
+static void test_protocol_errors() {
+    static const char long_ping[126] = {};
+    // a continuation of no message
+    check_protocol_error(FIN | OP_CONT, "x", 1, 0, nullptr, 0);
+    // a new message before the last one ended
+    check_protocol_error(OP_TEXT, "a", 1, FIN | OP_TEXT, "b", 1);
+    check_protocol_error(OP_TEXT, "a", 1, FIN | OP_BINARY, "b", 1);
+    // control frames cannot be fragmented, or longer than 125 bytes
+    check_protocol_error(OP_PING, "p", 1, 0, nullptr, 0);
+    check_protocol_error(FIN | OP_PING, long_ping, sizeof long_ping, 0, nullptr, 0);
+    // reserved bits and opcodes
+    check_protocol_error(FIN | 0x40 | OP_TEXT, "a", 1, 0, nullptr, 0);
+    check_protocol_error(FIN | 0x3, "a", 1, 0, nullptr, 0);
+    check_protocol_error(FIN | 0xB, "a", 1, 0, nullptr, 0);
+}
+
+int main() {
+    for (size_t i = 0; i < sizeof pattern; i++) pattern[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    server.setHandler(ws_server);
+    RUN(test_fragments);
+    RUN(test_control_between_fragments);
+    RUN(test_lengths);
+    RUN(test_close_codes);
+    RUN(test_protocol_errors);
+    return TEST_RESULT;
+}
@@ -19,6 +19,19 @@
  */
 
 #include "SSLClient.h"
+#include "SSLHostHash.h"
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+constexpr size_t SSLClient::DRS_SMALL_RECORD;
+constexpr size_t SSLClient::DRS_BOOST_BYTES;
+constexpr unsigned long SSLClient::DRS_IDLE_MS;
+constexpr unsigned int SSLClient::SSL_RTT_TIMEOUT_FACTOR;
+constexpr unsigned int SSLClient::SSL_RTT_HANDSHAKE_FACTOR;
+constexpr size_t SSLClient::SSL_CALIBRATE_BYTES;
 
 /* see SSLClient.h */
 SSLClient::SSLClient(   Client& client, 
@@ -29,11 +42,56 @@ SSLClient::SSLClient(   Client& client,
                         const DebugLevel debug)
     : m_client(client) 
     , m_sessions()
+#ifdef SSLCLIENT_NO_HEAP
+    , m_max_sessions(max_sessions < SSLCLIENT_MAX_SESSIONS ? max_sessions : SSLCLIENT_MAX_SESSIONS)
+#else
     , m_max_sessions(max_sessions)
+#endif
+    , m_session_cache(nullptr)
     , m_analog_pin(analog_pin)
     , m_debug(debug)
+    , m_log_sink(nullptr)
     , m_is_connected(false)
+    , m_timeout_close(1000)
+    , m_close_clean(false)
+    , m_prepared(false)
+    , m_prepared_tls(false)
+    , m_prepared_time(0)
+    , m_prepared_max_age(0)
+    , m_prepared_port(0)
+    , m_reconnect_enabled(false)
+    , m_dropped(false)
+    , m_reconnect_port(0)
+    , m_reconnect_ip()
+    , m_reconnect_stats()
+    , m_replay()
+    , m_replay_max(0)
+    , m_replay_len(0)
+    , m_replay_lost(0)
+    , m_failures()
+    , m_backoff_base(0)
+    , m_backoff_max(0)
+    , m_keystream()
+    , m_adaptive_timeouts(false)
+    , m_adaptive_min(1000)
+    , m_srtt(0)
+    , m_rttvar(0)
+    , m_handshake_max(0)
+    , m_rtt_probe_start(0)
+    , m_rtt_sample(0)
+    , m_rtt_sampled(false)
+    , m_io_count(0)
+    , m_read_waiting(false)
+    , m_read_idle_io(0)
+    , m_read_idle_start(0)
+    , m_status_cache_ms(2)
+    , m_status_time(0)
+    , m_status_connected(-1)
+    , m_status_available(-1)
     , m_write_idx(0)
+    , m_drs_enabled(true)
+    , m_drs_bytes(0)
+    , m_drs_last(0)
     , m_br_last_state(0) {
 
     setTimeout(30*1000);
@@ -51,13 +109,23 @@ SSLClient::SSLClient(   Client& client,
 /* see SSLClient.h*/
 int SSLClient::connect(IPAddress ip, uint16_t port) {
     const char* func_name = __func__;
+    // a connection parked for a hostname can't be matched to an IP
+    if (m_prepared) stop();
+    // anything left over from the last connection will never be sent
+    m_replay_discard();
+    m_reconnect_ip = ip;
+    m_reconnect_port = port;
     // connection check
     if (get_arduino_client().connected())
         m_warn("Arduino client is already connected? Continuing anyway...", func_name);
     // reset indexs for saftey
     m_write_idx = 0;
+    // start the connection with small records
+    m_drs_bytes = 0;
     // Warning for security
     m_warn("Using a raw IP Address for an SSL connection bypasses some important verification steps. You should use a domain name (www.google.com) whenever possible.", func_name);
+    // limit how long opening the socket can take, if the client supports it
+    m_set_connect_timeout(m_connect_timeout());
     // first we need our hidden client member to negotiate the socket for us,
     // since most times socket functionality is implemented in hardeware.
     if (!get_arduino_client().connect(ip, port)) {
@@ -72,11 +140,98 @@ int SSLClient::connect(IPAddress ip, uint16_t port) {
 /* see SSLClient.h*/
 int SSLClient::connect(const char *host, uint16_t port) {
     const char* func_name = __func__;
+    // anything left over from the last connection will never be sent
+    m_replay_discard();
+    m_reconnect_ip = IPAddress();
+    m_reconnect_port = port;
+    // use the connection from prepare, if there is one
+    if (m_prepared) {
+        if (m_take_prepared(host, port)) return 1;
+        // the socket may still be open without a handshake
+        if (m_is_connected || !get_arduino_client().connected()) stop();
+        else {
+            m_prepared = false;
+            if (m_backing_off(host, func_name)) {
+                stop();
+                return 0;
+            }
+            m_info("Starting SSL on the prepared socket", func_name);
+            m_write_idx = 0;
+            m_drs_bytes = 0;
+            return m_start_ssl(host, getSession(host));
+        }
+    }
+    // don't spend a handshake on a host that keeps failing them
+    if (m_backing_off(host, func_name)) return 0;
+    // open the socket
+    if (!m_connect_socket(host, port, func_name)) return 0;
+    // start ssl!
+    return m_start_ssl(host, getSession(host));
+}
+
+/* see SSLClient.h*/
+int SSLClient::prepare(const char *host, uint16_t port, bool handshake, unsigned long max_age) {
+    const char* func_name = __func__;
+#ifdef SSLCLIENT_NO_HEAP
+    if (strlen(host) > SSLCLIENT_MAX_HOSTNAME_LEN) {
+        m_error("Hostname is too long to prepare a connection for", func_name);
+        return 0;
+    }
+#endif
+    // replace whatever connection we had
+    if (m_prepared || m_is_connected) stop();
+    if (handshake) {
+        if (!connect(host, port)) return 0;
+    }
+    else if (!m_connect_socket(host, port, func_name)) return 0;
+    // park the connection until connect is called
+    m_prepared = true;
+    m_prepared_tls = handshake;
+    m_prepared_time = millis();
+    m_prepared_max_age = max_age;
+    m_prepared_port = port;
+#ifdef SSLCLIENT_NO_HEAP
+    strcpy(m_prepared_host, host);
+#else
+    m_prepared_host = host;
+#endif
+    m_info("Prepared a connection", func_name);
+    return 1;
+}
+
+/* see SSLClient.h*/
+bool SSLClient::isPrepared() {
+    if (!m_prepared) return false;
+    // a connection that has expired or been closed is of no use to anyone
+    bool usable = millis() - m_prepared_time <= m_prepared_max_age;
+    if (usable && m_prepared_tls) {
+        // let the engine process anything the server sent (ex. close_notify). This
+        // is skipped if there's nothing to read, since the engine waits a bit then.
+        if (get_arduino_client().available() > 0) {
+            const unsigned state = m_update_engine();
+            usable = state != 0 && state != BR_SSL_CLOSED && !(state & BR_SSL_RECVAPP);
+        }
+        usable = usable && connected();
+    }
+    else if (usable) usable = get_arduino_client().connected();
+    if (!usable) {
+        m_info("Prepared connection expired or was closed", __func__);
+        stop();
+    }
+    return usable;
+}
+
+/* see SSLClient.h */
+int SSLClient::m_connect_socket(const char* host, uint16_t port, const char* func_name) {
     // connection check
     if (get_arduino_client().connected())
         m_warn("Arduino client is already connected? Continuing anyway...", func_name);
     // reset indexs for saftey
     m_write_idx = 0;
+    // start the connection with small records
+    m_drs_bytes = 0;
+    // limit how long opening the socket can take, if the client supports it
+    m_set_connect_timeout(m_connect_timeout());
     // first we need our hidden client member to negotiate the socket for us,
     // since most times socket functionality is implemented in hardeware.
     if (!get_arduino_client().connect(host, port)) {
@@ -85,22 +240,219 @@ int SSLClient::connect(const char *host, uint16_t port) {
         return 0;
     }
     m_info("Base client connected!", func_name);
-    // start ssl!
-    return m_start_ssl(host, getSession(host));
+    return 1;
+}
+
+/* see SSLClient.h */
+int SSLClient::m_take_prepared(const char* host, uint16_t port) {
+#ifdef SSLCLIENT_NO_HEAP
+    const bool same_host = strcmp(m_prepared_host, host) == 0;
+#else
+    const bool same_host = m_prepared_host.equals(host);
+#endif
+    if (!same_host || port != m_prepared_port) {
+        m_info("Prepared connection is for a different server, closing it", "connect");
+        stop();
+        return 0;
+    }
+    // checks expiry, and closes the connection if it's no good
+    if (!isPrepared()) return 0;
+    // a socket without a handshake is finished by connect
+    if (!m_prepared_tls) return 0;
+    m_prepared = false;
+    m_drs_bytes = 0;
+    m_info("Using the prepared connection", "connect");
+    return 1;
+}
+
+/* see SSLClient.h */
+void SSLClient::m_drop() {
+    const bool was_connected = m_is_connected;
+    // stop must not try to send close_notify on a dead socket
+    m_is_connected = false;
+    stop();
+    // a connection woken from hibernation by a new SSLClient has no port to go back to
+    if (!m_reconnect_enabled || !was_connected || m_reconnect_port == 0) return;
+    // the write buffer is still intact, since stop didn't touch the engine
+    if (m_write_idx > 0 && (br_ssl_engine_current_state(&m_sslctx.eng) & BR_SSL_SENDAPP)) {
+        size_t alen;
+        m_replay_append(br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen), m_write_idx);
+    }
+    m_write_idx = 0;
+    m_dropped = true;
+}
+
+/* see SSLClient.h */
+int SSLClient::m_reconnect(const char* func_name) {
+    m_warn("Connection dropped, reconnecting", func_name);
+    // the engine keeps the hostname, but clears it when it resets
+    char host[sizeof m_sslctx.eng.server_name];
+    strcpy(host, m_sslctx.eng.server_name);
+    m_write_idx = 0;
+    m_drs_bytes = 0;
+    if (host[0] != '\0' && m_backing_off(host, func_name)) {
+        m_reconnect_stats.failures++;
+        m_dropped = true;
+        return 0;
+    }
+    m_set_connect_timeout(m_connect_timeout());
+    const int ret = host[0] != '\0'
+        ? get_arduino_client().connect(host, m_reconnect_port)
+        : get_arduino_client().connect(m_reconnect_ip, m_reconnect_port);
+    if (!ret || !m_start_ssl(host[0] != '\0' ? host : nullptr, host[0] != '\0' ? getSession(host) : nullptr)) {
+        m_error("Failed to reconnect", func_name);
+        if (!ret) setWriteError(SSL_CLIENT_CONNECT_FAIL);
+        get_arduino_client().stop();
+        m_reconnect_stats.failures++;
+        // keep the data, and try again next time
+        m_dropped = true;
+        return 0;
+    }
+    m_reconnect_stats.reconnects++;
+    // the new connection is up, so later calls must not reopen it again
+    m_dropped = false;
+    // if some of the data didn't fit, sending the rest would only confuse the server
+    if (m_replay_lost > 0) {
+        m_warn("Too much unsent data to replay, it was dropped", func_name);
+        m_replay_discard();
+        return -1;
+    }
+    // send the data again. Each piece is kept for replay again until it is sent,
+    // which only ever moves it towards the start of the replay buffer.
+    const size_t total = m_replay_len;
+    size_t off = 0;
+    m_replay_len = 0;
+    while (off < total) {
+        if (m_run_until(BR_SSL_SENDAPP, m_write_timeout(), true) < 0) {
+            m_error("Failed to replay unsent data", func_name);
+            // put back what we didn't get to, for the next attempt
+            memmove(&m_replay[m_replay_len], &m_replay[off], total - off);
+            m_replay_len += total - off;
+            return 0;
+        }
+        size_t alen;
+        unsigned char* buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
+        const size_t len = total - off < alen ? total - off : alen;
+        memcpy(buf, &m_replay[off], len);
+        m_replay_append(buf, len);
+        br_ssl_engine_sendapp_ack(&m_sslctx.eng, len);
+        br_ssl_engine_flush(&m_sslctx.eng, 0);
+        m_reconnect_stats.replayed += len;
+        off += len;
+    }
+    if (m_run_until(BR_SSL_SENDAPP, m_write_timeout(), true) < 0) {
+        m_error("Failed to replay unsent data", func_name);
+        return 0;
+    }
+    m_info("Reconnected", func_name);
+    return 1;
+}
+
+/* see SSLClient.h */
+bool SSLClient::m_wait_sendapp(const char* func_name, bool& reconnected) {
+    // running the engine when it can already take data would only risk reading a
+    // record into the shared buffer, which would then have to be discarded
+    if (!reconnected && !m_dropped && (br_ssl_engine_current_state(&m_sslctx.eng) & BR_SSL_SENDAPP)) return true;
+    while (m_run_until(BR_SSL_SENDAPP, m_write_timeout(), true) < 0) {
+        if (reconnected || !m_dropped) {
+            m_error("Failed while waiting for the engine to enter BR_SSL_SENDAPP", func_name);
+            return false;
+        }
+        reconnected = true;
+        if (m_reconnect(func_name) != 1) return false;
+    }
+    return true;
+}
+
+/* see SSLClient.h */
+bool SSLClient::m_send_record(const unsigned char* br_buf, bool flush, const char* func_name, bool& reconnected) {
+    // keep a copy in case the connection drops before it is sent
+    m_replay_append(br_buf, m_write_idx);
+    // indicate to bearssl that we are done writing
+    br_ssl_engine_sendapp_ack(&m_sslctx.eng, m_write_idx);
+    // the engine only closes the record on its own if the buffer is full
+    if (flush) br_ssl_engine_flush(&m_sslctx.eng, 0);
+    // reset the write index
+    m_write_idx = 0;
+    // write to the socket immediatly
+    return m_wait_sendapp(func_name, reconnected);
+}
+
+/* see SSLClient.h */
+void SSLClient::m_replay_append(const unsigned char* buf, const size_t len) {
+    // every record of application data passes through here, so start
+    // waiting for the answer
+    if (!m_read_waiting) {
+        m_read_waiting = true;
+        m_read_idle_io = m_io_count;
+        m_read_idle_start = millis();
+    }
+    if (!m_reconnect_enabled) return;
+    // once something didn't fit, later data can't be replayed without it
+    if (m_replay_lost > 0 || len > m_replay_max - m_replay_len) m_replay_lost += len;
+    else {
+        memcpy(&m_replay[m_replay_len], buf, len);
+        m_replay_len += len;
+    }
+}
+
+/* see SSLClient.h */
+bool SSLClient::m_read_idle_expired() {
+    if (!m_read_waiting) return false;
+    // any data moving restarts the timeout
+    if (m_read_idle_io != m_io_count) {
+        m_read_idle_io = m_io_count;
+        m_read_idle_start = millis();
+        return false;
+    }
+    return millis() - m_read_idle_start > m_read_timeout();
+}
+
+/* see SSLClient.h */
+void SSLClient::m_replay_commit() {
+    m_reconnect_stats.sent += m_replay_len + m_replay_lost;
+    m_replay_len = 0;
+    m_replay_lost = 0;
+}
+
+/* see SSLClient.h */
+void SSLClient::m_replay_discard() {
+    m_reconnect_stats.dropped += m_replay_len + m_replay_lost;
+    m_replay_len = 0;
+    m_replay_lost = 0;
 }
 
 /* see SSLClient.h*/
 size_t SSLClient::write(const uint8_t *buf, size_t size) {
-    const char* func_name = __func__;
-    // super debug
-    if (m_debug >= DebugLevel::SSL_DUMP) Serial.write(buf, size);
+    // the buffer is only read from, the SSLIoVec just can't say so
+    const SSLIoVec iov = { const_cast<uint8_t*>(buf), size };
+    return write(&iov, 1);
+}
+
+/* see SSLClient.h */
+size_t SSLClient::write(const SSLIoVec* iov, size_t count) {
+    const char* func_name = "write";
+    // add up the size of the buffers, and make sure they all exist
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (iov[i].iov_len == 0) continue;
+        if (!iov[i].iov_base) return 0;
+        size += iov[i].iov_len;
+        // super debug
+        if (m_debug >= DebugLevel::SSL_DUMP) Serial.write(static_cast<const uint8_t*>(iov[i].iov_base), iov[i].iov_len);
+    }
+    // reopen the connection if it dropped since the last call
+    bool reconnected = false;
+    if (m_dropped && size) {
+        reconnected = true;
+        if (m_reconnect(func_name) != 1) return 0;
+    }
     // check if the socket is still open and such
-    if (!m_soft_connected(func_name) || !buf || !size) return 0;
+    if (!m_soft_connected(func_name) || !size) return 0;
+    // once it's in use, a prepared connection can't be handed to connect
+    m_prepared = false;
     // wait until bearssl is ready to send
-    if (m_run_until(BR_SSL_SENDAPP) < 0) {
-        m_error("Failed while waiting for the engine to enter BR_SSL_SENDAPP", func_name);
-        return 0;
-    }
+    if (!m_wait_sendapp(func_name, reconnected)) return 0;
     // add to the bearssl io buffer, simply appending whatever we want to write
     size_t alen;
     unsigned char *br_buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
@@ -109,36 +461,130 @@ size_t SSLClient::write(const uint8_t *buf, size_t size) {
         m_error("BearSSL returned zero length buffer for sending, did an internal error occur?", func_name);
         return 0;
     }
+    // if the connection has been idle, go back to small records
+    if (millis() - m_drs_last > DRS_IDLE_MS) m_drs_bytes = 0;
+    // the buffer we are copying from, and how far into it we are
+    size_t iov_idx = 0;
+    size_t iov_off = 0;
     // while there are still elements to write
     while (cur_idx < size) {
-        // if we're about to fill the buffer, we need to send the data and then wait
+        // move on to the next buffer once this one is used up
+        while (iov_off == iov[iov_idx].iov_len) {
+            iov_idx++;
+            iov_off = 0;
+        }
+        const uint8_t* buf = static_cast<const uint8_t*>(iov[iov_idx].iov_base) + iov_off;
+        const size_t buf_left = iov[iov_idx].iov_len - iov_off;
+        // only use as much of the buffer as the current record size allows
+        const size_t rlen = m_record_window(alen);
+        // if we're about to fill the record, we need to send the data and then wait
         // for another oppurtinity to send
-        // so we only send the smallest of the buffer size or our data size - how much we've already sent
-        const size_t cpamount = size - cur_idx >= alen - m_write_idx ? alen - m_write_idx : size - cur_idx;
-        memcpy(br_buf + m_write_idx, buf + cur_idx, cpamount);
+        // so we only send the smallest of the record size or our data size - how much we've already sent
+        const size_t cpamount = buf_left >= rlen - m_write_idx ? rlen - m_write_idx : buf_left;
+        memcpy(br_buf + m_write_idx, buf, cpamount);
+        iov_off += cpamount;
         // increment write idx
         m_write_idx += cpamount;
         // increment the buffer pointer
         cur_idx += cpamount;
-        // if we filled the buffer, reset m_write_idx, and mark the data for sending
-        if(m_write_idx == alen) {
-            // indicate to bearssl that we are done writing
-            br_ssl_engine_sendapp_ack(&m_sslctx.eng, m_write_idx);
-            // reset the write index
-            m_write_idx = 0;
-            // write to the socket immediatly
-            if (m_run_until(BR_SSL_SENDAPP) < 0) {
-                m_error("Failed while waiting for the engine to enter BR_SSL_SENDAPP", func_name);
-                return 0;
-            }
+        if (m_drs_bytes < DRS_BOOST_BYTES) m_drs_bytes += cpamount;
+        // if we filled the record, reset m_write_idx, and mark the data for sending
+        if(m_write_idx == rlen) {
+            if (!m_send_record(br_buf, rlen < alen, func_name, reconnected)) return 0;
             // reset the buffer pointer
             br_buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
         }
     } 
+    m_drs_last = millis();
     // works oky
     return size;
 }
 
+/* see SSLClient.h */
+uint8_t* SSLClient::writeBuffer(size_t& len) {
+    const char* func_name = __func__;
+    len = 0;
+    // same checks as write, since the caller is about to write
+    bool reconnected = false;
+    if (m_dropped) {
+        reconnected = true;
+        if (m_reconnect(func_name) != 1) return nullptr;
+    }
+    if (!m_soft_connected(func_name)) return nullptr;
+    m_prepared = false;
+    if (!m_wait_sendapp(func_name, reconnected)) return nullptr;
+    size_t alen;
+    unsigned char* br_buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
+    if (br_buf == nullptr || alen == 0) return nullptr;
+    if (millis() - m_drs_last > DRS_IDLE_MS) m_drs_bytes = 0;
+    len = m_record_window(alen) - m_write_idx;
+    return br_buf + m_write_idx;
+}
+
+/* see SSLClient.h */
+size_t SSLClient::commit(size_t len) {
+    const char* func_name = __func__;
+    size_t alen;
+    unsigned char* br_buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
+    if (!len || br_buf == nullptr || !m_is_connected) return 0;
+    const size_t rlen = m_record_window(alen);
+    if (len > rlen - m_write_idx) len = rlen - m_write_idx;
+    // super debug
+    if (m_debug >= DebugLevel::SSL_DUMP) Serial.write(br_buf + m_write_idx, len);
+    m_write_idx += len;
+    if (m_drs_bytes < DRS_BOOST_BYTES) m_drs_bytes += len;
+    m_drs_last = millis();
+    bool reconnected = false;
+    if (m_write_idx == rlen && !m_send_record(br_buf, rlen < alen, func_name, reconnected)) return 0;
+    return len;
+}
+
+/* see SSLClient.h */
+size_t SSLClient::writeFrom(SSLSource& source, size_t limit) {
+    size_t total = 0;
+    while (total < limit) {
+        size_t len;
+        uint8_t* buf = writeBuffer(len);
+        if (buf == nullptr) return total;
+        if (len > limit - total) len = limit - total;
+        const int filled = source.fill(buf, len);
+        if (filled <= 0) break;
+        // a full record is sent by commit
+        const size_t added = commit(static_cast<size_t>(filled) < len ? static_cast<size_t>(filled) : len);
+        if (added == 0) return total;
+        total += added;
+    }
+    // close the last record and write it out, without waiting for the engine to take
+    // data again like write does, so that a response that comes back quickly is kept
+    // for reading rather than discarded
+    if (m_write_idx > 0 && (br_ssl_engine_current_state(&m_sslctx.eng) & BR_SSL_SENDAPP)) {
+        size_t alen;
+        m_replay_append(br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen), m_write_idx);
+        br_ssl_engine_sendapp_ack(&m_sslctx.eng, m_write_idx);
+        br_ssl_engine_flush(&m_sslctx.eng, 0);
+        m_write_idx = 0;
+        if (m_update_engine() == 0) m_error("Failed to send the last record", __func__);
+    }
+    return total;
+}
+
+/* see SSLClient.h */
+int SSLClient::availableForWrite() {
+    if (!m_is_connected || getWriteError() != SSL_OK) return 0;
+    // in a shared buffer, received data has to be read before anything can be written
+    if (!(br_ssl_engine_current_state(&m_sslctx.eng) & BR_SSL_SENDAPP)) return 0;
+    size_t alen;
+    br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
+    size_t rlen = m_record_window(alen);
+    // write goes back to small records after an idle period, so count on that too
+    if (m_drs_enabled && millis() - m_drs_last > DRS_IDLE_MS) {
+        const size_t small = m_write_idx > DRS_SMALL_RECORD ? m_write_idx : DRS_SMALL_RECORD;
+        if (small < rlen) rlen = small;
+    }
+    // filling the record sends it
+    return rlen > m_write_idx + 1 ? static_cast<int>(rlen - m_write_idx - 1) : 0;
+}
+
 /* see SSLClient.h*/
 int SSLClient::available() {
     const char* func_name = __func__;
@@ -148,6 +594,8 @@ int SSLClient::available() {
     unsigned state = m_update_engine();
     if (state == 0) m_error("SSL engine failed to update.", func_name);
     else if(state & BR_SSL_RECVAPP) {
+        // the server answered
+        m_read_waiting = false;
         // return how many received bytes we have
         size_t alen;
         br_ssl_engine_recvapp_buf(&m_sslctx.eng, &alen);
@@ -155,7 +603,17 @@ int SSLClient::available() {
     }
     else if (state == BR_SSL_CLOSED) m_info("Engine closed after update", func_name);
     // flush the buffer if it's stuck in the SENDAPP state
-    else if (state & BR_SSL_SENDAPP) br_ssl_engine_flush(&m_sslctx.eng, 0);
+    else if (state & BR_SSL_SENDAPP) {
+        br_ssl_engine_flush(&m_sslctx.eng, 0);
+        // nothing to read, so use the time to get the next record ready
+        precompute();
+    }
+    // give up if the server stopped answering
+    if (state != 0 && state != BR_SSL_CLOSED && m_read_idle_expired()) {
+        m_error("Timed out waiting for data from the server", func_name);
+        setWriteError(SSL_BR_WRITE_ERROR);
+        stop();
+    }
     // other state, or client is closed
     return 0;
 }
@@ -187,10 +645,30 @@ int SSLClient::peek() {
     return (int)read_num;
 }
 
+/* see SSLClient.h */
+const uint8_t* SSLClient::peekBuffer(size_t& len) {
+    len = 0;
+    if (available() <= 0) return nullptr;
+    return br_ssl_engine_recvapp_buf(&m_sslctx.eng, &len);
+}
+
+/* see SSLClient.h */
+void SSLClient::consume(size_t len) {
+    size_t alen;
+    if (len == 0 || br_ssl_engine_recvapp_buf(&m_sslctx.eng, &alen) == nullptr) return;
+    br_ssl_engine_recvapp_ack(&m_sslctx.eng, len < alen ? len : alen);
+}
+
 /* see SSLClient.h */
 void SSLClient::flush() {
+    // reopen the connection if it dropped with data still to send
+    if (m_dropped && m_reconnect(__func__) != 1) return;
     if (m_write_idx > 0) {
-        if(m_run_until(BR_SSL_RECVAPP) < 0) {
+        int ret = m_run_until(BR_SSL_RECVAPP, m_read_timeout(), true);
+        // try once more on a new connection if this one dropped
+        if (ret < 0 && m_dropped && m_reconnect(__func__) == 1)
+            ret = m_run_until(BR_SSL_RECVAPP, m_read_timeout(), true);
+        if(ret < 0) {
             m_error("Could not flush write buffer!", __func__);
             int error = br_ssl_engine_last_error(&m_sslctx.eng);
             if(error != BR_ERR_OK) 
@@ -203,14 +681,17 @@ void SSLClient::flush() {
 
 /* see SSLClient.h */
 void SSLClient::stop() {
-    // tell the SSL connection to gracefully close
-    // Disabled to prevent close_notify from hanging SSLClient
-    // br_ssl_engine_close(&m_sslctx.eng);
+    const char* func_name = __func__;
+    // a parked connection is gone after this
+    m_prepared = false;
     // if the engine isn't closed, and the socket is still open
     auto state = br_ssl_engine_current_state(&m_sslctx.eng);
     if (state != BR_SSL_CLOSED
         && state != 0
-        && connected()) {
+        && m_connected_impl(m_client)) {
+        // anything that fails from here on will call stop again, which
+        // should then just close the socket
+        m_is_connected = false;
         /*
 		 * Discard any incoming application data.
 		 */
@@ -218,50 +699,278 @@ void SSLClient::stop() {
 		if (br_ssl_engine_recvapp_buf(&m_sslctx.eng, &len) != nullptr) {
 			br_ssl_engine_recvapp_ack(&m_sslctx.eng, len);
 		}
-        // run SSL to finish any existing transactions
-        flush();
+        // send anything left over from SSLClient::write
+        state = m_update_engine();
+        const unsigned long timeout = m_close_timeout();
+        if (timeout > 0 && state != BR_SSL_CLOSED && state != 0 && getWriteError() == SSL_OK) {
+            // send close_notify, then wait a limited amount of time for the
+            // server to answer with its own. Unlike m_run_until we do not treat
+            // a timeout as an error, since the data has already been delivered.
+            br_ssl_engine_close(&m_sslctx.eng);
+            const unsigned long start = millis();
+            for (;;) {
+                state = m_update_engine();
+                if (state == BR_SSL_CLOSED || state == 0 || getWriteError() != SSL_OK) break;
+                if (millis() - start > timeout) {
+                    m_warn("Server did not respond to close_notify in time", func_name);
+                    break;
+                }
+                // the server may still be sending data, which we do not want
+                if (br_ssl_engine_recvapp_buf(&m_sslctx.eng, &len) != nullptr)
+                    br_ssl_engine_recvapp_ack(&m_sslctx.eng, len);
+            }
+        }
 	}
+    // the close was clean if the engine finished the close_notify exchange
+    // (either started by us or by the server) without an error
+    m_close_clean = br_ssl_engine_current_state(&m_sslctx.eng) == BR_SSL_CLOSED
+        && br_ssl_engine_last_error(&m_sslctx.eng) == BR_ERR_OK
+        && getWriteError() == SSL_OK;
     // close the ethernet socket
     get_arduino_client().flush();
     get_arduino_client().stop();
+    m_invalidate_status();
     // we are no longer connected 
     m_is_connected = false;
+    // and a stopped connection is not reopened
+    m_dropped = false;
 }
 
 /* see SSLClient.h */
 uint8_t SSLClient::connected() {
+    return m_connected_or_reconnect(m_client);
+}
+
+/* see SSLClient.h */
+bool SSLClient::hibernate(br_ssl_hibernation& state) {
     const char* func_name = __func__;
-    // check all of the error cases 
-    const auto c_con = get_arduino_client().connected();
-    const auto br_con = br_ssl_engine_current_state(&m_sslctx.eng) != BR_SSL_CLOSED && m_is_connected;
-    const auto wr_ok = getWriteError() == 0;
-    // if we're in an error state, close the connection and set a write error
-    if (br_con && !c_con) {
-        // If we've got a write error, the client probably failed for some reason
-        if (get_arduino_client().getWriteError()) {
-            m_error("Socket was unexpectedly interrupted. m_client error: ", func_name);
-            m_error(get_arduino_client().getWriteError(), func_name);
-            setWriteError(SSL_CLIENT_WRTIE_ERROR);
+    if (!m_soft_connected(func_name)) return false;
+    // send whatever is still in the write buffer
+    if (m_write_idx > 0) {
+        m_update_engine();
+        br_ssl_engine_flush(&m_sslctx.eng, 0);
+    }
+    if (m_run_until(BR_SSL_SENDAPP, m_write_timeout(), true) < 0) {
+        m_error("Failed to send buffered data before hibernating", func_name);
+        return false;
+    }
+    size_t alen;
+    if (br_ssl_engine_recvapp_buf(&m_sslctx.eng, &alen) != nullptr) {
+        m_error("Cannot hibernate with unread data from the server", func_name);
+        return false;
+    }
+    if (!br_ssl_engine_hibernate(&m_sslctx.eng, &state)) {
+        m_error("Cannot hibernate while a record is being transferred", func_name);
+        return false;
+    }
+    // everything we wrote has been sent
+    m_replay_commit();
+    // act as if we were disconnected, but leave the socket alone
+    m_is_connected = false;
+    m_prepared = false;
+    m_dropped = false;
+    m_invalidate_status();
+    m_info("Connection is hibernating", func_name);
+    return true;
+}
+
+/* see SSLClient.h */
+int SSLClient::wake(br_ssl_hibernation& state, const char* host) {
+    const char* func_name = __func__;
+    if (m_is_connected) {
+        m_error("Cannot wake a connection while another one is open", func_name);
+        return 0;
+    }
+    if (!get_arduino_client().connected()) {
+        m_error("The network client was disconnected while the connection was hibernating", func_name);
+        setWriteError(SSL_CLIENT_CONNECT_FAIL);
+        return 0;
+    }
+    setWriteError(SSL_OK);
+    m_inject_entropy();
+    if (!br_ssl_client_wake(&m_sslctx, host, &state)) {
+        m_error("Failed to wake the connection", func_name);
+        m_print_br_error(br_ssl_engine_last_error(&m_sslctx.eng), SSL_ERROR);
+        setWriteError(SSL_BR_CONNECT_FAIL);
+        return 0;
+    }
+    m_replay_discard();
+    m_is_connected = true;
+    m_close_clean = false;
+    m_write_idx = 0;
+    m_drs_bytes = 0;
+    m_invalidate_status();
+    m_info("Connection woke up", func_name);
+    return 1;
+}
+
+/* see SSLClient.h */
+void SSLClient::setAutoReconnect(bool enable, size_t max_replay) {
+#ifdef SSLCLIENT_NO_HEAP
+    if (max_replay > SSLCLIENT_MAX_REPLAY_LEN) max_replay = SSLCLIENT_MAX_REPLAY_LEN;
+#endif
+    // anything kept so far may not fit anymore
+    m_replay_discard();
+    m_reconnect_enabled = enable;
+    m_dropped = false;
+    m_replay_max = enable ? max_replay : 0;
+#ifndef SSLCLIENT_NO_HEAP
+    m_replay.resize(m_replay_max);
+    m_replay.shrink_to_fit();
+#endif
+}
+
+/* see SSLClient.h */
+void SSLClient::setPrecompute(size_t bytes) {
+#ifdef SSLCLIENT_NO_HEAP
+    if (bytes > SSLCLIENT_MAX_PRECOMPUTE_LEN) bytes = SSLCLIENT_MAX_PRECOMPUTE_LEN;
+    if (bytes > 0) br_ssl_engine_set_keystream_buffer(&m_sslctx.eng, m_keystream, SSLCLIENT_KEYSTREAM_LEN(bytes));
+    else br_ssl_engine_set_keystream_buffer(&m_sslctx.eng, nullptr, 0);
+#else
+    // the engine forgets the old buffer before it is freed
+    br_ssl_engine_set_keystream_buffer(&m_sslctx.eng, nullptr, 0);
+    m_keystream.assign(bytes > 0 ? SSLCLIENT_KEYSTREAM_LEN(bytes) : 0, 0);
+    m_keystream.shrink_to_fit();
+    if (bytes > 0) br_ssl_engine_set_keystream_buffer(&m_sslctx.eng, m_keystream.data(), m_keystream.size());
+#endif
+}
+
+/* see SSLClient.h */
+size_t SSLClient::precompute() {
+    if (!m_is_connected) return 0;
+    return br_ssl_engine_precompute_keystream(&m_sslctx.eng);
+}
+
+/* see SSLClient.h */
+SSLClient::Calibration SSLClient::calibrate(bool curves) {
+    const char* func_name = __func__;
+    br_ssl_engine_context& eng = m_sslctx.eng;
+    Calibration cal = Calibration();
+    // the key and data do not matter, only how long it takes
+    unsigned char buf[256] = { 0 };
+    unsigned char key[32] = { 0 };
+    unsigned char iv[12] = { 0 };
+    unsigned char tag[16] = { 0 };
+    if (eng.iaes_ctr != nullptr && eng.ighash != nullptr) {
+        br_aes_gen_ctr_keys aes;
+        eng.iaes_ctr->init(&aes.vtable, key, 16);
+        const unsigned long start = micros();
+        for (size_t done = 0; done < SSL_CALIBRATE_BYTES; done += sizeof buf) {
+            aes.vtable->run(&aes.vtable, iv, 2, buf, sizeof buf);
+            eng.ighash(tag, key, buf, sizeof buf);
         }
-        // Else tell the user the endpoint closed the socket on us (ouch)
-        else {
-            m_warn("Socket was dropped unexpectedly (this can be an alternative to closing the connection)", func_name);
+        cal.gcm_us = micros() - start + 1;
+    }
+    if (eng.ichacha != nullptr && eng.ipoly != nullptr) {
+        const unsigned long start = micros();
+        for (size_t done = 0; done < SSL_CALIBRATE_BYTES; done += sizeof buf)
+            eng.ipoly(key, iv, buf, sizeof buf, buf, 13, tag, eng.ichacha, 1);
+        cal.chapol_us = micros() - start + 1;
+    }
+    m_info("AES-GCM (us): ", func_name);
+    m_info(cal.gcm_us, func_name);
+    m_info("ChaCha20-Poly1305 (us): ", func_name);
+    m_info(cal.chapol_us, func_name);
+    // reorder the suites: forward secrecy first, then the fastest cipher
+    const auto rank = [&cal](uint16_t suite) -> unsigned long {
+        // signaling values (TLS_FALLBACK_SCSV) stay at the end
+        if (suite == 0x5600 || suite == 0x00FF) return ~0UL;
+        const bool chapol = (suite & 0xFF00) == 0xCC00;
+        const bool gcm = (suite >= 0xC02B && suite <= 0xC032) || (suite >= 0x009C && suite <= 0x009F);
+        // static ECDH and RSA key exchange
+        const bool no_fs = (suite & 0xFF00) == 0x0000
+            || suite == 0xC003 || suite == 0xC004 || suite == 0xC005
+            || suite == 0xC00D || suite == 0xC00E || suite == 0xC00F
+            || suite == 0xC025 || suite == 0xC026 || suite == 0xC029 || suite == 0xC02A
+            || suite == 0xC02D || suite == 0xC02E || suite == 0xC031 || suite == 0xC032;
+        unsigned long t = ~0UL >> 1;
+        if (chapol && cal.chapol_us) t = cal.chapol_us;
+        else if (gcm && cal.gcm_us) t = cal.gcm_us;
+        // keep the time below the top bit, which marks suites without forward secrecy
+        if (t > (~0UL >> 2)) t = ~0UL >> 2;
+        return no_fs ? t | ~(~0UL >> 1) : t;
+    };
+    size_t suites_num;
+    const uint16_t* current = br_ssl_engine_get_suites(&eng, &suites_num);
+    uint16_t suites[BR_MAX_CIPHER_SUITES];
+    memcpy(suites, current, suites_num * sizeof suites[0]);
+    // insertion sort, which keeps the configured order between equally fast suites
+    for (size_t i = 1; i < suites_num; i++) {
+        const uint16_t s = suites[i];
+        const unsigned long r = rank(s);
+        size_t j = i;
+        for (; j > 0 && rank(suites[j - 1]) > r; j--) suites[j] = suites[j - 1];
+        suites[j] = s;
+    }
+    br_ssl_engine_set_suites(&eng, suites, suites_num);
+    if (!curves || eng.iec == nullptr) return cal;
+    // time one multiplication of the generator on each curve
+    for (int id = 0; id < 32 && cal.curves_num < sizeof cal.curves; id++) {
+        if (!((eng.iec->supported_curves >> id) & 1)) continue;
+        size_t glen, olen;
+        const unsigned char* g = eng.iec->generator(id, &glen);
+        const unsigned char* order = eng.iec->order(id, &olen);
+        unsigned char point[133];
+        unsigned char scalar[66];
+        if (g == nullptr || glen > sizeof point || order == nullptr || olen == 0 || olen > sizeof scalar) continue;
+        memcpy(point, g, glen);
+        // a full size scalar for this curve (order - 1), as in a real key exchange
+        memcpy(scalar, order, olen);
+        scalar[olen - 1]--;
+        const unsigned long start = micros();
+        eng.iec->mul(point, glen, scalar, olen, id);
+        const unsigned long us = micros() - start + 1;
+        m_info("Curve ID: ", func_name);
+        m_info(id, func_name);
+        m_info("Curve multiplication (us): ", func_name);
+        m_info(us, func_name);
+        // insert in order, fastest first
+        size_t j = cal.curves_num++;
+        for (; j > 0 && cal.curve_us[j - 1] > us; j--) {
+            cal.curves[j] = cal.curves[j - 1];
+            cal.curve_us[j] = cal.curve_us[j - 1];
         }
-        // we are not connected
-        m_is_connected = false;
-        // set the write error so the engine doesn't try to close the connection
-        stop();
+        cal.curves[j] = static_cast<unsigned char>(id);
+        cal.curve_us[j] = us;
     }
-    else if (!wr_ok) {
-        m_error("Not connected because write error is set", func_name);
-        m_print_ssl_error(getWriteError(), SSL_ERROR);
+    br_ssl_engine_set_curves_order(&eng, cal.curves, cal.curves_num);
+    return cal;
+}
+
+/* see SSLClient.h */
+void SSLClient::setHandshakeBackoff(unsigned long base, unsigned long max) {
+    m_backoff_base = base;
+    m_backoff_max = max > base ? max : base;
+    if (base == 0) clearHandshakeFailure();
+}
+
+/* see SSLClient.h */
+bool SSLClient::getHandshakeFailure(const char* host, HandshakeFailure& failure) const {
+    const int index = m_get_failure_index(host);
+    if (index < 0) return false;
+    const auto& entry = m_failures[index];
+    const unsigned long elapsed = millis() - entry.since;
+    failure.br_error = entry.br_error;
+    failure.failures = entry.failures;
+    failure.retry_in = elapsed < entry.backoff ? entry.backoff - elapsed : 0;
+    return true;
+}
+
+/* see SSLClient.h */
+void SSLClient::clearHandshakeFailure(const char* host) {
+    if (host == nullptr) {
+        for (auto& entry : m_failures) entry.host_hash = 0;
+        return;
     }
-    return c_con && br_con;
+    const int index = m_get_failure_index(host);
+    if (index >= 0) m_failures[index].host_hash = 0;
 }
 
 /* see SSLClient.h */
 SSLSession* SSLClient::getSession(const char* host) {
     const char* func_name = __func__;
+    // shared sessions are copied in by m_start_ssl instead
+    if (m_session_cache != nullptr) return nullptr;
     // search for a matching session with the IP
     int temp_index = m_get_session_index(host);
     // if none are availible, use m_session_index
@@ -275,6 +984,10 @@ SSLSession* SSLClient::getSession(const char* host) {
 /* see SSLClient.h */
 void SSLClient::removeSession(const char* host) {
     const char* func_name = __func__;
+    if (m_session_cache != nullptr) {
+        m_session_cache->remove(host);
+        return;
+    }
     int temp_index = m_get_session_index(host);
     if (temp_index >= 0) {
         m_info(" Deleted session ", func_name);
@@ -305,6 +1018,25 @@ void SSLClient::setMutualAuthParams(const SSLClientParameters& params) {
     }
 }
 
+/* see SSLClient.h */
+void SSLClient::setAlpnProtocols(const char* const* protocols, size_t count) {
+    // BearSSL only reads the names, it just doesn't declare them const
+    br_ssl_engine_set_protocol_names(&m_sslctx.eng, const_cast<const char**>(protocols), protocols != nullptr ? count : 0);
+}
+
+/* see SSLClient.h */
+const char* SSLClient::getAlpnProtocol() {
+    if (!m_is_connected) return nullptr;
+    return br_ssl_engine_get_selected_protocol(&m_sslctx.eng);
+}
+
+/* see SSLClient.h */
+bool SSLClient::getRandom(void* buf, size_t len) {
+    if (!m_is_connected) return false;
+    br_hmac_drbg_generate(&m_sslctx.eng.rng, buf, len);
+    return true;
+}
+
 /* see SSLClient.h */
 void SSLClient::setVerificationTime(uint32_t days, uint32_t seconds) {
     br_x509_minimal_set_time(&m_x509ctx, days, seconds);
@@ -328,10 +1060,7 @@ bool SSLClient::m_soft_connected(const char* func_name) {
 }
 
 /* see SSLClient.h */
-int SSLClient::m_start_ssl(const char* host, SSLSession* ssl_ses) {
-    const char* func_name = __func__;
-    // clear the write error
-    setWriteError(SSL_OK);
+void SSLClient::m_inject_entropy() {
     // get some random data by reading the analog pin we've been handed
     // we want 128 bits to be safe, as recommended by the bearssl docs
     uint8_t rng_seeds[16];
@@ -339,34 +1068,74 @@ int SSLClient::m_start_ssl(const char* host, SSLSession* ssl_ses) {
     for (uint8_t i = 0; i < sizeof rng_seeds; i++) 
         rng_seeds[i] = static_cast<uint8_t>(analogRead(m_analog_pin));
     br_ssl_engine_inject_entropy(&m_sslctx.eng, rng_seeds, sizeof rng_seeds);
+}
+
+/* see SSLClient.h */
+int SSLClient::m_start_ssl(const char* host, SSLSession* ssl_ses) {
+    const char* func_name = __func__;
+    // clear the write error
+    setWriteError(SSL_OK);
+    m_inject_entropy();
     // inject session parameters for faster reconnection, if we have any
+    br_ssl_session_parameters shared_ses;
+    bool resume = true;
     if(ssl_ses != nullptr) {
         br_ssl_engine_set_session_parameters(&m_sslctx.eng, ssl_ses->to_br_session());
         m_info("Set SSL session!", func_name);
     }
+    else if (m_session_cache != nullptr && host != nullptr) {
+        if (m_session_cache->get(host, &shared_ses)) {
+            br_ssl_engine_set_session_parameters(&m_sslctx.eng, &shared_ses);
+            m_info("Set shared SSL session!", func_name);
+        }
+        // the engine still holds the session of the last host this client
+        // connected to, which must not be offered to another one
+        else resume = false;
+    }
     // reset the engine, but make sure that it reset successfully
-    int ret = br_ssl_client_reset(&m_sslctx, host, 1);
+    int ret = br_ssl_client_reset(&m_sslctx, host, resume ? 1 : 0);
     if (!ret) {
         m_error("Reset of bearSSL failed (is bearssl setup properly?)", func_name);
         m_print_br_error(br_ssl_engine_last_error(&m_sslctx.eng), SSL_ERROR);
         setWriteError(SSL_BR_CONNECT_FAIL);
         return 0;
     }
+    m_close_clean = false;
+    m_read_waiting = false;
+    // the network client just connected, so anything cached is out of date
+    m_invalidate_status();
+    // start measuring the round trip time with the first handshake record
+    m_rtt_probe_start = 0;
+    m_rtt_sampled = false;
+    const unsigned long handshake_start = millis();
     // initialize the SSL socket over the network
     // normally this would happen in write, but I think it makes
     // a little more structural sense to put it here
-    if (m_run_until(BR_SSL_SENDAPP) < 0) {
+    if (m_run_until(BR_SSL_SENDAPP, m_handshake_timeout()) < 0) {
 		m_error("Failed to initlalize the SSL layer", func_name);
         m_print_br_error(br_ssl_engine_last_error(&m_sslctx.eng), SSL_ERROR);
+        // only back off if the handshake itself failed, not the network
+        if (br_ssl_engine_last_error(&m_sslctx.eng) != BR_ERR_OK) m_record_handshake(host, false);
+        // don't leave the server waiting on a connection that will never be used
+        get_arduino_client().stop();
         return 0;
 	}
     m_info("Connection successful!", func_name);
     m_is_connected = true;
+    m_record_handshake(host, true);
+    // remember how long the handshake took for adaptive timeouts
+    const unsigned long handshake_time = millis() - handshake_start;
+    if (handshake_time > m_handshake_max) m_handshake_max = handshake_time;
+    if (m_rtt_sampled) m_update_rtt(m_rtt_sample);
     // all good to go! the SSL socket should be up and running
     // overwrite the session we got with new parameters
     if (ssl_ses != nullptr)
         br_ssl_engine_get_session_parameters(&m_sslctx.eng, ssl_ses->to_br_session());
-    else if (host != nullptr) {
+    else if (m_session_cache != nullptr) {
+        br_ssl_engine_get_session_parameters(&m_sslctx.eng, &shared_ses);
+        m_session_cache->put(host, shared_ses);
+    }
+    else if (host != nullptr && m_max_sessions > 0 && SSLSession::can_store_hostname(host)) {
         if (m_sessions.size() >= m_max_sessions)
             m_sessions.erase(m_sessions.begin());
         SSLSession session(host);
@@ -377,13 +1146,19 @@ int SSLClient::m_start_ssl(const char* host, SSLSession* ssl_ses) {
 }
 
 /* see SSLClient.h */
-int SSLClient::m_run_until(const unsigned target) {
+int SSLClient::m_run_until(const unsigned target, const unsigned long timeout, const bool idle) {
     const char* func_name = __func__;
     unsigned lastState = 0;
     size_t lastLen = 0;
-    const unsigned long start = millis();
+    unsigned long start = millis();
+    unsigned long io_count = m_io_count;
     for (;;) {
         unsigned state = m_update_engine();
+        // if we are waiting for an idle timeout, any data moving restarts it
+        if (idle && io_count != m_io_count) {
+            io_count = m_io_count;
+            start = millis();
+        }
 	    // error check
         if (state == BR_SSL_CLOSED || getWriteError() != SSL_OK) {
             if (state == BR_SSL_CLOSED) {
@@ -396,7 +1171,7 @@ int SSLClient::m_run_until(const unsigned target) {
             return -1;
         }
         // timeout check
-        if (millis() - start > getTimeout()) {
+        if (millis() - start > timeout) {
             m_error("SSL internals timed out! This could be an internal error, bad data sent from the server, or data being discarded due to a buffer overflow. If you are using Ethernet, did you modify the library properly (see README)?", func_name);
             setWriteError(SSL_BR_WRITE_ERROR);
             stop();
@@ -460,132 +1235,136 @@ int SSLClient::m_run_until(const unsigned target) {
 
 /* see SSLClient.h*/
 unsigned SSLClient::m_update_engine() {
-    const char* func_name = __func__;
-    for(;;) {
-        // get the state
-        unsigned state = br_ssl_engine_current_state(&m_sslctx.eng);
-        // debug
-        if (m_br_last_state == 0 || state != m_br_last_state) {
-            m_br_last_state = state;
-            m_print_br_state(state, DebugLevel::SSL_INFO);
-        }
-        if (state & BR_SSL_CLOSED) return state;
-        /*
-        * If there is some record data to send, do it. This takes
-        * precedence over everything else.
-        */
-        if (state & BR_SSL_SENDREC) {
-            unsigned char *buf;
-            size_t len;
-            int wlen;
-
-            buf = br_ssl_engine_sendrec_buf(&m_sslctx.eng, &len);
-            wlen = get_arduino_client().write(buf, len);
-            get_arduino_client().flush();
-            if (wlen <= 0) {
-                // if the arduino client encountered an error
-                if (get_arduino_client().getWriteError() || !get_arduino_client().connected()) {
-                    m_error("Error writing to m_client", func_name);
-                    m_error(get_arduino_client().getWriteError(), func_name);
-                    setWriteError(SSL_CLIENT_WRTIE_ERROR);
-                }
-                // else presumably the socket just closed itself, so just stop the engine
-                stop();
-                return 0;
-            }
-            if (wlen > 0) {
-                br_ssl_engine_sendrec_ack(&m_sslctx.eng, wlen);
-            }
-	    continue;
-        }
-        
-        /*
-         * If the client has specified there is client data to send, and 
-         * the engine is ready to handle it, send it along.
-         */
-        if (m_write_idx > 0) {
-            // if we've reached the point where BR_SSL_SENDAPP is off but
-            // data has been written to the io buffer, something is wrong
-            if (!(state & BR_SSL_SENDAPP)) {
-                m_error("Error m_write_idx > 0 but the ssl engine is not ready for data", func_name);
-                m_error(br_ssl_engine_current_state(&m_sslctx.eng), func_name);
-                m_error(br_ssl_engine_last_error(&m_sslctx.eng), func_name);
-                setWriteError(SSL_BR_WRITE_ERROR);
-                stop();
-                return 0;
-            }
-            // else time to send the application data
-            else if (state & BR_SSL_SENDAPP) {
-	            size_t alen;
-                unsigned char *buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
-                // engine check
-                if (alen == 0 || buf == nullptr) {
-                    m_error("Engine set write flag but returned null buffer", func_name);
-                    setWriteError(SSL_BR_WRITE_ERROR);
-                    stop();
-                    return 0;
-                }
-                // sanity check
-                if (alen < m_write_idx) {
-                    m_error("Alen is less than m_write_idx", func_name);
-                    setWriteError(SSL_INTERNAL_ERROR);
-                    stop();
-                    return 0;
-                }
-                // all good? lets send the data
-                // presumably the SSLClient::write function has already added
-                // data to *buf, so now we tell bearssl it's time for the
-                // encryption step.
-                // this will encrypt the data and presumably spit it out
-                // for BR_SSL_SENDREC to send over ethernet.
-                br_ssl_engine_sendapp_ack(&m_sslctx.eng, m_write_idx);
-                // reset the iobuffer index
-                m_write_idx = 0;
-                // loop again!
-                continue;
-            }
-        }
-        
-        /*
-         * If there is some record data to recieve, check if we've
-         * recieved it so far. If we have, then we can update the state.
-         * else we can return that we're still waiting for the server.
-         */
-        if (state & BR_SSL_RECVREC) {
-			size_t len;
-			unsigned char * buf = br_ssl_engine_recvrec_buf(&m_sslctx.eng, &len);
-            // do we have the record you're looking for?
-            const auto avail = get_arduino_client().available();
-            if (avail > 0) {
-                // I suppose so!
-                int rlen = get_arduino_client().read(buf, avail < len ? avail : len);
-                if (rlen <= 0) {
-                    m_error("Error reading bytes from m_client. Write Error: ", func_name);
-                    m_error(get_arduino_client().getWriteError(), func_name);
-                    setWriteError(SSL_CLIENT_WRTIE_ERROR);
-                    stop();
-                    return 0;
-                }
-                if (rlen > 0) {
-                    br_ssl_engine_recvrec_ack(&m_sslctx.eng, rlen);
-                }
-                continue;
-            }
-            // guess not, tell the state we're waiting still
-			else {
-                // m_print("Bytes avail: ");
-                // m_print(avail);
-                // m_print("Bytes needed: ");
-                // m_print(len);
-                // add a delay since spamming get_arduino_client().availible breaks the poor wiz chip
-                delay(10);
-                return state;
-            }
+    return m_update_engine_impl(m_client);
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_phase_timeout(const unsigned int configured, const unsigned long adaptive) const {
+    // use the configured value until we have measured something
+    if (!m_adaptive_timeouts || m_srtt == 0 || adaptive >= configured) return configured;
+    // but never go below the minimum, unless the configured value is lower
+    if (adaptive > m_adaptive_min) return adaptive;
+    return m_adaptive_min < configured ? m_adaptive_min : configured;
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_connect_timeout() const {
+    return m_phase_timeout(m_timeout_connect, SSL_RTT_TIMEOUT_FACTOR * (static_cast<unsigned long>(m_srtt) + 4 * m_rttvar));
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_handshake_timeout() const {
+    return m_phase_timeout(m_timeout_handshake, SSL_RTT_HANDSHAKE_FACTOR * m_handshake_max);
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_read_timeout() const {
+    return m_phase_timeout(m_timeout_read, SSL_RTT_TIMEOUT_FACTOR * (static_cast<unsigned long>(m_srtt) + 4 * m_rttvar));
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_write_timeout() const {
+    return m_phase_timeout(m_timeout_write, SSL_RTT_TIMEOUT_FACTOR * (static_cast<unsigned long>(m_srtt) + 4 * m_rttvar));
+}
+
+/* see SSLClient.h */
+unsigned long SSLClient::m_close_timeout() const {
+    return m_phase_timeout(m_timeout_close, SSL_RTT_TIMEOUT_FACTOR * (static_cast<unsigned long>(m_srtt) + 4 * m_rttvar));
+}
+
+/* see SSLClient.h */
+void SSLClient::m_expire_status() {
+    const unsigned long now = millis();
+    if (now - m_status_time >= m_status_cache_ms) {
+        m_invalidate_status();
+        m_status_time = now;
+    }
+}
+
+/* see SSLClient.h */
+void SSLClient::m_consume_available(const int len) {
+    // the network client can only have more data than it reported, so the
+    // rest is still a safe answer. If we used it all, ask again next time.
+    if (m_status_available > len) m_status_available -= len;
+    else m_status_available = -1;
+}
+
+/* see SSLClient.h */
+void SSLClient::m_update_rtt(const unsigned long sample) {
+    // smooth the samples the same way TCP does (RFC 6298), with
+    // a floor of 1ms so a measured RTT is never zero
+    const unsigned int r = sample > 0 ? sample : 1;
+    if (m_srtt == 0) {
+        m_srtt = r;
+        m_rttvar = r / 2;
+    }
+    else {
+        const unsigned int diff = m_srtt > r ? m_srtt - r : r - m_srtt;
+        m_rttvar = (3 * m_rttvar + diff) / 4;
+        m_srtt = (7 * m_srtt + r) / 8;
+        if (m_srtt == 0) m_srtt = 1;
+    }
+    m_info("Handshake round trip time (ms): ", __func__);
+    m_info(m_srtt, __func__);
+}
+
+/* see SSLClient.h */
+size_t SSLClient::m_record_window(const size_t alen) const {
+    if (!m_drs_enabled || m_drs_bytes >= DRS_BOOST_BYTES) return alen;
+    // never shrink below what has already been buffered for this record
+    const size_t small = m_write_idx > DRS_SMALL_RECORD ? m_write_idx : DRS_SMALL_RECORD;
+    return small < alen ? small : alen;
+}
+
+/* see SSLClient.h */
+bool SSLClient::m_backing_off(const char* host, const char* func_name) {
+    HandshakeFailure failure;
+    if (m_backoff_base == 0 || !getHandshakeFailure(host, failure) || failure.retry_in == 0)
+        return false;
+    m_warn("Handshakes with this host keep failing, not retrying until the backoff passes", func_name);
+    if (failure.br_error != 0) m_print_br_error(failure.br_error, SSL_WARN);
+    setWriteError(SSL_BR_CONNECT_FAIL);
+    return true;
+}
+
+/* see SSLClient.h */
+void SSLClient::m_record_handshake(const char* host, bool success) {
+    if (m_backoff_base == 0 || host == nullptr) return;
+    int index = m_get_failure_index(host);
+    if (success) {
+        if (index >= 0) m_failures[index].host_hash = 0;
+        return;
+    }
+    const unsigned long now = millis();
+    if (index < 0) {
+        // take a free entry, or the one that has waited longest since its last failure
+        index = 0;
+        for (size_t i = 0; i < SSLCLIENT_MAX_FAILED_HOSTS; i++) {
+            if (m_failures[i].host_hash == 0) { index = i; break; }
+            if (now - m_failures[i].since > now - m_failures[index].since) index = i;
         }
-        // if it's not any of the above states, then it must be waiting to send or recieve app data
-        // in which case we return 
-        return state;
+        m_failures[index].host_hash = ssl_hash_hostname(host);
+        m_failures[index].failures = 0;
+        m_failures[index].backoff = 0;
+    }
+    auto& entry = m_failures[index];
+    entry.br_error = br_ssl_engine_last_error(&m_sslctx.eng);
+    entry.since = now;
+    entry.failures++;
+    // double the backoff with each failure, stopping at the limit
+    entry.backoff = entry.backoff == 0 ? m_backoff_base
+        : entry.backoff > m_backoff_max / 2 ? m_backoff_max
+        : entry.backoff * 2;
+}
+
+/* see SSLClient.h */
+int SSLClient::m_get_failure_index(const char* host) const {
+    if (host == nullptr) return -1;
+    const uint32_t hash = ssl_hash_hostname(host);
+    for (size_t i = 0; i < SSLCLIENT_MAX_FAILED_HOSTS; i++) {
+        if (m_failures[i].host_hash == hash) return i;
     }
+    return -1;
 }
 
 /* see SSLClientImpl.h */
@@ -595,8 +1374,8 @@ int SSLClient::m_get_session_index(const char* host) const {
     // search for a matching session with the IP
     for (uint8_t i = 0; i < getSessionCount(); i++) {
         // if we're looking at a real session
-        if (m_sessions[i].get_hostname().equals(host)) {
-            m_info(m_sessions[i].get_hostname(), func_name);
+        if (m_sessions[i].matches_hostname(host)) {
+            m_info("Found a session matching the hostname", func_name);
             return i;
         }
     }
@@ -605,118 +1384,44 @@ int SSLClient::m_get_session_index(const char* host) const {
 }
 
 /* See SSLClient.h */
-void SSLClient::m_print_prefix(const char* func_name, const DebugLevel level) const
-{
-    // print the sslclient prefix
-    Serial.print("(SSLClient)");
-    // print the debug level
-    switch (level) {
-        case SSL_INFO: Serial.print("(SSL_INFO)"); break;
-        case SSL_WARN: Serial.print("(SSL_WARN)"); break;
-        case SSL_ERROR: Serial.print("(SSL_ERROR)"); break;
-        default: Serial.print("(Unknown level)");
-    }
-    // print the function name
-    Serial.print("(");
-    Serial.print(func_name);
-    Serial.print("): ");
+SSLLogEvent SSLClient::m_make_event(const char* func_name, const DebugLevel level, const uint8_t type) const {
+    SSLLogEvent event;
+    event.time = millis();
+    event.func_name = func_name;
+    event.str = nullptr;
+    event.arg = 0;
+    event.level = level;
+    event.type = type;
+    return event;
+}
+
+/* See SSLClient.h */
+void SSLClient::m_log(const SSLLogEvent& event) const {
+    // hand the event to the sink if there is one, otherwise print it now
+    if (m_log_sink != nullptr) m_log_sink->log(event);
+    else if (Serial) event.printTo(Serial);
 }
 
 /* See SSLClient.h */
 void SSLClient::m_print_ssl_error(const int ssl_error, const DebugLevel level) const {
     if (level > m_debug) return;
-    m_print_prefix(__func__, level);
-    switch(ssl_error) {
-        case SSL_OK: Serial.println("SSL_OK"); break;
-        case SSL_CLIENT_CONNECT_FAIL: Serial.println("SSL_CLIENT_CONNECT_FAIL"); break;
-        case SSL_BR_CONNECT_FAIL: Serial.println("SSL_BR_CONNECT_FAIL"); break;
-        case SSL_CLIENT_WRTIE_ERROR: Serial.println("SSL_CLIENT_WRITE_FAIL"); break;
-        case SSL_BR_WRITE_ERROR: Serial.println("SSL_BR_WRITE_ERROR"); break;
-        case SSL_INTERNAL_ERROR: Serial.println("SSL_INTERNAL_ERROR"); break;
-        case SSL_OUT_OF_MEMORY: Serial.println("SSL_OUT_OF_MEMORY"); break;
-    }
+    SSLLogEvent event = m_make_event(__func__, level, SSLLogEvent::SSL_LOG_SSL_ERROR);
+    event.arg = ssl_error;
+    m_log(event);
 }
 
 /* See SSLClient.h */
 void SSLClient::m_print_br_error(const unsigned br_error_code, const DebugLevel level) const {
     if (level > m_debug) return;
-    m_print_prefix(__func__, level);
-    switch (br_error_code) {
-        case BR_ERR_BAD_PARAM: Serial.println("Caller-provided parameter is incorrect."); break;
-        case BR_ERR_BAD_STATE: Serial.println("Operation requested by the caller cannot be applied with the current context state (e.g. reading data while outgoing data is waiting to be sent)."); break;
-        case BR_ERR_UNSUPPORTED_VERSION: Serial.println("Incoming protocol or record version is unsupported."); break;
-        case BR_ERR_BAD_VERSION: Serial.println("Incoming record version does not match the expected version."); break;
-        case BR_ERR_BAD_LENGTH: Serial.println("Incoming record length is invalid."); break;
-        case BR_ERR_TOO_LARGE: Serial.println("Incoming record is too large to be processed, or buffer is too small for the handshake message to send."); break;
-        case BR_ERR_BAD_MAC: Serial.println("Decryption found an invalid padding, or the record MAC is not correct."); break;
-        case BR_ERR_NO_RANDOM: Serial.println("No initial entropy was provided, and none can be obtained from the OS."); break;
-        case BR_ERR_UNKNOWN_TYPE: Serial.println("Incoming record type is unknown."); break;
-        case BR_ERR_UNEXPECTED: Serial.println("Incoming record or message has wrong type with regards to the current engine state."); break;
-        case BR_ERR_BAD_CCS: Serial.println("ChangeCipherSpec message from the peer has invalid contents."); break;
-        case BR_ERR_BAD_ALERT: Serial.println("Alert message from the peer has invalid contents (odd length)."); break;
-        case BR_ERR_BAD_HANDSHAKE: Serial.println("Incoming handshake message decoding failed."); break;
-        case BR_ERR_OVERSIZED_ID: Serial.println("ServerHello contains a session ID which is larger than 32 bytes."); break;
-        case BR_ERR_BAD_CIPHER_SUITE: Serial.println("Server wants to use a cipher suite that we did not claim to support. This is also reported if we tried to advertise a cipher suite that we do not support."); break;
-        case BR_ERR_BAD_COMPRESSION: Serial.println("Server wants to use a compression that we did not claim to support."); break;
-        case BR_ERR_BAD_FRAGLEN: Serial.println("Server's max fragment length does not match client's."); break;
-        case BR_ERR_BAD_SECRENEG: Serial.println("Secure renegotiation failed."); break;
-        case BR_ERR_EXTRA_EXTENSION: Serial.println("Server sent an extension type that we did not announce, or used the same extension type several times in a single ServerHello."); break;
-        case BR_ERR_BAD_SNI: Serial.println("Invalid Server Name Indication contents (when used by the server, this extension shall be empty)."); break;
-        case BR_ERR_BAD_HELLO_DONE: Serial.println("Invalid ServerHelloDone from the server (length is not 0)."); break;
-        case BR_ERR_LIMIT_EXCEEDED: Serial.println("Internal limit exceeded (e.g. server's public key is too large)."); break;
-        case BR_ERR_BAD_FINISHED: Serial.println("Finished message from peer does not match the expected value."); break;
-        case BR_ERR_RESUME_MISMATCH: Serial.println("Session resumption attempt with distinct version or cipher suite."); break;
-        case BR_ERR_INVALID_ALGORITHM: Serial.println("Unsupported or invalid algorithm (ECDHE curve, signature algorithm, hash function)."); break;
-        case BR_ERR_BAD_SIGNATURE: Serial.println("Invalid signature in ServerKeyExchange or CertificateVerify message."); break;
-        case BR_ERR_WRONG_KEY_USAGE: Serial.println("Peer's public key does not have the proper type or is not allowed for the requested operation."); break;
-        case BR_ERR_NO_CLIENT_AUTH: Serial.println("Client did not send a certificate upon request, or the client certificate could not be validated."); break;
-        case BR_ERR_IO: Serial.println("I/O error or premature close on transport stream."); break;
-        case BR_ERR_X509_INVALID_VALUE: Serial.println("Invalid value in an ASN.1 structure."); break;
-        case BR_ERR_X509_TRUNCATED: Serial.println("Truncated certificate or other ASN.1 object."); break;
-        case BR_ERR_X509_EMPTY_CHAIN: Serial.println("Empty certificate chain (no certificate at all)."); break;
-        case BR_ERR_X509_INNER_TRUNC: Serial.println("Decoding error: inner element extends beyond outer element size."); break;
-        case BR_ERR_X509_BAD_TAG_CLASS: Serial.println("Decoding error: unsupported tag class (application or private)."); break;
-        case BR_ERR_X509_BAD_TAG_VALUE: Serial.println("Decoding error: unsupported tag value."); break;
-        case BR_ERR_X509_INDEFINITE_LENGTH: Serial.println("Decoding error: indefinite length."); break;
-        case BR_ERR_X509_EXTRA_ELEMENT: Serial.println("Decoding error: extraneous element."); break;
-        case BR_ERR_X509_UNEXPECTED: Serial.println("Decoding error: unexpected element."); break;
-        case BR_ERR_X509_NOT_CONSTRUCTED: Serial.println("Decoding error: expected constructed element, but is primitive."); break;
-        case BR_ERR_X509_NOT_PRIMITIVE: Serial.println("Decoding error: expected primitive element, but is constructed."); break;
-        case BR_ERR_X509_PARTIAL_BYTE: Serial.println("Decoding error: BIT STRING length is not multiple of 8."); break;
-        case BR_ERR_X509_BAD_BOOLEAN: Serial.println("Decoding error: BOOLEAN value has invalid length."); break;
-        case BR_ERR_X509_OVERFLOW: Serial.println("Decoding error: value is off-limits."); break;
-        case BR_ERR_X509_BAD_DN: Serial.println("Invalid distinguished name."); break;
-        case BR_ERR_X509_BAD_TIME: Serial.println("Invalid date/time representation."); break;
-        case BR_ERR_X509_UNSUPPORTED: Serial.println("Certificate contains unsupported features that cannot be ignored."); break;
-        case BR_ERR_X509_LIMIT_EXCEEDED: Serial.println("Key or signature size exceeds internal limits."); break;
-        case BR_ERR_X509_WRONG_KEY_TYPE: Serial.println("Key type does not match that which was expected."); break;
-        case BR_ERR_X509_BAD_SIGNATURE: Serial.println("Signature is invalid."); break;
-        case BR_ERR_X509_TIME_UNKNOWN: Serial.println("Validation time is unknown."); break;
-        case BR_ERR_X509_EXPIRED: Serial.println("Certificate is expired or not yet valid."); break;
-        case BR_ERR_X509_DN_MISMATCH: Serial.println("Issuer/Subject DN mismatch in the chain."); break;
-        case BR_ERR_X509_BAD_SERVER_NAME: Serial.println("Expected server name was not found in the chain."); break;
-        case BR_ERR_X509_CRITICAL_EXTENSION: Serial.println("Unknown critical extension in certificate."); break;
-        case BR_ERR_X509_NOT_CA: Serial.println("Not a CA, or path length constraint violation."); break;
-        case BR_ERR_X509_FORBIDDEN_KEY_USAGE: Serial.println("Key Usage extension prohibits intended usage."); break;
-        case BR_ERR_X509_WEAK_PUBLIC_KEY: Serial.println("Public key found in certificate is too small."); break;
-        case BR_ERR_X509_NOT_TRUSTED: Serial.println("Chain could not be linked to a trust anchor. See https://github.com/OPEnSLab-OSU/SSLClient/blob/master/TrustAnchors.md"); break;
-        case 296: Serial.println("Server denied access (did you setup mTLS correctly?)"); break;
-        default: Serial.print("Unknown error code: "); Serial.println(br_error_code); break;
-    }
+    SSLLogEvent event = m_make_event(__func__, level, SSLLogEvent::SSL_LOG_BR_ERROR);
+    event.arg = static_cast<int32_t>(br_error_code);
+    m_log(event);
 }
 
-
+/* See SSLClient.h */
 void SSLClient::m_print_br_state(const unsigned state, const DebugLevel level) const {
-    const char* func_name = __func__;
     if (level > m_debug) return;
-    m_print_prefix(func_name, level);
-    m_info("State: ", func_name);
-    if(state == 0) Serial.println("    Invalid");
-    else if (state & BR_SSL_CLOSED) Serial.println("   Connection closed");
-    else {
-        if (state & BR_SSL_SENDREC) Serial.println("   SENDREC");
-        if (state & BR_SSL_RECVREC) Serial.println("   RECVREC");
-        if (state & BR_SSL_SENDAPP) Serial.println("   SENDAPP");
-        if (state & BR_SSL_RECVAPP) Serial.println("   RECVAPP");
-    }
-}
\ No newline at end of file
+    SSLLogEvent event = m_make_event(__func__, level, SSLLogEvent::SSL_LOG_BR_STATE);
+    event.arg = static_cast<int32_t>(state);
+    m_log(event);
+}
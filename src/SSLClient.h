@@ -19,9 +19,18 @@
  */
 
 #include "Client.h"
+#include "SSLClientConfig.h"
 #include "SSLSession.h"
+#include "SSLSessionCache.h"
 #include "SSLClientParameters.h"
+#include "SSLTransport.h"
+#include "SSLSource.h"
+#include "SSLLog.h"
+#ifdef SSLCLIENT_NO_HEAP
+#include "SSLFixedVector.h"
+#else
 #include <vector>
+#endif
 
 #ifndef SSLClient_H_
 #define SSLClient_H_
@@ -76,6 +85,58 @@ public:
         SSL_DUMP = 4,
     };
 
+    /**
+     * @brief What happened to written data across automatic reconnects.
+     * 
+     * See SSLClient::setAutoReconnect. The counters add up until
+     * SSLClient::resetReconnectStats is called.
+     */
+    struct ReconnectStats {
+        /** @brief Number of times a dropped connection was reopened */
+        unsigned long reconnects;
+        /** @brief Number of attempts to reopen a dropped connection that failed */
+        unsigned long failures;
+        /** 
+         * @brief Bytes that were completely written to the network client. These left the
+         * device, but may not have reached the server if the connection dropped right after.
+         */
+        size_t sent;
+        /** @brief Bytes that were sent again on a reopened connection */
+        size_t replayed;
+        /** @brief Bytes that were written with SSLClient::write but never sent */
+        size_t dropped;
+    };
+
+    /**
+     * @brief A host whose handshakes have been failing (see SSLClient::setHandshakeBackoff).
+     */
+    struct HandshakeFailure {
+        /** @brief BearSSL error code of the last failed handshake, or 0 if it timed out or the socket closed */
+        int br_error;
+        /** @brief Number of handshakes with the host that have failed in a row */
+        unsigned int failures;
+        /** @brief Milliseconds until SSLClient::connect will try the host again, or 0 if it will now */
+        unsigned long retry_in;
+    };
+
+    /**
+     * @brief Speed of the cryptography on this device, measured by SSLClient::calibrate.
+     * 
+     * Times are in microseconds, and zero if the algorithm is not configured.
+     */
+    struct Calibration {
+        /** @brief Time to encrypt and authenticate SSL_CALIBRATE_BYTES bytes with AES-128-GCM */
+        unsigned long gcm_us;
+        /** @brief Time to encrypt and authenticate SSL_CALIBRATE_BYTES bytes with ChaCha20-Poly1305 */
+        unsigned long chapol_us;
+        /** @brief Curve IDs (see bearssl_ec.h) from fastest to slowest */
+        unsigned char curves[8];
+        /** @brief Time of one key exchange multiplication on each curve, in the order of curves */
+        unsigned long curve_us[8];
+        /** @brief Number of entries in curves */
+        size_t curves_num;
+    };
+
     /**
      * @brief Initialize SSLClient with all of the prerequisites needed.
      * 
@@ -91,6 +152,7 @@ public:
      * @param trust_anchors_num The number of objects in the trust_anchors array.
      * @param analog_pin An analog pin to pull random bytes from, used in seeding the RNG.
      * @param max_sessions The maximum number of SSL sessions to store connection information from.
+     * If SSLCLIENT_NO_HEAP is defined, this is limited to SSLCLIENT_MAX_SESSIONS.
      * @param debug The level of debug logging (use the ::DebugLevel enum).
      */
     explicit SSLClient( Client& client, 
@@ -183,6 +245,214 @@ public:
      */
 	int connect(const char *host, uint16_t port) override;
 
+    /**
+     * @brief Connect to a server ahead of time, so a later connect to it returns immediately.
+     * 
+     * This function opens a connection to host the same way SSLClient::connect does and
+     * then parks it. The next call to SSLClient::connect with the same host and port takes
+     * over the parked connection instead of opening a new one, which moves the cost of the
+     * handshake out of the code that is waiting for the connection. If handshake is false
+     * only the socket is opened (including any DNS lookup), and the SSL handshake is left
+     * for SSLClient::connect.
+     * 
+     * A parked connection is not used if it is older than max_age, if the server has closed
+     * it, or if the server has sent data on it. In that case SSLClient::connect closes it
+     * and connects normally. Writing to the connection or calling SSLClient::stop also
+     * discards it. Any connection that is already open is closed by this function.
+     * 
+     * @param host The hostname as a null-terminated c-string ("www.google.com")
+     * @param port The port to connect to on the host (443 for HTTPS)
+     * @param handshake true to also perform the SSL handshake, false to only open the socket
+     * @param max_age How long the parked connection may be used for, in milliseconds. Many
+     * servers close idle connections after a minute or less, so keep this short.
+     * @returns 1 if the connection was opened and parked, 0 if failure
+     */
+    int prepare(const char *host, uint16_t port, bool handshake = true, unsigned long max_age = 20000);
+
+    /**
+     * @brief Check if there is a parked connection from SSLClient::prepare that can still be used.
+     * 
+     * This also processes anything the server has sent on the connection, and closes the
+     * connection if it has expired or the server closed it. Calling it regularly keeps a
+     * parked connection from going stale unnoticed.
+     * 
+     * @returns true if SSLClient::connect would take over a parked connection.
+     */
+    bool isPrepared();
+
+    /**
+     * @brief Reopen the connection automatically if the socket drops.
+     * 
+     * Normally, if the network client loses the connection, SSLClient closes it and any data
+     * that was written but not yet sent is lost. With this option enabled SSLClient instead
+     * connects to the same server again the next time SSLClient::write, SSLClient::flush or
+     * SSLClient::connected is called, resuming the cached session if there is one so that
+     * only a short handshake is needed. Data that was written but not yet completely sent
+     * to the network client is then sent again on the new connection, as long as there was
+     * no more than max_replay bytes of it. SSLClient copies outgoing data into a buffer of
+     * this size until it has been sent, so choose a bound that covers your largest
+     * message. If there was more, nothing is replayed, the data is counted as dropped, and
+     * the function that reconnected reports a failure (the new connection stays open).
+     * 
+     * Only the outgoing data is recovered: anything the server sent on the old connection
+     * that had not been read is gone, and data that did reach the network client may or may
+     * not have reached the server. Use SSLClient::getReconnectStats to see what happened to
+     * written data, and make sure the protocol on top can tolerate a request being sent twice
+     * or not at all. Each call reconnects at most once, and a connection closed by the server
+     * with close_notify or by SSLClient::stop is never reopened.
+     * 
+     * @param enable true to reconnect automatically.
+     * @param max_replay The most unsent data to keep for replay, in bytes. If
+     * SSLCLIENT_NO_HEAP is defined, this is limited to SSLCLIENT_MAX_REPLAY_LEN.
+     */
+    void setAutoReconnect(bool enable, size_t max_replay = 512);
+
+    /** @brief Get the counters for automatic reconnects (see SSLClient::setAutoReconnect). */
+    const ReconnectStats& getReconnectStats() const { return m_reconnect_stats; }
+
+    /** @brief Set all of the automatic reconnect counters to zero. */
+    void resetReconnectStats() { m_reconnect_stats = ReconnectStats(); }
+
+    /**
+     * @brief Save an idle connection in a small structure, leaving the socket open.
+     * 
+     * An established connection needs the BearSSL contexts and I/O buffer in SSLClient,
+     * which are several kilobytes. This function sends any buffered data, then copies
+     * only what is needed to continue the connection later (the session parameters, the
+     * values the traffic keys are derived from, and the record sequence numbers) into
+     * state, which is a few hundred bytes. Afterwards this SSLClient acts as if it were
+     * disconnected, but the network client is not stopped.
+     * 
+     * Since SSLClient does not own the network client, the SSLClient object can then be
+     * destroyed or reused for a connection on another network client, and the connection
+     * continued later with SSLClient::wake on any SSLClient created with the same network
+     * client and configuration. For example, with many long lived connections a program
+     * can keep one network client and one br_ssl_hibernation per connection, and only
+     * create an SSLClient while a connection is in use. The keys of the connection are
+     * erased from this SSLClient, so state is the only copy.
+     * 
+     * The connection must be idle: all data from the server has been read. Note that
+     * the server may still close the connection while it hibernates, for example if a
+     * protocol keepalive is missed. Calling SSLClient::stop on this SSLClient after
+     * hibernating closes the socket.
+     * 
+     * @param state Where to save the connection. This contains the master secret of the
+     * connection, so keep it private.
+     * @returns true if the connection was saved, false if it was not idle or not connected.
+     */
+    bool hibernate(br_ssl_hibernation& state);
+
+    /**
+     * @brief Continue a connection saved with SSLClient::hibernate, without a handshake.
+     * 
+     * The network client must still be connected to the server, and nothing else may have
+     * been sent or received on it since the connection was saved. The certificate of the
+     * server is not verified again. A state can only be woken once, so once waking is
+     * attempted on a connected network client state is erased, even if waking fails.
+     * Hibernate again to save the new state.
+     * 
+     * @param state The saved connection. This is erased.
+     * @param host The hostname of the server, used if the connection has to be reopened
+     * (see SSLClient::setAutoReconnect), or nullptr.
+     * @returns 1 if the connection is ready for use, 0 if failure
+     */
+    int wake(br_ssl_hibernation& state, const char* host = nullptr);
+
+    /**
+     * @brief Compute the encryption keystream for short writes ahead of time.
+     * 
+     * With AES-GCM and ChaCha20-Poly1305 cipher suites, the keystream that encrypts the
+     * next record only depends on the traffic key and the record's sequence number. With
+     * this option set, SSLClient computes the keystream for up to the given number of bytes
+     * of the next record whenever SSLClient::available finds nothing to read, or when
+     * SSLClient::precompute is called. A write of up to that many bytes is then encrypted
+     * with an XOR, and only the authentication tag is left to compute when it is sent.
+     * On slow microcontrollers this shortens the time between writing a short command
+     * and it reaching the network. Longer writes still work, the rest of the record is
+     * encrypted normally.
+     * 
+     * The keystream buffer takes about bytes + 64 bytes of memory. Other cipher suites
+     * are not affected.
+     * 
+     * @param bytes How much of the next record to prepare, or 0 to turn this off. If
+     * SSLCLIENT_NO_HEAP is defined, this is limited to SSLCLIENT_MAX_PRECOMPUTE_LEN.
+     */
+    void setPrecompute(size_t bytes);
+
+    /**
+     * @brief Compute the keystream for the next record now (see SSLClient::setPrecompute).
+     * 
+     * Call this when the program is about to be idle for a while, for example before
+     * waiting on a sensor. It does nothing if the keystream is already ready.
+     * 
+     * @returns How many bytes of the next write are covered, or 0 if precomputation is
+     * off, the connection is not established, or the cipher suite does not support it.
+     */
+    size_t precompute();
+
+    /**
+     * @brief Measure the cryptography on this device, and advertise the fastest options first.
+     * 
+     * The cipher suites and curves SSLClient offers in the handshake are in a fixed
+     * order, which suits some devices better than others (for example, ChaCha20 is much
+     * faster than AES on a microcontroller without AES hardware, and the opposite is
+     * true on a PC). This function times the record encryption of the configured AES-GCM
+     * and ChaCha20-Poly1305 implementations, and optionally a key exchange on each
+     * supported curve, then reorders the cipher suites and curves from fastest to
+     * slowest. Cipher suites with forward secrecy are still offered before those
+     * without. Servers that follow the client's preferences will then pick what runs
+     * best here; many servers use their own order and are not affected.
+     * 
+     * Call this once at startup, before connecting. Timing the curves takes about as
+     * long as a few key exchanges (several seconds on slow microcontrollers), so it
+     * can be skipped.
+     * 
+     * @param curves true to time and reorder the curves as well as the cipher suites.
+     * @returns The measurements. These are not kept by SSLClient.
+     */
+    Calibration calibrate(bool curves = true);
+
+    /**
+     * @brief Stop retrying handshakes with a host that keeps failing them, for a while.
+     * 
+     * A handshake that fails because of the server (an untrusted or expired certificate
+     * chain, a clock that is off, no cipher suite in common) usually fails the same way
+     * when retried, but each attempt still costs a full key exchange and certificate
+     * verification, which is seconds of CPU time on a microcontroller. With a backoff
+     * set, SSLClient remembers the hosts whose last handshake failed, and
+     * SSLClient::connect returns 0 for such a host right away (without opening a
+     * socket) until its backoff has passed. The backoff starts at base and doubles with
+     * each failure in a row, up to max. A successful handshake forgets the host.
+     * 
+     * Only handshakes that BearSSL rejects count: if the socket cannot be opened, the
+     * network client fails during the handshake, or the handshake times out, nothing
+     * is remembered, since those are usually problems with the network. Up to SSLCLIENT_MAX_FAILED_HOSTS hosts are remembered at once, by a
+     * hash of the hostname. Connections to an IP address are never held back.
+     * 
+     * @param base The backoff after the first failure, in milliseconds, or 0 to turn this
+     * off and forget all failures (the default).
+     * @param max The longest backoff, in milliseconds.
+     */
+    void setHandshakeBackoff(unsigned long base, unsigned long max = 600000);
+
+    /**
+     * @brief Check whether handshakes with a host have been failing.
+     * @param host The hostname passed to SSLClient::connect.
+     * @param failure Receives the last error, the number of failures and the time left.
+     * @returns true if the last handshake with the host failed, false if there is nothing
+     * remembered about it.
+     */
+    bool getHandshakeFailure(const char* host, HandshakeFailure& failure) const;
+
+    /**
+     * @brief Forget that handshakes with a host failed, so the next connect tries it.
+     * @param host The hostname, or nullptr to forget all hosts.
+     */
+    void clearHandshakeFailure(const char* host = nullptr);
+
+    /** @brief Bytes encrypted by each cipher in SSLClient::calibrate */
+    static constexpr size_t SSL_CALIBRATE_BYTES = 1024;
+
     /**
      * @brief Write some bytes to the SSL connection
      * 
@@ -210,6 +480,80 @@ public:
     /** @see SSLClient::write(uint8_t*, size_t) */
     size_t write(uint8_t b) override { return write(&b, 1); }
 
+    /**
+     * @brief Write several buffers to the SSL connection, as if they were one.
+     * 
+     * This behaves like calling SSLClient::write(const uint8_t*, size_t) for each buffer in
+     * turn, but the connection is only checked once, and the buffers are copied straight into
+     * the BearSSL IO buffer back to back. Records are only sent when they are full, so a
+     * message made of several parts (ex. an MQTT header, topic and payload) does not need to
+     * be copied into a temporary buffer first, and does not produce a small record for each
+     * part. As with the other write functions, call SSLClient::flush or SSLClient::available
+     * to send the last record.
+     * 
+     * @param iov The buffers to write, in order. Buffers with a length of zero are skipped.
+     * @param count The number of buffers in iov
+     * @returns The total number of bytes copied, or zero if the BearSSL engine
+     * fails to become ready for writing data.
+     */
+    size_t write(const SSLIoVec* iov, size_t count);
+
+    /**
+     * @brief Returns the number of bytes SSLClient::write can take without sending a record.
+     * 
+     * SSLClient uses the same buffer for sending and receiving, so a write that has to
+     * send a record must first wait until the buffer is free, and if data from the server
+     * arrives meanwhile it is discarded ("Discarded unread data to favor a write operation").
+     * Protocols where the server may send at any time can write at most this many bytes
+     * at once, and let SSLClient::available or SSLClient::flush send them. Returns zero
+     * while received data is waiting to be read.
+     */
+    int availableForWrite();
+
+    /**
+     * @brief Get the free part of the send buffer, to build data in place.
+     * 
+     * This is the zero copy counterpart of SSLClient::write: fill in at most len bytes at
+     * the returned address, then add them to the data to send with SSLClient::commit.
+     * The space is the rest of the current record. Committing all of it sends the record,
+     * and like a write that fills one, waits until the buffer is free again (see
+     * SSLClient::availableForWrite).
+     * 
+     * @param len Receives the number of bytes that can be written at the returned address.
+     * @returns The free space, or nullptr (and len set to zero) if the engine is not ready
+     * for data.
+     */
+    uint8_t* writeBuffer(size_t& len);
+
+    /**
+     * @brief Add bytes filled in at SSLClient::writeBuffer to the data to send.
+     * @param len The number of bytes, at most the length writeBuffer returned.
+     * @returns The number of bytes added, or zero if sending a full record failed.
+     */
+    size_t commit(size_t len);
+
+    /**
+     * @brief Write everything a source has to the SSL connection, letting it fill the send
+     * buffer directly.
+     * 
+     * Instead of reading a file into a buffer and writing that buffer (which SSLClient
+     * copies into its own), the source (see SSLSource) is asked to fill each record in
+     * place, which saves both the buffer and a copy of every byte. Records are sent as
+     * they fill up, and the last one is sent once the source runs out, so a whole upload
+     * is a single call:
+     * ```C++
+     * File log = SD.open("log.txt");
+     * SSLFileSource<File> source(log);
+     * client.writeFrom(source);
+     * ```
+     * 
+     * @param source The data to send.
+     * @param limit The most bytes to take from the source (for example a Content-Length).
+     * @returns The number of bytes written. If this is less than the length of the data,
+     * the source failed, or the connection did (see Print::getWriteError).
+     */
+    size_t writeFrom(SSLSource& source, size_t limit = static_cast<size_t>(-1));
+
     /**
      * @brief Returns the number of bytes available to read from the data that has been received and decrypted.
      * 
@@ -268,6 +612,26 @@ public:
      */
     int peek() override;
 
+    /**
+     * @brief Get the received data in place, without copying it.
+     * 
+     * Like SSLClient::available, this first lets the engine process anything that has
+     * arrived. The returned bytes are the decrypted contents of the current record,
+     * straight from the I/O buffer, and are returned again until they are removed with
+     * SSLClient::consume. They stay valid until the next call to this SSLClient other than
+     * SSLClient::consume, so a message larger than a record has to be parsed incrementally.
+     * 
+     * @param len Receives the number of bytes available at the returned address.
+     * @returns The received data, or nullptr (and len set to zero) if there is none.
+     */
+    const uint8_t* peekBuffer(size_t& len);
+
+    /**
+     * @brief Remove bytes returned by SSLClient::peekBuffer from the receive buffer.
+     * @param len The number of bytes to remove, at most the length peekBuffer returned.
+     */
+    void consume(size_t len);
+
     /**
      * @brief Force writing the buffered bytes from SSLClient::write to the network.
      * 
@@ -280,13 +644,27 @@ public:
     /**
      * @brief Close the connection
      *
-     * If the SSL session is still active, all incoming data is discarded and BearSSL will attempt to
-     * close the session gracefully (will write to the network), and then call m_client::stop. If the session is not active or an
+     * If the SSL session is still active, all incoming data is discarded, any data buffered by
+     * SSLClient::write is sent, and a close_notify alert is sent to the server. SSLClient then
+     * waits for the server's close_notify for at most the close timeout (see
+     * SSLClient::setCloseTimeout), and then calls m_client::stop. If the session is not active or an
      * error was encountered previously, this function will simply call m_client::stop.
-     * The implementation for this function can be found in SSLClientImpl::peek.
+     * 
+     * Closing gracefully lets the server know the session ended on purpose, so it will keep the
+     * session available for resumption. Use SSLClient::closedCleanly to check if the last close
+     * completed.
      */
 	void stop() override;
 
+    /**
+     * @brief Check if the last connection was closed gracefully.
+     * 
+     * @returns true if both SSLClient and the server exchanged close_notify alerts before the
+     * socket was closed, false if the close timed out, an error occurred, or no connection has
+     * been closed yet.
+     */
+    bool closedCleanly() const { return m_close_clean; }
+
     /**
      * @brief Check if the device is connected.
      *
@@ -316,6 +694,39 @@ public:
      */
     void setMutualAuthParams(const SSLClientParameters& params);
 
+    /**
+     * @brief Offer application protocols to the server with ALPN.
+     * 
+     * The server picks one of the protocols during the handshake (see
+     * SSLClient::getAlpnProtocol), for example "h2" for HTTP/2. Servers that do not support
+     * ALPN, or none of the protocols, still complete the handshake without choosing one.
+     * 
+     * @param protocols An array of protocol names, most preferred first. The array and the
+     * strings are not copied, and must stay valid until the protocols are changed.
+     * @param count The number of names in the array, or 0 to stop using ALPN.
+     * 
+     * @pre SSLClient has not already started an SSL connection.
+     */
+    void setAlpnProtocols(const char* const* protocols, size_t count);
+
+    /**
+     * @brief Get the protocol the server selected with ALPN.
+     * @returns One of the names given to SSLClient::setAlpnProtocols, or nullptr if the
+     * server did not select one (or SSLClient is not connected).
+     */
+    const char* getAlpnProtocol();
+
+    /**
+     * @brief Fill a buffer with random bytes from the engine's DRBG.
+     * 
+     * The generator is the one BearSSL seeds (from the analog pin given to the
+     * constructor) for the handshake, so this is only available while connected. Useful
+     * for protocol nonces, such as WebSocket masking keys.
+     * 
+     * @returns false if SSLClient is not connected.
+     */
+    bool getRandom(void* buf, size_t len);
+
     /**
      * @brief Gets a session reference corresponding to a host and IP, or a reference to a empty session if none exist
      * 
@@ -328,7 +739,9 @@ public:
      * 
      * @param host A hostname c string, or NULL if one is not available
      * @param addr An IP address
-     * @returns A pointer to the SSLSession, or NULL of none matched the criteria available
+     * @returns A pointer to the SSLSession, or NULL of none matched the criteria available.
+     * Always NULL while a shared cache is set with SSLClient::setSessionCache, since those
+     * sessions can only be copied out (see SSLSessionCache::get).
      */
     SSLSession* getSession(const char* host);
 
@@ -347,7 +760,23 @@ public:
      *
      *  @returns The SessionCache template parameter.
      */
-    size_t getSessionCount() const { return m_sessions.size(); }
+    size_t getSessionCount() const { return m_session_cache != nullptr ? m_session_cache->size() : m_sessions.size(); }
+
+    /**
+     * @brief Store and resume sessions in a cache shared with other SSLClient objects.
+     *
+     * With a shared cache, a session negotiated by any SSLClient using the cache can be
+     * resumed by all of them, instead of each client learning sessions separately. While
+     * it is set, the sessions stored in this object are not used, and removeSession and
+     * getSessionCount act on the shared cache. The cache must outlive this object, or be
+     * unset (with nullptr) first.
+     *
+     * @param cache The cache to use, or nullptr to go back to this object's own sessions.
+     */
+    void setSessionCache(SSLSessionCache* cache) { m_session_cache = cache; }
+
+    /** @brief Returns the shared session cache set with setSessionCache, or nullptr. */
+    SSLSessionCache* getSessionCache() const { return m_session_cache; }
 
     /** 
      * @brief Equivalent to SSLClient::connected() > 0
@@ -361,15 +790,116 @@ public:
 
     /** 
      * @brief Set the timeout when waiting for an SSL response.
+     * 
+     * This sets the connect, handshake, read and write timeouts to the same value. To
+     * set them separately use SSLClient::setConnectTimeout, SSLClient::setHandshakeTimeout,
+     * SSLClient::setReadTimeout and SSLClient::setWriteTimeout.
+     * 
      * @param t The timeout value, in milliseconds (defaults to 30 seconds if not set). Do not set to zero.
      */
-	void setTimeout(unsigned int t) { m_timeout = t; }
+	void setTimeout(unsigned int t) { m_timeout_connect = m_timeout_handshake = m_timeout_read = m_timeout_write = t; }
 
     /** 
      * @brief Get the timeout when waiting for an SSL response.
-     * @returns The timeout value in milliseconds.
+     * @returns The handshake timeout value in milliseconds.
+     */
+    unsigned int getTimeout() const { return m_timeout_handshake; }
+
+    /**
+     * @brief Set the timeout for opening the socket with the underlying client.
+     * 
+     * The Client interface does not have a way to limit how long connect() takes, so this
+     * timeout is only applied when using SSLClientFor with a client type that has a
+     * setConnectionTimeout function (such as EthernetClient).
+     * 
+     * @param t The timeout value, in milliseconds.
+     */
+    void setConnectTimeout(unsigned int t) { m_timeout_connect = t; }
+
+    /**
+     * @brief Set the maximum time the SSL handshake in SSLClient::connect may take.
+     * @param t The timeout value, in milliseconds. Do not set to zero.
+     */
+    void setHandshakeTimeout(unsigned int t) { m_timeout_handshake = t; }
+
+    /**
+     * @brief Set how long SSLClient waits for data from the server.
+     * 
+     * This limits how long SSLClient::flush waits for a response, and how long
+     * SSLClient::available and SSLClient::read keep returning nothing after data was
+     * sent before they give up and close the connection. This timeout is reset every
+     * time data is received, so a slow transfer that is still making progress will not
+     * time out. A connection with nothing sent that is still waiting for a response
+     * never times out.
+     * 
+     * @param t The timeout value, in milliseconds. Do not set to zero.
+     */
+    void setReadTimeout(unsigned int t) { m_timeout_read = t; }
+
+    /**
+     * @brief Set how long SSLClient::write waits for buffered data to be sent.
+     * 
+     * This timeout is reset every time data is sent, so a slow transfer that is still
+     * making progress will not time out.
+     * 
+     * @param t The timeout value, in milliseconds. Do not set to zero.
+     */
+    void setWriteTimeout(unsigned int t) { m_timeout_write = t; }
+
+    /**
+     * @brief Set how long SSLClient::stop waits for the server's close_notify.
+     * 
+     * If the server does not respond in time the socket is closed anyway, and
+     * SSLClient::closedCleanly will return false. Setting this to zero skips sending
+     * close_notify entirely, which is faster but may cause some servers to discard the
+     * session. setTimeout does not change this value.
+     * 
+     * @param t The timeout value, in milliseconds (defaults to 1 second).
+     */
+    void setCloseTimeout(unsigned int t) { m_timeout_close = t; }
+
+    /**
+     * @brief Set how long the network client's status is cached.
+     * 
+     * SSLClient checks whether the network client is connected and how many bytes it has
+     * available many times while processing a single call (for example, SSLClient::read
+     * calls SSLClient::available, which calls SSLClient::connected). With some drivers
+     * (ex. Ethernet) each of these checks is an SPI transaction, so SSLClient reuses the
+     * answers for this long instead of asking again. The cache is updated when SSLClient
+     * reads from the network client, and cleared when it writes to it.
+     * 
+     * @param t The time to cache the status for, in milliseconds (defaults to 2). Set to
+     * zero to always query the network client.
+     */
+    void setStatusCacheTime(unsigned int t) { m_status_cache_ms = t; m_invalidate_status(); }
+
+    /**
+     * @brief Derive the timeouts from round trip times measured during handshakes.
+     * 
+     * When enabled, SSLClient measures the time between sending the ClientHello and
+     * receiving the first bytes of the server's response in each handshake, and keeps a
+     * smoothed round trip time (RTT) and its variation, similar to a TCP retransmission
+     * timer. The connect, read, write and close timeouts then become SSL_RTT_TIMEOUT_FACTOR times
+     * (RTT + 4 * variation), and the handshake timeout becomes SSL_RTT_HANDSHAKE_FACTOR times
+     * the longest handshake seen so far. The values set with the other timeout functions
+     * act as upper limits, and no timeout is made shorter than min_timeout. Until the
+     * first handshake completes, the configured timeouts are used as-is.
+     * 
+     * @param enable true to adapt the timeouts, false to use the configured values.
+     * @param min_timeout The shortest any adaptive timeout can be, in milliseconds.
      */
-    unsigned int getTimeout() const { return m_timeout; }
+    void setAdaptiveTimeouts(bool enable, unsigned int min_timeout = 1000) { m_adaptive_timeouts = enable; m_adaptive_min = min_timeout; }
+
+    /**
+     * @brief Get the smoothed round trip time measured during handshakes.
+     * @returns The round trip time in milliseconds, or zero if no handshake has completed.
+     */
+    unsigned int getRTT() const { return m_srtt; }
+
+    /** @brief With adaptive timeouts, multiple of the retransmission timeout used for connect, read, write and close. */
+    static constexpr unsigned int SSL_RTT_TIMEOUT_FACTOR = 4;
+    /** @brief With adaptive timeouts, multiple of the longest handshake used for the handshake timeout. */
+    static constexpr unsigned int SSL_RTT_HANDSHAKE_FACTOR = 2;
 
     /**
      * @brief Change the time used during x509 verification to a different value.
@@ -384,6 +914,86 @@ public:
      */
     void setVerificationTime(uint32_t days, uint32_t seconds);
 
+    /**
+     * @brief Enable or disable dynamic record sizing for outgoing data.
+     *
+     * When enabled (the default), SSLClient::write sends records small enough to fit in a
+     * single TCP segment right after connecting and after the connection has been idle for
+     * SSLClient::DRS_IDLE_MS milliseconds, so the server can decrypt the first bytes without
+     * waiting on a full-sized record. Once SSLClient::DRS_BOOST_BYTES have been written, records
+     * grow to fill the entire write buffer for throughput. This has no effect if the write
+     * buffer is already smaller than SSLClient::DRS_SMALL_RECORD.
+     *
+     * @param enable true to use small records at the start of a transfer, false to always fill
+     * the write buffer.
+     */
+    void setDynamicRecordSizing(bool enable) { m_drs_enabled = enable; }
+
+    /**
+     * @brief Send log output to a sink instead of printing it to Serial.
+     * 
+     * By default every log message is printed to Serial as soon as it happens, which
+     * can take several milliseconds per message and changes the timing of the connection.
+     * With a sink such as SSLLogRing, log events are only recorded, and can be formatted
+     * and printed later. Messages are still filtered by the DebugLevel given to the
+     * constructor. For example:
+     * ```C++
+     * SSLLogRing<64> logs;
+     * client.setLogSink(&logs);
+     * // ...
+     * logs.drain(Serial);
+     * ```
+     * 
+     * @param sink The sink to record log events into, or nullptr to print to Serial. The
+     * sink must stay valid for as long as it is set.
+     */
+    void setLogSink(SSLLogSink* sink) { m_log_sink = sink; }
+
+    /** @brief Plaintext size of a record that fits in a single TCP segment (1460 byte MSS minus TLS overhead). */
+    static constexpr size_t DRS_SMALL_RECORD = 1400;
+    /** @brief Number of bytes written before dynamic record sizing switches to full-sized records. */
+    static constexpr size_t DRS_BOOST_BYTES = 16384;
+    /** @brief Time in milliseconds without writes after which dynamic record sizing returns to small records. */
+    static constexpr unsigned long DRS_IDLE_MS = 1000;
+
+protected:
+    /** 
+     * @brief Run the engine with the network client, returning the new engine state.
+     * 
+     * Overridden by SSLClientFor to use the concrete client type.
+     */
+    virtual unsigned m_update_engine();
+
+    /** 
+     * @brief Limit how long the next connect on the network client may take, if possible.
+     * 
+     * Overridden by SSLClientFor, since the Client interface has no way to do this.
+     */
+    virtual void m_set_connect_timeout(unsigned long /* timeout */) {}
+
+    /** @brief Implementation of SSLClient::m_update_engine for a given network client type */
+    template<class TransportT>
+    unsigned m_update_engine_impl(TransportT& client);
+
+    /** @brief Implementation of SSLClient::connected for a given network client type, without reconnecting */
+    template<class TransportT>
+    uint8_t m_connected_impl(TransportT& client);
+
+    /** @brief Implementation of SSLClient::connected, which also reopens a dropped connection (see SSLClient::setAutoReconnect) */
+    template<class TransportT>
+    uint8_t m_connected_or_reconnect(TransportT& client);
+
+    /** @brief Returns the network client's connected status, from the status cache if it is recent enough */
+    template<class TransportT>
+    uint8_t m_transport_connected(TransportT& client);
+
+    /** @brief Returns the number of bytes available from the network client, from the status cache if it is recent enough */
+    template<class TransportT>
+    int m_transport_available(TransportT& client);
+
+    /** @brief Clears the status cache, so the next status check queries the network client */
+    void m_invalidate_status() { m_status_connected = -1; m_status_available = -1; }
+
 private:
     /** @brief Returns an instance of m_client that is polymorphic and can be used by SSLClientImpl */
     Client& get_arduino_client() { return m_client; }
@@ -391,17 +1001,64 @@ private:
 
     /** Returns whether or not the engine is connected, without polling the client over SPI or other (as opposed to connected()) */
     bool m_soft_connected(const char* func_name);
+    /** open the socket to the server with the network client */
+    int m_connect_socket(const char* host, uint16_t port, const char* func_name);
+    /** if a parked connection for host and port is usable, take it over. Returns 1 if it did. */
+    int m_take_prepared(const char* host, uint16_t port);
+    /** close a connection the network client lost, keeping unsent data if it may be reopened */
+    void m_drop();
+    /** reopen a dropped connection and replay unsent data. Returns 1 if successful, -1 if reconnected without the data, 0 if failed */
+    int m_reconnect(const char* func_name);
+    /** wait until the engine can take data to send, reconnecting at most once if reconnected is false */
+    bool m_wait_sendapp(const char* func_name, bool& reconnected);
+    /** hand the full record at br_buf (m_write_idx bytes) to the engine and wait until it is sent */
+    bool m_send_record(const unsigned char* br_buf, bool flush, const char* func_name, bool& reconnected);
+    /** keep a copy of plaintext handed to the engine until it is sent */
+    void m_replay_append(const unsigned char* buf, const size_t len);
+    /** returns true if a response has been awaited for longer than the read timeout */
+    bool m_read_idle_expired();
+    /** mark everything kept for replay as sent */
+    void m_replay_commit();
+    /** throw away everything kept for replay, counting it as dropped */
+    void m_replay_discard();
+    /** returns true, and sets the write error, if host is still backing off after failed handshakes */
+    bool m_backing_off(const char* host, const char* func_name);
+    /** remember a failed handshake with host, or forget the host if the handshake succeeded */
+    void m_record_handshake(const char* host, bool success);
+    /** find the index in m_failures for a hostname, or -1 */
+    int m_get_failure_index(const char* host) const;
+    /** seed the random number generator from the analog pin */
+    void m_inject_entropy();
     /** start the ssl engine on the connected client */
     int m_start_ssl(const char* host = nullptr, SSLSession* ssl_ses = nullptr);
-    /** run the bearssl engine until a certain state */
-    int m_run_until(const unsigned target);
-    /** proxy for available that returns the state */
-    unsigned m_update_engine();
+    /** 
+     * run the bearssl engine until a certain state, or until timeout milliseconds have passed.
+     * if idle is true, the timeout restarts every time data is sent or received.
+     */
+    int m_run_until(const unsigned target, const unsigned long timeout, const bool idle = false);
+    /** returns the timeout to use for a phase, applying adaptive timeouts if enabled */
+    unsigned long m_phase_timeout(const unsigned int configured, const unsigned long adaptive) const;
+    unsigned long m_connect_timeout() const;
+    unsigned long m_handshake_timeout() const;
+    unsigned long m_read_timeout() const;
+    unsigned long m_write_timeout() const;
+    unsigned long m_close_timeout() const;
+    /** clears the status cache if it is older than the status cache time */
+    void m_expire_status();
+    /** update the status cache after reading len bytes from the network client */
+    void m_consume_available(const int len);
+    /** update the smoothed round trip time with a new sample */
+    void m_update_rtt(const unsigned long sample);
+    /** returns how much of the sendapp buffer (of size alen) the current record should use */
+    size_t m_record_window(const size_t alen) const;
     /** utility function to find a session index based off of a host and IP */
     int m_get_session_index(const char* host) const; 
 
-    /** @brief Prints a debugging prefix to all logs, so we can attatch them to useful information */
-    void m_print_prefix(const char* func_name, const DebugLevel level) const;
+    /** @brief Creates a log event with the common fields filled in */
+    SSLLogEvent m_make_event(const char* func_name, const DebugLevel level, const uint8_t type) const;
+
+    /** @brief Sends a log event to the log sink, or prints it to Serial if there is none */
+    void m_log(const SSLLogEvent& event) const;
 
     /** @brief Prints the string associated with a write error */
     void m_print_ssl_error(const int ssl_error, const DebugLevel level) const;
@@ -412,15 +1069,19 @@ private:
     /** @brief Print the text string associated with the BearSSL state */
     void m_print_br_state(const unsigned br_state, const DebugLevel level) const;
 
+    /** @brief Store a log message in an event. Messages must be string literals, since the event may be printed later. */
+    static void m_set_event_value(SSLLogEvent& event, const char* str) { event.str = str; event.type = SSLLogEvent::SSL_LOG_MESSAGE; }
+    /** @brief Store a number in an event */
+    static void m_set_event_value(SSLLogEvent& event, const long num) { event.arg = static_cast<int32_t>(num); event.type = SSLLogEvent::SSL_LOG_NUMBER; }
+
     /** @brief debugging print function, only prints if m_debug is true */
     template<typename T>
     void m_print(const T str, const char* func_name, const DebugLevel level) const { 
-        // check the current debug level and serial status
-        if (level > m_debug || !Serial) return;
-        // print prefix
-        m_print_prefix(func_name, level);
-        // print the message
-        Serial.println(str);
+        // check the current debug level
+        if (level > m_debug) return;
+        SSLLogEvent event = m_make_event(func_name, level, SSLLogEvent::SSL_LOG_MESSAGE);
+        m_set_event_value(event, str);
+        m_log(event);
     }
 
     /** @brief Prints a info message to serial, if info messages are enabled */
@@ -439,17 +1100,104 @@ private:
     // create a reference the client
     Client& m_client;
     // also store an array of SSLSessions, so we can resume communication with multiple websites
+#ifdef SSLCLIENT_NO_HEAP
+    SSLFixedVector<SSLSession, SSLCLIENT_MAX_SESSIONS> m_sessions;
+#else
     std::vector<SSLSession> m_sessions;
+#endif
     // as well as the maximmum number of sessions we can store
     const size_t m_max_sessions;
+    // sessions shared with other SSLClients, used instead of m_sessions if set
+    SSLSessionCache* m_session_cache;
     // store the pin to fetch an RNG see from
     const int m_analog_pin;
     // store whether to enable debug logging
     const DebugLevel m_debug;
+    // where to send log events, or nullptr to print them to Serial
+    SSLLogSink* m_log_sink;
     // store if we are connected in bearssl or not
     bool m_is_connected;
-    // store the timeout for SSL internals
-    unsigned int m_timeout;
+    // store the timeouts for each phase of the connection
+    unsigned int m_timeout_connect;
+    unsigned int m_timeout_handshake;
+    unsigned int m_timeout_read;
+    unsigned int m_timeout_write;
+    unsigned int m_timeout_close;
+    // store if the last connection ended with close_notify from both sides
+    bool m_close_clean;
+    // connection parked by prepare: whether there is one, if the handshake is done,
+    // when it was opened, how long it may be used for, and where it goes
+    bool m_prepared;
+    bool m_prepared_tls;
+    unsigned long m_prepared_time;
+    unsigned long m_prepared_max_age;
+    uint16_t m_prepared_port;
+#ifdef SSLCLIENT_NO_HEAP
+    char m_prepared_host[SSLCLIENT_MAX_HOSTNAME_LEN + 1];
+#else
+    String m_prepared_host;
+#endif
+    // automatic reconnect: whether it is enabled, whether the connection dropped and may
+    // be reopened, and the port and IP to reopen it with (the hostname is in m_sslctx)
+    bool m_reconnect_enabled;
+    bool m_dropped;
+    uint16_t m_reconnect_port;
+    IPAddress m_reconnect_ip;
+    ReconnectStats m_reconnect_stats;
+    // plaintext handed to the engine but not yet sent: the most we keep, how much we
+    // have, and how much more there was that did not fit
+#ifdef SSLCLIENT_NO_HEAP
+    unsigned char m_replay[SSLCLIENT_MAX_REPLAY_LEN > 0 ? SSLCLIENT_MAX_REPLAY_LEN : 1];
+#else
+    std::vector<unsigned char> m_replay;
+#endif
+    size_t m_replay_max;
+    size_t m_replay_len;
+    size_t m_replay_lost;
+    // hosts whose last handshake failed: a hash of the hostname (0 if the entry is
+    // unused), the last BearSSL error, failures in a row, and when to try again
+    struct {
+        uint32_t host_hash;
+        int br_error;
+        unsigned int failures;
+        unsigned long since;
+        unsigned long backoff;
+    } m_failures[SSLCLIENT_MAX_FAILED_HOSTS];
+    // backoff after the first failure (0 if off), and the longest backoff
+    unsigned long m_backoff_base;
+    unsigned long m_backoff_max;
+    // keystream computed ahead for the next outgoing record
+#ifdef SSLCLIENT_NO_HEAP
+    unsigned char m_keystream[SSLCLIENT_MAX_PRECOMPUTE_LEN > 0 ? SSLCLIENT_KEYSTREAM_LEN(SSLCLIENT_MAX_PRECOMPUTE_LEN) : 1];
+#else
+    std::vector<unsigned char> m_keystream;
+#endif
+    // adaptive timeouts: whether they are enabled, the lowest timeout allowed,
+    // the smoothed round trip time and its variation, and the longest handshake seen
+    bool m_adaptive_timeouts;
+    unsigned int m_adaptive_min;
+    unsigned int m_srtt;
+    unsigned int m_rttvar;
+    unsigned long m_handshake_max;
+    // when the first handshake record was sent (zero if it has not been), and
+    // the round trip time measured from it
+    unsigned long m_rtt_probe_start;
+    unsigned long m_rtt_sample;
+    bool m_rtt_sampled;
+    // counts successful reads and writes on the network client, so we can
+    // tell if a transfer is making progress
+    unsigned long m_io_count;
+    // whether data was sent that has not been answered yet, and the io count
+    // and time when data last moved while waiting for the answer
+    bool m_read_waiting;
+    unsigned long m_read_idle_io;
+    unsigned long m_read_idle_start;
+    // cached network client status: how long it is valid for, when it was
+    // last refreshed, and the values (-1 if not cached)
+    unsigned int m_status_cache_ms;
+    unsigned long m_status_time;
+    int8_t m_status_connected;
+    int m_status_available;
     // store the context values required for SSL
     br_ssl_client_context m_sslctx;
     br_x509_minimal_context m_x509ctx;
@@ -464,15 +1212,284 @@ private:
      * This buffer controls how much data BearSSL can encrypt/decrypt at a given time. It can be expanded
      * or shrunk to [255, BR_SSL_BUFSIZE_BIDI], depending on the memory and speed needs of your application.
      * As a rule of thumb SSLClient will fail if it does not have at least 8000 bytes when starting a
-     * connection.
+     * connection. The size of this buffer is also advertised to the server with the Record Size Limit
+     * extension, so that servers supporting it never send records that do not fit.
      */
     unsigned char m_iobuf[2048];
     // store the index of where we are writing in the buffer
     // so we can send our records all at once to prevent
     // weird timing issues
     size_t m_write_idx;
+    // dynamic record sizing: whether it is enabled, how many bytes have been
+    // written since the connection started or went idle, and when we last wrote
+    bool m_drs_enabled;
+    size_t m_drs_bytes;
+    unsigned long m_drs_last;
     // store the last BearSSL state so we can print changes to the console
     unsigned m_br_last_state;
 };
 
+/**
+ * @brief SSLClient for a network client type known at compile time.
+ * 
+ * SSLClient reaches the network through the Client interface, so every read, write and
+ * status check on the underlying client is a virtual call. SSLClientFor stores the
+ * concrete client type instead, and calls it directly from the polling code in
+ * SSLClient::available, SSLClient::connected and the write path, which allows the
+ * compiler to inline the driver. It can be used anywhere an SSLClient can:
+ * ```C++
+ * EthernetClient baseClient;
+ * SSLClientFor<EthernetClient> client(baseClient, TAs, (size_t)2, A7);
+ * ```
+ * 
+ * @tparam TransportT The type of the network client, for example EthernetClient. It must
+ * derive from Client and must not be abstract.
+ */
+template<class TransportT>
+class SSLClientFor : public SSLClient {
+public:
+    /** @see SSLClient::SSLClient */
+    explicit SSLClientFor(  TransportT& client, 
+                            const br_x509_trust_anchor *trust_anchors, 
+                            const size_t trust_anchors_num, 
+                            const int analog_pin, 
+                            const size_t max_sessions = 1,
+                            const DebugLevel debug = SSL_WARN)
+        : SSLClient(client, trust_anchors, trust_anchors_num, analog_pin, max_sessions, debug)
+        , m_transport(client) {}
+
+    /** @see SSLClient::connected */
+    uint8_t connected() override { return m_connected_or_reconnect(m_transport); }
+
+    /** @brief Returns a reference to the client object stored in this class. Take care not to break it. */
+    TransportT& getTransport() { return m_transport; }
+
+protected:
+    unsigned m_update_engine() override { return m_update_engine_impl(m_transport); }
+
+    void m_set_connect_timeout(unsigned long timeout) override { SSLTransport<TransportT>::setConnectTimeout(m_transport, timeout); }
+
+private:
+    // the same object as SSLClient::m_client, with its concrete type
+    TransportT& m_transport;
+};
+
+//============================================
+//= Template implementations
+//============================================
+
+/* see SSLClient.h */
+template<class TransportT>
+uint8_t SSLClient::m_connected_impl(TransportT& client) {
+    using Transport = SSLTransport<TransportT>;
+    const char* func_name = "connected";
+    // check all of the error cases 
+    const auto c_con = m_transport_connected(client);
+    const auto br_con = br_ssl_engine_current_state(&m_sslctx.eng) != BR_SSL_CLOSED && m_is_connected;
+    const auto wr_ok = getWriteError() == 0;
+    // if we're in an error state, close the connection and set a write error
+    if (br_con && !c_con) {
+        // If we've got a write error, the client probably failed for some reason
+        if (Transport::getWriteError(client)) {
+            m_error("Socket was unexpectedly interrupted. m_client error: ", func_name);
+            m_error(Transport::getWriteError(client), func_name);
+            setWriteError(SSL_CLIENT_WRTIE_ERROR);
+        }
+        // Else tell the user the endpoint closed the socket on us (ouch)
+        else {
+            m_warn("Socket was dropped unexpectedly (this can be an alternative to closing the connection)", func_name);
+        }
+        // we are not connected, so the engine doesn't try to close the connection
+        m_drop();
+    }
+    else if (!wr_ok) {
+        m_error("Not connected because write error is set", func_name);
+        m_print_ssl_error(getWriteError(), SSL_ERROR);
+    }
+    return c_con && br_con;
+}
+
+/* see SSLClient.h */
+template<class TransportT>
+uint8_t SSLClient::m_connected_or_reconnect(TransportT& client) {
+    const uint8_t ret = m_connected_impl(client);
+    // reopen the connection if it dropped
+    if (!ret && m_dropped) return m_reconnect("connected") != 0;
+    return ret;
+}
+
+/* see SSLClient.h */
+template<class TransportT>
+uint8_t SSLClient::m_transport_connected(TransportT& client) {
+    m_expire_status();
+    if (m_status_connected < 0) m_status_connected = SSLTransport<TransportT>::connected(client) ? 1 : 0;
+    return (uint8_t)m_status_connected;
+}
+
+/* see SSLClient.h */
+template<class TransportT>
+int SSLClient::m_transport_available(TransportT& client) {
+    m_expire_status();
+    if (m_status_available < 0) {
+        const int avail = SSLTransport<TransportT>::readable(client);
+        m_status_available = avail > 0 ? avail : 0;
+    }
+    return m_status_available;
+}
+
+/* see SSLClient.h */
+template<class TransportT>
+unsigned SSLClient::m_update_engine_impl(TransportT& client) {
+    using Transport = SSLTransport<TransportT>;
+    const char* func_name = "m_update_engine";
+    for(;;) {
+        // get the state
+        unsigned state = br_ssl_engine_current_state(&m_sslctx.eng);
+        // debug
+        if (m_br_last_state == 0 || state != m_br_last_state) {
+            m_br_last_state = state;
+            m_print_br_state(state, DebugLevel::SSL_INFO);
+        }
+        if (state & BR_SSL_CLOSED) return state;
+        /*
+        * If there is some record data to send, do it. This takes
+        * precedence over everything else.
+        */
+        if (state & BR_SSL_SENDREC) {
+            unsigned char *buf;
+            size_t len;
+            int wlen;
+
+            buf = br_ssl_engine_sendrec_buf(&m_sslctx.eng, &len);
+            // if the network client can tell us it is full, try again later
+            // instead of blocking in write
+            if (Transport::writable(client) == 0) return state;
+            // send the record in one transfer (write + flush for a plain Client)
+            const SSLIoVec iov = { buf, len };
+            wlen = Transport::writev(client, &iov, 1);
+            // writing may change what the network client reports
+            m_invalidate_status();
+            if (wlen <= 0) {
+                // if the arduino client encountered an error
+                if (Transport::getWriteError(client) || !Transport::connected(client)) {
+                    m_error("Error writing to m_client", func_name);
+                    m_error(Transport::getWriteError(client), func_name);
+                    setWriteError(SSL_CLIENT_WRTIE_ERROR);
+                }
+                // else presumably the socket just closed itself, so just stop the engine
+                m_drop();
+                return 0;
+            }
+            if (wlen > 0) {
+                br_ssl_engine_sendrec_ack(&m_sslctx.eng, wlen);
+                m_io_count++;
+                // once every record is out, the data kept for replay has been sent
+                // (handshake records don't count, since replayed data comes after them)
+                if (m_is_connected && m_replay_len + m_replay_lost > 0
+                    && !(br_ssl_engine_current_state(&m_sslctx.eng) & BR_SSL_SENDREC))
+                    m_replay_commit();
+                // start timing the round trip on the first handshake record
+                if (!m_is_connected && m_rtt_probe_start == 0) m_rtt_probe_start = millis();
+            }
+	    continue;
+        }
+        
+        /*
+         * If the client has specified there is client data to send, and 
+         * the engine is ready to handle it, send it along.
+         */
+        if (m_write_idx > 0) {
+            // if we've reached the point where BR_SSL_SENDAPP is off but
+            // data has been written to the io buffer, something is wrong
+            if (!(state & BR_SSL_SENDAPP)) {
+                m_error("Error m_write_idx > 0 but the ssl engine is not ready for data", func_name);
+                m_error(br_ssl_engine_current_state(&m_sslctx.eng), func_name);
+                m_error(br_ssl_engine_last_error(&m_sslctx.eng), func_name);
+                setWriteError(SSL_BR_WRITE_ERROR);
+                stop();
+                return 0;
+            }
+            // else time to send the application data
+            else if (state & BR_SSL_SENDAPP) {
+	            size_t alen;
+                unsigned char *buf = br_ssl_engine_sendapp_buf(&m_sslctx.eng, &alen);
+                // engine check
+                if (alen == 0 || buf == nullptr) {
+                    m_error("Engine set write flag but returned null buffer", func_name);
+                    setWriteError(SSL_BR_WRITE_ERROR);
+                    stop();
+                    return 0;
+                }
+                // sanity check
+                if (alen < m_write_idx) {
+                    m_error("Alen is less than m_write_idx", func_name);
+                    setWriteError(SSL_INTERNAL_ERROR);
+                    stop();
+                    return 0;
+                }
+                // all good? lets send the data
+                // presumably the SSLClient::write function has already added
+                // data to *buf, so now we tell bearssl it's time for the
+                // encryption step.
+                // this will encrypt the data and presumably spit it out
+                // for BR_SSL_SENDREC to send over ethernet.
+                m_replay_append(buf, m_write_idx);
+                br_ssl_engine_sendapp_ack(&m_sslctx.eng, m_write_idx);
+                // reset the iobuffer index
+                m_write_idx = 0;
+                // loop again!
+                continue;
+            }
+        }
+        
+        /*
+         * If there is some record data to recieve, check if we've
+         * recieved it so far. If we have, then we can update the state.
+         * else we can return that we're still waiting for the server.
+         */
+        if (state & BR_SSL_RECVREC) {
+			size_t len;
+			unsigned char * buf = br_ssl_engine_recvrec_buf(&m_sslctx.eng, &len);
+            // do we have the record you're looking for?
+            const auto avail = m_transport_available(client);
+            if (avail > 0) {
+                // I suppose so!
+                const SSLIoVec iov = { buf, static_cast<size_t>(avail) < len ? static_cast<size_t>(avail) : len };
+                int rlen = Transport::readv(client, &iov, 1);
+                if (rlen <= 0) {
+                    m_error("Error reading bytes from m_client. Write Error: ", func_name);
+                    m_error(Transport::getWriteError(client), func_name);
+                    setWriteError(SSL_CLIENT_WRTIE_ERROR);
+                    m_drop();
+                    return 0;
+                }
+                if (rlen > 0) {
+                    m_consume_available(rlen);
+                    br_ssl_engine_recvrec_ack(&m_sslctx.eng, rlen);
+                    m_io_count++;
+                    // the first response to the handshake completes the round trip
+                    if (!m_is_connected && m_rtt_probe_start != 0 && !m_rtt_sampled) {
+                        m_rtt_sample = millis() - m_rtt_probe_start;
+                        m_rtt_sampled = true;
+                    }
+                }
+                continue;
+            }
+            // guess not, tell the state we're waiting still
+			else {
+                // m_print("Bytes avail: ");
+                // m_print(avail);
+                // m_print("Bytes needed: ");
+                // m_print(len);
+                // add a delay since spamming get_arduino_client().availible breaks the poor wiz chip
+                delay(10);
+                return state;
+            }
+        }
+        // if it's not any of the above states, then it must be waiting to send or recieve app data
+        // in which case we return 
+        return state;
+    }
+}
+
 #endif /** SSLClient_H_ */
\ No newline at end of file
@@ -0,0 +1,196 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLClientConfig.h
+ *
+ * Compile time options for SSLClient. Since the Arduino IDE does not allow
+ * passing defines to libraries, these can either be uncommented here, or
+ * set with the build system (for example, build_flags in PlatformIO).
+ */
+
+#ifndef SSLClientConfig_H_
+#define SSLClientConfig_H_
+
+/**
+ * @brief Do not use dynamic memory anywhere in SSLClient.
+ *
+ * By default SSLClient stores sessions in a std::vector, hostnames in Arduino
+ * String objects, and mTLS certificates in a std::vector, all of which allocate
+ * on the heap. On devices that stay up for a long time this can fragment the heap
+ * until allocations start failing. With this option defined, sessions, hostnames
+ * and certificates are stored in fixed size arrays inside the SSLClient and
+ * SSLClientParameters objects instead, sized with the options below. The library
+ * sources are also compiled with malloc, new and String poisoned, so any use of
+ * the heap is a compile error.
+ *
+ * The poisoning is a check on SSLClient's own .cpp files and the headers they
+ * include, not a proof. It does not see code in headers that is only compiled in
+ * the sketch (such as the SSLClientFor and SSLFileSource templates), nor the
+ * BearSSL C sources (BearSSL never allocates by design), nor allocations made
+ * inside functions SSLClient calls, such as the network client's or the C
+ * library's. extras/test/test_no_heap.cpp covers those at run time, by counting
+ * the calls to malloc and new during whole sessions on a host build.
+ */
+// #define SSLCLIENT_NO_HEAP
+
+#ifdef SSLCLIENT_NO_HEAP
+
+/** @brief Maximum number of sessions SSLClient can store, regardless of the max_sessions constructor argument. */
+#ifndef SSLCLIENT_MAX_SESSIONS
+#define SSLCLIENT_MAX_SESSIONS 1
+#endif
+
+/** @brief Longest hostname stored in a session. Sessions are not saved for longer hostnames. */
+#ifndef SSLCLIENT_MAX_HOSTNAME_LEN
+#define SSLCLIENT_MAX_HOSTNAME_LEN 64
+#endif
+
+/** @brief Largest DER encoded client certificate SSLClientParameters can hold. */
+#ifndef SSLCLIENT_MAX_CERT_LEN
+#define SSLCLIENT_MAX_CERT_LEN 1024
+#endif
+
+/**
+ * @brief Most unsent data SSLClient::setAutoReconnect can keep for replay, regardless of
+ * the max_replay argument. The default of zero reconnects without replaying anything.
+ */
+#ifndef SSLCLIENT_MAX_REPLAY_LEN
+#define SSLCLIENT_MAX_REPLAY_LEN 0
+#endif
+
+/**
+ * @brief Most of a record SSLClient::setPrecompute can prepare, regardless of the
+ * bytes argument. The default of zero turns precomputation off.
+ */
+#ifndef SSLCLIENT_MAX_PRECOMPUTE_LEN
+#define SSLCLIENT_MAX_PRECOMPUTE_LEN 0
+#endif
+
+/** @brief Maximum number of sessions an SSLSessionCache can store, regardless of the max_sessions constructor argument. */
+#ifndef SSLCLIENT_MAX_SHARED_SESSIONS
+#define SSLCLIENT_MAX_SHARED_SESSIONS 4
+#endif
+
+#endif
+
+/** @brief Number of hosts SSLClient::setHandshakeBackoff can remember failed handshakes for. */
+#ifndef SSLCLIENT_MAX_FAILED_HOSTS
+#define SSLCLIENT_MAX_FAILED_HOSTS 4
+#endif
+
+/**
+ * @brief Size of each HPACK dynamic table in SSLHttp2Client, in bytes as counted by
+ * HPACK (every header field counts 32 bytes more than its name and value). Larger tables
+ * remember more repeated headers; the memory used is about three times this.
+ */
+#ifndef SSLCLIENT_HPACK_TABLE_SIZE
+#define SSLCLIENT_HPACK_TABLE_SIZE 512
+#endif
+
+/** @brief Number of requests an SSLHttp2Client can have open at once. */
+#ifndef SSLCLIENT_H2_MAX_STREAMS
+#define SSLCLIENT_H2_MAX_STREAMS 4
+#endif
+
+/** @brief Largest compressed block of response headers SSLHttp2Client can receive. */
+#ifndef SSLCLIENT_H2_MAX_HEADER_BLOCK
+#define SSLCLIENT_H2_MAX_HEADER_BLOCK 1024
+#endif
+
+/**
+ * @brief Make SSLSessionCache safe to share between threads.
+ *
+ * Uses a FreeRTOS mutex on the ESP32 and std::mutex on desktop hosts, which is where
+ * this is turned on automatically. Defined for any other target, it uses a spinlock on
+ * std::atomic_flag, which requires every thread using the cache to run at the same
+ * priority (see SSLSessionCache).
+ */
+#if !defined(SSLCLIENT_THREAD_SAFE) && (defined(__unix__) || defined(__APPLE__) || defined(_WIN32) || defined(ARDUINO_ARCH_ESP32))
+#define SSLCLIENT_THREAD_SAFE
+#endif
+
+/**
+ * @brief Build SSLPosixClient, a network client on POSIX sockets.
+ *
+ * Turned on automatically when building for a Unix-like host outside of the Arduino
+ * build system (for example to test a sketch on a PC, or on a Linux gateway).
+ */
+#if !defined(SSLCLIENT_POSIX) && !defined(ARDUINO) && (defined(__unix__) || defined(__APPLE__))
+#define SSLCLIENT_POSIX
+#endif
+
+/** @brief Most addresses of a hostname SSLPosixClient tries when connecting. */
+#ifndef SSLCLIENT_MAX_CONNECT_ADDRESSES
+#define SSLCLIENT_MAX_CONNECT_ADDRESSES 8
+#endif
+
+/** @brief Number of hostnames SSLPosixClient remembers the last connected address of. */
+#ifndef SSLCLIENT_MAX_AFFINITY_HOSTS
+#define SSLCLIENT_MAX_AFFINITY_HOSTS 4
+#endif
+
+/**
+ * @brief Size of the keystream buffer for SSLClient::setPrecompute(bytes): the ChaCha20
+ * block holding the Poly1305 key (or the GCM tag mask), then whole 64 byte blocks.
+ */
+#define SSLCLIENT_KEYSTREAM_LEN(bytes) ((((bytes) + 63) / 64 + 1) * 64)
+
+/** @brief Values for SSLCLIENT_FOOTPRINT */
+#define SSLCLIENT_FOOTPRINT_FULL 0
+#define SSLCLIENT_FOOTPRINT_SMALL 1
+#define SSLCLIENT_FOOTPRINT_TINY 2
+
+/**
+ * @brief Size the BearSSL context structures for what SSLClient actually uses.
+ *
+ * BearSSL sizes its contexts for everything it can do: 48 cipher suites, RSA keys up to
+ * 4096 bits and hashes up to SHA-512. This option shrinks them (and the stack buffers
+ * that depend on the same limits) to a smaller set of features:
+ *  - SSLCLIENT_FOOTPRINT_FULL: BearSSL's defaults.
+ *  - SSLCLIENT_FOOTPRINT_SMALL: up to 16 cipher suites, and hashes up to SHA-384 for
+ *    certificate signatures. RSA-4096 root certificates still work.
+ *  - SSLCLIENT_FOOTPRINT_TINY: up to 8 cipher suites, RSA keys up to 2048 bits, and
+ *    only SHA-256 for certificate signatures. This saves over a kilobyte in each
+ *    SSLClient, but cannot verify chains that end in an RSA-4096 root (for example ISRG
+ *    Root X1, used by Let's Encrypt) or that are signed with SHA-384, and cannot use an
+ *    mTLS key larger than RSA-2048.
+ *
+ * The examples/FootprintReport sketch prints the resulting sizes. Since these limits
+ * change the layout of structures used by both the C and C++ sources, they must be set
+ * for the whole library (here or with the build system), never for a single file.
+ */
+#ifndef SSLCLIENT_FOOTPRINT
+#define SSLCLIENT_FOOTPRINT SSLCLIENT_FOOTPRINT_FULL
+#endif
+
+#if SSLCLIENT_FOOTPRINT == SSLCLIENT_FOOTPRINT_SMALL
+#define BR_MAX_CIPHER_SUITES 16
+#define BR_X509_BUFSIZE_HASH 48
+#elif SSLCLIENT_FOOTPRINT == SSLCLIENT_FOOTPRINT_TINY
+#define BR_MAX_CIPHER_SUITES 8
+#define BR_MAX_RSA_SIZE 2048
+#define BR_X509_BUFSIZE_KEY 264
+#define BR_X509_BUFSIZE_SIG 256
+#define BR_X509_BUFSIZE_HASH 32
+#define BR_SSL_BUFSIZE_PAD 256
+#endif
+
+#endif /* SSLClientConfig_H_ */
@@ -1,5 +1,99 @@
 #include "SSLClientParameters.h"
 
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+
+struct ssl_pem_copy_state {
+    char* dest;
+    size_t index;
+    bool overflow;
+};
+
+static void ssl_pem_copy_callback(void *dest_ctx, const void *src, size_t len) {
+    ssl_pem_copy_state* ctx = static_cast<ssl_pem_copy_state*>(dest_ctx);
+    if (ctx->overflow || len > SSLCLIENT_MAX_CERT_LEN - ctx->index) {
+        ctx->overflow = true;
+        return;
+    }
+    memcpy(ctx->dest + ctx->index, src, len);
+    ctx->index += len;
+}
+
+static void ssl_skey_push_callback(void *dest_ctx, const void *src, size_t len) {
+    br_skey_decoder_push(static_cast<br_skey_decoder_context*>(dest_ctx), src, len);
+}
+
+/**
+ * Utility function to decode a PEM object, handing the DER bytes to a
+ * callback as they are decoded instead of storing them.
+ * @param data PEM certificate bytes, including the "BEGIN" and "END" statements.
+ * @param len Number of characters to process, MUST include a whole certificate.
+ * @param dest Callback which receives the decoded bytes.
+ * @param dest_ctx Context passed to dest.
+ * @return true if the object was decoded, false if an error occurred.
+ */
+static bool decode_pem(const char* data, const size_t len, void (*dest)(void *dest_ctx, const void *src, size_t len), void* dest_ctx) {
+    if (data == nullptr || len < 80) return false;
+    // initialize the bearssl PEM context
+    br_pem_decoder_context pctx;
+    br_pem_decoder_init(&pctx);
+    // set the byte reciever
+    br_pem_decoder_setdest(&pctx, dest, dest_ctx);
+    // start decoding!
+    int br_state = 0;
+    size_t index = 0;
+    do {
+        index += br_pem_decoder_push(&pctx, static_cast<const void*>(&data[index]), len - index);
+        br_state = br_pem_decoder_event(&pctx);
+    } while (br_state != BR_PEM_ERROR && br_state != BR_PEM_END_OBJ && len != index);
+    return br_state != BR_PEM_ERROR;
+}
+
+/**
+ * Copy a certificate into fixed storage, decoding it from PEM if needed.
+ * @returns The length of the DER certificate, or zero if it is invalid or
+ * larger than SSLCLIENT_MAX_CERT_LEN.
+ */
+static size_t copy_cert(char* dest, const char* cert, const size_t cert_len, bool is_der) {
+    if (is_der) {
+        if (cert == nullptr || cert_len > SSLCLIENT_MAX_CERT_LEN) return 0;
+        memcpy(dest, cert, cert_len);
+        return cert_len;
+    }
+    ssl_pem_copy_state state;
+    state.dest = dest;
+    state.index = 0;
+    state.overflow = false;
+    if (!decode_pem(cert, cert_len, &ssl_pem_copy_callback, &state) || state.overflow) return 0;
+    return state.index;
+}
+
+/**
+ * Decode a private key, streaming the PEM decoder output directly into
+ * the key decoder so that no copy of the DER key is needed.
+ * @returns context used by BearSSL to store information about the keys.
+ */
+static br_skey_decoder_context make_key(const char* key, const size_t key_len, bool is_der) {
+    br_skey_decoder_context out;
+    br_skey_decoder_init(&out);
+    if (is_der)
+        br_skey_decoder_push(&out, key, key_len);
+    // if the PEM was invalid, start over so no key is reported
+    else if (!decode_pem(key, key_len, &ssl_skey_push_callback, &out))
+        br_skey_decoder_init(&out);
+    return out;
+}
+
+/* See SSLClientParams.h */
+SSLClientParameters::SSLClientParameters(const char* cert, const size_t cert_len, const char* key, const size_t key_len, bool is_der)
+    : m_cert()
+    , m_cert_len(copy_cert(m_cert, cert, cert_len, is_der))
+    , m_cert_struct{ reinterpret_cast<unsigned char*>(m_cert), m_cert_len }
+    , m_key_struct( make_key(key, key_len, is_der) ) {}
+
+#else
+
 // fix for non-exception arduino platforms (Feather and Teensy 4.0)
 namespace std {
     void __attribute__((weak)) __throw_length_error(char const*) {}
@@ -82,6 +176,8 @@ SSLClientParameters::SSLClientParameters(const char* cert, const size_t cert_len
     , m_cert_struct{ const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(m_cert.data())), m_cert.size() }
     , m_key_struct( make_key_from_der( is_der ? std::vector<char>(key, key + key_len) : make_vector_pem(key, key_len) ) ) {}
 
+#endif
+
 /* See SSLClientParams.h */
 SSLClientParameters SSLClientParameters::fromPEM(const char* cert_pem, const size_t cert_len, const char* key_pem, const size_t key_len) {
     return SSLClientParameters(cert_pem, cert_len, key_pem, key_len, false);
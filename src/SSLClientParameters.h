@@ -26,9 +26,12 @@
  */
 
 #include "bearssl.h"
+#include "SSLClientConfig.h"
 #undef min
 #undef max
+#ifndef SSLCLIENT_NO_HEAP
 #include <vector>
+#endif
 
 #ifndef SSLClientParameters_H_
 #define SSLClientParameters_H_
@@ -48,6 +51,10 @@
  * SSLClientParameters supports both ECC and RSA client certificates. I recommend using
  * ECC certificates if possible, as SSLClientParameters will make a copy of both the
  * certificate and the private key in memory, and ECC keys tend to be smaller than RSA ones.
+ * 
+ * If SSLCLIENT_NO_HEAP is defined, the certificate is copied into an array of
+ * SSLCLIENT_MAX_CERT_LEN bytes inside this object instead of the heap. Certificates
+ * that do not fit are treated the same as certificates that fail to parse.
  */
 class SSLClientParameters {
 public:
@@ -127,7 +134,12 @@ protected:
     SSLClientParameters(const char* cert, const size_t cert_len, const char* key, const size_t key_len, bool is_der);
 
 private:
+#ifdef SSLCLIENT_NO_HEAP
+    char m_cert[SSLCLIENT_MAX_CERT_LEN];
+    const size_t m_cert_len;
+#else
     const std::vector<char> m_cert;
+#endif
     const br_x509_certificate m_cert_struct;
     const br_skey_decoder_context m_key_struct;
 };
@@ -0,0 +1,78 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLFixedVector.h
+ *
+ * A minimal std::vector replacement with a capacity fixed at compile time,
+ * used by SSLClient when SSLCLIENT_NO_HEAP is defined.
+ */
+
+#include <stddef.h>
+#include <new>
+
+#ifndef SSLFixedVector_H_
+#define SSLFixedVector_H_
+
+/**
+ * @brief Stores up to N objects of type T in place, without using the heap.
+ *
+ * Only the parts of the std::vector interface used by SSLClient are implemented.
+ * Unlike std::vector, push_back does nothing if the vector is full, so callers
+ * must check size() first.
+ */
+template<class T, size_t N>
+class SSLFixedVector {
+public:
+    SSLFixedVector() : m_size(0) {}
+    ~SSLFixedVector() { while (m_size > 0) data()[--m_size].~T(); }
+
+    SSLFixedVector(const SSLFixedVector&) = delete;
+    SSLFixedVector& operator=(const SSLFixedVector&) = delete;
+
+    size_t size() const { return m_size; }
+    static constexpr size_t capacity() { return N; }
+
+    T* begin() { return data(); }
+    T* end() { return data() + m_size; }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    /** @brief Copy an element to the end of the vector, if there is space. */
+    void push_back(const T& val) {
+        if (m_size < N) new (&data()[m_size++]) T(val);
+    }
+
+    /** @brief Remove an element, shifting the following elements down. */
+    void erase(T* pos) {
+        for (T* it = pos; it + 1 < end(); it++) *it = *(it + 1);
+        data()[--m_size].~T();
+    }
+
+private:
+    T* data() { return reinterpret_cast<T*>(m_storage); }
+    const T* data() const { return reinterpret_cast<const T*>(m_storage); }
+
+    alignas(T) unsigned char m_storage[N * sizeof(T)];
+    size_t m_size;
+};
+
+#endif /* SSLFixedVector_H_ */
@@ -0,0 +1,45 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLHostHash.h
+ *
+ * The hostname hash used by the tables that remember something per host
+ * (failed handshakes in SSLClient, connected addresses in SSLPosixClient).
+ */
+
+#include <stdint.h>
+
+#ifndef SSLHostHash_H_
+#define SSLHostHash_H_
+
+/**
+ * @brief FNV-1a hash of a hostname, never 0 (which the tables use to mark an unused entry).
+ */
+inline uint32_t ssl_hash_hostname(const char* host) {
+    uint32_t hash = 2166136261u;
+    for (; *host != '\0'; host++) {
+        hash ^= static_cast<uint8_t>(*host);
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+#endif /* SSLHostHash_H_ */
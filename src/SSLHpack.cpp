@@ -0,0 +1,440 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLHpack.h"
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+constexpr size_t SSLHpack::TABLE_SIZE;
+
+// the table size both ends start with (SETTINGS_HEADER_TABLE_SIZE)
+static const size_t HPACK_DEFAULT_TABLE_SIZE = 4096;
+// what an entry counts for in a table besides its name and value
+static const size_t HPACK_ENTRY_OVERHEAD = 32;
+// what an entry actually takes in Table::m_buf besides its name and value
+static const size_t HPACK_ENTRY_HEADER = 4;
+
+struct HpackStaticEntry {
+    const char* name;
+    const char* value;
+};
+
+// RFC 7541 appendix A, index 1 first
+static const HpackStaticEntry hpack_static[] = {
+    { ":authority", "" },
+    { ":method", "GET" },
+    { ":method", "POST" },
+    { ":path", "/" },
+    { ":path", "/index.html" },
+    { ":scheme", "http" },
+    { ":scheme", "https" },
+    { ":status", "200" },
+    { ":status", "204" },
+    { ":status", "206" },
+    { ":status", "304" },
+    { ":status", "400" },
+    { ":status", "404" },
+    { ":status", "500" },
+    { "accept-charset", "" },
+    { "accept-encoding", "gzip, deflate" },
+    { "accept-language", "" },
+    { "accept-ranges", "" },
+    { "accept", "" },
+    { "access-control-allow-origin", "" },
+    { "age", "" },
+    { "allow", "" },
+    { "authorization", "" },
+    { "cache-control", "" },
+    { "content-disposition", "" },
+    { "content-encoding", "" },
+    { "content-language", "" },
+    { "content-length", "" },
+    { "content-location", "" },
+    { "content-range", "" },
+    { "content-type", "" },
+    { "cookie", "" },
+    { "date", "" },
+    { "etag", "" },
+    { "expect", "" },
+    { "expires", "" },
+    { "from", "" },
+    { "host", "" },
+    { "if-match", "" },
+    { "if-modified-since", "" },
+    { "if-none-match", "" },
+    { "if-range", "" },
+    { "if-unmodified-since", "" },
+    { "last-modified", "" },
+    { "link", "" },
+    { "location", "" },
+    { "max-forwards", "" },
+    { "proxy-authenticate", "" },
+    { "proxy-authorization", "" },
+    { "range", "" },
+    { "referer", "" },
+    { "refresh", "" },
+    { "retry-after", "" },
+    { "server", "" },
+    { "set-cookie", "" },
+    { "strict-transport-security", "" },
+    { "transfer-encoding", "" },
+    { "user-agent", "" },
+    { "vary", "" },
+    { "via", "" },
+    { "www-authenticate", "" },
+};
+static const size_t HPACK_STATIC_COUNT = sizeof hpack_static / sizeof hpack_static[0];
+
+// The Huffman code of RFC 7541 appendix B is canonical: codes are assigned in order of
+// length, then of symbol. So the code lengths and the symbols in code order are enough
+// to decode it, instead of the whole code table.
+// number of Huffman codes of each length, from 0 to 30 bits (EOS is left out)
+static const uint8_t hpack_huffman_count[31] = {
+    0, 0, 0, 0, 0, 10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 3,
+};
+// the symbols, in the order of their codes
+static const uint8_t hpack_huffman_symbol[256] = {
+    48, 49, 50, 97, 99, 101, 105, 111, 115, 116, 32, 37, 45, 46, 47, 51,
+    52, 53, 54, 55, 56, 57, 61, 65, 95, 98, 100, 102, 103, 104, 108, 109,
+    110, 112, 114, 117, 58, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76,
+    77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 89, 106, 107, 113, 118,
+    119, 120, 121, 122, 38, 42, 44, 59, 88, 90, 33, 34, 40, 41, 63, 39,
+    43, 124, 35, 62, 0, 36, 64, 91, 93, 126, 94, 125, 60, 96, 123, 92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+    179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+    163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233, 1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+    158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239, 9, 142,
+    144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+    212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+    2, 3, 4, 5, 6, 7, 8, 11, 12, 14, 15, 16, 17, 18, 19, 20,
+    21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 127, 220, 249, 10, 13, 22,
+};
+
+static char hpack_lower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+static bool hpack_name_equals(const char* stored, size_t stored_len, const char* name, size_t name_len) {
+    if (stored_len != name_len) return false;
+    for (size_t i = 0; i < name_len; i++) {
+        if (stored[i] != hpack_lower(name[i])) return false;
+    }
+    return true;
+}
+
+static void hpack_write_int(Print& out, uint8_t first, uint8_t prefix_bits, size_t value) {
+    const size_t max_prefix = (static_cast<size_t>(1) << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out.write(static_cast<uint8_t>(first | value));
+        return;
+    }
+    out.write(static_cast<uint8_t>(first | max_prefix));
+    value -= max_prefix;
+    while (value >= 0x80) {
+        out.write(static_cast<uint8_t>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.write(static_cast<uint8_t>(value));
+}
+
+static void hpack_write_string(Print& out, const char* str, size_t len, bool lower) {
+    hpack_write_int(out, 0x00, 7, len);
+    for (size_t i = 0; i < len; i++)
+        out.write(static_cast<uint8_t>(lower ? hpack_lower(str[i]) : str[i]));
+}
+
+static bool hpack_read_int(const uint8_t*& p, const uint8_t* end, uint8_t prefix_bits, size_t& value) {
+    const size_t max_prefix = (static_cast<size_t>(1) << prefix_bits) - 1;
+    value = *p++ & max_prefix;
+    if (value < max_prefix) return true;
+    // nothing we can handle needs more than 28 bits
+    for (uint8_t shift = 0; shift <= 21; shift += 7) {
+        if (p == end) return false;
+        const uint8_t b = *p++;
+        value += static_cast<size_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+SSLHpack::Table::Table()
+    : m_buf()
+    , m_used(0)
+    , m_size(0)
+    , m_max(TABLE_SIZE)
+    , m_count(0) {}
+
+void SSLHpack::Table::clear() {
+    m_used = 0;
+    m_size = 0;
+    m_count = 0;
+}
+
+void SSLHpack::Table::setMax(size_t max) {
+    m_max = max < TABLE_SIZE ? max : TABLE_SIZE;
+    while (m_size > m_max) m_evict();
+}
+
+void SSLHpack::Table::add(const char* name, size_t name_len, const char* value, size_t value_len) {
+    const size_t size = name_len + value_len + HPACK_ENTRY_OVERHEAD;
+    // an entry larger than the table empties it (RFC 7541 section 4.4)
+    if (size > m_max) {
+        clear();
+        return;
+    }
+    while (m_size + size > m_max) m_evict();
+    // the overhead counted for each entry is larger than its header, so the
+    // entries always fit in the buffer if their size fits in the table
+    uint8_t* entry = m_buf + m_used;
+    entry[0] = static_cast<uint8_t>(name_len >> 8);
+    entry[1] = static_cast<uint8_t>(name_len);
+    entry[2] = static_cast<uint8_t>(value_len >> 8);
+    entry[3] = static_cast<uint8_t>(value_len);
+    for (size_t i = 0; i < name_len; i++) entry[HPACK_ENTRY_HEADER + i] = static_cast<uint8_t>(hpack_lower(name[i]));
+    memcpy(entry + HPACK_ENTRY_HEADER + name_len, value, value_len);
+    m_used += HPACK_ENTRY_HEADER + name_len + value_len;
+    m_size += size;
+    m_count++;
+}
+
+void SSLHpack::Table::get(size_t k, const char*& name, size_t& name_len,
+                          const char*& value, size_t& value_len) const {
+    const uint8_t* entry = m_buf;
+    for (size_t skip = m_count - k; ; skip--) {
+        name_len = (static_cast<size_t>(entry[0]) << 8) | entry[1];
+        value_len = (static_cast<size_t>(entry[2]) << 8) | entry[3];
+        if (skip == 0) break;
+        entry += HPACK_ENTRY_HEADER + name_len + value_len;
+    }
+    name = reinterpret_cast<const char*>(entry + HPACK_ENTRY_HEADER);
+    value = name + name_len;
+}
+
+void SSLHpack::Table::m_evict() {
+    // the oldest entry is first, so shift the rest down over it
+    const size_t len = HPACK_ENTRY_HEADER + ((static_cast<size_t>(m_buf[0]) << 8) | m_buf[1])
+        + ((static_cast<size_t>(m_buf[2]) << 8) | m_buf[3]);
+    memmove(m_buf, m_buf + len, m_used - len);
+    m_used -= len;
+    m_size -= len - HPACK_ENTRY_HEADER + HPACK_ENTRY_OVERHEAD;
+    m_count--;
+}
+
+/* see SSLHpack.h */
+SSLHpack::SSLHpack()
+    : m_encoder()
+    , m_decoder()
+    , m_encoder_min(0)
+    , m_encoder_update(false)
+    , m_field()
+    , m_field_len(0)
+    , m_field_overflow(false) {
+    reset();
+}
+
+/* see SSLHpack.h */
+void SSLHpack::reset() {
+    m_encoder.clear();
+    m_decoder.clear();
+    m_decoder.setMax(TABLE_SIZE);
+    m_encoder.setMax(HPACK_DEFAULT_TABLE_SIZE);
+    // the peer assumes the default size until told otherwise
+    m_encoder_min = m_encoder.max();
+    m_encoder_update = m_encoder.max() != HPACK_DEFAULT_TABLE_SIZE;
+}
+
+/* see SSLHpack.h */
+void SSLHpack::setEncoderLimit(size_t size) {
+    const size_t max = size < TABLE_SIZE ? size : TABLE_SIZE;
+    if (max == m_encoder.max()) return;
+    m_encoder.setMax(max);
+    if (!m_encoder_update || max < m_encoder_min) m_encoder_min = max;
+    m_encoder_update = true;
+}
+
+/* see SSLHpack.h */
+void SSLHpack::beginBlock(Print& out) {
+    if (!m_encoder_update) return;
+    // if the table shrank and grew again, the peer has to see the smallest size
+    // too, or it may keep entries we evicted
+    if (m_encoder_min < m_encoder.max()) hpack_write_int(out, 0x20, 5, m_encoder_min);
+    hpack_write_int(out, 0x20, 5, m_encoder.max());
+    m_encoder_update = false;
+}
+
+/* see SSLHpack.h */
+void SSLHpack::encode(Print& out, const char* name, size_t name_len,
+                      const char* value, size_t value_len, bool index) {
+    size_t name_index = 0;
+    const char* entry_name;
+    const char* entry_value;
+    size_t entry_name_len;
+    size_t entry_value_len;
+    for (size_t i = 1; i <= HPACK_STATIC_COUNT + m_encoder.count(); i++) {
+        m_lookup(m_encoder, i, entry_name, entry_name_len, entry_value, entry_value_len);
+        if (!hpack_name_equals(entry_name, entry_name_len, name, name_len)) continue;
+        if (entry_value_len == value_len && memcmp(entry_value, value, value_len) == 0) {
+            // indexed header field
+            hpack_write_int(out, 0x80, 7, i);
+            return;
+        }
+        if (name_index == 0) name_index = i;
+    }
+    // adding a field too large for the table would only empty it
+    if (index && name_len + value_len + HPACK_ENTRY_OVERHEAD <= m_encoder.max()) {
+        // literal header field with incremental indexing
+        hpack_write_int(out, 0x40, 6, name_index);
+        m_encoder.add(name, name_len, value, value_len);
+    }
+    else {
+        // literal header field without indexing
+        hpack_write_int(out, 0x00, 4, name_index);
+    }
+    if (name_index == 0) hpack_write_string(out, name, name_len, true);
+    hpack_write_string(out, value, value_len, false);
+}
+
+/* see SSLHpack.h */
+bool SSLHpack::decode(const uint8_t* block, size_t len, Handler& handler) {
+    const uint8_t* p = block;
+    const uint8_t* const end = block + len;
+    while (p < end) {
+        const uint8_t b = *p;
+        size_t index;
+        const char* name;
+        const char* value;
+        size_t name_len;
+        size_t value_len;
+        if (b & 0x20 && (b & 0xC0) == 0) {
+            // dynamic table size update, no larger than we advertised
+            if (!hpack_read_int(p, end, 5, index) || index > TABLE_SIZE) return false;
+            m_decoder.setMax(index);
+            continue;
+        }
+        m_field_len = 0;
+        m_field_overflow = false;
+        if (b & 0x80) {
+            // indexed header field
+            if (!hpack_read_int(p, end, 7, index) || !m_lookup(m_decoder, index, name, name_len, value, value_len))
+                return false;
+            m_store(name, name_len);
+            m_store(value, value_len);
+            handler.field(m_field, m_field + name_len + 1);
+            continue;
+        }
+        // a literal, with incremental indexing or without
+        const bool add = (b & 0x40) != 0;
+        if (!hpack_read_int(p, end, add ? 6 : 4, index)) return false;
+        if (index > 0) {
+            if (!m_lookup(m_decoder, index, name, name_len, value, value_len)) return false;
+            m_store(name, name_len);
+        }
+        else if (!m_read_string(p, end))
+            return false;
+        const size_t value_start = m_field_len;
+        if (!m_read_string(p, end)) return false;
+        if (add) {
+            // a field that overflowed is larger than the table, and empties it
+            if (m_field_overflow) m_decoder.clear();
+            else m_decoder.add(m_field, value_start - 1, m_field + value_start, m_field_len - value_start - 1);
+        }
+        if (!m_field_overflow) handler.field(m_field, m_field + value_start);
+    }
+    return true;
+}
+
+bool SSLHpack::m_lookup(const Table& table, size_t index, const char*& name, size_t& name_len,
+                        const char*& value, size_t& value_len) const {
+    if (index == 0) return false;
+    if (index <= HPACK_STATIC_COUNT) {
+        name = hpack_static[index - 1].name;
+        value = hpack_static[index - 1].value;
+        name_len = strlen(name);
+        value_len = strlen(value);
+        return true;
+    }
+    index -= HPACK_STATIC_COUNT;
+    if (index > table.count()) return false;
+    table.get(index, name, name_len, value, value_len);
+    return true;
+}
+
+bool SSLHpack::m_read_string(const uint8_t*& p, const uint8_t* end) {
+    if (p == end) return false;
+    const bool huffman = (*p & 0x80) != 0;
+    size_t len;
+    if (!hpack_read_int(p, end, 7, len) || len > static_cast<size_t>(end - p)) return false;
+    if (!huffman) {
+        m_store(reinterpret_cast<const char*>(p), len);
+        p += len;
+        return true;
+    }
+    // canonical decoding, one bit at a time: code is the bits read so far,
+    // first the first code of that length, and index the position of that code
+    // in hpack_huffman_symbol
+    int32_t code = 0;
+    int32_t first = 0;
+    int32_t index = 0;
+    uint8_t bits = 0;
+    bool all_ones = true;
+    for (const uint8_t* const str_end = p + len; p < str_end; p++) {
+        for (int8_t shift = 7; shift >= 0; shift--) {
+            const int32_t bit = (*p >> shift) & 1;
+            code |= bit;
+            all_ones = all_ones && bit;
+            bits++;
+            const int32_t count = hpack_huffman_count[bits];
+            if (code - first < count) {
+                const char sym = static_cast<char>(hpack_huffman_symbol[index + code - first]);
+                m_append(&sym, 1);
+                code = first = index = 0;
+                bits = 0;
+                all_ones = true;
+                continue;
+            }
+            // past the longest code is EOS, which may not appear in a string
+            if (bits == 30) return false;
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+    }
+    // the string is padded with at most 7 bits of the start of EOS, all ones
+    if (bits > 7 || !all_ones) return false;
+    m_append("", 1);
+    return true;
+}
+
+void SSLHpack::m_store(const char* data, size_t len) {
+    m_append(data, len);
+    m_append("", 1);
+}
+
+void SSLHpack::m_append(const char* data, size_t len) {
+    if (m_field_overflow || m_field_len + len > sizeof m_field) {
+        m_field_overflow = true;
+        return;
+    }
+    memcpy(m_field + m_field_len, data, len);
+    m_field_len += len;
+}
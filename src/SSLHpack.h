@@ -0,0 +1,141 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLHpack.h
+ *
+ * HPACK (RFC 7541), the header compression used by HTTP/2, sized for
+ * microcontrollers.
+ */
+
+#include "Arduino.h"
+#include "SSLClientConfig.h"
+
+#ifndef SSLHpack_H_
+#define SSLHpack_H_
+
+/**
+ * @brief Compresses and decompresses HTTP/2 header blocks for one connection.
+ *
+ * HPACK replaces header fields that were already sent on a connection with a small
+ * index into a table both ends keep (the dynamic table), so headers that repeat on every
+ * request, such as an authorization token, only cost a byte or two after the first one.
+ *
+ * This implementation keeps both dynamic tables in fixed buffers of
+ * SSLCLIENT_HPACK_TABLE_SIZE bytes: the decoder's size is advertised to the server, and
+ * the encoder shrinks the server's table to the same size. The encoder never uses
+ * Huffman coding, which saves the code table, while the decoder understands it since
+ * servers use it everywhere.
+ */
+class SSLHpack {
+public:
+    /** @brief Most bytes of header fields each dynamic table can hold. */
+    static constexpr size_t TABLE_SIZE = SSLCLIENT_HPACK_TABLE_SIZE;
+
+    /** @brief Receives decoded header fields. */
+    class Handler {
+    public:
+        virtual ~Handler() {}
+        /** @brief Called for every field of a header block, in order. */
+        virtual void field(const char* name, const char* value) = 0;
+    };
+
+    SSLHpack();
+
+    /** @brief Forget both dynamic tables, for a new connection. */
+    void reset();
+
+    /**
+     * @brief Apply the peer's SETTINGS_HEADER_TABLE_SIZE to the encoder.
+     *
+     * The encoder's table never grows past TABLE_SIZE. A change is announced to the
+     * peer at the start of the next header block.
+     */
+    void setEncoderLimit(size_t size);
+
+    /** @brief Start a header block, writing any pending table size update. */
+    void beginBlock(Print& out);
+
+    /**
+     * @brief Write one header field of a block.
+     *
+     * The field is sent as an index if it is in a table, and otherwise added to the
+     * dynamic table unless index is false or it is too large to fit.
+     *
+     * @param name The field name. It is lowercased, as HTTP/2 requires.
+     * @param index false for fields that should not be remembered, such as the path.
+     */
+    void encode(Print& out, const char* name, size_t name_len,
+                const char* value, size_t value_len, bool index = true);
+
+    /**
+     * @brief Decode a complete header block, calling handler for every field.
+     *
+     * Fields whose name and value add up to more than TABLE_SIZE bytes are decoded but
+     * not passed to the handler.
+     *
+     * @returns false if the block is malformed, which is a connection error.
+     */
+    bool decode(const uint8_t* block, size_t len, Handler& handler);
+
+private:
+    /** A dynamic table: entries packed newest last, with their lengths in front */
+    class Table {
+    public:
+        Table();
+        void clear();
+        size_t max() const { return m_max; }
+        void setMax(size_t max);
+        size_t count() const { return m_count; }
+        void add(const char* name, size_t name_len, const char* value, size_t value_len);
+        /** get entry k, where 1 is the newest */
+        void get(size_t k, const char*& name, size_t& name_len,
+                 const char*& value, size_t& value_len) const;
+    private:
+        void m_evict();
+        uint8_t m_buf[TABLE_SIZE];
+        size_t m_used;
+        size_t m_size;
+        size_t m_max;
+        size_t m_count;
+    };
+
+    /** look up a field by HPACK index: the static entries, then those of a dynamic table */
+    bool m_lookup(const Table& table, size_t index, const char*& name, size_t& name_len,
+                  const char*& value, size_t& value_len) const;
+    /** decode a string literal into the field buffer at m_field_len */
+    bool m_read_string(const uint8_t*& p, const uint8_t* end);
+    /** copy bytes into the field buffer at m_field_len, and terminate them */
+    void m_store(const char* data, size_t len);
+    /** copy bytes into the field buffer at m_field_len, or note that they did not fit */
+    void m_append(const char* data, size_t len);
+
+    Table m_encoder;
+    Table m_decoder;
+    // the smallest and last encoder table size since the last header block
+    size_t m_encoder_min;
+    bool m_encoder_update;
+    // the field being decoded: name, NUL, value, NUL
+    char m_field[TABLE_SIZE + 2];
+    size_t m_field_len;
+    bool m_field_overflow;
+};
+
+#endif /* SSLHpack_H_ */
@@ -0,0 +1,801 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLHttp2Client.h"
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+constexpr size_t SSLHttp2Client::MAX_STREAMS;
+
+// frame types (RFC 7540 section 6)
+static const uint8_t H2_DATA = 0x0;
+static const uint8_t H2_HEADERS = 0x1;
+static const uint8_t H2_RST_STREAM = 0x3;
+static const uint8_t H2_SETTINGS = 0x4;
+static const uint8_t H2_PUSH_PROMISE = 0x5;
+static const uint8_t H2_PING = 0x6;
+static const uint8_t H2_GOAWAY = 0x7;
+static const uint8_t H2_WINDOW_UPDATE = 0x8;
+static const uint8_t H2_CONTINUATION = 0x9;
+// frame flags
+static const uint8_t H2_END_STREAM = 0x1;
+static const uint8_t H2_ACK = 0x1;
+static const uint8_t H2_END_HEADERS = 0x4;
+static const uint8_t H2_PADDED = 0x8;
+static const uint8_t H2_PRIORITY = 0x20;
+// error codes
+static const uint32_t H2_NO_ERROR = 0x0;
+static const uint32_t H2_PROTOCOL_ERROR = 0x1;
+static const uint32_t H2_FLOW_CONTROL_ERROR = 0x3;
+static const uint32_t H2_FRAME_SIZE_ERROR = 0x6;
+static const uint32_t H2_CANCEL = 0x8;
+static const uint32_t H2_COMPRESSION_ERROR = 0x9;
+static const uint32_t H2_ENHANCE_YOUR_CALM = 0xb;
+// settings
+static const uint16_t H2_SETTINGS_HEADER_TABLE_SIZE = 0x1;
+static const uint16_t H2_SETTINGS_ENABLE_PUSH = 0x2;
+static const uint16_t H2_SETTINGS_MAX_CONCURRENT_STREAMS = 0x3;
+static const uint16_t H2_SETTINGS_INITIAL_WINDOW_SIZE = 0x4;
+
+static const size_t H2_FRAME_HEADER_LEN = 9;
+// we never raise SETTINGS_MAX_FRAME_SIZE, and neither can the server go below it
+static const uint32_t H2_MAX_FRAME_SIZE = 16384;
+static const int32_t H2_DEFAULT_WINDOW = 65535;
+static const int32_t H2_MAX_WINDOW = 0x7FFFFFFF;
+static const uint32_t H2_MAX_STREAM_ID = 0x7FFFFFFF;
+
+static const char h2_preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+static const char* const h2_alpn[] = { "h2" };
+
+static uint32_t h2_get_u32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+        | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+static void h2_put_u32(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+static size_t h2_format_authority(char* buf, size_t size, const char* host, uint16_t port) {
+    size_t len = strlen(host);
+    if (len + 7 > size) return 0;
+    memcpy(buf, host, len);
+    buf[len++] = ':';
+    char digits[5];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + port % 10);
+        port /= 10;
+    } while (port > 0);
+    while (n > 0) buf[len++] = digits[--n];
+    return len;
+}
+
+SSLHttp2Client::HeaderWriter::HeaderWriter(SSLHttp2Client& client, uint32_t stream_id, bool end_stream)
+    : m_h2(client)
+    , m_stream_id(stream_id)
+    , m_end_stream(end_stream)
+    , m_first(true)
+    , m_ok(true)
+    , m_len(0)
+    , m_buf() {}
+
+size_t SSLHttp2Client::HeaderWriter::write(uint8_t b) {
+    if (m_len == sizeof m_buf && !m_flush(false)) return 0;
+    m_buf[m_len++] = b;
+    return 1;
+}
+
+bool SSLHttp2Client::HeaderWriter::finish() {
+    return m_flush(true);
+}
+
+bool SSLHttp2Client::HeaderWriter::m_flush(bool last) {
+    const uint8_t type = m_first ? H2_HEADERS : H2_CONTINUATION;
+    const uint8_t flags = (last ? H2_END_HEADERS : 0) | (m_first && m_end_stream ? H2_END_STREAM : 0);
+    m_ok = m_ok && m_h2.m_make_room(H2_FRAME_HEADER_LEN + m_len)
+        && m_h2.m_write_header(static_cast<uint32_t>(m_len), type, flags, m_stream_id)
+        && (m_len == 0 || m_h2.m_client.write(m_buf, m_len) == m_len);
+    m_first = false;
+    m_len = 0;
+    return m_ok;
+}
+
+void SSLHttp2Client::FieldHandler::field(const char* name, const char* value) {
+    const int slot = m_h2.m_block_slot;
+    // the stream may have been released, but the block still had to be decoded
+    if (slot < 0 || m_h2.m_streams[slot].state != STREAM_OPEN) return;
+    Stream& stream = m_h2.m_streams[slot];
+    if (strcmp(name, ":status") == 0) stream.status = atoi(value);
+    else if (strcmp(name, "content-length") == 0) stream.content_length = atol(value);
+    if (m_h2.m_listener != nullptr) m_h2.m_listener->onHeader(slot, name, value);
+}
+
+/* see SSLHttp2Client.h */
+SSLHttp2Client::SSLHttp2Client(SSLClient& client, const char* host, uint16_t port)
+    : m_client(client)
+    , m_host(host)
+    , m_port(port)
+    , m_timeout(10000)
+    , m_listener(nullptr)
+    , m_hpack()
+    , m_streams()
+    , m_connected(false)
+    , m_goaway(false)
+    , m_next_id(1)
+    , m_max_streams(MAX_STREAMS)
+    , m_send_window(H2_DEFAULT_WINDOW)
+    , m_initial_window(H2_DEFAULT_WINDOW)
+    , m_received(0)
+    , m_window_pending(false)
+    , m_writing_block(false)
+    , m_settings_acks(0)
+    , m_resets()
+    , m_reset_count(0)
+    , m_ping()
+    , m_ping_pending(false)
+    , m_rx_header()
+    , m_rx_header_len(0)
+    , m_rx_type(0)
+    , m_rx_flags(0)
+    , m_rx_stream_id(0)
+    , m_rx_len(0)
+    , m_rx_left(0)
+    , m_rx_pad(0)
+    , m_rx_skip(0)
+    , m_rx_pad_next(false)
+    , m_block_stream_id(0)
+    , m_block_end_stream(false)
+    , m_block_slot(-1)
+    , m_ctl()
+    , m_ctl_len(0)
+    , m_block()
+    , m_block_len(0) {
+    for (size_t i = 0; i < MAX_STREAMS; i++) m_streams[i].state = STREAM_FREE;
+}
+
+/* see SSLHttp2Client.h */
+int SSLHttp2Client::request(const char* method, const char* path, const char* headers,
+                            const void* body, size_t body_len) {
+    if (m_connected && !m_client.connected()) m_fail(H2_NO_ERROR);
+    // a connection the server is closing, or that ran out of stream ids,
+    // takes no new streams, but the open ones may still finish on it
+    if (m_connected && (m_goaway || m_next_id > H2_MAX_STREAM_ID)) {
+        for (size_t i = 0; i < MAX_STREAMS; i++) {
+            if (m_streams[i].state == STREAM_OPEN) return -1;
+        }
+        stop();
+    }
+    if (!m_connected && !m_connect()) return -1;
+    int slot = -1;
+    size_t open = 0;
+    for (size_t i = 0; i < MAX_STREAMS; i++) {
+        if (m_streams[i].state == STREAM_FREE && slot < 0) slot = static_cast<int>(i);
+        else if (m_streams[i].state == STREAM_OPEN) open++;
+    }
+    if (slot < 0 || open >= m_max_streams) return -1;
+    Stream& stream = m_streams[slot];
+    stream.id = m_next_id;
+    stream.state = STREAM_OPEN;
+    stream.status = 0;
+    stream.content_length = -1;
+    stream.send_window = m_initial_window;
+    m_next_id += 2;
+    // nothing else may be sent between the frames of a header block
+    m_writing_block = true;
+    HeaderWriter out(*this, stream.id, body_len == 0);
+    m_hpack.beginBlock(out);
+    m_hpack.encode(out, ":method", 7, method, strlen(method));
+    m_hpack.encode(out, ":scheme", 7, "https", 5);
+    if (m_port == 443)
+        m_hpack.encode(out, ":authority", 10, m_host, strlen(m_host));
+    else {
+        char authority[256];
+        const size_t len = h2_format_authority(authority, sizeof authority, m_host, m_port);
+        m_hpack.encode(out, ":authority", 10, authority, len);
+    }
+    // paths rarely repeat, and would push everything else out of the table
+    m_hpack.encode(out, ":path", 5, path, strlen(path), false);
+    // "Name: value\r\n" lines
+    for (const char* line = headers; line != nullptr && *line != '\0'; ) {
+        const char* colon = line;
+        while (*colon != ':' && *colon != '\r' && *colon != '\n' && *colon != '\0') colon++;
+        const char* value = colon;
+        if (*value == ':') value++;
+        while (*value == ' ' || *value == '\t') value++;
+        const char* end = value;
+        while (*end != '\r' && *end != '\n' && *end != '\0') end++;
+        const char* next = end;
+        while (*next == '\r' || *next == '\n') next++;
+        while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+        if (*colon == ':' && colon > line)
+            m_hpack.encode(out, line, static_cast<size_t>(colon - line), value, static_cast<size_t>(end - value));
+        line = next;
+    }
+    const bool ok = out.finish();
+    m_writing_block = false;
+    m_send_resets();
+    if (!ok || (body_len > 0 && !m_send_body(slot, static_cast<const uint8_t*>(body), body_len))) {
+        // a failed connection has already failed the stream
+        if (m_connected && stream.state == STREAM_OPEN) {
+            m_close_stream(slot, true);
+            m_reset_stream(stream.id, H2_CANCEL);
+        }
+        stream.state = STREAM_FREE;
+        return -1;
+    }
+    m_send_control();
+    return slot;
+}
+
+/* see SSLHttp2Client.h */
+bool SSLHttp2Client::flush() {
+    if (!m_connected) return false;
+    m_client.flush();
+    return m_client.getWriteError() == SSLClient::SSL_OK;
+}
+
+/* see SSLHttp2Client.h */
+bool SSLHttp2Client::poll() {
+    m_service(-1, false);
+    return m_connected;
+}
+
+/* see SSLHttp2Client.h */
+bool SSLHttp2Client::wait(int stream) {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS || m_streams[stream].state == STREAM_FREE)
+        return false;
+    if (!m_service(stream, true) && m_streams[stream].state == STREAM_OPEN) {
+        // timed out: give up on the stream, but not the others
+        m_close_stream(stream, true);
+        m_reset_stream(m_streams[stream].id, H2_CANCEL);
+    }
+    return m_streams[stream].state == STREAM_DONE;
+}
+
+/* see SSLHttp2Client.h */
+bool SSLHttp2Client::done(int stream) const {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS) return false;
+    return m_streams[stream].state == STREAM_DONE || m_streams[stream].state == STREAM_FAILED;
+}
+
+/* see SSLHttp2Client.h */
+bool SSLHttp2Client::failed(int stream) const {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS) return false;
+    return m_streams[stream].state == STREAM_FAILED;
+}
+
+/* see SSLHttp2Client.h */
+int SSLHttp2Client::status(int stream) const {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS || m_streams[stream].state == STREAM_FREE)
+        return 0;
+    return m_streams[stream].status;
+}
+
+/* see SSLHttp2Client.h */
+long SSLHttp2Client::contentLength(int stream) const {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS || m_streams[stream].state == STREAM_FREE)
+        return -1;
+    return m_streams[stream].content_length;
+}
+
+/* see SSLHttp2Client.h */
+void SSLHttp2Client::release(int stream) {
+    if (stream < 0 || static_cast<size_t>(stream) >= MAX_STREAMS) return;
+    Stream& s = m_streams[stream];
+    const bool open = s.state == STREAM_OPEN;
+    // free it first, so nothing received while cancelling is passed on
+    s.state = STREAM_FREE;
+    if (open && m_connected) m_reset_stream(s.id, H2_CANCEL);
+}
+
+/* see SSLHttp2Client.h */
+size_t SSLHttp2Client::streams() const {
+    size_t count = 0;
+    for (size_t i = 0; i < MAX_STREAMS; i++) {
+        if (m_streams[i].state != STREAM_FREE) count++;
+    }
+    return count;
+}
+
+/* see SSLHttp2Client.h */
+void SSLHttp2Client::stop() {
+    if (m_connected) m_fail(H2_NO_ERROR);
+}
+
+bool SSLHttp2Client::m_connect() {
+    m_client.stop();
+    m_client.setAlpnProtocols(h2_alpn, 1);
+    if (!m_client.connect(m_host, m_port)) return false;
+    const char* protocol = m_client.getAlpnProtocol();
+    if (protocol == nullptr || strcmp(protocol, "h2") != 0) {
+        // the server only speaks HTTP/1.1 (see SSLHttpClient)
+        m_client.stop();
+        return false;
+    }
+    m_hpack.reset();
+    m_connected = true;
+    m_goaway = false;
+    m_next_id = 1;
+    m_max_streams = MAX_STREAMS;
+    m_send_window = H2_DEFAULT_WINDOW;
+    m_initial_window = H2_DEFAULT_WINDOW;
+    m_received = 0;
+    m_window_pending = false;
+    m_writing_block = false;
+    m_settings_acks = 0;
+    m_reset_count = 0;
+    m_ping_pending = false;
+    m_rx_header_len = 0;
+    m_block_stream_id = 0;
+    // Receiving flow control is turned all the way up, and the connection window is
+    // only topped up after a gigabyte: we never read faster than we can handle the data
+    // anyway, so TCP already slows the server down, and this way nothing has to be
+    // written while responses arrive, which the shared buffer does not allow.
+    uint8_t settings[3 * 6];
+    const uint16_t ids[3] = { H2_SETTINGS_HEADER_TABLE_SIZE, H2_SETTINGS_ENABLE_PUSH, H2_SETTINGS_INITIAL_WINDOW_SIZE };
+    const uint32_t values[3] = { SSLHpack::TABLE_SIZE, 0, static_cast<uint32_t>(H2_MAX_WINDOW) };
+    for (size_t i = 0; i < 3; i++) {
+        settings[i * 6] = static_cast<uint8_t>(ids[i] >> 8);
+        settings[i * 6 + 1] = static_cast<uint8_t>(ids[i]);
+        h2_put_u32(settings + i * 6 + 2, values[i]);
+    }
+    const bool ok = m_client.write(reinterpret_cast<const uint8_t*>(h2_preface), sizeof h2_preface - 1) == sizeof h2_preface - 1
+        && m_write_header(sizeof settings, H2_SETTINGS, 0, 0)
+        && m_client.write(settings, sizeof settings) == sizeof settings
+        && m_write_u32_frame(H2_WINDOW_UPDATE, 0, static_cast<uint32_t>(H2_MAX_WINDOW - H2_DEFAULT_WINDOW));
+    if (!ok) m_fail(H2_NO_ERROR);
+    return ok;
+}
+
+bool SSLHttp2Client::m_service(int stream, bool block) {
+    unsigned long last = millis();
+    while (m_connected) {
+        if (stream >= 0 && m_streams[stream].state != STREAM_OPEN) return true;
+        size_t len;
+        const uint8_t* data = m_client.peekBuffer(len);
+        if (data != nullptr) {
+            m_client.consume(m_receive(data, len));
+            m_send_control();
+            last = millis();
+            continue;
+        }
+        if (!m_client.connected()) {
+            m_fail(H2_NO_ERROR);
+            return false;
+        }
+        if (!block || millis() - last > m_timeout) return !block;
+    }
+    return false;
+}
+
+bool SSLHttp2Client::m_make_room(size_t len) {
+    unsigned long last = millis();
+    while (m_connected) {
+        const int room = m_client.availableForWrite();
+        if (room > 0 && static_cast<size_t>(room) >= len) return true;
+        // reading whatever arrived frees the buffer, and sends what was written
+        size_t avail;
+        const uint8_t* data = m_client.peekBuffer(avail);
+        if (data != nullptr) {
+            m_client.consume(m_receive(data, avail));
+            last = millis();
+            continue;
+        }
+        if (!m_client.connected() || millis() - last > m_timeout) {
+            m_fail(H2_NO_ERROR);
+            return false;
+        }
+    }
+    return false;
+}
+
+size_t SSLHttp2Client::m_receive(const uint8_t* data, size_t len) {
+    size_t used = 0;
+    while (used < len && m_connected) {
+        if (m_rx_header_len < H2_FRAME_HEADER_LEN) {
+            m_rx_header[m_rx_header_len++] = data[used++];
+            if (m_rx_header_len < H2_FRAME_HEADER_LEN) continue;
+            if (!m_begin_frame()) break;
+        }
+        else {
+            const size_t n = len - used < m_rx_left ? len - used : m_rx_left;
+            const uint8_t* p = data + used;
+            size_t i = 0;
+            while (i < n && m_connected) {
+                if (m_rx_pad_next) {
+                    // the pad length can't cover the priority fields or more
+                    m_rx_pad = p[i++];
+                    m_rx_left--;
+                    m_rx_pad_next = false;
+                    if (m_rx_pad > m_rx_left - m_rx_skip) m_fail(H2_PROTOCOL_ERROR);
+                }
+                else if (m_rx_skip > 0) {
+                    i++;
+                    m_rx_left--;
+                    m_rx_skip--;
+                }
+                else if (m_rx_left > m_rx_pad) {
+                    const size_t content = m_rx_left - m_rx_pad;
+                    const size_t k = n - i < content ? n - i : content;
+                    if (!m_frame_payload(p + i, k)) break;
+                    i += k;
+                    m_rx_left -= static_cast<uint32_t>(k);
+                }
+                else {
+                    // padding
+                    m_rx_left -= static_cast<uint32_t>(n - i);
+                    i = n;
+                }
+            }
+            used += i;
+        }
+        if (m_connected && m_rx_left == 0) {
+            m_rx_header_len = 0;
+            if (!m_end_frame()) break;
+        }
+    }
+    return used;
+}
+
+bool SSLHttp2Client::m_begin_frame() {
+    const uint8_t* h = m_rx_header;
+    m_rx_len = (static_cast<uint32_t>(h[0]) << 16) | (static_cast<uint32_t>(h[1]) << 8) | h[2];
+    m_rx_type = h[3];
+    m_rx_flags = h[4];
+    m_rx_stream_id = h2_get_u32(h + 5) & H2_MAX_STREAM_ID;
+    m_rx_left = m_rx_len;
+    m_rx_pad = 0;
+    m_rx_skip = 0;
+    m_rx_pad_next = false;
+    m_ctl_len = 0;
+    uint32_t error = H2_NO_ERROR;
+    if (m_rx_len > H2_MAX_FRAME_SIZE)
+        error = H2_FRAME_SIZE_ERROR;
+    // nothing may come between the frames of a header block
+    else if (m_block_stream_id != 0 && (m_rx_type != H2_CONTINUATION || m_rx_stream_id != m_block_stream_id))
+        error = H2_PROTOCOL_ERROR;
+    else {
+        switch (m_rx_type) {
+        case H2_DATA:
+        case H2_HEADERS:
+            if (m_rx_stream_id == 0) error = H2_PROTOCOL_ERROR;
+            if (m_rx_flags & H2_PADDED) {
+                if (m_rx_len == 0) error = H2_FRAME_SIZE_ERROR;
+                m_rx_pad_next = true;
+            }
+            if (m_rx_type == H2_HEADERS) {
+                if (m_rx_flags & H2_PRIORITY) m_rx_skip = 5;
+                if (m_rx_skip + (m_rx_pad_next ? 1u : 0u) > m_rx_len) error = H2_FRAME_SIZE_ERROR;
+                m_block_stream_id = m_rx_stream_id;
+                m_block_end_stream = (m_rx_flags & H2_END_STREAM) != 0;
+                m_block_slot = m_find(m_rx_stream_id);
+                m_block_len = 0;
+            }
+            break;
+        case H2_CONTINUATION:
+            if (m_block_stream_id == 0) error = H2_PROTOCOL_ERROR;
+            break;
+        case H2_SETTINGS:
+            if (m_rx_stream_id != 0) error = H2_PROTOCOL_ERROR;
+            else if ((m_rx_flags & H2_ACK) ? m_rx_len != 0 : m_rx_len % 6 != 0) error = H2_FRAME_SIZE_ERROR;
+            break;
+        case H2_PING:
+            if (m_rx_stream_id != 0) error = H2_PROTOCOL_ERROR;
+            else if (m_rx_len != 8) error = H2_FRAME_SIZE_ERROR;
+            break;
+        case H2_GOAWAY:
+            if (m_rx_stream_id != 0) error = H2_PROTOCOL_ERROR;
+            else if (m_rx_len < 8) error = H2_FRAME_SIZE_ERROR;
+            break;
+        case H2_RST_STREAM:
+        case H2_WINDOW_UPDATE:
+            if (m_rx_type == H2_RST_STREAM && m_rx_stream_id == 0) error = H2_PROTOCOL_ERROR;
+            else if (m_rx_len != 4) error = H2_FRAME_SIZE_ERROR;
+            break;
+        case H2_PUSH_PROMISE:
+            // we turned push off
+            error = H2_PROTOCOL_ERROR;
+            break;
+        default:
+            // PRIORITY, and unknown frame types, are ignored
+            break;
+        }
+    }
+    if (error != H2_NO_ERROR) {
+        m_fail(error);
+        return false;
+    }
+    return true;
+}
+
+bool SSLHttp2Client::m_frame_payload(const uint8_t* data, size_t len) {
+    switch (m_rx_type) {
+    case H2_DATA: {
+        const int slot = m_find(m_rx_stream_id);
+        if (slot >= 0 && m_streams[slot].state == STREAM_OPEN && m_listener != nullptr)
+            m_listener->onData(slot, data, len);
+        return true;
+    }
+    case H2_HEADERS:
+    case H2_CONTINUATION:
+        // the block has to be decoded to keep the tables in sync, so it can't be skipped
+        if (m_block_len + len > sizeof m_block) {
+            m_fail(H2_ENHANCE_YOUR_CALM);
+            return false;
+        }
+        memcpy(m_block + m_block_len, data, len);
+        m_block_len += len;
+        return true;
+    case H2_SETTINGS:
+        for (size_t i = 0; i < len; i++) {
+            m_ctl[m_ctl_len++] = data[i];
+            if (m_ctl_len < 6) continue;
+            m_ctl_len = 0;
+            if (!m_setting(static_cast<uint16_t>((m_ctl[0] << 8) | m_ctl[1]), h2_get_u32(m_ctl + 2))) return false;
+        }
+        return true;
+    case H2_PING:
+    case H2_GOAWAY:
+    case H2_RST_STREAM:
+    case H2_WINDOW_UPDATE:
+        // only the first eight bytes matter (GOAWAY may have debug data after them)
+        for (size_t i = 0; i < len && m_ctl_len < sizeof m_ctl; i++) m_ctl[m_ctl_len++] = data[i];
+        return true;
+    default:
+        return true;
+    }
+}
+
+bool SSLHttp2Client::m_end_frame() {
+    switch (m_rx_type) {
+    case H2_DATA: {
+        // padding counts too
+        m_received += m_rx_len;
+        if (m_received >= static_cast<uint32_t>(H2_MAX_WINDOW / 2)) m_window_pending = true;
+        const int slot = m_find(m_rx_stream_id);
+        if (slot >= 0 && (m_rx_flags & H2_END_STREAM)) m_close_stream(slot, false);
+        return true;
+    }
+    case H2_HEADERS:
+    case H2_CONTINUATION: {
+        if (!(m_rx_flags & H2_END_HEADERS)) return true;
+        FieldHandler handler(*this);
+        if (!m_hpack.decode(m_block, m_block_len, handler)) {
+            m_fail(H2_COMPRESSION_ERROR);
+            return false;
+        }
+        m_block_stream_id = 0;
+        if (m_block_slot >= 0 && m_block_end_stream) m_close_stream(m_block_slot, false);
+        return true;
+    }
+    case H2_SETTINGS:
+        if (!(m_rx_flags & H2_ACK)) m_settings_acks++;
+        return true;
+    case H2_PING:
+        if (!(m_rx_flags & H2_ACK)) {
+            memcpy(m_ping, m_ctl, sizeof m_ping);
+            m_ping_pending = true;
+        }
+        return true;
+    case H2_GOAWAY: {
+        // streams after the last one the server handled were never processed
+        const uint32_t last = h2_get_u32(m_ctl) & H2_MAX_STREAM_ID;
+        m_goaway = true;
+        for (size_t i = 0; i < MAX_STREAMS; i++) {
+            if (m_streams[i].state == STREAM_OPEN && m_streams[i].id > last) m_close_stream(static_cast<int>(i), true);
+        }
+        return true;
+    }
+    case H2_RST_STREAM: {
+        const int slot = m_find(m_rx_stream_id);
+        if (slot >= 0) m_close_stream(slot, true);
+        return true;
+    }
+    case H2_WINDOW_UPDATE: {
+        const int32_t increment = static_cast<int32_t>(h2_get_u32(m_ctl) & H2_MAX_STREAM_ID);
+        if (m_rx_stream_id == 0) {
+            if (increment == 0 || m_send_window > H2_MAX_WINDOW - increment) {
+                m_fail(increment == 0 ? H2_PROTOCOL_ERROR : H2_FLOW_CONTROL_ERROR);
+                return false;
+            }
+            m_send_window += increment;
+            return true;
+        }
+        const int slot = m_find(m_rx_stream_id);
+        if (slot < 0) return true;
+        Stream& stream = m_streams[slot];
+        if (increment == 0 || stream.send_window > H2_MAX_WINDOW - increment) {
+            m_close_stream(slot, true);
+            m_reset_stream(stream.id, increment == 0 ? H2_PROTOCOL_ERROR : H2_FLOW_CONTROL_ERROR);
+        }
+        else stream.send_window += increment;
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+bool SSLHttp2Client::m_setting(uint16_t id, uint32_t value) {
+    switch (id) {
+    case H2_SETTINGS_HEADER_TABLE_SIZE:
+        m_hpack.setEncoderLimit(value);
+        break;
+    case H2_SETTINGS_MAX_CONCURRENT_STREAMS:
+        m_max_streams = value < MAX_STREAMS ? value : MAX_STREAMS;
+        break;
+    case H2_SETTINGS_INITIAL_WINDOW_SIZE: {
+        if (value > static_cast<uint32_t>(H2_MAX_WINDOW)) {
+            m_fail(H2_FLOW_CONTROL_ERROR);
+            return false;
+        }
+        // applies to the streams already open too
+        const int32_t delta = static_cast<int32_t>(value) - m_initial_window;
+        for (size_t i = 0; i < MAX_STREAMS; i++) {
+            if (m_streams[i].state == STREAM_OPEN) m_streams[i].send_window += delta;
+        }
+        m_initial_window = static_cast<int32_t>(value);
+        break;
+    }
+    default:
+        // the rest only limit what the server receives, which we stay well under
+        break;
+    }
+    return true;
+}
+
+bool SSLHttp2Client::m_write_header(uint32_t len, uint8_t type, uint8_t flags, uint32_t stream_id) {
+    uint8_t header[H2_FRAME_HEADER_LEN];
+    header[0] = static_cast<uint8_t>(len >> 16);
+    header[1] = static_cast<uint8_t>(len >> 8);
+    header[2] = static_cast<uint8_t>(len);
+    header[3] = type;
+    header[4] = flags;
+    h2_put_u32(header + 5, stream_id);
+    return m_client.write(header, sizeof header) == sizeof header;
+}
+
+bool SSLHttp2Client::m_write_u32_frame(uint8_t type, uint32_t stream_id, uint32_t value) {
+    uint8_t payload[4];
+    h2_put_u32(payload, value);
+    return m_write_header(sizeof payload, type, 0, stream_id) && m_client.write(payload, sizeof payload) == sizeof payload;
+}
+
+bool SSLHttp2Client::m_send_body(int slot, const uint8_t* body, size_t len) {
+    Stream& stream = m_streams[slot];
+    unsigned long last = millis();
+    while (len > 0) {
+        // the server may answer before it has the whole body
+        if (stream.state != STREAM_OPEN) return stream.state == STREAM_DONE;
+        int32_t window = m_send_window < stream.send_window ? m_send_window : stream.send_window;
+        const int room = m_connected ? m_client.availableForWrite() - static_cast<int>(H2_FRAME_HEADER_LEN) : 0;
+        if (window <= 0 || room <= 0) {
+            // wait for a WINDOW_UPDATE, or for the last frames to leave
+            if (!m_service(-1, false)) return false;
+            if (millis() - last > m_timeout) return false;
+            continue;
+        }
+        // only write what fits, so writing never has to wait on received data
+        size_t n = len;
+        if (n > static_cast<size_t>(window)) n = static_cast<size_t>(window);
+        if (n > static_cast<size_t>(room)) n = static_cast<size_t>(room);
+        if (n > H2_MAX_FRAME_SIZE) n = H2_MAX_FRAME_SIZE;
+        if (!m_write_header(static_cast<uint32_t>(n), H2_DATA, n == len ? H2_END_STREAM : 0, stream.id)
+            || m_client.write(body, n) != n) {
+            m_fail(H2_NO_ERROR);
+            return false;
+        }
+        m_send_window -= static_cast<int32_t>(n);
+        stream.send_window -= static_cast<int32_t>(n);
+        body += n;
+        len -= n;
+        last = millis();
+    }
+    return true;
+}
+
+void SSLHttp2Client::m_send_control() {
+    if (!m_connected || m_writing_block) return;
+    if (m_settings_acks == 0 && !m_ping_pending && !m_window_pending) return;
+    // a SETTINGS ack, a PING ack and a WINDOW_UPDATE at most
+    const int room = m_client.availableForWrite();
+    if (room < static_cast<int>(3 * H2_FRAME_HEADER_LEN + 8 + 4)) return;
+    bool ok = true;
+    for (; ok && m_settings_acks > 0; m_settings_acks--) ok = m_write_header(0, H2_SETTINGS, H2_ACK, 0);
+    if (ok && m_ping_pending) {
+        ok = m_write_header(sizeof m_ping, H2_PING, H2_ACK, 0) && m_client.write(m_ping, sizeof m_ping) == sizeof m_ping;
+        m_ping_pending = false;
+    }
+    if (ok && m_window_pending) {
+        ok = m_write_u32_frame(H2_WINDOW_UPDATE, 0, m_received);
+        m_received = 0;
+        m_window_pending = false;
+    }
+    if (!ok) m_fail(H2_NO_ERROR);
+}
+
+void SSLHttp2Client::m_reset_stream(uint32_t stream_id, uint32_t error) {
+    if (!m_connected) return;
+    // nothing may be sent between the frames of a header block
+    if (m_writing_block) {
+        // each stream is reset at most once, so this never fills up
+        if (m_reset_count < MAX_STREAMS) {
+            m_resets[m_reset_count].id = stream_id;
+            m_resets[m_reset_count].error = error;
+            m_reset_count++;
+        }
+        return;
+    }
+    if (!m_make_room(H2_FRAME_HEADER_LEN + 4) || !m_write_u32_frame(H2_RST_STREAM, stream_id, error))
+        m_fail(H2_NO_ERROR);
+}
+
+void SSLHttp2Client::m_send_resets() {
+    const uint8_t count = m_reset_count;
+    m_reset_count = 0;
+    for (uint8_t i = 0; i < count; i++) m_reset_stream(m_resets[i].id, m_resets[i].error);
+}
+
+int SSLHttp2Client::m_find(uint32_t id) const {
+    for (size_t i = 0; i < MAX_STREAMS; i++) {
+        if (m_streams[i].state != STREAM_FREE && m_streams[i].id == id) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void SSLHttp2Client::m_close_stream(int slot, bool failed) {
+    Stream& stream = m_streams[slot];
+    if (stream.state != STREAM_OPEN) return;
+    stream.state = failed ? STREAM_FAILED : STREAM_DONE;
+    if (m_listener != nullptr) m_listener->onClose(slot);
+    // once a closing connection has nothing left open, it can go
+    if (m_goaway) {
+        for (size_t i = 0; i < MAX_STREAMS; i++) {
+            if (m_streams[i].state == STREAM_OPEN) return;
+        }
+        m_connected = false;
+        m_client.stop();
+    }
+}
+
+void SSLHttp2Client::m_fail(uint32_t error) {
+    if (!m_connected) return;
+    // say why, if there is room to without waiting (and not in the middle of a header block)
+    if (!m_writing_block && m_client.connected()
+        && m_client.availableForWrite() >= static_cast<int>(H2_FRAME_HEADER_LEN + 8)) {
+        uint8_t payload[8];
+        // the last stream we processed: the server cannot open streams (push is off)
+        h2_put_u32(payload, 0);
+        h2_put_u32(payload + 4, error);
+        if (m_write_header(sizeof payload, H2_GOAWAY, 0, 0)) m_client.write(payload, sizeof payload);
+    }
+    m_connected = false;
+    m_client.stop();
+    for (size_t i = 0; i < MAX_STREAMS; i++) {
+        if (m_streams[i].state == STREAM_OPEN) m_close_stream(static_cast<int>(i), true);
+    }
+}
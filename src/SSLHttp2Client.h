@@ -0,0 +1,310 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLHttp2Client.h
+ *
+ * A small HTTP/2 client on top of SSLClient that runs several requests at
+ * once over one connection.
+ */
+
+#include "SSLClient.h"
+#include "SSLHpack.h"
+
+#ifndef SSLHttp2Client_H_
+#define SSLHttp2Client_H_
+
+/**
+ * @brief Receives the responses of an SSLHttp2Client.
+ *
+ * The responses to concurrent requests arrive interleaved, so they are handed out as they
+ * come instead of being read one at a time.
+ */
+class SSLHttp2Listener {
+public:
+    virtual ~SSLHttp2Listener() {}
+    /**
+     * @brief Called for each header of a response (including ":status"), and for its
+     * trailers if it has any. The strings are only valid during the call.
+     */
+    virtual void onHeader(int /* stream */, const char* /* name */, const char* /* value */) {}
+    /**
+     * @brief Called with each piece of a response's body. The data points into
+     * SSLClient's receive buffer, and is only valid during the call.
+     */
+    virtual void onData(int /* stream */, const uint8_t* /* data */, size_t /* len */) {}
+    /** @brief Called once a response is complete, or has failed (see SSLHttp2Client::failed). */
+    virtual void onClose(int /* stream */) {}
+};
+
+/**
+ * @brief HTTP/2 requests, several at a time, over one SSLClient connection.
+ *
+ * HTTP/2 is negotiated with ALPN (see SSLClient::setAlpnProtocols), and every request is
+ * a stream of the same connection, so a burst of requests shares one handshake and their
+ * responses can arrive in any order. Headers are compressed with HPACK (see SSLHpack),
+ * so headers repeated on every request cost a few bytes after the first one:
+ * ```C++
+ * SSLHttp2Client http(client, "api.example.com");
+ * int a = http.get("/a", "Authorization: Bearer abc\r\n");
+ * int b = http.get("/b", "Authorization: Bearer abc\r\n");
+ * http.wait(a);
+ * http.wait(b);
+ * Serial.println(http.status(a));
+ * http.release(a);
+ * http.release(b);
+ * ```
+ * Request functions return a stream handle, from 0 to MAX_STREAMS - 1, that stays in use
+ * until it is given back with SSLHttp2Client::release. Response headers and bodies are
+ * passed to an SSLHttp2Listener as they are received, whenever the connection is
+ * serviced by SSLHttp2Client::poll or SSLHttp2Client::wait.
+ *
+ * Requests are buffered by SSLClient, so requests made one after the other usually
+ * leave together. If the server does not support HTTP/2, connecting fails.
+ */
+class SSLHttp2Client {
+public:
+    /** @brief The most requests that can be open at once */
+    static constexpr size_t MAX_STREAMS = SSLCLIENT_H2_MAX_STREAMS;
+
+    /**
+     * @brief Create an HTTP/2 client using an SSLClient.
+     * @param client The SSLClient to send the requests with. SSLHttp2Client sets its ALPN
+     * protocols and connects it when needed, and it should not be used for anything else
+     * meanwhile.
+     * @param host The server's hostname, sent as the :authority of every request. It is
+     * not copied, and must stay valid for the life of this object.
+     * @param port The server's port.
+     */
+    SSLHttp2Client(SSLClient& client, const char* host, uint16_t port = 443);
+
+    /**
+     * @brief Start a request, connecting first if needed.
+     *
+     * The request is buffered by SSLClient and is only sure to be sent after
+     * SSLHttp2Client::flush, SSLHttp2Client::poll or SSLHttp2Client::wait. A body larger
+     * than the server lets us send at once is sent as the server makes room for it, which
+     * waits for the server like SSLHttp2Client::wait.
+     *
+     * @param method The method, such as "GET" or "POST".
+     * @param path The path and query, starting with "/".
+     * @param headers Extra header lines, each ending with "\r\n", or nullptr. Names are
+     * lowercased, and connection specific headers (such as Connection) are not allowed.
+     * @param body The request body, or nullptr.
+     * @param body_len The length of the body in bytes.
+     * @returns The stream handle of the request, or -1 if the connection could not be
+     * opened, the request could not be sent, or MAX_STREAMS streams are in use.
+     */
+    int request(const char* method, const char* path, const char* headers = nullptr,
+                const void* body = nullptr, size_t body_len = 0);
+
+    /** @brief Start a GET request (see SSLHttp2Client::request). */
+    int get(const char* path, const char* headers = nullptr) { return request("GET", path, headers); }
+
+    /** @brief Send any requests that are still buffered. Returns false on error. */
+    bool flush();
+
+    /**
+     * @brief Send buffered requests, and handle whatever the server sent, without waiting.
+     * @returns false if the connection failed.
+     */
+    bool poll();
+
+    /**
+     * @brief Handle what the server sends until a response is complete.
+     * @returns true if the response arrived, false if it failed or timed out.
+     */
+    bool wait(int stream);
+
+    /** @brief Returns true once a stream's response is complete, or has failed. */
+    bool done(int stream) const;
+
+    /**
+     * @brief Returns true if a stream failed: it was reset, the connection closed before
+     * the response was complete, or a wait for it timed out.
+     */
+    bool failed(int stream) const;
+
+    /** @brief Returns the status code of a stream's response, or 0 if its headers have not arrived. */
+    int status(int stream) const;
+
+    /** @brief Returns the content-length of a stream's response, or -1 if it did not have one. */
+    long contentLength(int stream) const;
+
+    /**
+     * @brief Give back a stream handle, cancelling the request if it is still open.
+     *
+     * The handle may be returned again by the next request.
+     */
+    void release(int stream);
+
+    /** @brief Returns the number of stream handles in use. */
+    size_t streams() const;
+
+    /** @brief Set the object that receives response headers and bodies. */
+    void setListener(SSLHttp2Listener* listener) { m_listener = listener; }
+
+    /** @brief Set how long to wait for data from the server, in milliseconds (default 10000). */
+    void setTimeout(unsigned long timeout) { m_timeout = timeout; }
+
+    /** @brief Close the connection, failing any open streams. */
+    void stop();
+
+private:
+    enum StreamState : uint8_t {
+        STREAM_FREE,
+        STREAM_OPEN,
+        STREAM_DONE,
+        STREAM_FAILED,
+    };
+
+    struct Stream {
+        uint32_t id;
+        StreamState state;
+        int status;
+        long content_length;
+        // flow control: what we may still send on the stream
+        int32_t send_window;
+    };
+
+    /** Collects a header block and writes it as HEADERS and CONTINUATION frames */
+    class HeaderWriter : public Print {
+    public:
+        HeaderWriter(SSLHttp2Client& client, uint32_t stream_id, bool end_stream);
+        size_t write(uint8_t b) override;
+        using Print::write;
+        /** write what is left with END_HEADERS, returns false if anything failed */
+        bool finish();
+    private:
+        bool m_flush(bool last);
+        SSLHttp2Client& m_h2;
+        const uint32_t m_stream_id;
+        const bool m_end_stream;
+        bool m_first;
+        bool m_ok;
+        size_t m_len;
+        uint8_t m_buf[128];
+    };
+
+    /** Passes decoded header fields to the stream being received */
+    class FieldHandler : public SSLHpack::Handler {
+    public:
+        explicit FieldHandler(SSLHttp2Client& client) : m_h2(client) {}
+        void field(const char* name, const char* value) override;
+    private:
+        SSLHttp2Client& m_h2;
+    };
+
+    /** open the connection and send the preface, false on failure */
+    bool m_connect();
+    /**
+     * handle received data until a stream is done (stream >= 0), or until nothing more
+     * has arrived (stream -1), returns false if the connection failed or a blocking
+     * wait timed out
+     */
+    bool m_service(int stream, bool block);
+    /**
+     * handle received data until len bytes can be written without SSLClient waiting
+     * for the server, which would discard what was received meanwhile
+     */
+    bool m_make_room(size_t len);
+    /** handle received bytes, returns how many were used */
+    size_t m_receive(const uint8_t* data, size_t len);
+    /** a frame header arrived */
+    bool m_begin_frame();
+    /** the payload of the current frame (after its padding and priority fields) */
+    bool m_frame_payload(const uint8_t* data, size_t len);
+    /** the current frame is complete */
+    bool m_end_frame();
+    /** a SETTINGS parameter arrived */
+    bool m_setting(uint16_t id, uint32_t value);
+    /** write a frame header */
+    bool m_write_header(uint32_t len, uint8_t type, uint8_t flags, uint32_t stream_id);
+    /** write a frame with a payload of four bytes */
+    bool m_write_u32_frame(uint8_t type, uint32_t stream_id, uint32_t value);
+    /** send a request's body as DATA frames, as flow control allows */
+    bool m_send_body(int slot, const uint8_t* body, size_t len);
+    /** send the acks and window updates that are due, if they fit without waiting */
+    void m_send_control();
+    /** tell the server we gave up on a stream, once any header block being written is done */
+    void m_reset_stream(uint32_t stream_id, uint32_t error);
+    /** send the stream resets held back while a header block was written */
+    void m_send_resets();
+    /** find the stream for an id, or -1 */
+    int m_find(uint32_t id) const;
+    /** a stream is complete (or failed) */
+    void m_close_stream(int slot, bool failed);
+    /** close the connection with an error, failing every open stream */
+    void m_fail(uint32_t error);
+
+    SSLClient& m_client;
+    const char* m_host;
+    const uint16_t m_port;
+    unsigned long m_timeout;
+    SSLHttp2Listener* m_listener;
+    SSLHpack m_hpack;
+    Stream m_streams[MAX_STREAMS];
+    // connection state
+    bool m_connected;
+    bool m_goaway;
+    uint32_t m_next_id;
+    uint32_t m_max_streams;
+    int32_t m_send_window;
+    int32_t m_initial_window;
+    // DATA received since the connection window was last topped up
+    uint32_t m_received;
+    bool m_window_pending;
+    // set while the frames of a header block are written
+    bool m_writing_block;
+    // control frames waiting for room in the write buffer
+    uint8_t m_settings_acks;
+    // streams to reset once the header block being written is done
+    struct {
+        uint32_t id;
+        uint32_t error;
+    } m_resets[MAX_STREAMS];
+    uint8_t m_reset_count;
+    uint8_t m_ping[8];
+    bool m_ping_pending;
+    // the frame being received: its header, what is left of its payload, the
+    // padding at its end and the bytes to skip at its start
+    uint8_t m_rx_header[9];
+    uint8_t m_rx_header_len;
+    uint8_t m_rx_type;
+    uint8_t m_rx_flags;
+    uint32_t m_rx_stream_id;
+    uint32_t m_rx_len;
+    uint32_t m_rx_left;
+    uint8_t m_rx_pad;
+    uint8_t m_rx_skip;
+    bool m_rx_pad_next;
+    // the stream a header block is being received for (0 if none), and whether
+    // its HEADERS frame ended the stream
+    uint32_t m_block_stream_id;
+    bool m_block_end_stream;
+    int m_block_slot;
+    // small control frames, and the header block being collected
+    uint8_t m_ctl[8];
+    uint8_t m_ctl_len;
+    uint8_t m_block[SSLCLIENT_H2_MAX_HEADER_BLOCK];
+    size_t m_block_len;
+};
+
+#endif /* SSLHttp2Client_H_ */
@@ -0,0 +1,424 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLHttpClient.h"
+#include <limits.h>
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+constexpr size_t SSLHttpClient::MAX_PIPELINE;
+
+// headers that matter for the connection, lowercase, one bit each in m_header
+static const char* const http_headers[] = { "content-length", "transfer-encoding", "connection" };
+static const uint8_t HTTP_CONTENT_LENGTH = 1 << 0;
+static const uint8_t HTTP_TRANSFER_ENCODING = 1 << 1;
+static const uint8_t HTTP_CONNECTION = 1 << 2;
+static const uint8_t HTTP_ANY_HEADER = 0x7;
+
+static char http_lower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+/**
+ * Advance the match of token in a header value by one character. None of the
+ * tokens we look for repeat their first letter, so on a mismatch the match
+ * can only restart at that letter. A complete match stays complete.
+ */
+static uint8_t http_match_token(const char* token, uint8_t pos, char c) {
+    if (token[pos] == '\0') return pos;
+    c = http_lower(c);
+    if (token[pos] == c) return pos + 1;
+    return token[0] == c ? 1 : 0;
+}
+
+static size_t http_format_ulong(char* buf, unsigned long v) {
+    char tmp[10 * sizeof v / 4 + 1];
+    size_t n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    for (size_t i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    buf[n] = '\0';
+    return n;
+}
+
+/* see SSLHttpClient.h */
+SSLHttpClient::SSLHttpClient(SSLClient& client, const char* host, uint16_t port)
+    : m_client(client)
+    , m_host(host)
+    , m_port(port)
+    , m_timeout(10000)
+    , m_pending(0)
+    , m_head_mask(0)
+    , m_reconnect(true)
+    , m_state(STATE_IDLE)
+    , m_status(0)
+    , m_content_length(-1)
+    , m_chunked(false)
+    , m_keep_alive(false)
+    , m_http10(false)
+    , m_field(0)
+    , m_header(0)
+    , m_match(0)
+    , m_token(0)
+    , m_chunk(CHUNK_SIZE)
+    , m_remaining(0)
+    , m_until_close(false) {}
+
+/* see SSLHttpClient.h */
+bool SSLHttpClient::request(const char* method, const char* path, const char* headers,
+                            const void* body, size_t body_len) {
+    if (m_pending >= MAX_PIPELINE) return false;
+    // reopen the connection if the server closed it, or said it would
+    if (m_reconnect || !m_client.connected()) {
+        // responses still owed on the old connection will never come
+        if (m_pending > 0 || m_state != STATE_IDLE) m_fail();
+        m_client.stop();
+        if (!m_client.connect(m_host, m_port)) return false;
+        m_reconnect = false;
+    }
+    char num[12];
+    bool ok = m_client.print(method) > 0
+        && m_client.print(' ') > 0
+        && m_client.print(path) > 0
+        && m_client.print(" HTTP/1.1\r\nHost: ") > 0
+        && m_client.print(m_host) > 0;
+    if (ok && m_port != 443) {
+        http_format_ulong(num, m_port);
+        ok = m_client.print(':') > 0 && m_client.print(num) > 0;
+    }
+    ok = ok && m_client.print("\r\n") > 0;
+    // methods that carry a body need a length even when it is empty, or the
+    // server may wait for one
+    const bool send_length = body_len > 0 || body != nullptr
+        || strcmp(method, "POST") == 0 || strcmp(method, "PUT") == 0 || strcmp(method, "PATCH") == 0;
+    if (ok && send_length) {
+        http_format_ulong(num, body_len);
+        ok = m_client.print("Content-Length: ") > 0 && m_client.print(num) > 0 && m_client.print("\r\n") > 0;
+    }
+    if (ok && headers != nullptr && headers[0] != '\0') ok = m_client.print(headers) > 0;
+    ok = ok && m_client.print("\r\n") > 0;
+    if (ok && body_len > 0) ok = m_client.write(static_cast<const uint8_t*>(body), body_len) == body_len;
+    if (!ok) {
+        m_fail();
+        return false;
+    }
+    if (strcmp(method, "HEAD") == 0) m_head_mask |= static_cast<uint32_t>(1) << m_pending;
+    m_pending++;
+    return true;
+}
+
+/* see SSLHttpClient.h */
+bool SSLHttpClient::flush() {
+    m_client.flush();
+    return m_client.getWriteError() == SSLClient::SSL_OK;
+}
+
+/* see SSLHttpClient.h */
+bool SSLHttpClient::readResponse() {
+    // skip whatever is left of the last response
+    if (m_state == STATE_BODY) {
+        size_t len;
+        while (readBody(len) != nullptr) {}
+        if (m_state != STATE_IDLE) return false;
+    }
+    if (m_pending == 0) return false;
+    if (!flush()) {
+        m_fail();
+        return false;
+    }
+    m_state = STATE_STATUS;
+    m_status = 0;
+    m_field = 0;
+    m_match = 0;
+    m_http10 = false;
+    m_content_length = -1;
+    m_chunked = false;
+    m_until_close = false;
+    for (;;) {
+        size_t len;
+        const uint8_t* data = m_client.peekBuffer(len);
+        if (data == nullptr) {
+            if (!m_wait()) {
+                m_fail();
+                return false;
+            }
+            continue;
+        }
+        size_t used = 0;
+        bool done = false;
+        while (used < len && !done) done = m_parse_head(static_cast<char>(data[used++]));
+        m_client.consume(used);
+        if (!done) continue;
+        if (m_status < 100) {
+            // not an HTTP response, or one we cannot read
+            m_fail();
+            return false;
+        }
+        // 100 Continue and friends come before the real response
+        if (m_status < 200 && m_status != 101) {
+            m_state = STATE_STATUS;
+            m_status = 0;
+            m_field = 0;
+            m_match = 0;
+            continue;
+        }
+        break;
+    }
+    m_state = STATE_BODY;
+    m_remaining = 0;
+    if ((m_head_mask & 1) || m_status == 204 || m_status == 304) {
+        // no body, whatever the headers say
+    }
+    else if (m_chunked)
+        m_chunk = CHUNK_SIZE;
+    else if (m_content_length >= 0)
+        m_remaining = static_cast<unsigned long>(m_content_length);
+    else {
+        // the body ends when the server closes the connection
+        m_until_close = true;
+        m_keep_alive = false;
+    }
+    if (!m_until_close && !m_chunked && m_remaining == 0) m_finish_response();
+    return true;
+}
+
+/* see SSLHttpClient.h */
+const uint8_t* SSLHttpClient::readBody(size_t& len) {
+    return m_body(static_cast<size_t>(-1), len);
+}
+
+/* see SSLHttpClient.h */
+size_t SSLHttpClient::readBody(uint8_t* buf, size_t size) {
+    size_t len;
+    const uint8_t* data = m_body(size, len);
+    if (data == nullptr) return 0;
+    memcpy(buf, data, len);
+    return len;
+}
+
+/* see SSLHttpClient.h */
+void SSLHttpClient::stop() {
+    m_fail();
+}
+
+/* see SSLHttpClient.h */
+bool SSLHttpClient::m_wait() {
+    const unsigned long start = millis();
+    do {
+        if (m_client.available() > 0) return true;
+        if (!m_client.connected()) return false;
+    } while (millis() - start < m_timeout);
+    return false;
+}
+
+/* see SSLHttpClient.h */
+const uint8_t* SSLHttpClient::m_body(size_t max, size_t& len) {
+    len = 0;
+    while (m_state == STATE_BODY) {
+        if (!m_until_close && !m_chunked && m_remaining == 0) {
+            m_finish_response();
+            break;
+        }
+        size_t avail;
+        const uint8_t* data = m_client.peekBuffer(avail);
+        if (data == nullptr) {
+            if (m_wait()) continue;
+            // a body without a length ends when the connection does
+            if (m_until_close && !m_client.connected()) {
+                m_finish_response();
+                break;
+            }
+            m_fail();
+            return nullptr;
+        }
+        // chunk sizes and line endings are consumed without being handed out
+        if (m_chunked && m_chunk != CHUNK_DATA) {
+            size_t used = 0;
+            while (used < avail && m_state == STATE_BODY && m_chunk != CHUNK_DATA)
+                m_parse_chunk(static_cast<char>(data[used++]));
+            m_client.consume(used);
+            continue;
+        }
+        size_t n = avail < max ? avail : max;
+        if (!m_until_close && n > m_remaining) n = m_remaining;
+        // acknowledging does not touch the buffer, so the data stays valid
+        // until the engine runs again
+        m_client.consume(n);
+        if (!m_until_close) m_remaining -= n;
+        if (m_chunked && m_remaining == 0) m_chunk = CHUNK_DATA_END;
+        len = n;
+        return data;
+    }
+    return nullptr;
+}
+
+/* see SSLHttpClient.h */
+bool SSLHttpClient::m_parse_head(char c) {
+    if (c == '\r') return false;
+    switch (m_state) {
+    case STATE_STATUS:
+        // HTTP-version SP status-code SP reason-phrase
+        if (c == '\n') {
+            // tolerate empty lines before the status line
+            if (m_field == 0 && m_match == 0) return false;
+            if (m_status == 0) return true;
+            m_state = STATE_HEADER_NAME;
+            m_keep_alive = !m_http10;
+            m_field = 0;
+            m_header = HTTP_ANY_HEADER;
+            m_match = 0;
+        }
+        else if (m_field == 0) {
+            if (c == ' ') m_field = 1;
+            else if (m_match++ == 7) m_http10 = c == '0';
+        }
+        else if (m_field == 1) {
+            if (c >= '0' && c <= '9' && m_status < 1000) m_status = m_status * 10 + (c - '0');
+            else if (m_status > 0) m_field = 2;
+        }
+        return false;
+    case STATE_HEADER_NAME:
+        if (c == '\n') {
+            // an empty line ends the headers
+            if (m_field == 0) return true;
+            m_field = 0;
+            m_header = HTTP_ANY_HEADER;
+            m_match = 0;
+        }
+        else if (c == ':') {
+            // keep only the header whose whole name matched
+            uint8_t header = 0;
+            for (uint8_t i = 0; i < 3; i++) {
+                if ((m_header & (1 << i)) && http_headers[i][m_match] == '\0') header = 1 << i;
+            }
+            m_header = header;
+            m_state = STATE_HEADER_VALUE;
+            m_match = 0;
+            m_token = 0;
+            if (header == HTTP_CONTENT_LENGTH) m_content_length = -1;
+        }
+        else {
+            m_field = 1;
+            c = http_lower(c);
+            for (uint8_t i = 0; i < 3; i++) {
+                if ((m_header & (1 << i)) && (m_match >= strlen(http_headers[i]) || http_headers[i][m_match] != c))
+                    m_header &= ~(1 << i);
+            }
+            if (m_match < 0xFF) m_match++;
+        }
+        return false;
+    case STATE_HEADER_VALUE:
+        if (c == '\n') {
+            m_state = STATE_HEADER_NAME;
+            m_field = 0;
+            m_header = HTTP_ANY_HEADER;
+            m_match = 0;
+        }
+        else if (m_header == HTTP_CONTENT_LENGTH) {
+            if (c >= '0' && c <= '9') {
+                const long digit = c - '0';
+                const long value = m_content_length < 0 ? 0 : m_content_length;
+                // a length we cannot represent would cut the body short, and leave the
+                // rest to be read as the next response
+                if (value > (LONG_MAX - digit) / 10) {
+                    m_content_length = -1;
+                    m_status = 0;
+                    return true;
+                }
+                m_content_length = value * 10 + digit;
+            }
+        }
+        else if (m_header == HTTP_TRANSFER_ENCODING) {
+            m_token = http_match_token("chunked", m_token, c);
+            if (m_token == 7) m_chunked = true;
+        }
+        else if (m_header == HTTP_CONNECTION) {
+            m_token = http_match_token("close", m_token, c);
+            m_match = http_match_token("keep-alive", m_match, c);
+            if (m_token == 5) m_keep_alive = false;
+            else if (m_match == 10) m_keep_alive = true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+/* see SSLHttpClient.h */
+void SSLHttpClient::m_parse_chunk(char c) {
+    switch (m_chunk) {
+    case CHUNK_SIZE:
+    case CHUNK_EXT:
+        if (c == '\n') {
+            // a zero size chunk ends the body, and may be followed by trailers
+            m_chunk = m_remaining > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+        }
+        else if (m_chunk == CHUNK_SIZE && c != '\r') {
+            const char l = http_lower(c);
+            const int digit = l >= '0' && l <= '9' ? l - '0' : l >= 'a' && l <= 'f' ? l - 'a' + 10 : -1;
+            if (digit < 0) m_chunk = CHUNK_EXT;
+            else if (m_remaining > (static_cast<unsigned long>(-1) >> 4)) m_fail();
+            else m_remaining = (m_remaining << 4) | static_cast<unsigned long>(digit);
+        }
+        break;
+    case CHUNK_DATA_END:
+        if (c == '\n') {
+            m_chunk = CHUNK_SIZE;
+            m_remaining = 0;
+        }
+        break;
+    case CHUNK_TRAILER:
+        if (c == '\n') m_finish_response();
+        else if (c != '\r') m_chunk = CHUNK_TRAILER_LINE;
+        break;
+    case CHUNK_TRAILER_LINE:
+        if (c == '\n') m_chunk = CHUNK_TRAILER;
+        break;
+    default:
+        break;
+    }
+}
+
+/* see SSLHttpClient.h */
+void SSLHttpClient::m_finish_response() {
+    m_state = STATE_IDLE;
+    m_pending--;
+    m_head_mask >>= 1;
+    if (!m_keep_alive) {
+        // anything pipelined after this response is lost with the connection
+        m_pending = 0;
+        m_head_mask = 0;
+        m_reconnect = true;
+        m_client.stop();
+    }
+}
+
+/* see SSLHttpClient.h */
+void SSLHttpClient::m_fail() {
+    m_client.stop();
+    m_pending = 0;
+    m_head_mask = 0;
+    m_state = STATE_IDLE;
+    m_status = 0;
+    m_reconnect = true;
+}
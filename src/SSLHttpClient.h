@@ -0,0 +1,223 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLHttpClient.h
+ *
+ * A small HTTP/1.1 client on top of SSLClient that keeps the connection
+ * open between requests and can pipeline them.
+ */
+
+#include "SSLClient.h"
+
+#ifndef SSLHttpClient_H_
+#define SSLHttpClient_H_
+
+/**
+ * @brief HTTP/1.1 requests over one kept-alive SSLClient connection.
+ *
+ * Sending `Connection: close` and reconnecting for every request means every request
+ * pays for a handshake. SSLHttpClient instead keeps the connection open, and lets
+ * several requests be written before any response is read (pipelining), so they leave
+ * together in as few TLS records as possible:
+ * ```C++
+ * SSLHttpClient http(client, "api.example.com");
+ * http.get("/a");
+ * http.get("/b");
+ * http.flush();
+ * while (http.readResponse()) {
+ *     size_t len;
+ *     while (const uint8_t* data = http.readBody(len)) {
+ *         // use len bytes of the body at data
+ *     }
+ * }
+ * ```
+ * Responses are parsed directly from SSLClient's receive buffer (see
+ * SSLClient::peekBuffer): only the status code and the headers that control the
+ * connection (Content-Length, Transfer-Encoding and Connection) are kept, and the body
+ * is handed out in place, with chunked encoding removed.
+ *
+ * If the server closes the connection (or says it will with `Connection: close`), the
+ * next request reconnects. Requests that were pipelined behind a response that closed
+ * the connection are lost: readResponse returns false for them, and they need to be
+ * sent again. Only send non-idempotent requests (such as POST) when nothing else is
+ * pending if that matters.
+ */
+class SSLHttpClient {
+public:
+    /** @brief The most requests that can wait for a response at once */
+    static constexpr size_t MAX_PIPELINE = 32;
+
+    /**
+     * @brief Create an HTTP client using an SSLClient.
+     * @param client The SSLClient to send the requests with. SSLHttpClient connects it
+     * when needed, and it should not be used for anything else meanwhile.
+     * @param host The server's hostname, sent in the Host header. It is not copied, and
+     * must stay valid for the life of this object.
+     * @param port The server's port.
+     */
+    SSLHttpClient(SSLClient& client, const char* host, uint16_t port = 443);
+
+    /**
+     * @brief Write a request, connecting first if needed.
+     *
+     * The request is buffered by SSLClient and is only sure to be sent after
+     * SSLHttpClient::flush or SSLHttpClient::readResponse, so that several requests can
+     * share TLS records.
+     *
+     * @param method The method, such as "GET" or "POST".
+     * @param path The path and query, starting with "/".
+     * @param headers Extra header lines, each ending with "\r\n", or nullptr. Host and
+     * (if there is a body, or the method is POST, PUT or PATCH) Content-Length are added
+     * automatically.
+     * @param body The request body, or nullptr.
+     * @param body_len The length of the body in bytes.
+     * @returns false if the connection could not be opened, the request could not be
+     * written, or MAX_PIPELINE responses are already pending.
+     */
+    bool request(const char* method, const char* path, const char* headers = nullptr,
+                 const void* body = nullptr, size_t body_len = 0);
+
+    /** @brief Write a GET request (see SSLHttpClient::request). */
+    bool get(const char* path, const char* headers = nullptr) { return request("GET", path, headers); }
+
+    /** @brief Write a POST request (see SSLHttpClient::request). An empty body is sent with Content-Length: 0. */
+    bool post(const char* path, const char* headers, const void* body, size_t body_len) {
+        return request("POST", path, headers, body, body_len);
+    }
+
+    /** @brief Send any requests that are still buffered. Returns false on error. */
+    bool flush();
+
+    /** @brief Returns the number of requests whose responses have not been read. */
+    size_t pending() const { return m_pending; }
+
+    /**
+     * @brief Wait for the status line and headers of the next response.
+     *
+     * Any body left unread from the previous response is skipped first, and interim
+     * (1xx) responses are skipped. After this, read the body with SSLHttpClient::readBody.
+     *
+     * @returns true if a response was received, false if no request is pending, or if
+     * the connection failed or timed out (pending requests are then dropped).
+     */
+    bool readResponse();
+
+    /** @brief Returns the status code of the current response, or 0 if there is none. */
+    int status() const { return m_status; }
+
+    /** @brief Returns the Content-Length of the current response, or -1 if it did not have one. */
+    long contentLength() const { return m_content_length; }
+
+    /** @brief Returns true if the current response uses chunked transfer encoding. */
+    bool isChunked() const { return m_chunked; }
+
+    /** @brief Returns true if the connection stays open after the current response. */
+    bool keepAlive() const { return m_keep_alive; }
+
+    /**
+     * @brief Get the next piece of the current response's body, in place.
+     *
+     * The data points into SSLClient's receive buffer, and is valid until the next call
+     * to this object or the SSLClient.
+     *
+     * @param len Receives the number of bytes at the returned address.
+     * @returns The data, or nullptr (with len set to zero) once the body is complete or
+     * if the connection failed (see SSLHttpClient::bodyComplete).
+     */
+    const uint8_t* readBody(size_t& len);
+
+    /**
+     * @brief Copy up to size bytes of the current response's body into buf.
+     * @returns The number of bytes copied, or 0 once the body is complete or on failure.
+     */
+    size_t readBody(uint8_t* buf, size_t size);
+
+    /** @brief Returns true if the whole body of the current response has been read. */
+    bool bodyComplete() const { return m_state == STATE_IDLE && m_status != 0; }
+
+    /** @brief Set how long to wait for data from the server, in milliseconds (default 10000). */
+    void setTimeout(unsigned long timeout) { m_timeout = timeout; }
+
+    /** @brief Close the connection, dropping any pending requests. */
+    void stop();
+
+private:
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_STATUS,
+        STATE_HEADER_NAME,
+        STATE_HEADER_VALUE,
+        STATE_BODY,
+    };
+
+    enum Chunk : uint8_t {
+        CHUNK_SIZE,
+        CHUNK_EXT,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        CHUNK_TRAILER,
+        CHUNK_TRAILER_LINE,
+    };
+
+    /** wait until there is data to read, false on timeout or if the connection closed */
+    bool m_wait();
+    /** get up to max bytes of the body in place */
+    const uint8_t* m_body(size_t max, size_t& len);
+    /** feed one byte of the status line or headers, returns true at the end of the headers */
+    bool m_parse_head(char c);
+    /** feed one byte of chunked framing */
+    void m_parse_chunk(char c);
+    /** the current response is complete: take it off the queue */
+    void m_finish_response();
+    /** drop the connection and every pending request */
+    void m_fail();
+
+    SSLClient& m_client;
+    const char* m_host;
+    const uint16_t m_port;
+    unsigned long m_timeout;
+    // requests sent, and which of them (bit 0 is the oldest) were HEAD requests
+    size_t m_pending;
+    uint32_t m_head_mask;
+    // the connection must be reopened before the next request
+    bool m_reconnect;
+    // response state
+    State m_state;
+    int m_status;
+    long m_content_length;
+    bool m_chunked;
+    bool m_keep_alive;
+    bool m_http10;
+    // status line and header parsing: which field we are in, which known header the
+    // name can still be (a bit per header), how much of it matched, and how much of
+    // the token we look for in its value matched
+    uint8_t m_field;
+    uint8_t m_header;
+    uint8_t m_match;
+    uint8_t m_token;
+    // body: bytes left (of the body, or of the current chunk), and whether the body
+    // ends when the connection closes
+    Chunk m_chunk;
+    unsigned long m_remaining;
+    bool m_until_close;
+};
+
+#endif /* SSLHttpClient_H_ */
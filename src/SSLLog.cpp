@@ -0,0 +1,156 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLLog.h"
+#include "SSLClient.h"
+
+/** Returns the name of an SSLClient::Error, or nullptr if unknown */
+static const char* ssl_error_string(const int ssl_error) {
+    switch(ssl_error) {
+        case SSLClient::SSL_OK: return "SSL_OK";
+        case SSLClient::SSL_CLIENT_CONNECT_FAIL: return "SSL_CLIENT_CONNECT_FAIL";
+        case SSLClient::SSL_BR_CONNECT_FAIL: return "SSL_BR_CONNECT_FAIL";
+        case SSLClient::SSL_CLIENT_WRTIE_ERROR: return "SSL_CLIENT_WRITE_FAIL";
+        case SSLClient::SSL_BR_WRITE_ERROR: return "SSL_BR_WRITE_ERROR";
+        case SSLClient::SSL_INTERNAL_ERROR: return "SSL_INTERNAL_ERROR";
+        case SSLClient::SSL_OUT_OF_MEMORY: return "SSL_OUT_OF_MEMORY";
+        default: return nullptr;
+    }
+}
+
+/** Returns a description of a BearSSL error code, or nullptr if unknown */
+static const char* br_error_string(const unsigned br_error_code) {
+    switch (br_error_code) {
+        case BR_ERR_BAD_PARAM: return "Caller-provided parameter is incorrect.";
+        case BR_ERR_BAD_STATE: return "Operation requested by the caller cannot be applied with the current context state (e.g. reading data while outgoing data is waiting to be sent).";
+        case BR_ERR_UNSUPPORTED_VERSION: return "Incoming protocol or record version is unsupported.";
+        case BR_ERR_BAD_VERSION: return "Incoming record version does not match the expected version.";
+        case BR_ERR_BAD_LENGTH: return "Incoming record length is invalid.";
+        case BR_ERR_TOO_LARGE: return "Incoming record is too large to be processed, or buffer is too small for the handshake message to send.";
+        case BR_ERR_BAD_MAC: return "Decryption found an invalid padding, or the record MAC is not correct.";
+        case BR_ERR_NO_RANDOM: return "No initial entropy was provided, and none can be obtained from the OS.";
+        case BR_ERR_UNKNOWN_TYPE: return "Incoming record type is unknown.";
+        case BR_ERR_UNEXPECTED: return "Incoming record or message has wrong type with regards to the current engine state.";
+        case BR_ERR_BAD_CCS: return "ChangeCipherSpec message from the peer has invalid contents.";
+        case BR_ERR_BAD_ALERT: return "Alert message from the peer has invalid contents (odd length).";
+        case BR_ERR_BAD_HANDSHAKE: return "Incoming handshake message decoding failed.";
+        case BR_ERR_OVERSIZED_ID: return "ServerHello contains a session ID which is larger than 32 bytes.";
+        case BR_ERR_BAD_CIPHER_SUITE: return "Server wants to use a cipher suite that we did not claim to support. This is also reported if we tried to advertise a cipher suite that we do not support.";
+        case BR_ERR_BAD_COMPRESSION: return "Server wants to use a compression that we did not claim to support.";
+        case BR_ERR_BAD_FRAGLEN: return "Server's max fragment length does not match client's.";
+        case BR_ERR_BAD_SECRENEG: return "Secure renegotiation failed.";
+        case BR_ERR_EXTRA_EXTENSION: return "Server sent an extension type that we did not announce, or used the same extension type several times in a single ServerHello.";
+        case BR_ERR_BAD_SNI: return "Invalid Server Name Indication contents (when used by the server, this extension shall be empty).";
+        case BR_ERR_BAD_HELLO_DONE: return "Invalid ServerHelloDone from the server (length is not 0).";
+        case BR_ERR_LIMIT_EXCEEDED: return "Internal limit exceeded (e.g. server's public key is too large).";
+        case BR_ERR_BAD_FINISHED: return "Finished message from peer does not match the expected value.";
+        case BR_ERR_RESUME_MISMATCH: return "Session resumption attempt with distinct version or cipher suite.";
+        case BR_ERR_INVALID_ALGORITHM: return "Unsupported or invalid algorithm (ECDHE curve, signature algorithm, hash function).";
+        case BR_ERR_BAD_SIGNATURE: return "Invalid signature in ServerKeyExchange or CertificateVerify message.";
+        case BR_ERR_WRONG_KEY_USAGE: return "Peer's public key does not have the proper type or is not allowed for the requested operation.";
+        case BR_ERR_NO_CLIENT_AUTH: return "Client did not send a certificate upon request, or the client certificate could not be validated.";
+        case BR_ERR_BAD_EMS: return "Server's Extended Master Secret extension is not empty, or its use does not match the session being resumed.";
+        case BR_ERR_IO: return "I/O error or premature close on transport stream.";
+        case BR_ERR_X509_INVALID_VALUE: return "Invalid value in an ASN.1 structure.";
+        case BR_ERR_X509_TRUNCATED: return "Truncated certificate or other ASN.1 object.";
+        case BR_ERR_X509_EMPTY_CHAIN: return "Empty certificate chain (no certificate at all).";
+        case BR_ERR_X509_INNER_TRUNC: return "Decoding error: inner element extends beyond outer element size.";
+        case BR_ERR_X509_BAD_TAG_CLASS: return "Decoding error: unsupported tag class (application or private).";
+        case BR_ERR_X509_BAD_TAG_VALUE: return "Decoding error: unsupported tag value.";
+        case BR_ERR_X509_INDEFINITE_LENGTH: return "Decoding error: indefinite length.";
+        case BR_ERR_X509_EXTRA_ELEMENT: return "Decoding error: extraneous element.";
+        case BR_ERR_X509_UNEXPECTED: return "Decoding error: unexpected element.";
+        case BR_ERR_X509_NOT_CONSTRUCTED: return "Decoding error: expected constructed element, but is primitive.";
+        case BR_ERR_X509_NOT_PRIMITIVE: return "Decoding error: expected primitive element, but is constructed.";
+        case BR_ERR_X509_PARTIAL_BYTE: return "Decoding error: BIT STRING length is not multiple of 8.";
+        case BR_ERR_X509_BAD_BOOLEAN: return "Decoding error: BOOLEAN value has invalid length.";
+        case BR_ERR_X509_OVERFLOW: return "Decoding error: value is off-limits.";
+        case BR_ERR_X509_BAD_DN: return "Invalid distinguished name.";
+        case BR_ERR_X509_BAD_TIME: return "Invalid date/time representation.";
+        case BR_ERR_X509_UNSUPPORTED: return "Certificate contains unsupported features that cannot be ignored.";
+        case BR_ERR_X509_LIMIT_EXCEEDED: return "Key or signature size exceeds internal limits.";
+        case BR_ERR_X509_WRONG_KEY_TYPE: return "Key type does not match that which was expected.";
+        case BR_ERR_X509_BAD_SIGNATURE: return "Signature is invalid.";
+        case BR_ERR_X509_TIME_UNKNOWN: return "Validation time is unknown.";
+        case BR_ERR_X509_EXPIRED: return "Certificate is expired or not yet valid.";
+        case BR_ERR_X509_DN_MISMATCH: return "Issuer/Subject DN mismatch in the chain.";
+        case BR_ERR_X509_BAD_SERVER_NAME: return "Expected server name was not found in the chain.";
+        case BR_ERR_X509_CRITICAL_EXTENSION: return "Unknown critical extension in certificate.";
+        case BR_ERR_X509_NOT_CA: return "Not a CA, or path length constraint violation.";
+        case BR_ERR_X509_FORBIDDEN_KEY_USAGE: return "Key Usage extension prohibits intended usage.";
+        case BR_ERR_X509_WEAK_PUBLIC_KEY: return "Public key found in certificate is too small.";
+        case BR_ERR_X509_NOT_TRUSTED: return "Chain could not be linked to a trust anchor. See https://github.com/OPEnSLab-OSU/SSLClient/blob/master/TrustAnchors.md";
+        case 296: return "Server denied access (did you setup mTLS correctly?)";
+        default: return nullptr;
+    }
+}
+
+/* See SSLLog.h */
+void SSLLogEvent::printTo(Print& out, bool with_time) const {
+    if (with_time) {
+        out.print("[");
+        out.print(time);
+        out.print("]");
+    }
+    // print the sslclient prefix
+    out.print("(SSLClient)");
+    // print the debug level
+    switch (level) {
+        case SSLClient::SSL_INFO: out.print("(SSL_INFO)"); break;
+        case SSLClient::SSL_WARN: out.print("(SSL_WARN)"); break;
+        case SSLClient::SSL_ERROR: out.print("(SSL_ERROR)"); break;
+        default: out.print("(Unknown level)");
+    }
+    // print the function name
+    out.print("(");
+    out.print(func_name);
+    out.print("): ");
+    // print the message
+    switch (type) {
+        case SSL_LOG_MESSAGE: out.println(str); break;
+        case SSL_LOG_NUMBER: out.println(arg); break;
+        case SSL_LOG_SSL_ERROR: {
+            const char* name = ssl_error_string(arg);
+            if (name) out.println(name);
+            else { out.print("Unknown SSLClient error: "); out.println(arg); }
+            break;
+        }
+        case SSL_LOG_BR_ERROR: {
+            const char* desc = br_error_string(static_cast<unsigned>(arg));
+            if (desc) out.println(desc);
+            else { out.print("Unknown error code: "); out.println(arg); }
+            break;
+        }
+        case SSL_LOG_BR_STATE: {
+            const unsigned state = static_cast<unsigned>(arg);
+            out.print("State:");
+            if(state == 0) out.print(" Invalid");
+            else if (state & BR_SSL_CLOSED) out.print(" Connection closed");
+            else {
+                if (state & BR_SSL_SENDREC) out.print(" SENDREC");
+                if (state & BR_SSL_RECVREC) out.print(" RECVREC");
+                if (state & BR_SSL_SENDAPP) out.print(" SENDAPP");
+                if (state & BR_SSL_RECVAPP) out.print(" RECVAPP");
+            }
+            out.println();
+            break;
+        }
+    }
+}
@@ -0,0 +1,164 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLLog.h
+ *
+ * Deferred logging for SSLClient: log events are recorded into a sink
+ * instead of being printed to Serial, and can be formatted later.
+ */
+
+#include "Arduino.h"
+
+#ifndef SSLLog_H_
+#define SSLLog_H_
+
+/**
+ * @brief A single log entry recorded by SSLClient.
+ *
+ * Events are kept compact so they can be recorded quickly: the message is a pointer
+ * to a string literal (which doubles as an event ID), error codes and engine states
+ * are stored as numbers, and all text formatting happens in SSLLogEvent::printTo.
+ */
+struct SSLLogEvent {
+    /** @brief How SSLLogEvent::str and SSLLogEvent::arg should be interpreted. */
+    enum Type : uint8_t {
+        /** A static message in str */
+        SSL_LOG_MESSAGE = 0,
+        /** A number in arg */
+        SSL_LOG_NUMBER = 1,
+        /** An SSLClient::Error in arg */
+        SSL_LOG_SSL_ERROR = 2,
+        /** A BearSSL error code in arg */
+        SSL_LOG_BR_ERROR = 3,
+        /** A BearSSL engine state in arg */
+        SSL_LOG_BR_STATE = 4,
+    };
+
+    /** Value of millis() when the event was recorded */
+    uint32_t time;
+    /** Name of the function that recorded the event */
+    const char* func_name;
+    /** Message, only valid if type is SSL_LOG_MESSAGE. Always a string literal. */
+    const char* str;
+    /** Numeric argument for all other types */
+    int32_t arg;
+    /** The SSLClient::DebugLevel of this event */
+    uint8_t level;
+    /** One of SSLLogEvent::Type */
+    uint8_t type;
+
+    /**
+     * @brief Print this event in the same format SSLClient uses with Serial.
+     *
+     * @param out Where to print the event, such as Serial.
+     * @param with_time If true, prefix the line with SSLLogEvent::time.
+     */
+    void printTo(Print& out, bool with_time = false) const;
+};
+
+/**
+ * @brief Receives log events from SSLClient in place of Serial.
+ *
+ * Set a sink with SSLClient::setLogSink. log() is called from inside SSLClient
+ * operations (including the handshake), so it should return quickly.
+ */
+class SSLLogSink {
+public:
+    virtual ~SSLLogSink() {}
+    /** @brief Record a log event. */
+    virtual void log(const SSLLogEvent& event) = 0;
+};
+
+/**
+ * @brief A lock-free ring buffer of log events.
+ *
+ * SSLLogRing stores events as they are logged, without formatting them or touching
+ * Serial, so diagnostics can stay enabled without changing the timing of a connection.
+ * The events can then be drained when convenient, either printed with
+ * SSLLogRing::drain or read one by one with SSLLogRing::pop (for example to send
+ * them to a host that formats them).
+ *
+ * The ring is safe to use with one thread or interrupt logging, and one other thread
+ * draining, without any locks. If the ring is full, new events are dropped and counted.
+ *
+ * @tparam N The number of events the ring can hold, must be a power of two.
+ */
+template<size_t N>
+class SSLLogRing : public SSLLogSink {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SSLLogRing size must be a power of two");
+public:
+    SSLLogRing() : m_head(0), m_tail(0), m_dropped(0) {}
+
+    /** @see SSLLogSink::log */
+    void log(const SSLLogEvent& event) override {
+        const size_t head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+        if (head - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) >= N) {
+            __atomic_store_n(&m_dropped, m_dropped + 1, __ATOMIC_RELAXED);
+            return;
+        }
+        m_events[head & (N - 1)] = event;
+        __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief Remove the oldest event from the ring.
+     * @param event Set to the removed event.
+     * @returns false if the ring was empty.
+     */
+    bool pop(SSLLogEvent& event) {
+        const size_t tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+        if (tail == __atomic_load_n(&m_head, __ATOMIC_ACQUIRE)) return false;
+        event = m_events[tail & (N - 1)];
+        __atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * @brief Print and remove events from the ring.
+     * @param out Where to print the events, such as Serial.
+     * @param max The maximum number of events to print.
+     * @returns The number of events printed.
+     */
+    size_t drain(Print& out, size_t max = N) {
+        SSLLogEvent event;
+        size_t count = 0;
+        while (count < max && pop(event)) {
+            event.printTo(out, true);
+            count++;
+        }
+        return count;
+    }
+
+    /** @brief Returns the number of events waiting in the ring. */
+    size_t size() const { return __atomic_load_n(&m_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE); }
+
+    /** @brief Returns the number of events dropped because the ring was full. */
+    uint32_t dropped() const { return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED); }
+
+private:
+    SSLLogEvent m_events[N];
+    // m_head is only written by log(), m_tail only by pop()
+    size_t m_head;
+    size_t m_tail;
+    uint32_t m_dropped;
+};
+
+#endif /* SSLLog_H_ */
@@ -0,0 +1,431 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLPosixClient.h"
+#include "SSLHostHash.h"
+
+#ifdef SSLCLIENT_POSIX
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+// macOS has no MSG_NOSIGNAL, and uses SO_NOSIGPIPE on the socket instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static_assert(sizeof(SSLIoVec) == sizeof(iovec), "SSLIoVec must have the layout of struct iovec");
+
+constexpr unsigned long SSLPosixClient::DEFAULT_ATTEMPT_DELAY;
+
+/* see SSLPosixClient.h */
+SSLPosixClient::SSLPosixClient()
+    : m_fd(-1)
+    , m_eof(false)
+    , m_timeout(0)
+    , m_attempt_delay(DEFAULT_ATTEMPT_DELAY)
+    , m_remote()
+    , m_affinity() {}
+
+/* see SSLPosixClient.h */
+SSLPosixClient::~SSLPosixClient() {
+    stop();
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::connect(IPAddress ip, uint16_t port) {
+    const unsigned long start = millis();
+    stop();
+    Address addr = {};
+    sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&addr.addr);
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(port);
+    uint8_t* octets = reinterpret_cast<uint8_t*>(&sin->sin_addr.s_addr);
+    for (int i = 0; i < 4; i++) octets[i] = ip[i];
+    addr.len = sizeof(sockaddr_in);
+    int fd;
+    if (m_race(&addr, 1, start, fd) < 0) return 0;
+    m_use(fd, addr);
+    return 1;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::connect(const char* host, uint16_t port) {
+    const unsigned long start = millis();
+    stop();
+    Address addrs[SSLCLIENT_MAX_CONNECT_ADDRESSES];
+    const size_t count = m_resolve(host, port, addrs);
+    if (count == 0) return 0;
+    const uint32_t host_hash = ssl_hash_hostname(host);
+    m_order(addrs, count, host_hash, port);
+    int fd;
+    const int index = m_race(addrs, count, start, fd);
+    if (index < 0) {
+        // the remembered server may be gone, so don't keep sending the next connection there
+        const int affinity = m_find_affinity(host_hash, port);
+        if (affinity >= 0) m_affinity[affinity].host_hash = 0;
+        return 0;
+    }
+    m_use(fd, addrs[index]);
+    m_remember(host_hash, port, addrs[index]);
+    return 1;
+}
+
+/* see SSLPosixClient.h */
+size_t SSLPosixClient::m_resolve(const char* host, uint16_t port, Address* addrs) {
+#ifdef SSLCLIENT_NO_HEAP
+    // getaddrinfo allocates its results, so only addresses written out as text can be used
+    addrs[0] = {};
+    sockaddr_in* sin = reinterpret_cast<sockaddr_in*>(&addrs[0].addr);
+    sockaddr_in6* sin6 = reinterpret_cast<sockaddr_in6*>(&addrs[0].addr);
+    if (inet_pton(AF_INET, host, &sin->sin_addr) == 1) {
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        addrs[0].len = sizeof(sockaddr_in);
+        return 1;
+    }
+    if (inet_pton(AF_INET6, host, &sin6->sin6_addr) == 1) {
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        addrs[0].len = sizeof(sockaddr_in6);
+        return 1;
+    }
+    return 0;
+#else
+    char service[6];
+    snprintf(service, sizeof service, "%u", port);
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host, service, &hints, &results) != 0) return 0;
+    // copy what we can use, in the order getaddrinfo sorted them (RFC 6724)
+    size_t count = 0;
+    for (const addrinfo* ai = results; ai != nullptr && count < SSLCLIENT_MAX_CONNECT_ADDRESSES; ai = ai->ai_next) {
+        if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) || ai->ai_addrlen > sizeof(sockaddr_storage)) continue;
+        addrs[count] = {};
+        memcpy(&addrs[count].addr, ai->ai_addr, ai->ai_addrlen);
+        addrs[count].len = ai->ai_addrlen;
+        count++;
+    }
+    freeaddrinfo(results);
+    return count;
+#endif
+}
+
+/* see SSLPosixClient.h */
+size_t SSLPosixClient::write(const uint8_t* buf, size_t size) {
+    if (m_fd < 0) return 0;
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t r = ::send(m_fd, buf + total, size - total, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        total += r;
+    }
+    return total;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::available() {
+    if (m_fd < 0) return 0;
+    int n = 0;
+    if (ioctl(m_fd, FIONREAD, &n) < 0) n = 0;
+    // a socket that is readable with nothing to read has been closed by the server
+    if (n == 0 && !m_eof) {
+        pollfd p = { m_fd, POLLIN, 0 };
+        if (poll(&p, 1, 0) > 0) {
+            uint8_t b;
+            m_check_read(::recv(m_fd, &b, 1, MSG_PEEK | MSG_DONTWAIT));
+        }
+    }
+    return n;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::read(uint8_t* buf, size_t size) {
+    if (m_fd < 0 || size == 0) return -1;
+    const ssize_t r = ::recv(m_fd, buf, size, MSG_DONTWAIT);
+    m_check_read(r);
+    return r > 0 ? static_cast<int>(r) : -1;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::peek() {
+    if (m_fd < 0) return -1;
+    uint8_t b;
+    const ssize_t r = ::recv(m_fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    m_check_read(r);
+    return r == 1 ? b : -1;
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::stop() {
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+    m_eof = false;
+}
+
+/* see SSLPosixClient.h */
+uint8_t SSLPosixClient::connected() {
+    if (m_fd < 0) return 0;
+    // like other Arduino clients, stay connected while there is data left to read
+    const int avail = available();
+    return !m_eof || avail > 0;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::writev(const SSLIoVec* iov, size_t count) {
+    if (m_fd < 0) return 0;
+    msghdr msg = {};
+    msg.msg_iov = reinterpret_cast<iovec*>(const_cast<SSLIoVec*>(iov));
+    msg.msg_iovlen = count;
+    ssize_t r;
+    do {
+        r = ::sendmsg(m_fd, &msg, MSG_NOSIGNAL);
+    } while (r < 0 && errno == EINTR);
+    return r > 0 ? static_cast<int>(r) : 0;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::readv(const SSLIoVec* iov, size_t count) {
+    if (m_fd < 0) return -1;
+    msghdr msg = {};
+    msg.msg_iov = reinterpret_cast<iovec*>(const_cast<SSLIoVec*>(iov));
+    msg.msg_iovlen = count;
+    const ssize_t r = ::recvmsg(m_fd, &msg, MSG_DONTWAIT);
+    m_check_read(r);
+    return r > 0 ? static_cast<int>(r) : -1;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::writable() {
+    if (m_fd < 0) return -1;
+    pollfd p = { m_fd, POLLOUT, 0 };
+    // errors are left for the write to report
+    if (poll(&p, 1, 0) == 0) return 0;
+    return -1;
+}
+
+/* see SSLPosixClient.h */
+const sockaddr* SSLPosixClient::remoteAddress(socklen_t& len) const {
+    if (m_fd < 0) return nullptr;
+    len = m_remote.len;
+    return reinterpret_cast<const sockaddr*>(&m_remote.addr);
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::clearAffinity() {
+    for (auto& entry : m_affinity) entry.host_hash = 0;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::m_race(const Address* addrs, size_t count, unsigned long start, int& fd) {
+    int fds[SSLCLIENT_MAX_CONNECT_ADDRESSES];
+    size_t started = 0;
+    size_t pending = 0;
+    unsigned long last_start = 0;
+    // an attempt failed since the last one started, so the next may start now
+    bool failed = false;
+    int winner = -1;
+    while (winner < 0) {
+        const unsigned long now = millis();
+        if (m_timeout > 0 && now - start >= m_timeout) break;
+        // start the next attempt when nothing else is in flight, the last one failed,
+        // or the last one has had its attempt delay
+        if (started < count && (pending == 0 || failed || now - last_start >= m_attempt_delay)) {
+            bool connected = false;
+            fds[started] = m_start_attempt(addrs[started], connected);
+            last_start = now;
+            failed = fds[started] < 0;
+            if (connected) winner = started;
+            else if (!failed) pending++;
+            started++;
+            continue;
+        }
+        if (pending == 0) break;
+        // wait for an attempt to finish, until the next one is due or the time is up
+        unsigned long wait = m_timeout > 0 ? m_timeout - (now - start) : 0x7FFFFFFF;
+        if (started < count && m_attempt_delay - (now - last_start) < wait)
+            wait = m_attempt_delay - (now - last_start);
+        pollfd polls[SSLCLIENT_MAX_CONNECT_ADDRESSES];
+        size_t indices[SSLCLIENT_MAX_CONNECT_ADDRESSES];
+        nfds_t npolls = 0;
+        for (size_t i = 0; i < started; i++) {
+            if (fds[i] < 0) continue;
+            polls[npolls] = { fds[i], POLLOUT, 0 };
+            indices[npolls++] = i;
+        }
+        const int ready = poll(polls, npolls, static_cast<int>(wait));
+        if (ready < 0 && errno != EINTR) break;
+        for (nfds_t i = 0; i < npolls && ready > 0; i++) {
+            if (polls[i].revents == 0) continue;
+            int error = 0;
+            socklen_t len = sizeof error;
+            if (getsockopt(polls[i].fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) error = errno;
+            if (error == 0 && (polls[i].revents & POLLOUT)) {
+                winner = indices[i];
+                break;
+            }
+            ::close(polls[i].fd);
+            fds[indices[i]] = -1;
+            pending--;
+            failed = true;
+        }
+    }
+    // abandon the attempts that lost
+    for (size_t i = 0; i < started; i++) {
+        if (fds[i] >= 0 && static_cast<int>(i) != winner) ::close(fds[i]);
+    }
+    if (winner >= 0) fd = fds[winner];
+    return winner;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::m_start_attempt(const Address& addr, bool& connected) {
+    const int fd = ::socket(addr.addr.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof one);
+#endif
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr.addr), addr.len) == 0) {
+        connected = true;
+        return fd;
+    }
+    if (errno == EINPROGRESS) return fd;
+    ::close(fd);
+    return -1;
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::m_order(Address* addrs, size_t count, uint32_t host_hash, uint16_t port) const {
+    // alternate address families, starting with the one getaddrinfo preferred
+    // (RFC 8305, section 4), keeping the order within each family
+    Address sorted[SSLCLIENT_MAX_CONNECT_ADDRESSES];
+    bool taken[SSLCLIENT_MAX_CONNECT_ADDRESSES] = {};
+    sa_family_t family = count > 0 ? addrs[0].addr.ss_family : AF_UNSPEC;
+    for (size_t n = 0; n < count; n++) {
+        size_t pick = count;
+        for (size_t i = 0; i < count; i++) {
+            if (taken[i]) continue;
+            if (pick == count) pick = i;
+            if (addrs[i].addr.ss_family == family) { pick = i; break; }
+        }
+        taken[pick] = true;
+        sorted[n] = addrs[pick];
+        family = addrs[pick].addr.ss_family == AF_INET6 ? AF_INET : AF_INET6;
+    }
+    // try the server we last connected to first, if the name still points to it
+    const int affinity = m_find_affinity(host_hash, port);
+    size_t first = count;
+    for (size_t i = 0; affinity >= 0 && i < count; i++) {
+        if (m_same_address(sorted[i], m_affinity[affinity].address)) { first = i; break; }
+    }
+    size_t out = 0;
+    if (first < count) addrs[out++] = sorted[first];
+    for (size_t i = 0; i < count; i++) {
+        if (i != first) addrs[out++] = sorted[i];
+    }
+}
+
+/* see SSLPosixClient.h */
+bool SSLPosixClient::m_same_address(const Address& a, const Address& b) {
+    if (a.addr.ss_family != b.addr.ss_family) return false;
+    if (a.addr.ss_family == AF_INET) {
+        const sockaddr_in& x = reinterpret_cast<const sockaddr_in&>(a.addr);
+        const sockaddr_in& y = reinterpret_cast<const sockaddr_in&>(b.addr);
+        return x.sin_port == y.sin_port && x.sin_addr.s_addr == y.sin_addr.s_addr;
+    }
+    if (a.addr.ss_family == AF_INET6) {
+        const sockaddr_in6& x = reinterpret_cast<const sockaddr_in6&>(a.addr);
+        const sockaddr_in6& y = reinterpret_cast<const sockaddr_in6&>(b.addr);
+        return x.sin6_port == y.sin6_port && x.sin6_scope_id == y.sin6_scope_id
+            && memcmp(&x.sin6_addr, &y.sin6_addr, sizeof x.sin6_addr) == 0;
+    }
+    return false;
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::m_use(int fd, const Address& addr) {
+    // the race needed a non-blocking socket, but writes should complete
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    // TLS records are written whole, so there is nothing to gain from Nagle
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    m_fd = fd;
+    m_eof = false;
+    m_remote = addr;
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::m_remember(uint32_t host_hash, uint16_t port, const Address& addr) {
+    const unsigned long now = millis();
+    int index = m_find_affinity(host_hash, port);
+    if (index < 0) {
+        // take a free entry, or the one used least recently
+        index = 0;
+        for (size_t i = 0; i < SSLCLIENT_MAX_AFFINITY_HOSTS; i++) {
+            if (m_affinity[i].host_hash == 0) { index = i; break; }
+            if (now - m_affinity[i].used > now - m_affinity[index].used) index = i;
+        }
+    }
+    m_affinity[index].host_hash = host_hash;
+    m_affinity[index].port = port;
+    m_affinity[index].address = addr;
+    m_affinity[index].used = now;
+}
+
+/* see SSLPosixClient.h */
+int SSLPosixClient::m_find_affinity(uint32_t host_hash, uint16_t port) const {
+    for (size_t i = 0; i < SSLCLIENT_MAX_AFFINITY_HOSTS; i++) {
+        if (m_affinity[i].host_hash == host_hash && m_affinity[i].port == port) return i;
+    }
+    return -1;
+}
+
+/* see SSLPosixClient.h */
+void SSLPosixClient::m_check_read(long r) {
+    if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) m_eof = true;
+}
+
+#endif /* SSLCLIENT_POSIX */
@@ -0,0 +1,181 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLPosixClient.h
+ *
+ * A network client for host builds that uses POSIX sockets, and connects to
+ * hosts with several addresses using Happy Eyeballs (RFC 8305).
+ */
+
+#include "Client.h"
+#include "SSLClientConfig.h"
+#include "SSLTransport.h"
+
+#ifndef SSLPosixClient_H_
+#define SSLPosixClient_H_
+
+#ifdef SSLCLIENT_POSIX
+
+#include <sys/socket.h>
+
+/**
+ * @brief A Client on a POSIX TCP socket, for running SSLClient on a host (Linux, macOS).
+ *
+ * When a hostname resolves to several addresses (for example the A and AAAA records of a
+ * dual-stack server), connect() does not try them one after the other, which would cost
+ * a whole connect timeout for every address that does not answer. Instead it races them
+ * as described in RFC 8305: the addresses are ordered to alternate between IPv6 and IPv4,
+ * a connection attempt is started on the first, and another is started every attempt delay
+ * (see SSLPosixClient::setAttemptDelay) or as soon as one fails, until one connects. The
+ * other attempts are then abandoned.
+ *
+ * The address that won is remembered for each hostname, and tried first the next time.
+ * Servers behind one name do not always share TLS session state, so going back to the
+ * server that issued our session makes it much more likely that SSLClient can resume it
+ * instead of doing a full handshake.
+ *
+ * SSLPosixClient also implements SSLTransportExt with scatter/gather socket calls, so it
+ * is best used through SSLClientFor:
+ * ```C++
+ * SSLPosixClient socket;
+ * SSLClientFor<SSLPosixClient> client(socket, TAs, TAs_NUM, A7);
+ * ```
+ * Name resolution uses getaddrinfo, which waits for both address families, so the
+ * Resolution Delay of RFC 8305 does not apply. This class is only available where
+ * SSLCLIENT_POSIX is defined (see SSLClientConfig.h).
+ */
+class SSLPosixClient : public Client, public SSLTransportExt {
+public:
+    /** @brief The default time between the start of two connection attempts, in milliseconds (RFC 8305, section 8) */
+    static constexpr unsigned long DEFAULT_ATTEMPT_DELAY = 250;
+
+    SSLPosixClient();
+    ~SSLPosixClient();
+
+    SSLPosixClient(const SSLPosixClient&) = delete;
+    SSLPosixClient& operator=(const SSLPosixClient&) = delete;
+
+    /** @brief Connect to an IPv4 address. */
+    int connect(IPAddress ip, uint16_t port) override;
+
+    /**
+     * @brief Resolve a hostname, and connect to the first of its addresses that answers.
+     *
+     * See the class description for how the addresses are tried. If SSLCLIENT_NO_HEAP is
+     * defined, names are not resolved (getaddrinfo allocates memory), and host must be an
+     * IPv4 or IPv6 address written out, such as "192.0.2.1" or "2001:db8::1".
+     *
+     * @returns 1 if connected, 0 if the name could not be resolved, every address failed,
+     * or the connection timeout passed.
+     */
+    int connect(const char* host, uint16_t port) override;
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return m_fd >= 0; }
+
+    /** @brief Write the buffers with a single sendmsg call (see SSLTransportExt::writev). */
+    int writev(const SSLIoVec* iov, size_t count) override;
+    /** @brief Read into the buffers with a single recvmsg call, without waiting (see SSLTransportExt::readv). */
+    int readv(const SSLIoVec* iov, size_t count) override;
+    /** @brief Returns how many bytes the socket has received. */
+    int readable() override { return available(); }
+    /** @brief Returns 0 if the socket's send buffer is full, or -1 if something can be written. */
+    int writable() override;
+
+    /**
+     * @brief Limit the time connect() may take, in milliseconds, or 0 to wait until every
+     * attempt has failed. The time taken to resolve the name counts, though resolving
+     * itself cannot be cut short. SSLClient sets this from its connect timeout.
+     */
+    void setConnectionTimeout(unsigned long timeout) { m_timeout = timeout; }
+
+    /**
+     * @brief Set the time to wait for a connection attempt before starting one to the next
+     * address, in milliseconds. RFC 8305 recommends 250, and no less than 100.
+     */
+    void setAttemptDelay(unsigned long delay) { m_attempt_delay = delay; }
+
+    /**
+     * @brief Returns the address of the server connected to, and sets len to its length, or
+     * returns nullptr if not connected.
+     */
+    const sockaddr* remoteAddress(socklen_t& len) const;
+
+    /** @brief Forget the addresses remembered for every hostname. */
+    void clearAffinity();
+
+private:
+    /** An address to connect to */
+    struct Address {
+        sockaddr_storage addr;
+        socklen_t len;
+    };
+
+    /**
+     * race connection attempts to the addresses in order, until timeout milliseconds
+     * after start, returns the index of the address that connected and sets fd to its
+     * socket, or returns -1
+     */
+    int m_race(const Address* addrs, size_t count, unsigned long start, int& fd);
+    /** find the addresses of a host (at most SSLCLIENT_MAX_CONNECT_ADDRESSES), returns how many */
+    static size_t m_resolve(const char* host, uint16_t port, Address* addrs);
+    /** start a non-blocking connection attempt, returns the socket or -1 if it failed at once */
+    static int m_start_attempt(const Address& addr, bool& connected);
+    /** order resolved addresses for the race, with the remembered one first */
+    void m_order(Address* addrs, size_t count, uint32_t host_hash, uint16_t port) const;
+    /** returns true if two addresses are the same host and port */
+    static bool m_same_address(const Address& a, const Address& b);
+    /** use a connected socket */
+    void m_use(int fd, const Address& addr);
+    /** remember which address a hostname connected to */
+    void m_remember(uint32_t host_hash, uint16_t port, const Address& addr);
+    /** find the remembered address for a hostname, or -1 */
+    int m_find_affinity(uint32_t host_hash, uint16_t port) const;
+    /** note that the server closed the connection, if a read returned r */
+    void m_check_read(long r);
+
+    int m_fd;
+    // the server closed its side, though some data may still be unread
+    bool m_eof;
+    unsigned long m_timeout;
+    unsigned long m_attempt_delay;
+    Address m_remote;
+    // addresses connected to for the last few hostnames: a hash of the hostname (0 if
+    // the entry is unused), the port, the address and when it was last used
+    struct {
+        uint32_t host_hash;
+        uint16_t port;
+        Address address;
+        unsigned long used;
+    } m_affinity[SSLCLIENT_MAX_AFFINITY_HOSTS];
+};
+
+#endif /* SSLCLIENT_POSIX */
+
+#endif /* SSLPosixClient_H_ */
@@ -27,6 +27,7 @@
 
 #include "bearssl.h"
 #include "Arduino.h"
+#include "SSLClientConfig.h"
 
 #ifndef SSLSession_H_
 #define SSLSession_H_
@@ -56,8 +57,15 @@ public:
      * 
      * Sets all parameters to zero, and invalidates the session
      */
+#ifdef SSLCLIENT_NO_HEAP
+    SSLSession(const char* hostname) {
+        strncpy(m_hostname, hostname, sizeof m_hostname - 1);
+        m_hostname[sizeof m_hostname - 1] = '\0';
+    }
+#else
     SSLSession(const char* hostname)
         : m_hostname(hostname) {}
+#endif
 
     /**
      * @brief Get the hostname string associated with this session
@@ -67,14 +75,36 @@ public:
      * as if this session in invalid this value is not guarenteed
      * to be reset to "".
      */
+#ifdef SSLCLIENT_NO_HEAP
+    const char* get_hostname() const { return m_hostname; }
+#else
     const String& get_hostname() const { return m_hostname; }
+#endif
+
+    /** @brief Returns true if this session was created for the hostname given */
+#ifdef SSLCLIENT_NO_HEAP
+    bool matches_hostname(const char* hostname) const { return strcmp(m_hostname, hostname) == 0; }
+#else
+    bool matches_hostname(const char* hostname) const { return m_hostname.equals(hostname); }
+#endif
+
+    /** @brief Returns true if a hostname is short enough to be stored in an SSLSession */
+#ifdef SSLCLIENT_NO_HEAP
+    static bool can_store_hostname(const char* hostname) { return strlen(hostname) <= SSLCLIENT_MAX_HOSTNAME_LEN; }
+#else
+    static bool can_store_hostname(const char*) { return true; }
+#endif
 
     /** @brief Returns a pointer to the ::br_ssl_session_parameters component of this class. */
     br_ssl_session_parameters* to_br_session() { return (br_ssl_session_parameters *)this; }
 
 private:
     // aparently a hostname has a max length of 256 chars. Go figure.
+#ifdef SSLCLIENT_NO_HEAP
+    char m_hostname[SSLCLIENT_MAX_HOSTNAME_LEN + 1];
+#else
     String m_hostname;
+#endif
 };
 
 
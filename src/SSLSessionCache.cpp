@@ -0,0 +1,138 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLSessionCache.h"
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+SSLSessionCache::Guard::Guard(const SSLSessionCache& cache)
+    : m_cache(cache) {
+#ifdef SSLCLIENT_THREAD_SAFE
+#if defined(ARDUINO_ARCH_ESP32)
+    xSemaphoreTake(m_cache.m_lock, portMAX_DELAY);
+#elif defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+    m_cache.m_lock.lock();
+#else
+    // no mutex on this target: yield in case the holder is a task on the same
+    // core (see the class description for why this needs equal priorities)
+    while (m_cache.m_lock.test_and_set(std::memory_order_acquire))
+        yield();
+#endif
+#endif
+}
+
+SSLSessionCache::Guard::~Guard() {
+#ifdef SSLCLIENT_THREAD_SAFE
+#if defined(ARDUINO_ARCH_ESP32)
+    xSemaphoreGive(m_cache.m_lock);
+#elif defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+    m_cache.m_lock.unlock();
+#else
+    m_cache.m_lock.clear(std::memory_order_release);
+#endif
+#endif
+}
+
+/* see SSLSessionCache.h */
+SSLSessionCache::SSLSessionCache(size_t max_sessions)
+    : m_sessions()
+#ifdef SSLCLIENT_NO_HEAP
+    , m_max_sessions(max_sessions < SSLCLIENT_MAX_SHARED_SESSIONS ? max_sessions : SSLCLIENT_MAX_SHARED_SESSIONS)
+#else
+    , m_max_sessions(max_sessions)
+#endif
+{
+#if defined(SSLCLIENT_THREAD_SAFE) && defined(ARDUINO_ARCH_ESP32)
+    // a static mutex, so the cache does not allocate
+    m_lock = xSemaphoreCreateMutexStatic(&m_lock_buf);
+#elif defined(SSLCLIENT_THREAD_SAFE) && !(defined(__unix__) || defined(__APPLE__) || defined(_WIN32))
+    m_lock.clear();
+#endif
+#ifndef SSLCLIENT_NO_HEAP
+    // allocate everything up front so put() never reallocates
+    m_sessions.reserve(m_max_sessions);
+#endif
+}
+
+/* see SSLSessionCache.h */
+SSLSessionCache::~SSLSessionCache() {
+#if defined(SSLCLIENT_THREAD_SAFE) && defined(ARDUINO_ARCH_ESP32)
+    vSemaphoreDelete(m_lock);
+#endif
+}
+
+/* see SSLSessionCache.h */
+bool SSLSessionCache::get(const char* host, br_ssl_session_parameters* params) const {
+    if (host == nullptr) return false;
+    Guard guard(*this);
+    const int index = m_find(host);
+    if (index < 0) return false;
+    *params = m_sessions[static_cast<size_t>(index)];
+    return true;
+}
+
+/* see SSLSessionCache.h */
+void SSLSessionCache::put(const char* host, const br_ssl_session_parameters& params) {
+    if (host == nullptr || m_max_sessions == 0 || !SSLSession::can_store_hostname(host)) return;
+    Guard guard(*this);
+    const int index = m_find(host);
+    if (index >= 0) {
+        *m_sessions[static_cast<size_t>(index)].to_br_session() = params;
+        return;
+    }
+    if (m_sessions.size() >= m_max_sessions)
+        m_sessions.erase(m_sessions.begin());
+    SSLSession session(host);
+    *session.to_br_session() = params;
+    m_sessions.push_back(session);
+}
+
+/* see SSLSessionCache.h */
+void SSLSessionCache::remove(const char* host) {
+    if (host == nullptr) return;
+    Guard guard(*this);
+    const int index = m_find(host);
+    if (index >= 0)
+        m_sessions.erase(m_sessions.begin() + static_cast<size_t>(index));
+}
+
+/* see SSLSessionCache.h */
+void SSLSessionCache::clear() {
+    Guard guard(*this);
+    while (m_sessions.size() > 0)
+        m_sessions.erase(m_sessions.end() - 1);
+}
+
+/* see SSLSessionCache.h */
+size_t SSLSessionCache::size() const {
+    Guard guard(*this);
+    return m_sessions.size();
+}
+
+int SSLSessionCache::m_find(const char* host) const {
+    for (size_t i = 0; i < m_sessions.size(); i++) {
+        if (m_sessions[i].matches_hostname(host))
+            return static_cast<int>(i);
+    }
+    return -1;
+}
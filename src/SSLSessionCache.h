@@ -0,0 +1,141 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLSessionCache.h
+ *
+ * A session cache that can be shared by several SSLClient objects, so a
+ * session negotiated by one of them can be resumed by any of them.
+ */
+
+#include "SSLClientConfig.h"
+#include "SSLSession.h"
+#ifdef SSLCLIENT_NO_HEAP
+#include "SSLFixedVector.h"
+#else
+#include <vector>
+#endif
+#ifdef SSLCLIENT_THREAD_SAFE
+#if defined(ARDUINO_ARCH_ESP32)
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#elif defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+#include <mutex>
+#else
+#include <atomic>
+#endif
+#endif
+
+#ifndef SSLSessionCache_H_
+#define SSLSessionCache_H_
+
+/**
+ * @brief Stores SSL sessions for any number of SSLClient objects.
+ *
+ * By default each SSLClient keeps its own sessions, so a pool of clients connecting to
+ * the same server each has to run a full handshake before it can resume. Giving them
+ * all the same SSLSessionCache (see SSLClient::setSessionCache) lets every client resume
+ * a session negotiated by any other.
+ *
+ * Sessions are copied in and out of the cache rather than handed out by pointer, so a
+ * client never holds on to an entry that another client may be updating. If
+ * SSLCLIENT_THREAD_SAFE is defined, every function may be called from any thread: the
+ * cache is guarded by a lock that is only held while an entry is looked up and copied,
+ * never during network I/O or a handshake. The lock is a FreeRTOS mutex on the ESP32
+ * (which has priority inheritance) and a std::mutex on desktop hosts. On other targets
+ * it is a spinlock that calls yield() while it waits, which is only safe if every
+ * thread using the cache runs at the same priority: on a single core, a higher priority
+ * thread spinning on the lock would never let a lower priority holder release it.
+ *
+ * When the cache is full, storing a session for a new host replaces the oldest one.
+ */
+class SSLSessionCache {
+public:
+    /**
+     * @brief Create an empty cache.
+     * @param max_sessions The maximum number of sessions (one per host) to keep. If
+     * SSLCLIENT_NO_HEAP is defined, this is limited to SSLCLIENT_MAX_SHARED_SESSIONS.
+     */
+    explicit SSLSessionCache(size_t max_sessions);
+
+    ~SSLSessionCache();
+
+    SSLSessionCache(const SSLSessionCache&) = delete;
+    SSLSessionCache& operator=(const SSLSessionCache&) = delete;
+
+    /**
+     * @brief Copy the session stored for a host.
+     * @param host The hostname the session was negotiated with.
+     * @param params Receives the session parameters.
+     * @returns true if a session was found and copied, false otherwise.
+     */
+    bool get(const char* host, br_ssl_session_parameters* params) const;
+
+    /**
+     * @brief Store the session for a host, replacing any older session for it.
+     * @param host The hostname the session was negotiated with.
+     * @param params The session parameters to store.
+     */
+    void put(const char* host, const br_ssl_session_parameters& params);
+
+    /** @brief Forget the session stored for a host, if any. */
+    void remove(const char* host);
+
+    /** @brief Forget all sessions. */
+    void clear();
+
+    /** @brief Returns the number of sessions currently stored. */
+    size_t size() const;
+
+    /** @brief Returns the maximum number of sessions that can be stored. */
+    size_t capacity() const { return m_max_sessions; }
+
+private:
+    /** Holds the cache lock for the lifetime of the object */
+    class Guard {
+    public:
+        explicit Guard(const SSLSessionCache& cache);
+        ~Guard();
+    private:
+        const SSLSessionCache& m_cache;
+    };
+
+    /** Find the index of the session for a host, or -1. The lock must be held. */
+    int m_find(const char* host) const;
+
+#ifdef SSLCLIENT_NO_HEAP
+    SSLFixedVector<SSLSession, SSLCLIENT_MAX_SHARED_SESSIONS> m_sessions;
+#else
+    std::vector<SSLSession> m_sessions;
+#endif
+    const size_t m_max_sessions;
+#ifdef SSLCLIENT_THREAD_SAFE
+#if defined(ARDUINO_ARCH_ESP32)
+    StaticSemaphore_t m_lock_buf;
+    SemaphoreHandle_t m_lock;
+#elif defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+    mutable std::mutex m_lock;
+#else
+    mutable std::atomic_flag m_lock;
+#endif
+#endif
+};
+
+#endif /* SSLSessionCache_H_ */
@@ -0,0 +1,148 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Arduino.h"
+#include "SSLClientConfig.h"
+
+#ifndef SSLSource_H_
+#define SSLSource_H_
+
+#ifdef SSLCLIENT_POSIX
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Data for SSLClient::writeFrom to send.
+ *
+ * SSLClient::writeFrom hands the source the free part of BearSSL's send buffer, and the
+ * source fills it directly, so the data does not pass through a buffer of the
+ * application's on the way. Implement this for any other kind of storage.
+ */
+class SSLSource {
+public:
+    virtual ~SSLSource() {}
+
+    /**
+     * @brief Copy the next bytes of data into buf.
+     * @param buf Where to put the data. This is inside SSLClient's send buffer.
+     * @param len The most bytes that fit.
+     * @returns The number of bytes copied, 0 once there is no more data, or a value < 0
+     * if reading failed.
+     */
+    virtual int fill(uint8_t* buf, size_t len) = 0;
+};
+
+/**
+ * @brief An SSLSource that reads from an Arduino Stream (a serial port, for example).
+ *
+ * Data is read with Stream::readBytes, so the source ends once the stream has had
+ * nothing to give for its timeout (see Stream::setTimeout). Files are faster through
+ * SSLFileSource.
+ */
+class SSLStreamSource : public SSLSource {
+public:
+    explicit SSLStreamSource(Stream& stream) : m_stream(stream) {}
+
+    int fill(uint8_t* buf, size_t len) override {
+        return static_cast<int>(m_stream.readBytes(buf, len));
+    }
+
+private:
+    Stream& m_stream;
+};
+
+/**
+ * @brief An SSLSource that reads from a file until its end.
+ *
+ * Works with any class with a `read(buffer, length)` function, such as the SD and
+ * LittleFS File classes, which can usually read straight from the card or flash into
+ * the send buffer.
+ *
+ * @tparam FileT The file type.
+ */
+template<class FileT>
+class SSLFileSource : public SSLSource {
+public:
+    explicit SSLFileSource(FileT& file) : m_file(file) {}
+
+    int fill(uint8_t* buf, size_t len) override {
+        // some File classes take a uint16_t length
+        if (len > 0xFFFF) len = 0xFFFF;
+        return static_cast<int>(m_file.read(buf, len));
+    }
+
+private:
+    FileT& m_file;
+};
+
+/**
+ * @brief An SSLSource for data already in memory, such as a region of memory-mapped flash.
+ *
+ * The memory is not copied when the source is created, and must stay valid until it has
+ * been written.
+ */
+class SSLMemorySource : public SSLSource {
+public:
+    SSLMemorySource(const void* data, size_t len)
+        : m_data(static_cast<const uint8_t*>(data))
+        , m_left(len) {}
+
+    int fill(uint8_t* buf, size_t len) override {
+        if (len > m_left) len = m_left;
+        memcpy(buf, m_data, len);
+        m_data += len;
+        m_left -= len;
+        return static_cast<int>(len);
+    }
+
+    /** @brief Returns the number of bytes not yet written. */
+    size_t remaining() const { return m_left; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_left;
+};
+
+#ifdef SSLCLIENT_POSIX
+/**
+ * @brief An SSLSource that reads from a POSIX file descriptor, with one read() call
+ * straight into the send buffer per record.
+ *
+ * The descriptor is not closed by this class.
+ */
+class SSLFdSource : public SSLSource {
+public:
+    explicit SSLFdSource(int fd) : m_fd(fd) {}
+
+    int fill(uint8_t* buf, size_t len) override {
+        ssize_t r;
+        do {
+            r = ::read(m_fd, buf, len);
+        } while (r < 0 && errno == EINTR);
+        return static_cast<int>(r);
+    }
+
+private:
+    int m_fd;
+};
+#endif
+
+#endif /* SSLSource_H_ */
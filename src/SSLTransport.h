@@ -0,0 +1,192 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "Client.h"
+
+#ifndef SSLTransport_H_
+#define SSLTransport_H_
+
+/**
+ * @brief One buffer in a vectored transfer.
+ *
+ * This has the same layout as POSIX `struct iovec`, so a network client built on
+ * `readv`/`writev` can pass an array of these straight through.
+ */
+struct SSLIoVec {
+    /** @brief Start of the buffer */
+    void* iov_base;
+    /** @brief Length of the buffer in bytes */
+    size_t iov_len;
+};
+
+/**
+ * @brief Optional interface for network clients that can move several buffers at once.
+ *
+ * A network client class can inherit from both Client and SSLTransportExt to let
+ * SSLClientFor hand it whole buffer lists in one call (for example to queue a single DMA
+ * transfer, or to use `readv`/`writev` on a socket), and to ask it directly whether it is
+ * ready to send or receive. SSLClientFor detects the interface at compile time; other
+ * network clients keep working through the Client functions.
+ */
+class SSLTransportExt {
+public:
+    virtual ~SSLTransportExt() {}
+
+    /**
+     * @brief Write the buffers, in order, as one transfer.
+     *
+     * The data should be on its way to the network when this function returns, so
+     * SSLClient does not call Client::flush afterwards.
+     *
+     * @returns The number of bytes written, which may be less than the total if the
+     * client ran out of room, or a value <= 0 on error.
+     */
+    virtual int writev(const SSLIoVec* iov, size_t count) = 0;
+
+    /**
+     * @brief Read into the buffers, in order, filling each before moving to the next.
+     * @returns The number of bytes read, or a value <= 0 if nothing could be read.
+     */
+    virtual int readv(const SSLIoVec* iov, size_t count) = 0;
+
+    /** @brief Returns how many bytes can be read without waiting. */
+    virtual int readable() = 0;
+
+    /** @brief Returns how many bytes can be written without waiting, or -1 if unknown. */
+    virtual int writable() = 0;
+};
+
+/**
+ * @brief Vectored write for network clients without SSLTransportExt.
+ *
+ * Writes each buffer with Transport::write, stopping at the first short write, and then
+ * flushes the client once.
+ */
+template<class Transport, class ClientT>
+int SSLTransportWritev(ClientT& c, const SSLIoVec* iov, size_t count) {
+    int total = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t len = Transport::write(c, static_cast<const uint8_t*>(iov[i].iov_base), iov[i].iov_len);
+        if (len == 0 && total == 0) return 0;
+        total += len;
+        if (len < iov[i].iov_len) break;
+    }
+    Transport::flush(c);
+    return total;
+}
+
+/**
+ * @brief Vectored read for network clients without SSLTransportExt.
+ *
+ * Reads each buffer with Transport::read, stopping when the client runs out of data.
+ */
+template<class Transport, class ClientT>
+int SSLTransportReadv(ClientT& c, const SSLIoVec* iov, size_t count) {
+    int total = 0;
+    for (size_t i = 0; i < count; i++) {
+        const int len = Transport::read(c, static_cast<uint8_t*>(iov[i].iov_base), iov[i].iov_len);
+        if (len <= 0) return total > 0 ? total : len;
+        total += len;
+        if (static_cast<size_t>(len) < iov[i].iov_len) break;
+    }
+    return total;
+}
+
+/**
+ * @brief Calls into the network client used by SSLClient.
+ *
+ * SSLClient talks to the network only through these functions. For a concrete client
+ * type (EthernetClient, WiFiClient, ...) every call is qualified with the class name,
+ * which bypasses the vtable and lets the compiler inline the driver code. The
+ * specialization for the abstract Client class below uses normal virtual calls.
+ *
+ * @tparam TransportT The network client type, which must derive from Client and may not
+ * be abstract.
+ */
+template<class TransportT>
+struct SSLTransport {
+    static size_t write(TransportT& c, const uint8_t* buf, size_t size) { return c.TransportT::write(buf, size); }
+    static void flush(TransportT& c) { c.TransportT::flush(); }
+    static int available(TransportT& c) { return c.TransportT::available(); }
+    static int read(TransportT& c, uint8_t* buf, size_t size) { return c.TransportT::read(buf, size); }
+    static uint8_t connected(TransportT& c) { return c.TransportT::connected(); }
+    static int getWriteError(TransportT& c) { return c.TransportT::getWriteError(); }
+
+    /** @brief Limit the time connect() may take, if the client type supports it (e.g. EthernetClient). */
+    static void setConnectTimeout(TransportT& c, unsigned long timeout) { m_set_connect_timeout(c, timeout, 0); }
+
+    /** @brief Write a list of buffers and push them to the network, using SSLTransportExt::writev if available. */
+    static int writev(TransportT& c, const SSLIoVec* iov, size_t count) { return m_writev(c, iov, count, 0); }
+    /** @brief Read into a list of buffers, using SSLTransportExt::readv if available. */
+    static int readv(TransportT& c, const SSLIoVec* iov, size_t count) { return m_readv(c, iov, count, 0); }
+    /** @brief Bytes that can be read now, using SSLTransportExt::readable if available. */
+    static int readable(TransportT& c) { return m_readable(c, 0); }
+    /** @brief Bytes that can be written now, or -1 if the client type cannot tell. */
+    static int writable(TransportT& c) { return m_writable(c, 0); }
+
+private:
+    template<class T>
+    static auto m_writev(T& c, const SSLIoVec* iov, size_t count, int) -> decltype(static_cast<SSLTransportExt*>(&c), int()) {
+        return c.T::writev(iov, count);
+    }
+    template<class T>
+    static int m_writev(T& c, const SSLIoVec* iov, size_t count, long) { return SSLTransportWritev<SSLTransport>(c, iov, count); }
+    template<class T>
+    static auto m_readv(T& c, const SSLIoVec* iov, size_t count, int) -> decltype(static_cast<SSLTransportExt*>(&c), int()) {
+        return c.T::readv(iov, count);
+    }
+    template<class T>
+    static int m_readv(T& c, const SSLIoVec* iov, size_t count, long) { return SSLTransportReadv<SSLTransport>(c, iov, count); }
+    template<class T>
+    static auto m_readable(T& c, int) -> decltype(static_cast<SSLTransportExt*>(&c), int()) { return c.T::readable(); }
+    template<class T>
+    static int m_readable(T& c, long) { return c.T::available(); }
+    template<class T>
+    static auto m_writable(T& c, int) -> decltype(static_cast<SSLTransportExt*>(&c), int()) { return c.T::writable(); }
+    template<class T>
+    static int m_writable(T&, long) { return -1; }
+
+    template<class T>
+    static auto m_set_connect_timeout(T& c, unsigned long timeout, int) -> decltype(c.setConnectionTimeout(0), void()) {
+        // EthernetClient takes a uint16_t
+        c.setConnectionTimeout(timeout > 0xFFFF ? 0xFFFF : timeout);
+    }
+    template<class T>
+    static void m_set_connect_timeout(T&, unsigned long, long) {}
+};
+
+/** @brief Transport calls for an SSLClient that only knows about the Client interface. */
+template<>
+struct SSLTransport<Client> {
+    static size_t write(Client& c, const uint8_t* buf, size_t size) { return c.write(buf, size); }
+    static void flush(Client& c) { c.flush(); }
+    static int available(Client& c) { return c.available(); }
+    static int read(Client& c, uint8_t* buf, size_t size) { return c.read(buf, size); }
+    static uint8_t connected(Client& c) { return c.connected(); }
+    static int getWriteError(Client& c) { return c.getWriteError(); }
+    static void setConnectTimeout(Client&, unsigned long) {}
+
+    static int writev(Client& c, const SSLIoVec* iov, size_t count) { return SSLTransportWritev<SSLTransport>(c, iov, count); }
+    static int readv(Client& c, const SSLIoVec* iov, size_t count) { return SSLTransportReadv<SSLTransport>(c, iov, count); }
+    static int readable(Client& c) { return c.available(); }
+    static int writable(Client&) { return -1; }
+};
+
+#endif /** SSLTransport_H_ */
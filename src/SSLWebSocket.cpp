@@ -0,0 +1,487 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "SSLWebSocket.h"
+
+#ifdef SSLCLIENT_NO_HEAP
+// nothing below this point may use dynamic memory
+#pragma GCC poison malloc calloc realloc free new String
+#endif
+
+constexpr size_t SSLWebSocket::MAX_CONTROL_PAYLOAD;
+
+// appended to our key to compute the accept value the server must send back
+static const char ws_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const char ws_accept_header[] = "sec-websocket-accept:";
+static const char ws_base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// close status codes (RFC 6455 section 7.4.1)
+static const uint16_t WS_CLOSE_NONE = 1005;
+static const uint16_t WS_CLOSE_PROTOCOL_ERROR = 1002;
+
+static const uint8_t WS_FIN = 0x80;
+static const uint8_t WS_RSV = 0x70;
+static const uint8_t WS_MASKED = 0x80;
+
+static char ws_lower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+static void ws_base64(const uint8_t* in, size_t len, char* out) {
+    for (; len >= 3; in += 3, len -= 3) {
+        *out++ = ws_base64_chars[in[0] >> 2];
+        *out++ = ws_base64_chars[((in[0] & 0x3) << 4) | (in[1] >> 4)];
+        *out++ = ws_base64_chars[((in[1] & 0xF) << 2) | (in[2] >> 6)];
+        *out++ = ws_base64_chars[in[2] & 0x3F];
+    }
+    if (len > 0) {
+        *out++ = ws_base64_chars[in[0] >> 2];
+        *out++ = ws_base64_chars[((in[0] & 0x3) << 4) | (len > 1 ? in[1] >> 4 : 0)];
+        *out++ = len > 1 ? ws_base64_chars[(in[1] & 0xF) << 2] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+}
+
+/**
+ * Copy len bytes of payload, XORing them with the masking key. offset is the
+ * position of src in the payload, which picks the key byte to start with. Once
+ * dst is aligned, whole words are masked at once with the key rotated to match;
+ * the key is built in memory order, so this works with either byte order.
+ */
+static void ws_mask_copy(uint8_t* dst, const uint8_t* src, size_t len, const uint8_t* key, size_t offset) {
+    size_t i = 0;
+    for (; i < len && (reinterpret_cast<uintptr_t>(dst + i) & (sizeof(uint32_t) - 1)) != 0; i++)
+        dst[i] = src[i] ^ key[(offset + i) & 3];
+    if (len - i >= sizeof(uint32_t)) {
+        uint8_t rotated[sizeof(uint32_t)];
+        for (size_t k = 0; k < sizeof rotated; k++) rotated[k] = key[(offset + i + k) & 3];
+        uint32_t word_key;
+        memcpy(&word_key, rotated, sizeof word_key);
+        for (; len - i >= sizeof(uint32_t); i += sizeof(uint32_t)) {
+            uint32_t word;
+            memcpy(&word, src + i, sizeof word);
+            word ^= word_key;
+            memcpy(dst + i, &word, sizeof word);
+        }
+    }
+    for (; i < len; i++) dst[i] = src[i] ^ key[(offset + i) & 3];
+}
+
+/* see SSLWebSocket.h */
+SSLWebSocket::SSLWebSocket(SSLClient& client, const char* host, uint16_t port)
+    : m_client(client)
+    , m_host(host)
+    , m_port(port)
+    , m_timeout(10000)
+    , m_listener(nullptr)
+    , m_open(false)
+    , m_writing(false)
+    , m_line()
+    , m_line_len(0)
+    , m_status_line(true)
+    , m_upgraded(false)
+    , m_accepted(false)
+    , m_rx_state(RX_HEADER)
+    , m_rx_header()
+    , m_rx_header_len(0)
+    , m_rx_opcode(0)
+    , m_rx_fin(false)
+    , m_rx_left(0)
+    , m_rx_in_message(false)
+    , m_rx_text(false)
+    , m_rx_message(false)
+    , m_ctl()
+    , m_ctl_len(0)
+    , m_pong()
+    , m_pong_len(0)
+    , m_pong_pending(false)
+    , m_closing(false)
+    , m_close_code(WS_CLOSE_NONE)
+    , m_close_sent(false)
+    , m_keys()
+    , m_keys_used(sizeof m_keys) {}
+
+/* see SSLWebSocket.h */
+bool SSLWebSocket::connect(const char* path, const char* headers) {
+    m_open = false;
+    m_client.stop();
+    if (!m_client.connect(m_host, m_port)) return false;
+    // the key is random, and the server proves it understood the request by hashing it
+    uint8_t nonce[16];
+    char key[25];
+    if (!m_client.getRandom(nonce, sizeof nonce)) {
+        m_client.stop();
+        return false;
+    }
+    ws_base64(nonce, sizeof nonce, key);
+    br_sha1_context sha;
+    uint8_t digest[br_sha1_SIZE];
+    char accept[29];
+    br_sha1_init(&sha);
+    br_sha1_update(&sha, key, strlen(key));
+    br_sha1_update(&sha, ws_guid, sizeof ws_guid - 1);
+    br_sha1_out(&sha, digest);
+    ws_base64(digest, sizeof digest, accept);
+    if (!m_send_upgrade(path, headers, key) || !m_read_upgrade(accept)) {
+        m_client.stop();
+        return false;
+    }
+    m_open = true;
+    m_writing = false;
+    m_rx_state = RX_HEADER;
+    m_rx_header_len = 0;
+    m_rx_in_message = false;
+    m_pong_pending = false;
+    m_closing = false;
+    m_close_sent = false;
+    m_keys_used = sizeof m_keys;
+    return true;
+}
+
+/* see SSLWebSocket.h */
+bool SSLWebSocket::connected() {
+    if (m_open && !m_client.connected()) m_fail();
+    return m_open;
+}
+
+/* see SSLWebSocket.h */
+bool SSLWebSocket::send(Opcode opcode, const void* data, size_t len) {
+    if (!m_open || m_closing || m_close_sent) return false;
+    if ((opcode & 0x8) && len > MAX_CONTROL_PAYLOAD) return false;
+    if (!m_write_frame(opcode, static_cast<const uint8_t*>(data), len)) return false;
+    // a ping may have arrived while the frame was written
+    m_send_pending();
+    return m_open;
+}
+
+/* see SSLWebSocket.h */
+bool SSLWebSocket::poll() {
+    // available (which peekBuffer calls) closes the record being written, and the
+    // next call sends it, so it takes two passes to be sure everything went out
+    for (int i = 0; i < 2 && m_open; i++) m_service(false);
+    return m_open;
+}
+
+/* see SSLWebSocket.h */
+bool SSLWebSocket::wait() {
+    return m_service(true);
+}
+
+/* see SSLWebSocket.h */
+void SSLWebSocket::close(uint16_t code) {
+    if (!m_open) return;
+    if (!m_closing && !m_close_sent) {
+        const uint8_t payload[2] = { static_cast<uint8_t>(code >> 8), static_cast<uint8_t>(code) };
+        if (!m_write_frame(OP_CLOSE, payload, sizeof payload)) return;
+        m_close_sent = true;
+    }
+    // the server answers with its own close frame, then closes the connection
+    const unsigned long start = millis();
+    while (m_open && !m_closing && millis() - start < m_timeout) m_service(false);
+    if (m_closing) m_send_pending();
+    else m_fail(code);
+}
+
+bool SSLWebSocket::m_send_upgrade(const char* path, const char* headers, const char* key) {
+    bool ok = m_client.print("GET ") > 0
+        && m_client.print(path) > 0
+        && m_client.print(" HTTP/1.1\r\nHost: ") > 0
+        && m_client.print(m_host) > 0;
+    if (ok && m_port != 443) ok = m_client.print(':') > 0 && m_client.print(m_port) > 0;
+    ok = ok && m_client.print("\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\nSec-WebSocket-Key: ") > 0
+        && m_client.print(key) > 0
+        && m_client.print("\r\n") > 0;
+    if (ok && headers != nullptr && headers[0] != '\0') ok = m_client.print(headers) > 0;
+    return ok && m_client.print("\r\n") > 0;
+}
+
+bool SSLWebSocket::m_read_upgrade(const char* accept) {
+    m_line_len = 0;
+    m_status_line = true;
+    m_upgraded = false;
+    m_accepted = false;
+    // the server answers the request, so waiting for it here is fine
+    m_client.flush();
+    unsigned long last = millis();
+    for (;;) {
+        size_t len;
+        const uint8_t* data = m_client.peekBuffer(len);
+        if (data == nullptr) {
+            if (!m_client.connected() || millis() - last > m_timeout) return false;
+            continue;
+        }
+        // frames may follow the headers in the same record, so stop right after them
+        size_t used = 0;
+        bool done = false;
+        while (used < len && !done) done = m_parse_upgrade(static_cast<char>(data[used++]), accept);
+        m_client.consume(used);
+        if (done) return m_upgraded && m_accepted;
+        last = millis();
+    }
+}
+
+bool SSLWebSocket::m_parse_upgrade(char c, const char* accept) {
+    if (c == '\r') return false;
+    if (c != '\n') {
+        // long lines are cut short, since none of the ones we need are
+        if (m_line_len < sizeof m_line - 1) m_line[m_line_len++] = c;
+        return false;
+    }
+    const size_t len = m_line_len;
+    m_line[len] = '\0';
+    m_line_len = 0;
+    if (m_status_line) {
+        // "HTTP/1.1 101 Switching Protocols"
+        const char* code = strchr(m_line, ' ');
+        m_status_line = false;
+        m_upgraded = code != nullptr && strncmp(code + 1, "101", 3) == 0;
+        return false;
+    }
+    if (len == 0) return true;
+    const size_t name_len = sizeof ws_accept_header - 1;
+    if (len < name_len) return false;
+    for (size_t i = 0; i < name_len; i++) {
+        if (ws_lower(m_line[i]) != ws_accept_header[i]) return false;
+    }
+    char* value = m_line + name_len;
+    while (*value == ' ' || *value == '\t') value++;
+    char* end = m_line + len;
+    while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    *end = '\0';
+    m_accepted = strcmp(value, accept) == 0;
+    return false;
+}
+
+bool SSLWebSocket::m_service(bool wait_message) {
+    unsigned long last = millis();
+    m_rx_message = false;
+    while (m_open) {
+        if (wait_message && m_rx_message) return true;
+        size_t len;
+        const uint8_t* data = m_client.peekBuffer(len);
+        if (data != nullptr) {
+            m_client.consume(m_receive(data, len));
+            m_send_pending();
+            last = millis();
+            continue;
+        }
+        if (!m_client.connected()) {
+            m_fail();
+            return false;
+        }
+        if (!wait_message) return true;
+        if (millis() - last > m_timeout) return false;
+    }
+    return false;
+}
+
+bool SSLWebSocket::m_next_key(uint8_t* key) {
+    if (m_keys_used + 4u > sizeof m_keys) {
+        if (!m_client.getRandom(m_keys, sizeof m_keys)) return false;
+        m_keys_used = 0;
+    }
+    memcpy(key, m_keys + m_keys_used, 4);
+    m_keys_used += 4;
+    return true;
+}
+
+size_t SSLWebSocket::m_receive(const uint8_t* data, size_t len) {
+    size_t used = 0;
+    while (used < len && m_open && !m_closing) {
+        if (m_rx_state == RX_HEADER) {
+            m_rx_header[m_rx_header_len++] = data[used++];
+            if (m_rx_header_len < 2) continue;
+            const uint8_t len7 = m_rx_header[1] & 0x7F;
+            const uint8_t header_len = len7 == 127 ? 10 : len7 == 126 ? 4 : 2;
+            if (m_rx_header_len == header_len && !m_begin_frame()) break;
+            continue;
+        }
+        const size_t n = len - used < m_rx_left ? len - used : static_cast<size_t>(m_rx_left);
+        const uint8_t* p = data + used;
+        used += n;
+        m_rx_left -= n;
+        if (m_rx_opcode & 0x8) {
+            memcpy(m_ctl + m_ctl_len, p, n);
+            m_ctl_len += static_cast<uint8_t>(n);
+        }
+        else if (m_listener != nullptr)
+            m_listener->onMessage(p, n, m_rx_text, m_rx_fin && m_rx_left == 0);
+        if (m_rx_left == 0) m_end_frame();
+    }
+    // nothing after a close frame matters
+    return m_closing ? len : used;
+}
+
+bool SSLWebSocket::m_begin_frame() {
+    const uint8_t* h = m_rx_header;
+    m_rx_fin = (h[0] & WS_FIN) != 0;
+    m_rx_opcode = h[0] & 0x0F;
+    const uint8_t len7 = h[1] & 0x7F;
+    if (len7 == 127) {
+        m_rx_left = 0;
+        for (size_t i = 2; i < 10; i++) m_rx_left = (m_rx_left << 8) | h[i];
+    }
+    else if (len7 == 126) m_rx_left = (static_cast<uint16_t>(h[2]) << 8) | h[3];
+    else m_rx_left = len7;
+    m_rx_header_len = 0;
+    m_rx_state = RX_PAYLOAD;
+    // no extensions were negotiated, and servers never mask
+    bool ok = !(h[0] & WS_RSV) && !(h[1] & WS_MASKED);
+    if (m_rx_opcode & 0x8) {
+        ok = ok && m_rx_fin && m_rx_left <= MAX_CONTROL_PAYLOAD
+            && (m_rx_opcode == OP_CLOSE || m_rx_opcode == OP_PING || m_rx_opcode == OP_PONG);
+        m_ctl_len = 0;
+    }
+    else if (m_rx_opcode == OP_CONTINUATION)
+        ok = ok && m_rx_in_message;
+    else {
+        ok = ok && !m_rx_in_message && (m_rx_opcode == OP_TEXT || m_rx_opcode == OP_BINARY);
+        m_rx_in_message = true;
+        m_rx_text = m_rx_opcode == OP_TEXT;
+    }
+    if (!ok) {
+        m_fail(WS_CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+    if (m_rx_left == 0) {
+        // an empty frame can still end a message
+        if (!(m_rx_opcode & 0x8) && m_rx_fin && m_listener != nullptr)
+            m_listener->onMessage(m_rx_header, 0, m_rx_text, true);
+        m_end_frame();
+    }
+    return true;
+}
+
+void SSLWebSocket::m_end_frame() {
+    m_rx_state = RX_HEADER;
+    switch (m_rx_opcode) {
+    case OP_PING:
+        // only the latest ping needs an answer
+        memcpy(m_pong, m_ctl, m_ctl_len);
+        m_pong_len = m_ctl_len;
+        m_pong_pending = true;
+        break;
+    case OP_CLOSE:
+        m_close_code = m_ctl_len >= 2 ? static_cast<uint16_t>((m_ctl[0] << 8) | m_ctl[1]) : WS_CLOSE_NONE;
+        m_closing = true;
+        break;
+    case OP_PONG:
+        break;
+    default:
+        if (m_rx_fin) {
+            m_rx_in_message = false;
+            m_rx_message = true;
+        }
+        break;
+    }
+}
+
+bool SSLWebSocket::m_write_frame(uint8_t opcode, const uint8_t* data, size_t len) {
+    uint8_t header[14];
+    size_t header_len = 2;
+    header[0] = WS_FIN | opcode;
+    if (len < 126) header[1] = WS_MASKED | static_cast<uint8_t>(len);
+    else if (len <= 0xFFFF) {
+        header[1] = WS_MASKED | 126;
+        header[2] = static_cast<uint8_t>(len >> 8);
+        header[3] = static_cast<uint8_t>(len);
+        header_len = 4;
+    }
+    else {
+        header[1] = WS_MASKED | 127;
+        const uint64_t len64 = len;
+        for (size_t i = 0; i < 8; i++) header[2 + i] = static_cast<uint8_t>(len64 >> (56 - 8 * i));
+        header_len = 10;
+    }
+    uint8_t* key = header + header_len;
+    if (!m_next_key(key)) return false;
+    header_len += 4;
+    m_writing = true;
+    const bool ok = m_put(header, header_len, nullptr, 0) && (len == 0 || m_put(data, len, key, 0));
+    m_writing = false;
+    if (!ok) m_fail();
+    return ok;
+}
+
+bool SSLWebSocket::m_put(const uint8_t* data, size_t len, const uint8_t* mask, size_t offset) {
+    unsigned long last = millis();
+    while (len > 0) {
+        // never fill the record: sending it would wait for the shared buffer, and drop
+        // whatever the server sent meanwhile
+        const int room = m_open ? m_client.availableForWrite() : 0;
+        size_t avail = 0;
+        uint8_t* dst = room > 0 ? m_client.writeBuffer(avail) : nullptr;
+        if (dst == nullptr) {
+            if (!m_make_room(last)) return false;
+            continue;
+        }
+        const size_t n = len < static_cast<size_t>(room) ? len : static_cast<size_t>(room);
+        if (mask != nullptr) ws_mask_copy(dst, data, n, mask, offset);
+        else memcpy(dst, data, n);
+        if (m_client.commit(n) != n) return false;
+        data += n;
+        len -= n;
+        offset += n;
+        last = millis();
+    }
+    return true;
+}
+
+bool SSLWebSocket::m_make_room(unsigned long& last) {
+    if (!m_open) return false;
+    // reading what arrived frees the buffer, and sends what was written
+    size_t len;
+    const uint8_t* data = m_client.peekBuffer(len);
+    if (data != nullptr) {
+        m_client.consume(m_receive(data, len));
+        last = millis();
+        return m_open;
+    }
+    if (!m_client.connected() || millis() - last > m_timeout) {
+        m_fail();
+        return false;
+    }
+    return true;
+}
+
+void SSLWebSocket::m_send_pending() {
+    if (!m_open || m_writing) return;
+    if (m_closing) {
+        // echo the server's status code, unless we already sent our own close frame
+        if (!m_close_sent) {
+            const uint8_t payload[2] = { static_cast<uint8_t>(m_close_code >> 8), static_cast<uint8_t>(m_close_code) };
+            m_close_sent = true;
+            if (!m_write_frame(OP_CLOSE, payload, m_close_code != WS_CLOSE_NONE ? sizeof payload : 0)) return;
+        }
+        m_fail(m_close_code);
+        return;
+    }
+    if (m_pong_pending) {
+        m_pong_pending = false;
+        m_write_frame(OP_PONG, m_pong, m_pong_len);
+    }
+}
+
+void SSLWebSocket::m_fail(uint16_t code) {
+    if (!m_open) return;
+    m_open = false;
+    // stop sends whatever is still buffered, such as our close frame
+    m_client.stop();
+    if (m_listener != nullptr) m_listener->onClose(code);
+}
@@ -0,0 +1,239 @@
+/* Copyright 2019 OSU OPEnS Lab
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * SSLWebSocket.h
+ *
+ * A WebSocket (RFC 6455) client on top of SSLClient that builds frames in
+ * SSLClient's send buffer and parses them from its receive buffer.
+ */
+
+#include "SSLClient.h"
+
+#ifndef SSLWebSocket_H_
+#define SSLWebSocket_H_
+
+/** @brief Receives the messages of an SSLWebSocket. */
+class SSLWebSocketListener {
+public:
+    virtual ~SSLWebSocketListener() {}
+    /**
+     * @brief Called with each piece of a message as it is received.
+     *
+     * Messages are not collected, so one message may arrive in several pieces (one per
+     * TLS record or frame, at least), and may be of any size. The data points into
+     * SSLClient's receive buffer, and is only valid during the call.
+     *
+     * @param text true for text messages, false for binary ones.
+     * @param last true for the last piece of the message, which may be empty.
+     */
+    virtual void onMessage(const uint8_t* /* data */, size_t /* len */, bool /* text */, bool /* last */) {}
+    /**
+     * @brief Called when the WebSocket closes, with the status code the server gave (1005
+     * if it gave none, 1006 if the connection was lost without one).
+     */
+    virtual void onClose(uint16_t /* code */) {}
+};
+
+/**
+ * @brief A WebSocket over an SSLClient connection, without extra buffers.
+ *
+ * WebSocket frames sent by a client must be masked: XORed with a random key that changes
+ * with every frame. Instead of building each frame in a separate buffer and writing it,
+ * SSLWebSocket writes the frame header straight into SSLClient's send buffer (see
+ * SSLClient::writeBuffer), and masks the payload a word at a time as it copies it there.
+ * Frames from the server are parsed straight out of the receive buffer, and their
+ * payload is handed to an SSLWebSocketListener in place:
+ * ```C++
+ * SSLWebSocket ws(client, "stream.example.com");
+ * ws.setListener(&commands);
+ * if (ws.connect("/commands")) {
+ *     ws.sendText("{\"hello\":1}");
+ *     while (ws.connected()) ws.poll();
+ * }
+ * ```
+ * Since the server may send at any time, frames are never written in a way that would
+ * make SSLClient wait for its shared buffer (see SSLClient::availableForWrite): a frame
+ * larger than the free space is written in parts, and whatever the server sent meanwhile
+ * is handled first. Pings are answered automatically.
+ */
+class SSLWebSocket {
+public:
+    /** @brief Opcodes of the frames SSLWebSocket sends and receives */
+    enum Opcode : uint8_t {
+        OP_CONTINUATION = 0x0,
+        OP_TEXT = 0x1,
+        OP_BINARY = 0x2,
+        OP_CLOSE = 0x8,
+        OP_PING = 0x9,
+        OP_PONG = 0xA,
+    };
+
+    /** @brief Longest payload of a control frame (ping, pong or close) */
+    static constexpr size_t MAX_CONTROL_PAYLOAD = 125;
+
+    /**
+     * @brief Create a WebSocket using an SSLClient.
+     * @param client The SSLClient to use. SSLWebSocket connects it, and it should not be
+     * used for anything else meanwhile.
+     * @param host The server's hostname, sent in the Host header. It is not copied, and
+     * must stay valid for the life of this object.
+     * @param port The server's port.
+     */
+    SSLWebSocket(SSLClient& client, const char* host, uint16_t port = 443);
+
+    /**
+     * @brief Connect, and open the WebSocket with an HTTP Upgrade request.
+     * @param path The path and query of the WebSocket, starting with "/".
+     * @param headers Extra header lines for the request (such as Sec-WebSocket-Protocol or
+     * Authorization), each ending with "\r\n", or nullptr.
+     * @returns true if the server accepted the WebSocket.
+     */
+    bool connect(const char* path, const char* headers = nullptr);
+
+    /** @brief Returns true while the WebSocket is open. */
+    bool connected();
+
+    /** @brief Send a text message (see SSLWebSocket::send). */
+    bool sendText(const char* text) { return send(OP_TEXT, text, strlen(text)); }
+
+    /** @brief Send a binary message (see SSLWebSocket::send). */
+    bool sendBinary(const void* data, size_t len) { return send(OP_BINARY, data, len); }
+
+    /**
+     * @brief Send a message as one frame.
+     *
+     * The frame is buffered by SSLClient, and is only sure to be sent after
+     * SSLWebSocket::poll, so that several small messages can share a TLS record.
+     *
+     * @param opcode OP_TEXT or OP_BINARY, or OP_PING (for at most MAX_CONTROL_PAYLOAD bytes).
+     * @returns false if the WebSocket is not open, or the frame could not be written.
+     */
+    bool send(Opcode opcode, const void* data, size_t len);
+
+    /** @brief Send a ping, which the server answers with a pong. */
+    bool ping(const void* data = nullptr, size_t len = 0) { return send(OP_PING, data, len); }
+
+    /**
+     * @brief Send buffered frames, and handle whatever the server sent, without waiting.
+     *
+     * Unlike SSLClient::flush, this does not wait for the server to send something, which
+     * on a WebSocket it may never do.
+     *
+     * @returns false if the WebSocket is closed.
+     */
+    bool poll();
+
+    /**
+     * @brief Handle what the server sends until a message is complete.
+     * @returns true if a message arrived, false if the WebSocket closed or the timeout passed.
+     */
+    bool wait();
+
+    /**
+     * @brief Close the WebSocket, telling the server why, and close the connection.
+     * @param code The status code, 1000 for a normal closure.
+     */
+    void close(uint16_t code = 1000);
+
+    /** @brief Set the object that receives messages. */
+    void setListener(SSLWebSocketListener* listener) { m_listener = listener; }
+
+    /** @brief Set how long to wait for the server, in milliseconds (default 10000). */
+    void setTimeout(unsigned long timeout) { m_timeout = timeout; }
+
+private:
+    enum RxState : uint8_t {
+        RX_HEADER,
+        RX_PAYLOAD,
+    };
+
+    /** send the upgrade request, false if it could not be written */
+    bool m_send_upgrade(const char* path, const char* headers, const char* key);
+    /** read the upgrade response, false unless it accepts our key */
+    bool m_read_upgrade(const char* accept);
+    /** feed one byte of the upgrade response, returns true at the end of its headers */
+    bool m_parse_upgrade(char c, const char* accept);
+    /** handle received data until a message is complete (if wait_message) or nothing more has arrived */
+    bool m_service(bool wait_message);
+    /** get the next masking key */
+    bool m_next_key(uint8_t* key);
+    /** handle received bytes, returns how many were used */
+    size_t m_receive(const uint8_t* data, size_t len);
+    /** a frame header arrived */
+    bool m_begin_frame();
+    /** the current frame is complete */
+    void m_end_frame();
+    /** write a whole frame */
+    bool m_write_frame(uint8_t opcode, const uint8_t* data, size_t len);
+    /** copy bytes into the send buffer, masking them if mask is not null */
+    bool m_put(const uint8_t* data, size_t len, const uint8_t* mask, size_t offset);
+    /** wait until at least one byte can be written without SSLClient waiting for the server */
+    bool m_make_room(unsigned long& last);
+    /** send the pong or close frame that is due */
+    void m_send_pending();
+    /** drop the connection, telling the listener with code */
+    void m_fail(uint16_t code = 1006);
+
+    SSLClient& m_client;
+    const char* m_host;
+    const uint16_t m_port;
+    unsigned long m_timeout;
+    SSLWebSocketListener* m_listener;
+    bool m_open;
+    // set while frames are written, so that pongs don't end up inside them
+    bool m_writing;
+    // upgrade response parsing: the current line (truncated), whether it is the
+    // status line, and what was found so far
+    char m_line[64];
+    uint8_t m_line_len;
+    bool m_status_line;
+    bool m_upgraded;
+    bool m_accepted;
+    // the frame being received: its header (up to 10 bytes from the server, which
+    // doesn't mask), and what is left of its payload
+    RxState m_rx_state;
+    uint8_t m_rx_header[10];
+    uint8_t m_rx_header_len;
+    uint8_t m_rx_opcode;
+    bool m_rx_fin;
+    uint64_t m_rx_left;
+    // a message is being received, it is text, and whether one completed
+    bool m_rx_in_message;
+    bool m_rx_text;
+    bool m_rx_message;
+    // control frame payload
+    uint8_t m_ctl[MAX_CONTROL_PAYLOAD];
+    uint8_t m_ctl_len;
+    // a ping waiting to be answered
+    uint8_t m_pong[MAX_CONTROL_PAYLOAD];
+    uint8_t m_pong_len;
+    bool m_pong_pending;
+    // the server closed the WebSocket with m_close_code, and whether we sent a close frame
+    bool m_closing;
+    uint16_t m_close_code;
+    bool m_close_sent;
+    // masking keys are generated several at a time, since each call to the DRBG costs
+    // a few HMACs
+    uint8_t m_keys[32];
+    uint8_t m_keys_used;
+};
+
+#endif /* SSLWebSocket_H_ */
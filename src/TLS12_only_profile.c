@@ -456,8 +456,13 @@ br_client_init_TLS12_only(br_ssl_client_context *cc,
 	// br_x509_minimal_set_hash(xc, br_sha1_ID, &br_sha1_vtable);
 	br_x509_minimal_set_hash(xc, br_sha224_ID, &br_sha224_vtable);
 	br_x509_minimal_set_hash(xc, br_sha256_ID, &br_sha256_vtable);
+	// reduced footprint builds (see SSLClientConfig.h) cannot hold the larger hashes
+#if BR_X509_BUFSIZE_HASH >= 48
 	br_x509_minimal_set_hash(xc, br_sha384_ID, &br_sha384_vtable);
+#endif
+#if BR_X509_BUFSIZE_HASH >= 64
 	br_x509_minimal_set_hash(xc, br_sha512_ID, &br_sha512_vtable);
+#endif
 
 	/*
 	 * Link the X.509 engine in the SSL engine.
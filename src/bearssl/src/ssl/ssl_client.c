@@ -37,13 +37,33 @@ br_ssl_client_zero(br_ssl_client_context *cc)
 	memset(cc, 0, sizeof *cc);
 }
 
+/*
+ * Set the name sent in the SNI extension. Returned value is 1 on success,
+ * 0 on error (name too long).
+ */
+static int
+set_server_name(br_ssl_client_context *cc, const char *server_name)
+{
+	size_t n;
+
+	if (server_name == NULL) {
+		cc->eng.server_name[0] = 0;
+	} else {
+		n = strlen(server_name) + 1;
+		if (n > sizeof cc->eng.server_name) {
+			br_ssl_engine_fail(&cc->eng, BR_ERR_BAD_PARAM);
+			return 0;
+		}
+		memcpy(cc->eng.server_name, server_name, n);
+	}
+	return 1;
+}
+
 /* see bearssl_ssl.h */
 int
 br_ssl_client_reset(br_ssl_client_context *cc,
 	const char *server_name, int resume_session)
 {
-	size_t n;
-
 	br_ssl_engine_set_buffer(&cc->eng, NULL, 0, 0);
 	cc->eng.version_out = cc->eng.version_min;
 	if (!resume_session) {
@@ -61,18 +81,67 @@ br_ssl_client_reset(br_ssl_client_context *cc,
 	 */
 	cc->eng.reneg = 0;
 
-	if (server_name == NULL) {
-		cc->eng.server_name[0] = 0;
-	} else {
-		n = strlen(server_name) + 1;
-		if (n > sizeof cc->eng.server_name) {
-			br_ssl_engine_fail(&cc->eng, BR_ERR_BAD_PARAM);
-			return 0;
-		}
-		memcpy(cc->eng.server_name, server_name, n);
+	if (!set_server_name(cc, server_name)) {
+		return 0;
 	}
 
 	br_ssl_engine_hs_reset(&cc->eng,
 		br_ssl_hs_client_init_main, br_ssl_hs_client_run);
 	return br_ssl_engine_last_error(&cc->eng) == BR_ERR_OK;
 }
+
+static int
+client_wake(br_ssl_client_context *cc,
+	const char *server_name, const br_ssl_hibernation *hb)
+{
+	br_ssl_engine_set_buffer(&cc->eng, NULL, 0, 0);
+	if (!br_ssl_engine_init_rand(&cc->eng)) {
+		return 0;
+	}
+	if (!set_server_name(cc, server_name)) {
+		return 0;
+	}
+
+	/*
+	 * Put back the values the keys are derived from; the handshake
+	 * handler sees the 'wake' flag and switches to them instead of
+	 * sending a ClientHello. The rest of the record state is
+	 * restored afterwards.
+	 */
+	br_ssl_engine_set_session_parameters(&cc->eng, &hb->session);
+	memcpy(cc->eng.client_random, hb->client_random,
+		sizeof cc->eng.client_random);
+	memcpy(cc->eng.server_random, hb->server_random,
+		sizeof cc->eng.server_random);
+	cc->eng.wake = 1;
+	br_ssl_engine_hs_reset(&cc->eng,
+		br_ssl_hs_client_init_main, br_ssl_hs_client_run);
+	if (!br_ssl_engine_wake_records(&cc->eng, hb)) {
+		if (br_ssl_engine_last_error(&cc->eng) == BR_ERR_OK) {
+			br_ssl_engine_fail(&cc->eng, BR_ERR_BAD_STATE);
+		}
+		return 0;
+	}
+	return 1;
+}
+
+/* see bearssl_ssl.h */
+int
+br_ssl_client_wake(br_ssl_client_context *cc,
+	const char *server_name, br_ssl_hibernation *hb)
+{
+	int r;
+
+	/*
+	 * A state that was already used has been erased; its version
+	 * is then zero, which no real session has.
+	 */
+	if (hb->session.version == 0) {
+		cc->eng.iomode = BR_IO_FAILED;
+		cc->eng.err = BR_ERR_BAD_PARAM;
+		return 0;
+	}
+	r = client_wake(cc, server_name, hb);
+	memset(hb, 0, sizeof *hb);
+	return r;
+}
@@ -445,6 +445,19 @@ br_ssl_engine_set_buffers_bidi(br_ssl_engine_context *rc,
 		rc->max_frag_len = (size_t)1 << u;
 		rc->log_max_frag_len = u;
 		rc->peer_log_max_frag_len = 0;
+
+		/*
+		 * The Record Size Limit is the plaintext length of the
+		 * largest record we can receive, with the worst-case
+		 * overhead. Unlike the fragment length above, it needs
+		 * not be a power of two.
+		 */
+		if (ibuf_len >= 16384 + MAX_IN_OVERHEAD) {
+			rc->record_size_limit = 16384;
+		} else {
+			rc->record_size_limit =
+				(uint16_t)(ibuf_len - MAX_IN_OVERHEAD);
+		}
 	}
 	rc->out.vtable = &br_sslrec_out_clear_vtable;
 	make_ready_in(rc);
@@ -730,9 +743,27 @@ recvrec_ack(br_ssl_engine_context *rc, size_t len)
 
 	/*
 	 * Since encryption is active, we must wait for a full record
-	 * before processing it.
+	 * before using it. With GCM and ChaCha20+Poly1305, the bytes
+	 * received so far can already be authenticated and decrypted,
+	 * so that less work remains when the last bytes arrive; the
+	 * record payload stays hidden until its tag has been checked.
 	 */
 	if (rc->ixc != 0) {
+		if ((const void *)rc->in.vtable
+			== (const void *)rc->igcm_in)
+		{
+			br_sslrec_in_gcm_update(&rc->in.gcm,
+				rc->record_type_in, rc->version_in,
+				rc->ibuf + 5, rc->ixa - 5,
+				rc->ixa - 5 + rc->ixc);
+		} else if ((const void *)rc->in.vtable
+			== (const void *)rc->ichapol_in)
+		{
+			br_sslrec_in_chapol_update(&rc->in.chapol,
+				rc->record_type_in, rc->version_in,
+				rc->ibuf + 5, rc->ixa - 5,
+				rc->ixa - 5 + rc->ixc);
+		}
 		return;
 	}
 
@@ -1308,6 +1339,14 @@ void
 br_ssl_engine_hs_reset(br_ssl_engine_context *cc,
 	void (*hsinit)(void *), void (*hsrun)(void *))
 {
+	/*
+	 * A Record Size Limit from the previous peer lowered the
+	 * outgoing fragment length; it does not apply to the next
+	 * handshake, which starts again from our buffer sizes.
+	 */
+	if (cc->log_max_frag_len >= 9 && cc->log_max_frag_len <= 14) {
+		cc->max_frag_len = (size_t)1 << cc->log_max_frag_len;
+	}
 	engine_clearbuf(cc);
 	cc->cpu.dp = cc->dp_stack;
 	cc->cpu.rp = cc->rp_stack;
@@ -1319,6 +1358,160 @@ br_ssl_engine_hs_reset(br_ssl_engine_context *cc,
 	jump_handshake(cc, 0);
 }
 
+/*
+ * All record handler contexts used with encryption start with the
+ * vtable pointer, followed by the sequence number.
+ */
+typedef struct {
+	const void *vtable;
+	uint64_t seq;
+} record_seq_header;
+
+/*
+ * CBC contexts additionally keep the chaining value (used as IV for the
+ * next record with TLS 1.0).
+ */
+static int
+in_is_cbc(const br_ssl_engine_context *cc)
+{
+	return (const void *)cc->in.vtable == (const void *)cc->icbc_in;
+}
+
+static int
+out_is_cbc(const br_ssl_engine_context *cc)
+{
+	return (const void *)cc->out.vtable == (const void *)cc->icbc_out;
+}
+
+/* see bearssl_ssl.h */
+int
+br_ssl_engine_hibernate(br_ssl_engine_context *cc,
+	br_ssl_hibernation *hb)
+{
+	/*
+	 * The connection must be established and idle: no partial
+	 * incoming record, nothing buffered for output, and no
+	 * application data waiting to be read.
+	 */
+	if (cc->err != BR_ERR_OK || cc->application_data != 1
+		|| !cc->incrypt || cc->shutdown_recv
+		|| cc->iomode != BR_IO_INOUT || cc->ixa != 0 || cc->ixb != 0
+		|| has_rec_tosend(cc) || br_ssl_engine_has_pld_to_send(cc))
+	{
+		return 0;
+	}
+	memset(hb, 0, sizeof *hb);
+	memcpy(&hb->session, &cc->session, sizeof hb->session);
+	memcpy(hb->client_random, cc->client_random, sizeof hb->client_random);
+	memcpy(hb->server_random, cc->server_random, sizeof hb->server_random);
+	hb->seq_in = ((const record_seq_header *)&cc->in)->seq;
+	hb->seq_out = ((const record_seq_header *)&cc->out)->seq;
+	if (in_is_cbc(cc)) {
+		memcpy(hb->iv_in, cc->in.cbc.iv, sizeof hb->iv_in);
+	}
+	if (out_is_cbc(cc)) {
+		memcpy(hb->iv_out, cc->out.cbc.iv, sizeof hb->iv_out);
+	}
+	memcpy(hb->saved_finished, cc->saved_finished,
+		sizeof hb->saved_finished);
+	hb->reneg = cc->reneg;
+	hb->max_frag_len = cc->max_frag_len;
+	hb->selected_protocol = cc->selected_protocol;
+
+	/*
+	 * The saved state is now the only copy of the keys. Erase them
+	 * from the context and close it, so that it cannot send a record
+	 * with a sequence number the woken connection will use again.
+	 */
+	memset(&cc->session, 0, sizeof cc->session);
+	memset(cc->client_random, 0, sizeof cc->client_random);
+	memset(cc->server_random, 0, sizeof cc->server_random);
+	memset(&cc->in, 0, sizeof cc->in);
+	memset(&cc->out, 0, sizeof cc->out);
+	cc->out.vtable = &br_sslrec_out_clear_vtable;
+	cc->incrypt = 0;
+	if (cc->ks_buf != NULL) {
+		memset(cc->ks_buf, 0, cc->ks_buf_len);
+	}
+	cc->iomode = BR_IO_FAILED;
+	return 1;
+}
+
+/* see inner.h */
+int
+br_ssl_engine_wake_records(br_ssl_engine_context *cc,
+	const br_ssl_hibernation *hb)
+{
+	if (cc->err != BR_ERR_OK || cc->application_data != 1
+		|| !cc->incrypt)
+	{
+		return 0;
+	}
+	((record_seq_header *)&cc->in)->seq = hb->seq_in;
+	((record_seq_header *)&cc->out)->seq = hb->seq_out;
+	if (in_is_cbc(cc)) {
+		memcpy(cc->in.cbc.iv, hb->iv_in, sizeof hb->iv_in);
+	}
+	if (out_is_cbc(cc)) {
+		memcpy(cc->out.cbc.iv, hb->iv_out, sizeof hb->iv_out);
+	}
+	memcpy(cc->saved_finished, hb->saved_finished,
+		sizeof cc->saved_finished);
+	cc->reneg = hb->reneg;
+	cc->selected_protocol = hb->selected_protocol;
+	if (hb->max_frag_len < cc->max_frag_len) {
+		cc->max_frag_len = hb->max_frag_len;
+	}
+
+	/*
+	 * The current output record was laid out before the switch
+	 * to encryption, so it must be prepared again for the new
+	 * record overhead. It is still empty at this point.
+	 */
+	make_ready_out(cc);
+	return 1;
+}
+
+/* see bearssl_ssl.h */
+void
+br_ssl_engine_set_keystream_buffer(br_ssl_engine_context *cc,
+	void *buf, size_t len)
+{
+	/*
+	 * The record encryption context points into the old buffer
+	 * until its keystream is used; forget it.
+	 */
+	if ((const void *)cc->out.vtable == (const void *)cc->igcm_out) {
+		cc->out.gcm.ks = NULL;
+		cc->out.gcm.ks_len = 0;
+	} else if ((const void *)cc->out.vtable
+		== (const void *)cc->ichapol_out)
+	{
+		cc->out.chapol.ks = NULL;
+		cc->out.chapol.ks_len = 0;
+	}
+	cc->ks_buf = (unsigned char *)buf;
+	cc->ks_buf_len = buf == NULL ? 0 : len;
+}
+
+/* see bearssl_ssl.h */
+size_t
+br_ssl_engine_precompute_keystream(br_ssl_engine_context *cc)
+{
+	if (cc->ks_buf == NULL || br_ssl_engine_closed(cc)) {
+		return 0;
+	}
+	if ((const void *)cc->out.vtable == (const void *)cc->igcm_out) {
+		return br_sslrec_out_gcm_precompute(&cc->out.gcm,
+			cc->ks_buf, cc->ks_buf_len);
+	}
+	if ((const void *)cc->out.vtable == (const void *)cc->ichapol_out) {
+		return br_sslrec_out_chapol_precompute(&cc->out.chapol,
+			cc->ks_buf, cc->ks_buf_len);
+	}
+	return 0;
+}
+
 /* see inner.h */
 br_tls_prf_impl
 br_ssl_engine_get_PRF(br_ssl_engine_context *cc, int prf_id)
@@ -1346,6 +1539,28 @@ br_ssl_engine_compute_master(br_ssl_engine_context *cc,
 	};
 
 	iprf = br_ssl_engine_get_PRF(cc, prf_id);
+	if (cc->session.extended_master_secret) {
+		/*
+		 * The seed is the session hash, computed over the
+		 * handshake messages in the same way as for the
+		 * Finished messages (RFC 7627, section 4).
+		 */
+		unsigned char tmp[48];
+		br_tls_prf_seed_chunk hseed;
+
+		hseed.data = tmp;
+		if (cc->session.version >= BR_TLS12) {
+			hseed.len = br_multihash_out(&cc->mhash, prf_id, tmp);
+		} else {
+			br_multihash_out(&cc->mhash, br_md5_ID, tmp);
+			br_multihash_out(&cc->mhash, br_sha1_ID, tmp + 16);
+			hseed.len = 36;
+		}
+		iprf(cc->session.master_secret,
+			sizeof cc->session.master_secret,
+			pms, pms_len, "extended master secret", 1, &hseed);
+		return;
+	}
 	iprf(cc->session.master_secret, sizeof cc->session.master_secret,
 		pms, pms_len, "master secret", 2, seed);
 }
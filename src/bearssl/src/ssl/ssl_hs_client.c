@@ -91,6 +91,34 @@ void br_ssl_hs_client_run(void *t0ctx);
  */
 #define CTX  ((br_ssl_client_context *)ENG)
 
+/*
+ * Compute the master secret once the contents of the ClientKeyExchange
+ * message are known. With the Extended Master Secret (RFC 7627), the
+ * session hash covers the ClientKeyExchange, of which only the type
+ * byte has been written (and hashed) at that point: the rest of the
+ * message ('head' then 'body') is added to the running hash for the
+ * computation, and the hash state is then restored so that it is not
+ * hashed twice when it is actually written.
+ */
+static void
+compute_master_cke(br_ssl_client_context *ctx, int prf_id,
+	const void *pms, size_t pms_len,
+	const unsigned char *head, size_t head_len,
+	const unsigned char *body, size_t body_len)
+{
+	br_multihash_context saved;
+
+	if (!ctx->eng.session.extended_master_secret) {
+		br_ssl_engine_compute_master(&ctx->eng, prf_id, pms, pms_len);
+		return;
+	}
+	saved = ctx->eng.mhash;
+	br_multihash_update(&ctx->eng.mhash, head, head_len);
+	br_multihash_update(&ctx->eng.mhash, body, body_len);
+	br_ssl_engine_compute_master(&ctx->eng, prf_id, pms, pms_len);
+	ctx->eng.mhash = saved;
+}
+
 /*
  * Generate the pre-master secret for RSA key exchange, and encrypt it
  * with the server's public key. Returned value is either the encrypted
@@ -106,7 +134,7 @@ make_pms_rsa(br_ssl_client_context *ctx, int prf_id)
 	const br_x509_class **xc;
 	const br_x509_pkey *pk;
 	const unsigned char *n;
-	unsigned char *pms;
+	unsigned char pms[48], head[5];
 	size_t nlen, u;
 
 	xc = ctx->eng.x509ctx;
@@ -139,10 +167,9 @@ make_pms_rsa(br_ssl_client_context *ctx, int prf_id)
 	/*
 	 * Make PMS.
 	 */
-	pms = ctx->eng.pad + nlen - 48;
 	br_enc16be(pms, ctx->eng.version_max);
 	br_hmac_drbg_generate(&ctx->eng.rng, pms + 2, 46);
-	br_ssl_engine_compute_master(&ctx->eng, prf_id, pms, 48);
+	memcpy(ctx->eng.pad + nlen - 48, pms, 48);
 
 	/*
 	 * Apply PKCS#1 type 2 padding.
@@ -164,6 +191,16 @@ make_pms_rsa(br_ssl_client_context *ctx, int prf_id)
 	if (!ctx->irsapub(ctx->eng.pad, nlen, &pk->key.rsa)) {
 		return -BR_ERR_LIMIT_EXCEEDED;
 	}
+
+	/*
+	 * The ClientKeyExchange consists of the encrypted pre-master
+	 * secret, with a two-byte length. Its type byte has already
+	 * been written.
+	 */
+	head[0] = 0;
+	br_enc16be(head + 1, nlen + 2);
+	br_enc16be(head + 3, nlen);
+	compute_master_cke(ctx, prf_id, pms, 48, head, 5, ctx->eng.pad, nlen);
 	return (int)nlen;
 }
 
@@ -264,7 +301,7 @@ static int
 make_pms_ecdh(br_ssl_client_context *ctx, unsigned ecdhe, int prf_id)
 {
 	int curve;
-	unsigned char key[66], point[133];
+	unsigned char key[66], point[133], head[4];
 	const unsigned char *order, *point_src;
 	size_t glen, olen, point_len, xoff, xlen;
 	unsigned char mask;
@@ -319,11 +356,18 @@ make_pms_ecdh(br_ssl_client_context *ctx, unsigned ecdhe, int prf_id)
 	/*
 	 * The pre-master secret is the X coordinate.
 	 */
-	xoff = ctx->eng.iec->xoff(curve, &xlen);
-	br_ssl_engine_compute_master(&ctx->eng, prf_id, point + xoff, xlen);
+	ctx->eng.iec->mulgen(ctx->eng.pad, key, olen, curve);
 
-	ctx->eng.iec->mulgen(point, key, olen, curve);
-	memcpy(ctx->eng.pad, point, glen);
+	/*
+	 * The ClientKeyExchange consists of our point, with a one-byte
+	 * length. Its type byte has already been written.
+	 */
+	xoff = ctx->eng.iec->xoff(curve, &xlen);
+	head[0] = 0;
+	br_enc16be(head + 1, glen + 1);
+	head[3] = (unsigned char)glen;
+	compute_master_cke(ctx, prf_id, point + xoff, xlen,
+		head, 4, ctx->eng.pad, glen);
 	return (int)glen;
 }
 
@@ -357,6 +401,10 @@ make_pms_static_ecdh(br_ssl_client_context *ctx, int prf_id)
 	{
 		return -1;
 	}
+	/*
+	 * The ClientKeyExchange is empty in that case, and it has
+	 * already been written, so the running hash is complete.
+	 */
 	br_ssl_engine_compute_master(&ctx->eng,
 		prf_id, point, point_len);
 	return 0;
@@ -423,6 +471,7 @@ static const unsigned char t0_codeblock[] = {
 	T0_INT1(BR_ERR_BAD_CCS), 0x00, 0x00, 0x01,
 	T0_INT1(BR_ERR_BAD_CIPHER_SUITE), 0x00, 0x00, 0x01,
 	T0_INT1(BR_ERR_BAD_COMPRESSION), 0x00, 0x00, 0x01,
+	T0_INT1(BR_ERR_BAD_EMS), 0x00, 0x00, 0x01,
 	T0_INT1(BR_ERR_BAD_FINISHED), 0x00, 0x00, 0x01,
 	T0_INT1(BR_ERR_BAD_FRAGLEN), 0x00, 0x00, 0x01,
 	T0_INT1(BR_ERR_BAD_HANDSHAKE), 0x00, 0x00, 0x01,
@@ -451,20 +500,25 @@ static const unsigned char t0_codeblock[] = {
 	0x00, 0x00, 0x01,
 	T0_INT2(offsetof(br_ssl_engine_context, ecdhe_point)), 0x00, 0x00,
 	0x01, T0_INT2(offsetof(br_ssl_engine_context, ecdhe_point_len)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, flags)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_client_context, hash_id)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_client_context, hashes)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, log_max_frag_len)),
-	0x00, 0x00, 0x01,
-	T0_INT2(offsetof(br_ssl_client_context, min_clienthello_len)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, pad)), 0x00, 0x00,
-	0x01, T0_INT2(offsetof(br_ssl_engine_context, protocol_names_num)),
+	0x00, 0x01,
+	T0_INT2(offsetof(br_ssl_engine_context, session) + offsetof(br_ssl_session_parameters, extended_master_secret)),
+	0x00, 0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, flags)),
+	0x00, 0x00, 0x01, T0_INT2(offsetof(br_ssl_client_context, hash_id)),
+	0x00, 0x00, 0x01, T0_INT2(offsetof(br_ssl_client_context, hashes)),
 	0x00, 0x00, 0x01,
-	T0_INT2(offsetof(br_ssl_engine_context, record_type_in)), 0x00, 0x00,
-	0x01, T0_INT2(offsetof(br_ssl_engine_context, record_type_out)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, reneg)), 0x00,
-	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, saved_finished)),
+	T0_INT2(offsetof(br_ssl_engine_context, log_max_frag_len)), 0x00, 0x00,
+	0x01, T0_INT2(offsetof(br_ssl_client_context, min_clienthello_len)),
+	0x00, 0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, pad)), 0x00,
+	0x00, 0x01,
+	T0_INT2(offsetof(br_ssl_engine_context, protocol_names_num)), 0x00,
+	0x00, 0x01,
+	T0_INT2(offsetof(br_ssl_engine_context, record_size_limit)), 0x00,
+	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, record_type_in)),
 	0x00, 0x00, 0x01,
+	T0_INT2(offsetof(br_ssl_engine_context, record_type_out)), 0x00, 0x00,
+	0x01, T0_INT2(offsetof(br_ssl_engine_context, reneg)), 0x00, 0x00,
+	0x01, T0_INT2(offsetof(br_ssl_engine_context, saved_finished)), 0x00,
+	0x00, 0x01,
 	T0_INT2(offsetof(br_ssl_engine_context, selected_protocol)), 0x00,
 	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, server_name)),
 	0x00, 0x00, 0x01,
@@ -484,258 +538,273 @@ static const unsigned char t0_codeblock[] = {
 	T0_INT2(offsetof(br_ssl_engine_context, version_max)), 0x00, 0x00,
 	0x01, T0_INT2(offsetof(br_ssl_engine_context, version_min)), 0x00,
 	0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, version_out)),
-	0x00, 0x00, 0x09, 0x26, 0x58, 0x06, 0x02, 0x68, 0x28, 0x00, 0x00, 0x06,
-	0x08, 0x2C, 0x0E, 0x05, 0x02, 0x71, 0x28, 0x04, 0x01, 0x3C, 0x00, 0x00,
-	0x01, 0x01, 0x00, 0x01, 0x03, 0x00, 0x99, 0x26, 0x5E, 0x44, 0x9D, 0x26,
-	0x05, 0x04, 0x60, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0E, 0x06, 0x02, 0x9D,
-	0x00, 0x5E, 0x04, 0x6B, 0x00, 0x06, 0x02, 0x68, 0x28, 0x00, 0x00, 0x26,
-	0x89, 0x44, 0x05, 0x03, 0x01, 0x0C, 0x08, 0x44, 0x79, 0x2C, 0xAB, 0x1C,
-	0x84, 0x01, 0x0C, 0x31, 0x00, 0x00, 0x26, 0x1F, 0x01, 0x08, 0x0B, 0x44,
-	0x5C, 0x1F, 0x08, 0x00, 0x01, 0x03, 0x00, 0x77, 0x2E, 0x02, 0x00, 0x36,
-	0x17, 0x01, 0x01, 0x0B, 0x77, 0x3E, 0x29, 0x1A, 0x36, 0x06, 0x07, 0x02,
-	0x00, 0xCF, 0x03, 0x00, 0x04, 0x75, 0x01, 0x00, 0xC5, 0x02, 0x00, 0x26,
-	0x1A, 0x17, 0x06, 0x02, 0x6F, 0x28, 0xCF, 0x04, 0x76, 0x01, 0x01, 0x00,
-	0x77, 0x3E, 0x01, 0x16, 0x87, 0x3E, 0x01, 0x00, 0x8A, 0x3C, 0x34, 0xD5,
-	0x29, 0xB4, 0x06, 0x09, 0x01, 0x7F, 0xAF, 0x01, 0x7F, 0xD2, 0x04, 0x80,
-	0x53, 0xB1, 0x79, 0x2C, 0xA1, 0x01, T0_INT1(BR_KEYTYPE_SIGN), 0x17,
-	0x06, 0x01, 0xB5, 0xB8, 0x26, 0x01, 0x0D, 0x0E, 0x06, 0x07, 0x25, 0xB7,
-	0xB8, 0x01, 0x7F, 0x04, 0x02, 0x01, 0x00, 0x03, 0x00, 0x01, 0x0E, 0x0E,
-	0x05, 0x02, 0x72, 0x28, 0x06, 0x02, 0x67, 0x28, 0x33, 0x06, 0x02, 0x72,
-	0x28, 0x02, 0x00, 0x06, 0x1C, 0xD3, 0x80, 0x2E, 0x01, 0x81, 0x7F, 0x0E,
-	0x06, 0x0D, 0x25, 0x01, 0x10, 0xDE, 0x01, 0x00, 0xDD, 0x79, 0x2C, 0xAB,
-	0x24, 0x04, 0x04, 0xD6, 0x06, 0x01, 0xD4, 0x04, 0x01, 0xD6, 0x01, 0x7F,
-	0xD2, 0x01, 0x7F, 0xAF, 0x01, 0x01, 0x77, 0x3E, 0x01, 0x17, 0x87, 0x3E,
-	0x00, 0x00, 0x38, 0x38, 0x00, 0x00, 0x9A, 0x01, 0x0C, 0x11, 0x01, 0x00,
-	0x38, 0x0E, 0x06, 0x05, 0x25, 0x01,
+	0x00, 0x00, 0x01, T0_INT2(offsetof(br_ssl_engine_context, wake)), 0x00,
+	0x00, 0x09, 0x26, 0x5A, 0x06, 0x02, 0x6B, 0x28, 0x00, 0x00, 0x06, 0x08,
+	0x2C, 0x0E, 0x05, 0x02, 0x74, 0x28, 0x04, 0x01, 0x3E, 0x00, 0x00, 0x01,
+	0x01, 0x00, 0x01, 0x03, 0x00, 0x9F, 0x26, 0x60, 0x46, 0xA3, 0x26, 0x05,
+	0x04, 0x62, 0x01, 0x00, 0x00, 0x02, 0x00, 0x0E, 0x06, 0x02, 0xA3, 0x00,
+	0x60, 0x04, 0x6B, 0x00, 0x06, 0x02, 0x6B, 0x28, 0x00, 0x00, 0x26, 0x8E,
+	0x46, 0x05, 0x03, 0x01, 0x0C, 0x08, 0x46, 0x7C, 0x2C, 0xB3, 0x1C, 0x88,
+	0x01, 0x0C, 0x31, 0x00, 0x00, 0x26, 0x1F, 0x01, 0x08, 0x0B, 0x46, 0x5E,
+	0x1F, 0x08, 0x00, 0x01, 0x03, 0x00, 0x7A, 0x2E, 0x02, 0x00, 0x37, 0x17,
+	0x01, 0x01, 0x0B, 0x7A, 0x40, 0x29, 0x1A, 0x37, 0x06, 0x07, 0x02, 0x00,
+	0xD9, 0x03, 0x00, 0x04, 0x75, 0x01, 0x00, 0xCF, 0x02, 0x00, 0x26, 0x1A,
+	0x17, 0x06, 0x02, 0x72, 0x28, 0xD9, 0x04, 0x76, 0x01, 0x01, 0x00, 0x7A,
+	0x40, 0x01, 0x16, 0x8C, 0x40, 0x01, 0x00, 0x8F, 0x3E, 0x34, 0xE0, 0x29,
+	0xBC, 0x06, 0x09, 0x01, 0x7F, 0xB7, 0x01, 0x7F, 0xDD, 0x04, 0x80, 0x53,
+	0xB9, 0x7C, 0x2C, 0xA7, 0x01, T0_INT1(BR_KEYTYPE_SIGN), 0x17, 0x06,
+	0x01, 0xBD, 0xC0, 0x26, 0x01, 0x0D, 0x0E, 0x06, 0x07, 0x25, 0xBF, 0xC0,
+	0x01, 0x7F, 0x04, 0x02, 0x01, 0x00, 0x03, 0x00, 0x01, 0x0E, 0x0E, 0x05,
+	0x02, 0x75, 0x28, 0x06, 0x02, 0x6A, 0x28, 0x33, 0x06, 0x02, 0x75, 0x28,
+	0x02, 0x00, 0x06, 0x1C, 0xDE, 0x84, 0x2E, 0x01, 0x81, 0x7F, 0x0E, 0x06,
+	0x0D, 0x25, 0x01, 0x10, 0xE9, 0x01, 0x00, 0xE8, 0x7C, 0x2C, 0xB3, 0x24,
+	0x04, 0x04, 0xE1, 0x06, 0x01, 0xDF, 0x04, 0x01, 0xE1, 0x01, 0x7F, 0xDD,
+	0x01, 0x7F, 0xB7, 0x01, 0x01, 0x7A, 0x40, 0x01, 0x17, 0x8C, 0x40, 0x00,
+	0x00, 0x39, 0x39, 0x00, 0x00, 0xA0, 0x01, 0x0C, 0x11, 0x01, 0x00, 0x39,
+	0x0E, 0x06, 0x05, 0x25, 0x01,
 	T0_INT1(BR_KEYTYPE_RSA | BR_KEYTYPE_KEYX), 0x04, 0x30, 0x01, 0x01,
-	0x38, 0x0E, 0x06, 0x05, 0x25, 0x01,
+	0x39, 0x0E, 0x06, 0x05, 0x25, 0x01,
 	T0_INT1(BR_KEYTYPE_RSA | BR_KEYTYPE_SIGN), 0x04, 0x25, 0x01, 0x02,
-	0x38, 0x0E, 0x06, 0x05, 0x25, 0x01,
+	0x39, 0x0E, 0x06, 0x05, 0x25, 0x01,
 	T0_INT1(BR_KEYTYPE_EC  | BR_KEYTYPE_SIGN), 0x04, 0x1A, 0x01, 0x03,
-	0x38, 0x0E, 0x06, 0x05, 0x25, 0x01,
+	0x39, 0x0E, 0x06, 0x05, 0x25, 0x01,
 	T0_INT1(BR_KEYTYPE_EC  | BR_KEYTYPE_KEYX), 0x04, 0x0F, 0x01, 0x04,
-	0x38, 0x0E, 0x06, 0x05, 0x25, 0x01,
+	0x39, 0x0E, 0x06, 0x05, 0x25, 0x01,
 	T0_INT1(BR_KEYTYPE_EC  | BR_KEYTYPE_KEYX), 0x04, 0x04, 0x01, 0x00,
-	0x44, 0x25, 0x00, 0x00, 0x82, 0x2E, 0x01, 0x0E, 0x0E, 0x06, 0x04, 0x01,
-	0x00, 0x04, 0x02, 0x01, 0x05, 0x00, 0x00, 0x40, 0x06, 0x04, 0x01, 0x06,
-	0x04, 0x02, 0x01, 0x00, 0x00, 0x00, 0x88, 0x2E, 0x26, 0x06, 0x08, 0x01,
-	0x01, 0x09, 0x01, 0x11, 0x07, 0x04, 0x03, 0x25, 0x01, 0x05, 0x00, 0x01,
-	0x41, 0x03, 0x00, 0x25, 0x01, 0x00, 0x43, 0x06, 0x03, 0x02, 0x00, 0x08,
-	0x42, 0x06, 0x03, 0x02, 0x00, 0x08, 0x26, 0x06, 0x06, 0x01, 0x01, 0x0B,
-	0x01, 0x06, 0x08, 0x00, 0x00, 0x8B, 0x3F, 0x26, 0x06, 0x03, 0x01, 0x09,
-	0x08, 0x00, 0x01, 0x40, 0x26, 0x06, 0x1E, 0x01, 0x00, 0x03, 0x00, 0x26,
-	0x06, 0x0E, 0x26, 0x01, 0x01, 0x17, 0x02, 0x00, 0x08, 0x03, 0x00, 0x01,
-	0x01, 0x11, 0x04, 0x6F, 0x25, 0x02, 0x00, 0x01, 0x01, 0x0B, 0x01, 0x06,
-	0x08, 0x00, 0x00, 0x7F, 0x2D, 0x44, 0x11, 0x01, 0x01, 0x17, 0x35, 0x00,
-	0x00, 0x9F, 0xCE, 0x26, 0x01, 0x07, 0x17, 0x01, 0x00, 0x38, 0x0E, 0x06,
-	0x09, 0x25, 0x01, 0x10, 0x17, 0x06, 0x01, 0x9F, 0x04, 0x35, 0x01, 0x01,
-	0x38, 0x0E, 0x06, 0x2C, 0x25, 0x25, 0x01, 0x00, 0x77, 0x3E, 0xB3, 0x88,
-	0x2E, 0x01, 0x01, 0x0E, 0x01, 0x01, 0xA8, 0x37, 0x06, 0x17, 0x29, 0x1A,
-	0x36, 0x06, 0x04, 0xCE, 0x25, 0x04, 0x78, 0x01, 0x80, 0x64, 0xC5, 0x01,
-	0x01, 0x77, 0x3E, 0x01, 0x17, 0x87, 0x3E, 0x04, 0x01, 0x9F, 0x04, 0x03,
-	0x72, 0x28, 0x25, 0x04, 0xFF, 0x34, 0x01, 0x26, 0x03, 0x00, 0x09, 0x26,
-	0x58, 0x06, 0x02, 0x68, 0x28, 0x02, 0x00, 0x00, 0x00, 0x9A, 0x01, 0x0F,
-	0x17, 0x00, 0x00, 0x76, 0x2E, 0x01, 0x00, 0x38, 0x0E, 0x06, 0x10, 0x25,
-	0x26, 0x01, 0x01, 0x0D, 0x06, 0x03, 0x25, 0x01, 0x02, 0x76, 0x3E, 0x01,
-	0x00, 0x04, 0x21, 0x01, 0x01, 0x38, 0x0E, 0x06, 0x14, 0x25, 0x01, 0x00,
-	0x76, 0x3E, 0x26, 0x01, 0x80, 0x64, 0x0E, 0x06, 0x05, 0x01, 0x82, 0x00,
-	0x08, 0x28, 0x5A, 0x04, 0x07, 0x25, 0x01, 0x82, 0x00, 0x08, 0x28, 0x25,
-	0x00, 0x00, 0x01, 0x00, 0x2F, 0x06, 0x05, 0x3A, 0xAC, 0x37, 0x04, 0x78,
-	0x26, 0x06, 0x04, 0x01, 0x01, 0x8F, 0x3E, 0x00, 0x01, 0xBF, 0xAA, 0xBF,
-	0xAA, 0xC1, 0x84, 0x44, 0x26, 0x03, 0x00, 0xB6, 0x9B, 0x9B, 0x02, 0x00,
-	0x4D, 0x26, 0x58, 0x06, 0x0A, 0x01, 0x03, 0xA8, 0x06, 0x02, 0x72, 0x28,
-	0x25, 0x04, 0x03, 0x5C, 0x8A, 0x3C, 0x00, 0x00, 0x2F, 0x06, 0x0B, 0x86,
-	0x2E, 0x01, 0x14, 0x0D, 0x06, 0x02, 0x72, 0x28, 0x04, 0x11, 0xCE, 0x01,
-	0x07, 0x17, 0x26, 0x01, 0x02, 0x0D, 0x06, 0x06, 0x06, 0x02, 0x72, 0x28,
-	0x04, 0x70, 0x25, 0xC2, 0x01, 0x01, 0x0D, 0x33, 0x37, 0x06, 0x02, 0x61,
-	0x28, 0x26, 0x01, 0x01, 0xC8, 0x36, 0xB2, 0x00, 0x01, 0xB8, 0x01, 0x0B,
-	0x0E, 0x05, 0x02, 0x72, 0x28, 0x26, 0x01, 0x03, 0x0E, 0x06, 0x08, 0xC0,
-	0x06, 0x02, 0x68, 0x28, 0x44, 0x25, 0x00, 0x44, 0x57, 0xC0, 0xAA, 0x26,
-	0x06, 0x23, 0xC0, 0xAA, 0x26, 0x56, 0x26, 0x06, 0x18, 0x26, 0x01, 0x82,
-	0x00, 0x0F, 0x06, 0x05, 0x01, 0x82, 0x00, 0x04, 0x01, 0x26, 0x03, 0x00,
-	0x84, 0x02, 0x00, 0xB6, 0x02, 0x00, 0x53, 0x04, 0x65, 0x9B, 0x54, 0x04,
-	0x5A, 0x9B, 0x9B, 0x55, 0x26, 0x06, 0x02, 0x35, 0x00, 0x25, 0x2B, 0x00,
-	0x00, 0x79, 0x2C, 0xA1, 0x01, 0x7F, 0xB0, 0x26, 0x58, 0x06, 0x02, 0x35,
-	0x28, 0x26, 0x05, 0x02, 0x72, 0x28, 0x38, 0x17, 0x0D, 0x06, 0x02, 0x74,
-	0x28, 0x3B, 0x00, 0x00, 0x9C, 0xB8, 0x01, 0x14, 0x0D, 0x06, 0x02, 0x72,
-	0x28, 0x84, 0x01, 0x0C, 0x08, 0x01, 0x0C, 0xB6, 0x9B, 0x84, 0x26, 0x01,
-	0x0C, 0x08, 0x01, 0x0C, 0x30, 0x05, 0x02, 0x64, 0x28, 0x00, 0x00, 0xB9,
-	0x06, 0x02, 0x72, 0x28, 0x06, 0x02, 0x66, 0x28, 0x00, 0x0A, 0xB8, 0x01,
-	0x02, 0x0E, 0x05, 0x02, 0x72, 0x28, 0xBF, 0x03, 0x00, 0x02, 0x00, 0x95,
-	0x2C, 0x0A, 0x02, 0x00, 0x94, 0x2C, 0x0F, 0x37, 0x06, 0x02, 0x73, 0x28,
-	0x02, 0x00, 0x93, 0x2C, 0x0D, 0x06, 0x02, 0x6B, 0x28, 0x02, 0x00, 0x96,
-	0x3C, 0x8C, 0x01, 0x20, 0xB6, 0x01, 0x00, 0x03, 0x01, 0xC1, 0x03, 0x02,
-	0x02, 0x02, 0x01, 0x20, 0x0F, 0x06, 0x02, 0x70, 0x28, 0x84, 0x02, 0x02,
-	0xB6, 0x02, 0x02, 0x8E, 0x2E, 0x0E, 0x02, 0x02, 0x01, 0x00, 0x0F, 0x17,
-	0x06, 0x0B, 0x8D, 0x84, 0x02, 0x02, 0x30, 0x06, 0x04, 0x01, 0x7F, 0x03,
-	0x01, 0x8D, 0x84, 0x02, 0x02, 0x31, 0x02, 0x02, 0x8E, 0x3E, 0x02, 0x00,
-	0x92, 0x02, 0x01, 0x98, 0xBF, 0x26, 0xC3, 0x58, 0x06, 0x02, 0x62, 0x28,
-	0x26, 0xCD, 0x02, 0x00, 0x01, 0x86, 0x03, 0x0A, 0x17, 0x06, 0x02, 0x62,
-	0x28, 0x79, 0x02, 0x01, 0x98, 0xC1, 0x06, 0x02, 0x63, 0x28, 0x26, 0x06,
-	0x81, 0x47, 0xBF, 0xAA, 0xA6, 0x03, 0x03, 0xA4, 0x03, 0x04, 0xA2, 0x03,
-	0x05, 0xA5, 0x03, 0x06, 0xA7, 0x03, 0x07, 0xA3, 0x03, 0x08, 0x27, 0x03,
-	0x09, 0x26, 0x06, 0x81, 0x18, 0xBF, 0x01, 0x00, 0x38, 0x0E, 0x06, 0x0F,
-	0x25, 0x02, 0x03, 0x05, 0x02, 0x6C, 0x28, 0x01, 0x00, 0x03, 0x03, 0xBE,
-	0x04, 0x80, 0x7F, 0x01, 0x01, 0x38, 0x0E, 0x06, 0x0F, 0x25, 0x02, 0x05,
-	0x05, 0x02, 0x6C, 0x28, 0x01, 0x00, 0x03, 0x05, 0xBC, 0x04, 0x80, 0x6A,
-	0x01, 0x83, 0xFE, 0x01, 0x38, 0x0E, 0x06, 0x0F, 0x25, 0x02, 0x04, 0x05,
-	0x02, 0x6C, 0x28, 0x01, 0x00, 0x03, 0x04, 0xBD, 0x04, 0x80, 0x53, 0x01,
-	0x0D, 0x38, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x06, 0x05, 0x02, 0x6C, 0x28,
-	0x01, 0x00, 0x03, 0x06, 0xBA, 0x04, 0x3F, 0x01, 0x0A, 0x38, 0x0E, 0x06,
-	0x0E, 0x25, 0x02, 0x07, 0x05, 0x02, 0x6C, 0x28, 0x01, 0x00, 0x03, 0x07,
-	0xBA, 0x04, 0x2B, 0x01, 0x0B, 0x38, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x08,
-	0x05, 0x02, 0x6C, 0x28, 0x01, 0x00, 0x03, 0x08, 0xBA, 0x04, 0x17, 0x01,
-	0x10, 0x38, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x09, 0x05, 0x02, 0x6C, 0x28,
-	0x01, 0x00, 0x03, 0x09, 0xAE, 0x04, 0x03, 0x6C, 0x28, 0x25, 0x04, 0xFE,
-	0x64, 0x02, 0x04, 0x06, 0x0D, 0x02, 0x04, 0x01, 0x05, 0x0F, 0x06, 0x02,
-	0x69, 0x28, 0x01, 0x01, 0x88, 0x3E, 0x9B, 0x04, 0x0C, 0xA4, 0x01, 0x05,
-	0x0F, 0x06, 0x02, 0x69, 0x28, 0x01, 0x01, 0x88, 0x3E, 0x9B, 0x02, 0x01,
-	0x00, 0x04, 0xB8, 0x01, 0x0C, 0x0E, 0x05, 0x02, 0x72, 0x28, 0xC1, 0x01,
-	0x03, 0x0E, 0x05, 0x02, 0x6D, 0x28, 0xBF, 0x26, 0x7C, 0x3E, 0x26, 0x01,
-	0x20, 0x10, 0x06, 0x02, 0x6D, 0x28, 0x40, 0x44, 0x11, 0x01, 0x01, 0x17,
-	0x05, 0x02, 0x6D, 0x28, 0xC1, 0x26, 0x01, 0x81, 0x05, 0x0F, 0x06, 0x02,
-	0x6D, 0x28, 0x26, 0x7E, 0x3E, 0x7D, 0x44, 0xB6, 0x92, 0x2C, 0x01, 0x86,
-	0x03, 0x10, 0x03, 0x00, 0x79, 0x2C, 0xCB, 0x03, 0x01, 0x01, 0x02, 0x03,
-	0x02, 0x02, 0x00, 0x06, 0x21, 0xC1, 0x26, 0x26, 0x01, 0x02, 0x0A, 0x44,
-	0x01, 0x06, 0x0F, 0x37, 0x06, 0x02, 0x6D, 0x28, 0x03, 0x02, 0xC1, 0x02,
-	0x01, 0x01, 0x01, 0x0B, 0x01, 0x03, 0x08, 0x0E, 0x05, 0x02, 0x6D, 0x28,
-	0x04, 0x08, 0x02, 0x01, 0x06, 0x04, 0x01, 0x00, 0x03, 0x02, 0xBF, 0x26,
-	0x03, 0x03, 0x26, 0x01, 0x84, 0x00, 0x0F, 0x06, 0x02, 0x6E, 0x28, 0x84,
-	0x44, 0xB6, 0x02, 0x02, 0x02, 0x01, 0x02, 0x03, 0x50, 0x26, 0x06, 0x01,
-	0x28, 0x25, 0x9B, 0x00, 0x02, 0x03, 0x00, 0x03, 0x01, 0x02, 0x00, 0x97,
-	0x02, 0x01, 0x02, 0x00, 0x39, 0x26, 0x01, 0x00, 0x0E, 0x06, 0x02, 0x60,
-	0x00, 0xD0, 0x04, 0x74, 0x02, 0x01, 0x00, 0x03, 0x00, 0xC1, 0xAA, 0x26,
-	0x06, 0x80, 0x43, 0xC1, 0x01, 0x01, 0x38, 0x0E, 0x06, 0x06, 0x25, 0x01,
-	0x81, 0x7F, 0x04, 0x2E, 0x01, 0x80, 0x40, 0x38, 0x0E, 0x06, 0x07, 0x25,
-	0x01, 0x83, 0xFE, 0x00, 0x04, 0x20, 0x01, 0x80, 0x41, 0x38, 0x0E, 0x06,
-	0x07, 0x25, 0x01, 0x84, 0x80, 0x00, 0x04, 0x12, 0x01, 0x80, 0x42, 0x38,
-	0x0E, 0x06, 0x07, 0x25, 0x01, 0x88, 0x80, 0x00, 0x04, 0x04, 0x01, 0x00,
-	0x44, 0x25, 0x02, 0x00, 0x37, 0x03, 0x00, 0x04, 0xFF, 0x39, 0x9B, 0x79,
-	0x2C, 0xC9, 0x05, 0x09, 0x02, 0x00, 0x01, 0x83, 0xFF, 0x7F, 0x17, 0x03,
-	0x00, 0x92, 0x2C, 0x01, 0x86, 0x03, 0x10, 0x06, 0x3A, 0xBB, 0x26, 0x81,
-	0x3D, 0x41, 0x25, 0x26, 0x01, 0x08, 0x0B, 0x37, 0x01, 0x8C, 0x80, 0x00,
-	0x37, 0x17, 0x02, 0x00, 0x17, 0x02, 0x00, 0x01, 0x8C, 0x80, 0x00, 0x17,
-	0x06, 0x19, 0x26, 0x01, 0x81, 0x7F, 0x17, 0x06, 0x05, 0x01, 0x84, 0x80,
-	0x00, 0x37, 0x26, 0x01, 0x83, 0xFE, 0x00, 0x17, 0x06, 0x05, 0x01, 0x88,
-	0x80, 0x00, 0x37, 0x03, 0x00, 0x04, 0x09, 0x02, 0x00, 0x01, 0x8C, 0x88,
-	0x01, 0x17, 0x03, 0x00, 0x16, 0xBF, 0xAA, 0x26, 0x06, 0x23, 0xBF, 0xAA,
-	0x26, 0x15, 0x26, 0x06, 0x18, 0x26, 0x01, 0x82, 0x00, 0x0F, 0x06, 0x05,
-	0x01, 0x82, 0x00, 0x04, 0x01, 0x26, 0x03, 0x01, 0x84, 0x02, 0x01, 0xB6,
-	0x02, 0x01, 0x12, 0x04, 0x65, 0x9B, 0x13, 0x04, 0x5A, 0x9B, 0x14, 0x9B,
-	0x02, 0x00, 0x2A, 0x00, 0x00, 0xB9, 0x26, 0x5A, 0x06, 0x07, 0x25, 0x06,
-	0x02, 0x66, 0x28, 0x04, 0x74, 0x00, 0x00, 0xC2, 0x01, 0x03, 0xC0, 0x44,
-	0x25, 0x44, 0x00, 0x00, 0xBF, 0xC6, 0x00, 0x03, 0x01, 0x00, 0x03, 0x00,
-	0xBF, 0xAA, 0x26, 0x06, 0x80, 0x50, 0xC1, 0x03, 0x01, 0xC1, 0x03, 0x02,
-	0x02, 0x01, 0x01, 0x08, 0x0E, 0x06, 0x16, 0x02, 0x02, 0x01, 0x0F, 0x0C,
-	0x06, 0x0D, 0x01, 0x01, 0x02, 0x02, 0x01, 0x10, 0x08, 0x0B, 0x02, 0x00,
-	0x37, 0x03, 0x00, 0x04, 0x2A, 0x02, 0x01, 0x01, 0x02, 0x10, 0x02, 0x01,
-	0x01, 0x06, 0x0C, 0x17, 0x02, 0x02, 0x01, 0x01, 0x0E, 0x02, 0x02, 0x01,
-	0x03, 0x0E, 0x37, 0x17, 0x06, 0x11, 0x02, 0x00, 0x01, 0x01, 0x02, 0x02,
-	0x5D, 0x01, 0x02, 0x0B, 0x02, 0x01, 0x08, 0x0B, 0x37, 0x03, 0x00, 0x04,
-	0xFF, 0x2C, 0x9B, 0x02, 0x00, 0x00, 0x00, 0xBF, 0x01, 0x01, 0x0E, 0x05,
-	0x02, 0x65, 0x28, 0xC1, 0x01, 0x08, 0x08, 0x82, 0x2E, 0x0E, 0x05, 0x02,
-	0x65, 0x28, 0x00, 0x00, 0xBF, 0x88, 0x2E, 0x05, 0x15, 0x01, 0x01, 0x0E,
-	0x05, 0x02, 0x69, 0x28, 0xC1, 0x01, 0x00, 0x0E, 0x05, 0x02, 0x69, 0x28,
-	0x01, 0x02, 0x88, 0x3E, 0x04, 0x1C, 0x01, 0x19, 0x0E, 0x05, 0x02, 0x69,
-	0x28, 0xC1, 0x01, 0x18, 0x0E, 0x05, 0x02, 0x69, 0x28, 0x84, 0x01, 0x18,
-	0xB6, 0x89, 0x84, 0x01, 0x18, 0x30, 0x05, 0x02, 0x69, 0x28, 0x00, 0x00,
-	0xBF, 0x06, 0x02, 0x6A, 0x28, 0x00, 0x00, 0x01, 0x02, 0x97, 0xC2, 0x01,
-	0x08, 0x0B, 0xC2, 0x08, 0x00, 0x00, 0x01, 0x03, 0x97, 0xC2, 0x01, 0x08,
-	0x0B, 0xC2, 0x08, 0x01, 0x08, 0x0B, 0xC2, 0x08, 0x00, 0x00, 0x01, 0x01,
-	0x97, 0xC2, 0x00, 0x00, 0x3A, 0x26, 0x58, 0x05, 0x01, 0x00, 0x25, 0xD0,
-	0x04, 0x76, 0x02, 0x03, 0x00, 0x91, 0x2E, 0x03, 0x01, 0x01, 0x00, 0x26,
-	0x02, 0x01, 0x0A, 0x06, 0x10, 0x26, 0x01, 0x01, 0x0B, 0x90, 0x08, 0x2C,
-	0x02, 0x00, 0x0E, 0x06, 0x01, 0x00, 0x5C, 0x04, 0x6A, 0x25, 0x01, 0x7F,
-	0x00, 0x00, 0x01, 0x15, 0x87, 0x3E, 0x44, 0x52, 0x25, 0x52, 0x25, 0x29,
-	0x00, 0x00, 0x01, 0x01, 0x44, 0xC4, 0x00, 0x00, 0x44, 0x38, 0x97, 0x44,
-	0x26, 0x06, 0x05, 0xC2, 0x25, 0x5D, 0x04, 0x78, 0x25, 0x00, 0x00, 0x26,
-	0x01, 0x81, 0xAC, 0x00, 0x0E, 0x06, 0x04, 0x25, 0x01, 0x7F, 0x00, 0x9A,
-	0x59, 0x00, 0x02, 0x03, 0x00, 0x79, 0x2C, 0x9A, 0x03, 0x01, 0x02, 0x01,
-	0x01, 0x0F, 0x17, 0x02, 0x01, 0x01, 0x04, 0x11, 0x01, 0x0F, 0x17, 0x02,
-	0x01, 0x01, 0x08, 0x11, 0x01, 0x0F, 0x17, 0x01, 0x00, 0x38, 0x0E, 0x06,
-	0x10, 0x25, 0x01, 0x00, 0x01, 0x18, 0x02, 0x00, 0x06, 0x03, 0x49, 0x04,
-	0x01, 0x4A, 0x04, 0x81, 0x0D, 0x01, 0x01, 0x38, 0x0E, 0x06, 0x10, 0x25,
-	0x01, 0x01, 0x01, 0x10, 0x02, 0x00, 0x06, 0x03, 0x49, 0x04, 0x01, 0x4A,
-	0x04, 0x80, 0x77, 0x01, 0x02, 0x38, 0x0E, 0x06, 0x10, 0x25, 0x01, 0x01,
-	0x01, 0x20, 0x02, 0x00, 0x06, 0x03, 0x49, 0x04, 0x01, 0x4A, 0x04, 0x80,
-	0x61, 0x01, 0x03, 0x38, 0x0E, 0x06, 0x0F, 0x25, 0x25, 0x01, 0x10, 0x02,
-	0x00, 0x06, 0x03, 0x47, 0x04, 0x01, 0x48, 0x04, 0x80, 0x4C, 0x01, 0x04,
-	0x38, 0x0E, 0x06, 0x0E, 0x25, 0x25, 0x01, 0x20, 0x02, 0x00, 0x06, 0x03,
-	0x47, 0x04, 0x01, 0x48, 0x04, 0x38, 0x01, 0x05, 0x38, 0x0E, 0x06, 0x0C,
-	0x25, 0x25, 0x02, 0x00, 0x06, 0x03, 0x4B, 0x04, 0x01, 0x4C, 0x04, 0x26,
-	0x26, 0x01, 0x09, 0x0F, 0x06, 0x02, 0x68, 0x28, 0x44, 0x25, 0x26, 0x01,
-	0x01, 0x17, 0x01, 0x04, 0x0B, 0x01, 0x10, 0x08, 0x44, 0x01, 0x08, 0x17,
-	0x01, 0x10, 0x44, 0x09, 0x02, 0x00, 0x06, 0x03, 0x45, 0x04, 0x01, 0x46,
-	0x00, 0x25, 0x00, 0x00, 0x9A, 0x01, 0x0C, 0x11, 0x01, 0x02, 0x0F, 0x00,
-	0x00, 0x9A, 0x01, 0x0C, 0x11, 0x26, 0x5B, 0x44, 0x01, 0x03, 0x0A, 0x17,
-	0x00, 0x00, 0x9A, 0x01, 0x0C, 0x11, 0x01, 0x01, 0x0E, 0x00, 0x00, 0x9A,
-	0x01, 0x0C, 0x11, 0x5A, 0x00, 0x00, 0x9A, 0x01, 0x81, 0x70, 0x17, 0x01,
-	0x20, 0x0D, 0x00, 0x00, 0x1B, 0x01, 0x00, 0x75, 0x2E, 0x26, 0x06, 0x22,
-	0x01, 0x01, 0x38, 0x0E, 0x06, 0x06, 0x25, 0x01, 0x00, 0x9E, 0x04, 0x14,
-	0x01, 0x02, 0x38, 0x0E, 0x06, 0x0D, 0x25, 0x77, 0x2E, 0x01, 0x01, 0x0E,
-	0x06, 0x03, 0x01, 0x10, 0x37, 0x04, 0x01, 0x25, 0x04, 0x01, 0x25, 0x7B,
-	0x2E, 0x05, 0x33, 0x2F, 0x06, 0x30, 0x86, 0x2E, 0x01, 0x14, 0x38, 0x0E,
-	0x06, 0x06, 0x25, 0x01, 0x02, 0x37, 0x04, 0x22, 0x01, 0x15, 0x38, 0x0E,
-	0x06, 0x09, 0x25, 0xAD, 0x06, 0x03, 0x01, 0x7F, 0x9E, 0x04, 0x13, 0x01,
-	0x16, 0x38, 0x0E, 0x06, 0x06, 0x25, 0x01, 0x01, 0x37, 0x04, 0x07, 0x25,
-	0x01, 0x04, 0x37, 0x01, 0x00, 0x25, 0x1A, 0x06, 0x03, 0x01, 0x08, 0x37,
-	0x00, 0x00, 0x1B, 0x26, 0x05, 0x13, 0x2F, 0x06, 0x10, 0x86, 0x2E, 0x01,
-	0x15, 0x0E, 0x06, 0x08, 0x25, 0xAD, 0x01, 0x00, 0x77, 0x3E, 0x04, 0x01,
-	0x20, 0x00, 0x00, 0xCE, 0x01, 0x07, 0x17, 0x01, 0x01, 0x0F, 0x06, 0x02,
-	0x72, 0x28, 0x00, 0x01, 0x03, 0x00, 0x29, 0x1A, 0x06, 0x05, 0x02, 0x00,
-	0x87, 0x3E, 0x00, 0xCE, 0x25, 0x04, 0x74, 0x00, 0x01, 0x14, 0xD1, 0x01,
-	0x01, 0xDE, 0x29, 0x26, 0x01, 0x00, 0xC8, 0x01, 0x16, 0xD1, 0xD7, 0x29,
-	0x00, 0x00, 0x01, 0x0B, 0xDE, 0x4E, 0x26, 0x26, 0x01, 0x03, 0x08, 0xDD,
-	0xDD, 0x18, 0x26, 0x58, 0x06, 0x02, 0x25, 0x00, 0xDD, 0x1D, 0x26, 0x06,
-	0x05, 0x84, 0x44, 0xD8, 0x04, 0x77, 0x25, 0x04, 0x6C, 0x00, 0x21, 0x01,
-	0x0F, 0xDE, 0x26, 0x92, 0x2C, 0x01, 0x86, 0x03, 0x10, 0x06, 0x0C, 0x01,
-	0x04, 0x08, 0xDD, 0x80, 0x2E, 0xDE, 0x78, 0x2E, 0xDE, 0x04, 0x02, 0x5E,
-	0xDD, 0x26, 0xDC, 0x84, 0x44, 0xD8, 0x00, 0x02, 0xA4, 0xA6, 0x08, 0xA2,
-	0x08, 0xA5, 0x08, 0xA7, 0x08, 0xA3, 0x08, 0x27, 0x08, 0x03, 0x00, 0x01,
-	0x01, 0xDE, 0x01, 0x27, 0x8E, 0x2E, 0x08, 0x91, 0x2E, 0x01, 0x01, 0x0B,
-	0x08, 0x02, 0x00, 0x06, 0x04, 0x5E, 0x02, 0x00, 0x08, 0x83, 0x2C, 0x38,
-	0x09, 0x26, 0x5B, 0x06, 0x24, 0x02, 0x00, 0x05, 0x04, 0x44, 0x5E, 0x44,
-	0x5F, 0x01, 0x04, 0x09, 0x26, 0x58, 0x06, 0x03, 0x25, 0x01, 0x00, 0x26,
-	0x01, 0x04, 0x08, 0x02, 0x00, 0x08, 0x03, 0x00, 0x44, 0x01, 0x04, 0x08,
-	0x38, 0x08, 0x44, 0x04, 0x03, 0x25, 0x01, 0x7F, 0x03, 0x01, 0xDD, 0x94,
-	0x2C, 0xDC, 0x7A, 0x01, 0x04, 0x19, 0x7A, 0x01, 0x04, 0x08, 0x01, 0x1C,
-	0x32, 0x7A, 0x01, 0x20, 0xD8, 0x8D, 0x8E, 0x2E, 0xDA, 0x91, 0x2E, 0x26,
-	0x01, 0x01, 0x0B, 0xDC, 0x90, 0x44, 0x26, 0x06, 0x0F, 0x5D, 0x38, 0x2C,
-	0x26, 0xC7, 0x05, 0x02, 0x62, 0x28, 0xDC, 0x44, 0x5E, 0x44, 0x04, 0x6E,
-	0x60, 0x01, 0x01, 0xDE, 0x01, 0x00, 0xDE, 0x02, 0x00, 0x06, 0x81, 0x5A,
-	0x02, 0x00, 0xDC, 0xA4, 0x06, 0x0E, 0x01, 0x83, 0xFE, 0x01, 0xDC, 0x89,
-	0xA4, 0x01, 0x04, 0x09, 0x26, 0xDC, 0x5D, 0xDA, 0xA6, 0x06, 0x16, 0x01,
-	0x00, 0xDC, 0x8B, 0xA6, 0x01, 0x04, 0x09, 0x26, 0xDC, 0x01, 0x02, 0x09,
-	0x26, 0xDC, 0x01, 0x00, 0xDE, 0x01, 0x03, 0x09, 0xD9, 0xA2, 0x06, 0x0C,
-	0x01, 0x01, 0xDC, 0x01, 0x01, 0xDC, 0x82, 0x2E, 0x01, 0x08, 0x09, 0xDE,
-	0xA5, 0x06, 0x19, 0x01, 0x0D, 0xDC, 0xA5, 0x01, 0x04, 0x09, 0x26, 0xDC,
-	0x01, 0x02, 0x09, 0xDC, 0x42, 0x06, 0x03, 0x01, 0x03, 0xDB, 0x43, 0x06,
-	0x03, 0x01, 0x01, 0xDB, 0xA7, 0x26, 0x06, 0x36, 0x01, 0x0A, 0xDC, 0x01,
-	0x04, 0x09, 0x26, 0xDC, 0x5F, 0xDC, 0x40, 0x01, 0x00, 0x26, 0x01, 0x82,
-	0x80, 0x80, 0x80, 0x00, 0x17, 0x06, 0x0A, 0x01, 0xFD, 0xFF, 0xFF, 0xFF,
-	0x7F, 0x17, 0x01, 0x1D, 0xDC, 0x26, 0x01, 0x20, 0x0A, 0x06, 0x0C, 0xA0,
-	0x11, 0x01, 0x01, 0x17, 0x06, 0x02, 0x26, 0xDC, 0x5C, 0x04, 0x6E, 0x60,
-	0x04, 0x01, 0x25, 0xA3, 0x06, 0x0A, 0x01, 0x0B, 0xDC, 0x01, 0x02, 0xDC,
-	0x01, 0x82, 0x00, 0xDC, 0x27, 0x26, 0x06, 0x1F, 0x01, 0x10, 0xDC, 0x01,
-	0x04, 0x09, 0x26, 0xDC, 0x5F, 0xDC, 0x85, 0x2C, 0x01, 0x00, 0xA0, 0x0F,
-	0x06, 0x0A, 0x26, 0x1E, 0x26, 0xDE, 0x84, 0x44, 0xD8, 0x5C, 0x04, 0x72,
-	0x60, 0x04, 0x01, 0x25, 0x02, 0x01, 0x58, 0x05, 0x11, 0x01, 0x15, 0xDC,
-	0x02, 0x01, 0x26, 0xDC, 0x26, 0x06, 0x06, 0x5D, 0x01, 0x00, 0xDE, 0x04,
-	0x77, 0x25, 0x00, 0x00, 0x01, 0x10, 0xDE, 0x79, 0x2C, 0x26, 0xCC, 0x06,
-	0x0C, 0xAB, 0x23, 0x26, 0x5E, 0xDD, 0x26, 0xDC, 0x84, 0x44, 0xD8, 0x04,
-	0x0D, 0x26, 0xCA, 0x44, 0xAB, 0x22, 0x26, 0x5C, 0xDD, 0x26, 0xDE, 0x84,
-	0x44, 0xD8, 0x00, 0x00, 0x9C, 0x01, 0x14, 0xDE, 0x01, 0x0C, 0xDD, 0x84,
-	0x01, 0x0C, 0xD8, 0x00, 0x00, 0x51, 0x26, 0x01, 0x00, 0x0E, 0x06, 0x02,
-	0x60, 0x00, 0xCE, 0x25, 0x04, 0x73, 0x00, 0x26, 0xDC, 0xD8, 0x00, 0x00,
-	0x26, 0xDE, 0xD8, 0x00, 0x01, 0x03, 0x00, 0x41, 0x25, 0x26, 0x01, 0x10,
-	0x17, 0x06, 0x06, 0x01, 0x04, 0xDE, 0x02, 0x00, 0xDE, 0x26, 0x01, 0x08,
-	0x17, 0x06, 0x06, 0x01, 0x03, 0xDE, 0x02, 0x00, 0xDE, 0x26, 0x01, 0x20,
-	0x17, 0x06, 0x06, 0x01, 0x05, 0xDE, 0x02, 0x00, 0xDE, 0x26, 0x01, 0x80,
-	0x40, 0x17, 0x06, 0x06, 0x01, 0x06, 0xDE, 0x02, 0x00, 0xDE, 0x01, 0x04,
-	0x17, 0x06, 0x06, 0x01, 0x02, 0xDE, 0x02, 0x00, 0xDE, 0x00, 0x00, 0x26,
-	0x01, 0x08, 0x4F, 0xDE, 0xDE, 0x00, 0x00, 0x26, 0x01, 0x10, 0x4F, 0xDE,
-	0xDC, 0x00, 0x00, 0x26, 0x52, 0x06, 0x02, 0x25, 0x00, 0xCE, 0x25, 0x04,
-	0x76
+	0x46, 0x25, 0x00, 0x00, 0x01, 0x04, 0x00, 0x00, 0x86, 0x2E, 0x01, 0x0E,
+	0x0E, 0x06, 0x04, 0x01, 0x00, 0x04, 0x02, 0x01, 0x05, 0x00, 0x00, 0x42,
+	0x06, 0x04, 0x01, 0x06, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00, 0x8A, 0x2C,
+	0x01, 0x81, 0x80, 0x00, 0x0E, 0x06, 0x04, 0x01, 0x00, 0x04, 0x02, 0x01,
+	0x06, 0x00, 0x00, 0x8D, 0x2E, 0x26, 0x06, 0x08, 0x01, 0x01, 0x09, 0x01,
+	0x11, 0x07, 0x04, 0x03, 0x25, 0x01, 0x05, 0x00, 0x01, 0x43, 0x03, 0x00,
+	0x25, 0x01, 0x00, 0x45, 0x06, 0x03, 0x02, 0x00, 0x08, 0x44, 0x06, 0x03,
+	0x02, 0x00, 0x08, 0x26, 0x06, 0x06, 0x01, 0x01, 0x0B, 0x01, 0x06, 0x08,
+	0x00, 0x00, 0x90, 0x41, 0x26, 0x06, 0x03, 0x01, 0x09, 0x08, 0x00, 0x01,
+	0x42, 0x26, 0x06, 0x1E, 0x01, 0x00, 0x03, 0x00, 0x26, 0x06, 0x0E, 0x26,
+	0x01, 0x01, 0x17, 0x02, 0x00, 0x08, 0x03, 0x00, 0x01, 0x01, 0x11, 0x04,
+	0x6F, 0x25, 0x02, 0x00, 0x01, 0x01, 0x0B, 0x01, 0x06, 0x08, 0x00, 0x00,
+	0x83, 0x2D, 0x46, 0x11, 0x01, 0x01, 0x17, 0x35, 0x00, 0x00, 0x9C, 0x2E,
+	0x06, 0x03, 0xDC, 0x04, 0x01, 0xA5, 0xD8, 0x26, 0x01, 0x07, 0x17, 0x01,
+	0x00, 0x39, 0x0E, 0x06, 0x09, 0x25, 0x01, 0x10, 0x17, 0x06, 0x01, 0xA5,
+	0x04, 0x35, 0x01, 0x01, 0x39, 0x0E, 0x06, 0x2C, 0x25, 0x25, 0x01, 0x00,
+	0x7A, 0x40, 0xBB, 0x8D, 0x2E, 0x01, 0x01, 0x0E, 0x01, 0x01, 0xB0, 0x38,
+	0x06, 0x17, 0x29, 0x1A, 0x37, 0x06, 0x04, 0xD8, 0x25, 0x04, 0x78, 0x01,
+	0x80, 0x64, 0xCF, 0x01, 0x01, 0x7A, 0x40, 0x01, 0x17, 0x8C, 0x40, 0x04,
+	0x01, 0xA5, 0x04, 0x03, 0x75, 0x28, 0x25, 0x04, 0xFF, 0x34, 0x01, 0x26,
+	0x03, 0x00, 0x09, 0x26, 0x5A, 0x06, 0x02, 0x6B, 0x28, 0x02, 0x00, 0x00,
+	0x00, 0xA0, 0x01, 0x0F, 0x17, 0x00, 0x00, 0x79, 0x2E, 0x01, 0x00, 0x39,
+	0x0E, 0x06, 0x10, 0x25, 0x26, 0x01, 0x01, 0x0D, 0x06, 0x03, 0x25, 0x01,
+	0x02, 0x79, 0x40, 0x01, 0x00, 0x04, 0x21, 0x01, 0x01, 0x39, 0x0E, 0x06,
+	0x14, 0x25, 0x01, 0x00, 0x79, 0x40, 0x26, 0x01, 0x80, 0x64, 0x0E, 0x06,
+	0x05, 0x01, 0x82, 0x00, 0x08, 0x28, 0x5C, 0x04, 0x07, 0x25, 0x01, 0x82,
+	0x00, 0x08, 0x28, 0x25, 0x00, 0x00, 0x01, 0x00, 0x2F, 0x06, 0x05, 0x3B,
+	0xB4, 0x38, 0x04, 0x78, 0x26, 0x06, 0x04, 0x01, 0x01, 0x94, 0x40, 0x00,
+	0x01, 0xC9, 0xB2, 0xC9, 0xB2, 0xCB, 0x88, 0x46, 0x26, 0x03, 0x00, 0xBE,
+	0xA1, 0xA1, 0x02, 0x00, 0x4F, 0x26, 0x5A, 0x06, 0x0A, 0x01, 0x03, 0xB0,
+	0x06, 0x02, 0x75, 0x28, 0x25, 0x04, 0x03, 0x5E, 0x8F, 0x3E, 0x00, 0x00,
+	0x2F, 0x06, 0x0B, 0x8B, 0x2E, 0x01, 0x14, 0x0D, 0x06, 0x02, 0x75, 0x28,
+	0x04, 0x11, 0xD8, 0x01, 0x07, 0x17, 0x26, 0x01, 0x02, 0x0D, 0x06, 0x06,
+	0x06, 0x02, 0x75, 0x28, 0x04, 0x70, 0x25, 0xCC, 0x01, 0x01, 0x0D, 0x33,
+	0x38, 0x06, 0x02, 0x63, 0x28, 0x26, 0x01, 0x01, 0xD2, 0x37, 0xBA, 0x00,
+	0x01, 0xC0, 0x01, 0x0B, 0x0E, 0x05, 0x02, 0x75, 0x28, 0x26, 0x01, 0x03,
+	0x0E, 0x06, 0x08, 0xCA, 0x06, 0x02, 0x6B, 0x28, 0x46, 0x25, 0x00, 0x46,
+	0x59, 0xCA, 0xB2, 0x26, 0x06, 0x23, 0xCA, 0xB2, 0x26, 0x58, 0x26, 0x06,
+	0x18, 0x26, 0x01, 0x82, 0x00, 0x0F, 0x06, 0x05, 0x01, 0x82, 0x00, 0x04,
+	0x01, 0x26, 0x03, 0x00, 0x88, 0x02, 0x00, 0xBE, 0x02, 0x00, 0x55, 0x04,
+	0x65, 0xA1, 0x56, 0x04, 0x5A, 0xA1, 0xA1, 0x57, 0x26, 0x06, 0x02, 0x35,
+	0x00, 0x25, 0x2B, 0x00, 0x00, 0x7C, 0x2C, 0xA7, 0x01, 0x7F, 0xB8, 0x26,
+	0x5A, 0x06, 0x02, 0x35, 0x28, 0x26, 0x05, 0x02, 0x75, 0x28, 0x39, 0x17,
+	0x0D, 0x06, 0x02, 0x77, 0x28, 0x3D, 0x00, 0x00, 0xA2, 0xC0, 0x01, 0x14,
+	0x0D, 0x06, 0x02, 0x75, 0x28, 0x88, 0x01, 0x0C, 0x08, 0x01, 0x0C, 0xBE,
+	0xA1, 0x88, 0x26, 0x01, 0x0C, 0x08, 0x01, 0x0C, 0x30, 0x05, 0x02, 0x67,
+	0x28, 0x00, 0x00, 0xC1, 0x06, 0x02, 0x75, 0x28, 0x06, 0x02, 0x69, 0x28,
+	0x00, 0x0D, 0xC0, 0x01, 0x02, 0x0E, 0x05, 0x02, 0x75, 0x28, 0xC9, 0x03,
+	0x00, 0x02, 0x00, 0x9A, 0x2C, 0x0A, 0x02, 0x00, 0x99, 0x2C, 0x0F, 0x38,
+	0x06, 0x02, 0x76, 0x28, 0x02, 0x00, 0x98, 0x2C, 0x0D, 0x06, 0x02, 0x6E,
+	0x28, 0x02, 0x00, 0x9B, 0x3E, 0x91, 0x01, 0x20, 0xBE, 0x01, 0x00, 0x03,
+	0x01, 0xCB, 0x03, 0x02, 0x02, 0x02, 0x01, 0x20, 0x0F, 0x06, 0x02, 0x73,
+	0x28, 0x88, 0x02, 0x02, 0xBE, 0x02, 0x02, 0x93, 0x2E, 0x0E, 0x02, 0x02,
+	0x01, 0x00, 0x0F, 0x17, 0x06, 0x0B, 0x92, 0x88, 0x02, 0x02, 0x30, 0x06,
+	0x04, 0x01, 0x7F, 0x03, 0x01, 0x92, 0x88, 0x02, 0x02, 0x31, 0x02, 0x02,
+	0x93, 0x40, 0x02, 0x00, 0x97, 0x02, 0x01, 0x9E, 0xC9, 0x26, 0xCD, 0x5A,
+	0x06, 0x02, 0x64, 0x28, 0x26, 0xD7, 0x02, 0x00, 0x01, 0x86, 0x03, 0x0A,
+	0x17, 0x06, 0x02, 0x64, 0x28, 0x7C, 0x02, 0x01, 0x9E, 0xCB, 0x06, 0x02,
+	0x65, 0x28, 0x01, 0x00, 0x03, 0x03, 0x26, 0x06, 0x82, 0x0B, 0xC9, 0xB2,
+	0xAE, 0x03, 0x04, 0xAC, 0x03, 0x05, 0xA9, 0x03, 0x06, 0xAB, 0x03, 0x07,
+	0xA8, 0x03, 0x08, 0xAD, 0x03, 0x09, 0xAF, 0x03, 0x0A, 0xAA, 0x03, 0x0B,
+	0x27, 0x03, 0x0C, 0x26, 0x06, 0x81, 0x56, 0xC9, 0x01, 0x00, 0x39, 0x0E,
+	0x06, 0x0F, 0x25, 0x02, 0x04, 0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03,
+	0x04, 0xC8, 0x04, 0x81, 0x3D, 0x01, 0x01, 0x39, 0x0E, 0x06, 0x17, 0x25,
+	0x02, 0x06, 0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x06, 0x02, 0x07,
+	0xAB, 0x0D, 0x06, 0x02, 0x75, 0x28, 0xC5, 0x04, 0x81, 0x20, 0x01, 0x1C,
+	0x39, 0x0E, 0x06, 0x17, 0x25, 0x02, 0x07, 0x05, 0x02, 0x6F, 0x28, 0x01,
+	0x00, 0x03, 0x07, 0x02, 0x06, 0xA9, 0x0D, 0x06, 0x02, 0x75, 0x28, 0xC7,
+	0x04, 0x81, 0x03, 0x01, 0x17, 0x39, 0x0E, 0x06, 0x13, 0x25, 0x02, 0x08,
+	0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x08, 0xC4, 0x01, 0x7F, 0x03,
+	0x03, 0x04, 0x80, 0x6A, 0x01, 0x83, 0xFE, 0x01, 0x39, 0x0E, 0x06, 0x0F,
+	0x25, 0x02, 0x05, 0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x05, 0xC6,
+	0x04, 0x80, 0x53, 0x01, 0x0D, 0x39, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x09,
+	0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x09, 0xC2, 0x04, 0x3F, 0x01,
+	0x0A, 0x39, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x0A, 0x05, 0x02, 0x6F, 0x28,
+	0x01, 0x00, 0x03, 0x0A, 0xC2, 0x04, 0x2B, 0x01, 0x0B, 0x39, 0x0E, 0x06,
+	0x0E, 0x25, 0x02, 0x0B, 0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x0B,
+	0xC2, 0x04, 0x17, 0x01, 0x10, 0x39, 0x0E, 0x06, 0x0E, 0x25, 0x02, 0x0C,
+	0x05, 0x02, 0x6F, 0x28, 0x01, 0x00, 0x03, 0x0C, 0xB6, 0x04, 0x03, 0x6F,
+	0x28, 0x25, 0x04, 0xFE, 0x26, 0x02, 0x05, 0x06, 0x0D, 0x02, 0x05, 0x01,
+	0x05, 0x0F, 0x06, 0x02, 0x6C, 0x28, 0x01, 0x01, 0x8D, 0x40, 0xA1, 0x04,
+	0x0C, 0xAC, 0x01, 0x05, 0x0F, 0x06, 0x02, 0x6C, 0x28, 0x01, 0x01, 0x8D,
+	0x40, 0xA1, 0x02, 0x03, 0x01, 0x01, 0x17, 0x02, 0x01, 0x06, 0x09, 0x82,
+	0x2E, 0x0D, 0x06, 0x02, 0x66, 0x28, 0x04, 0x02, 0x82, 0x40, 0x02, 0x01,
+	0x00, 0x04, 0xC0, 0x01, 0x0C, 0x0E, 0x05, 0x02, 0x75, 0x28, 0xCB, 0x01,
+	0x03, 0x0E, 0x05, 0x02, 0x70, 0x28, 0xC9, 0x26, 0x7F, 0x40, 0x26, 0x01,
+	0x20, 0x10, 0x06, 0x02, 0x70, 0x28, 0x42, 0x46, 0x11, 0x01, 0x01, 0x17,
+	0x05, 0x02, 0x70, 0x28, 0xCB, 0x26, 0x01, 0x81, 0x05, 0x0F, 0x06, 0x02,
+	0x70, 0x28, 0x26, 0x81, 0x40, 0x80, 0x46, 0xBE, 0x97, 0x2C, 0x01, 0x86,
+	0x03, 0x10, 0x03, 0x00, 0x7C, 0x2C, 0xD5, 0x03, 0x01, 0x01, 0x02, 0x03,
+	0x02, 0x02, 0x00, 0x06, 0x21, 0xCB, 0x26, 0x26, 0x01, 0x02, 0x0A, 0x46,
+	0x01, 0x06, 0x0F, 0x38, 0x06, 0x02, 0x70, 0x28, 0x03, 0x02, 0xCB, 0x02,
+	0x01, 0x01, 0x01, 0x0B, 0x01, 0x03, 0x08, 0x0E, 0x05, 0x02, 0x70, 0x28,
+	0x04, 0x08, 0x02, 0x01, 0x06, 0x04, 0x01, 0x00, 0x03, 0x02, 0xC9, 0x26,
+	0x03, 0x03, 0x26, 0x01, T0_INT2(BR_SSL_BUFSIZE_PAD), 0x0F, 0x06, 0x02,
+	0x71, 0x28, 0x88, 0x46, 0xBE, 0x02, 0x02, 0x02, 0x01, 0x02, 0x03, 0x52,
+	0x26, 0x06, 0x01, 0x28, 0x25, 0xA1, 0x00, 0x02, 0x03, 0x00, 0x03, 0x01,
+	0x02, 0x00, 0x9D, 0x02, 0x01, 0x02, 0x00, 0x3A, 0x26, 0x01, 0x00, 0x0E,
+	0x06, 0x02, 0x62, 0x00, 0xDA, 0x04, 0x74, 0x02, 0x01, 0x00, 0x03, 0x00,
+	0xCB, 0xB2, 0x26, 0x06, 0x80, 0x43, 0xCB, 0x01, 0x01, 0x39, 0x0E, 0x06,
+	0x06, 0x25, 0x01, 0x81, 0x7F, 0x04, 0x2E, 0x01, 0x80, 0x40, 0x39, 0x0E,
+	0x06, 0x07, 0x25, 0x01, 0x83, 0xFE, 0x00, 0x04, 0x20, 0x01, 0x80, 0x41,
+	0x39, 0x0E, 0x06, 0x07, 0x25, 0x01, 0x84, 0x80, 0x00, 0x04, 0x12, 0x01,
+	0x80, 0x42, 0x39, 0x0E, 0x06, 0x07, 0x25, 0x01, 0x88, 0x80, 0x00, 0x04,
+	0x04, 0x01, 0x00, 0x46, 0x25, 0x02, 0x00, 0x38, 0x03, 0x00, 0x04, 0xFF,
+	0x39, 0xA1, 0x7C, 0x2C, 0xD3, 0x05, 0x09, 0x02, 0x00, 0x01, 0x83, 0xFF,
+	0x7F, 0x17, 0x03, 0x00, 0x97, 0x2C, 0x01, 0x86, 0x03, 0x10, 0x06, 0x3A,
+	0xC3, 0x26, 0x85, 0x3F, 0x43, 0x25, 0x26, 0x01, 0x08, 0x0B, 0x38, 0x01,
+	0x8C, 0x80, 0x00, 0x38, 0x17, 0x02, 0x00, 0x17, 0x02, 0x00, 0x01, 0x8C,
+	0x80, 0x00, 0x17, 0x06, 0x19, 0x26, 0x01, 0x81, 0x7F, 0x17, 0x06, 0x05,
+	0x01, 0x84, 0x80, 0x00, 0x38, 0x26, 0x01, 0x83, 0xFE, 0x00, 0x17, 0x06,
+	0x05, 0x01, 0x88, 0x80, 0x00, 0x38, 0x03, 0x00, 0x04, 0x09, 0x02, 0x00,
+	0x01, 0x8C, 0x88, 0x01, 0x17, 0x03, 0x00, 0x16, 0xC9, 0xB2, 0x26, 0x06,
+	0x23, 0xC9, 0xB2, 0x26, 0x15, 0x26, 0x06, 0x18, 0x26, 0x01, 0x82, 0x00,
+	0x0F, 0x06, 0x05, 0x01, 0x82, 0x00, 0x04, 0x01, 0x26, 0x03, 0x01, 0x88,
+	0x02, 0x01, 0xBE, 0x02, 0x01, 0x12, 0x04, 0x65, 0xA1, 0x13, 0x04, 0x5A,
+	0xA1, 0x14, 0xA1, 0x02, 0x00, 0x2A, 0x00, 0x00, 0xC1, 0x26, 0x5C, 0x06,
+	0x07, 0x25, 0x06, 0x02, 0x69, 0x28, 0x04, 0x74, 0x00, 0x00, 0xCC, 0x01,
+	0x03, 0xCA, 0x46, 0x25, 0x46, 0x00, 0x00, 0xC9, 0xD0, 0x00, 0x03, 0x01,
+	0x00, 0x03, 0x00, 0xC9, 0xB2, 0x26, 0x06, 0x80, 0x50, 0xCB, 0x03, 0x01,
+	0xCB, 0x03, 0x02, 0x02, 0x01, 0x01, 0x08, 0x0E, 0x06, 0x16, 0x02, 0x02,
+	0x01, 0x0F, 0x0C, 0x06, 0x0D, 0x01, 0x01, 0x02, 0x02, 0x01, 0x10, 0x08,
+	0x0B, 0x02, 0x00, 0x38, 0x03, 0x00, 0x04, 0x2A, 0x02, 0x01, 0x01, 0x02,
+	0x10, 0x02, 0x01, 0x01, 0x06, 0x0C, 0x17, 0x02, 0x02, 0x01, 0x01, 0x0E,
+	0x02, 0x02, 0x01, 0x03, 0x0E, 0x38, 0x17, 0x06, 0x11, 0x02, 0x00, 0x01,
+	0x01, 0x02, 0x02, 0x5F, 0x01, 0x02, 0x0B, 0x02, 0x01, 0x08, 0x0B, 0x38,
+	0x03, 0x00, 0x04, 0xFF, 0x2C, 0xA1, 0x02, 0x00, 0x00, 0x00, 0xC9, 0x06,
+	0x02, 0x66, 0x28, 0x00, 0x00, 0xC9, 0x01, 0x01, 0x0E, 0x05, 0x02, 0x68,
+	0x28, 0xCB, 0x01, 0x08, 0x08, 0x86, 0x2E, 0x0E, 0x05, 0x02, 0x68, 0x28,
+	0x00, 0x00, 0xC9, 0x8D, 0x2E, 0x05, 0x15, 0x01, 0x01, 0x0E, 0x05, 0x02,
+	0x6C, 0x28, 0xCB, 0x01, 0x00, 0x0E, 0x05, 0x02, 0x6C, 0x28, 0x01, 0x02,
+	0x8D, 0x40, 0x04, 0x1C, 0x01, 0x19, 0x0E, 0x05, 0x02, 0x6C, 0x28, 0xCB,
+	0x01, 0x18, 0x0E, 0x05, 0x02, 0x6C, 0x28, 0x88, 0x01, 0x18, 0xBE, 0x8E,
+	0x88, 0x01, 0x18, 0x30, 0x05, 0x02, 0x6C, 0x28, 0x00, 0x00, 0xC9, 0x01,
+	0x02, 0x0E, 0x05, 0x02, 0x68, 0x28, 0xC9, 0x26, 0x01, 0x80, 0x40, 0x0A,
+	0x06, 0x02, 0x68, 0x28, 0x3C, 0x00, 0x00, 0xC9, 0x06, 0x02, 0x6D, 0x28,
+	0x00, 0x00, 0x01, 0x02, 0x9D, 0xCC, 0x01, 0x08, 0x0B, 0xCC, 0x08, 0x00,
+	0x00, 0x01, 0x03, 0x9D, 0xCC, 0x01, 0x08, 0x0B, 0xCC, 0x08, 0x01, 0x08,
+	0x0B, 0xCC, 0x08, 0x00, 0x00, 0x01, 0x01, 0x9D, 0xCC, 0x00, 0x00, 0x3B,
+	0x26, 0x5A, 0x05, 0x01, 0x00, 0x25, 0xDA, 0x04, 0x76, 0x02, 0x03, 0x00,
+	0x96, 0x2E, 0x03, 0x01, 0x01, 0x00, 0x26, 0x02, 0x01, 0x0A, 0x06, 0x10,
+	0x26, 0x01, 0x01, 0x0B, 0x95, 0x08, 0x2C, 0x02, 0x00, 0x0E, 0x06, 0x01,
+	0x00, 0x5E, 0x04, 0x6A, 0x25, 0x01, 0x7F, 0x00, 0x00, 0x01, 0x15, 0x8C,
+	0x40, 0x46, 0x54, 0x25, 0x54, 0x25, 0x29, 0x00, 0x00, 0x01, 0x01, 0x46,
+	0xCE, 0x00, 0x00, 0x46, 0x39, 0x9D, 0x46, 0x26, 0x06, 0x05, 0xCC, 0x25,
+	0x5F, 0x04, 0x78, 0x25, 0x00, 0x00, 0x26, 0x01, 0x81, 0xAC, 0x00, 0x0E,
+	0x06, 0x04, 0x25, 0x01, 0x7F, 0x00, 0xA0, 0x5B, 0x00, 0x02, 0x03, 0x00,
+	0x7C, 0x2C, 0xA0, 0x03, 0x01, 0x02, 0x01, 0x01, 0x0F, 0x17, 0x02, 0x01,
+	0x01, 0x04, 0x11, 0x01, 0x0F, 0x17, 0x02, 0x01, 0x01, 0x08, 0x11, 0x01,
+	0x0F, 0x17, 0x01, 0x00, 0x39, 0x0E, 0x06, 0x10, 0x25, 0x01, 0x00, 0x01,
+	0x18, 0x02, 0x00, 0x06, 0x03, 0x4B, 0x04, 0x01, 0x4C, 0x04, 0x81, 0x0D,
+	0x01, 0x01, 0x39, 0x0E, 0x06, 0x10, 0x25, 0x01, 0x01, 0x01, 0x10, 0x02,
+	0x00, 0x06, 0x03, 0x4B, 0x04, 0x01, 0x4C, 0x04, 0x80, 0x77, 0x01, 0x02,
+	0x39, 0x0E, 0x06, 0x10, 0x25, 0x01, 0x01, 0x01, 0x20, 0x02, 0x00, 0x06,
+	0x03, 0x4B, 0x04, 0x01, 0x4C, 0x04, 0x80, 0x61, 0x01, 0x03, 0x39, 0x0E,
+	0x06, 0x0F, 0x25, 0x25, 0x01, 0x10, 0x02, 0x00, 0x06, 0x03, 0x49, 0x04,
+	0x01, 0x4A, 0x04, 0x80, 0x4C, 0x01, 0x04, 0x39, 0x0E, 0x06, 0x0E, 0x25,
+	0x25, 0x01, 0x20, 0x02, 0x00, 0x06, 0x03, 0x49, 0x04, 0x01, 0x4A, 0x04,
+	0x38, 0x01, 0x05, 0x39, 0x0E, 0x06, 0x0C, 0x25, 0x25, 0x02, 0x00, 0x06,
+	0x03, 0x4D, 0x04, 0x01, 0x4E, 0x04, 0x26, 0x26, 0x01, 0x09, 0x0F, 0x06,
+	0x02, 0x6B, 0x28, 0x46, 0x25, 0x26, 0x01, 0x01, 0x17, 0x01, 0x04, 0x0B,
+	0x01, 0x10, 0x08, 0x46, 0x01, 0x08, 0x17, 0x01, 0x10, 0x46, 0x09, 0x02,
+	0x00, 0x06, 0x03, 0x47, 0x04, 0x01, 0x48, 0x00, 0x25, 0x00, 0x00, 0xA0,
+	0x01, 0x0C, 0x11, 0x01, 0x02, 0x0F, 0x00, 0x00, 0xA0, 0x01, 0x0C, 0x11,
+	0x26, 0x5D, 0x46, 0x01, 0x03, 0x0A, 0x17, 0x00, 0x00, 0xA0, 0x01, 0x0C,
+	0x11, 0x01, 0x01, 0x0E, 0x00, 0x00, 0xA0, 0x01, 0x0C, 0x11, 0x5C, 0x00,
+	0x00, 0xA0, 0x01, 0x81, 0x70, 0x17, 0x01, 0x20, 0x0D, 0x00, 0x00, 0x1B,
+	0x01, 0x00, 0x78, 0x2E, 0x26, 0x06, 0x22, 0x01, 0x01, 0x39, 0x0E, 0x06,
+	0x06, 0x25, 0x01, 0x00, 0xA4, 0x04, 0x14, 0x01, 0x02, 0x39, 0x0E, 0x06,
+	0x0D, 0x25, 0x7A, 0x2E, 0x01, 0x01, 0x0E, 0x06, 0x03, 0x01, 0x10, 0x38,
+	0x04, 0x01, 0x25, 0x04, 0x01, 0x25, 0x7E, 0x2E, 0x05, 0x33, 0x2F, 0x06,
+	0x30, 0x8B, 0x2E, 0x01, 0x14, 0x39, 0x0E, 0x06, 0x06, 0x25, 0x01, 0x02,
+	0x38, 0x04, 0x22, 0x01, 0x15, 0x39, 0x0E, 0x06, 0x09, 0x25, 0xB5, 0x06,
+	0x03, 0x01, 0x7F, 0xA4, 0x04, 0x13, 0x01, 0x16, 0x39, 0x0E, 0x06, 0x06,
+	0x25, 0x01, 0x01, 0x38, 0x04, 0x07, 0x25, 0x01, 0x04, 0x38, 0x01, 0x00,
+	0x25, 0x1A, 0x06, 0x03, 0x01, 0x08, 0x38, 0x00, 0x00, 0x1B, 0x26, 0x05,
+	0x13, 0x2F, 0x06, 0x10, 0x8B, 0x2E, 0x01, 0x15, 0x0E, 0x06, 0x08, 0x25,
+	0xB5, 0x01, 0x00, 0x7A, 0x40, 0x04, 0x01, 0x20, 0x00, 0x00, 0xD8, 0x01,
+	0x07, 0x17, 0x01, 0x01, 0x0F, 0x06, 0x02, 0x75, 0x28, 0x00, 0x01, 0x03,
+	0x00, 0x29, 0x1A, 0x06, 0x05, 0x02, 0x00, 0x8C, 0x40, 0x00, 0xD8, 0x25,
+	0x04, 0x74, 0x00, 0x01, 0x00, 0x9C, 0x40, 0x97, 0x2C, 0x26, 0x98, 0x3E,
+	0x9B, 0x3E, 0x01, 0x7F, 0x01, 0x01, 0xD2, 0x01, 0x7F, 0x01, 0x00, 0xD2,
+	0x01, 0x01, 0x7A, 0x40, 0x01, 0x17, 0x8C, 0x40, 0x00, 0x00, 0x01, 0x14,
+	0xDB, 0x01, 0x01, 0xE9, 0x29, 0x26, 0x01, 0x00, 0xD2, 0x01, 0x16, 0xDB,
+	0xE2, 0x29, 0x00, 0x00, 0x01, 0x0B, 0xE9, 0x50, 0x26, 0x26, 0x01, 0x03,
+	0x08, 0xE8, 0xE8, 0x18, 0x26, 0x5A, 0x06, 0x02, 0x25, 0x00, 0xE8, 0x1D,
+	0x26, 0x06, 0x05, 0x88, 0x46, 0xE3, 0x04, 0x77, 0x25, 0x04, 0x6C, 0x00,
+	0x21, 0x01, 0x0F, 0xE9, 0x26, 0x97, 0x2C, 0x01, 0x86, 0x03, 0x10, 0x06,
+	0x0C, 0x01, 0x04, 0x08, 0xE8, 0x84, 0x2E, 0xE9, 0x7B, 0x2E, 0xE9, 0x04,
+	0x02, 0x60, 0xE8, 0x26, 0xE7, 0x88, 0x46, 0xE3, 0x00, 0x02, 0xAC, 0xAE,
+	0x08, 0xA9, 0x08, 0xAB, 0x08, 0xA8, 0x08, 0xAD, 0x08, 0xAF, 0x08, 0xAA,
+	0x08, 0x27, 0x08, 0x03, 0x00, 0x01, 0x01, 0xE9, 0x01, 0x27, 0x93, 0x2E,
+	0x08, 0x96, 0x2E, 0x01, 0x01, 0x0B, 0x08, 0x02, 0x00, 0x06, 0x04, 0x60,
+	0x02, 0x00, 0x08, 0x87, 0x2C, 0x39, 0x09, 0x26, 0x5D, 0x06, 0x24, 0x02,
+	0x00, 0x05, 0x04, 0x46, 0x60, 0x46, 0x61, 0x01, 0x04, 0x09, 0x26, 0x5A,
+	0x06, 0x03, 0x25, 0x01, 0x00, 0x26, 0x01, 0x04, 0x08, 0x02, 0x00, 0x08,
+	0x03, 0x00, 0x46, 0x01, 0x04, 0x08, 0x39, 0x08, 0x46, 0x04, 0x03, 0x25,
+	0x01, 0x7F, 0x03, 0x01, 0xE8, 0x99, 0x2C, 0xE7, 0x7D, 0x01, 0x04, 0x19,
+	0x7D, 0x01, 0x04, 0x08, 0x01, 0x1C, 0x32, 0x7D, 0x01, 0x20, 0xE3, 0x92,
+	0x93, 0x2E, 0xE5, 0x96, 0x2E, 0x26, 0x01, 0x01, 0x0B, 0xE7, 0x95, 0x46,
+	0x26, 0x06, 0x0F, 0x5F, 0x39, 0x2C, 0x26, 0xD1, 0x05, 0x02, 0x64, 0x28,
+	0xE7, 0x46, 0x60, 0x46, 0x04, 0x6E, 0x62, 0x01, 0x01, 0xE9, 0x01, 0x00,
+	0xE9, 0x02, 0x00, 0x06, 0x81, 0x4E, 0x02, 0x00, 0xE7, 0xAC, 0x06, 0x0E,
+	0x01, 0x83, 0xFE, 0x01, 0xE7, 0x8E, 0xAC, 0x01, 0x04, 0x09, 0x26, 0xE7,
+	0x5F, 0xE5, 0xAE, 0x06, 0x16, 0x01, 0x00, 0xE7, 0x90, 0xAE, 0x01, 0x04,
+	0x09, 0x26, 0xE7, 0x01, 0x02, 0x09, 0x26, 0xE7, 0x01, 0x00, 0xE9, 0x01,
+	0x03, 0x09, 0xE4, 0xA9, 0x06, 0x0C, 0x01, 0x01, 0xE7, 0x01, 0x01, 0xE7,
+	0x86, 0x2E, 0x01, 0x08, 0x09, 0xE9, 0xAB, 0x06, 0x09, 0x01, 0x1C, 0xE7,
+	0x01, 0x02, 0xE7, 0x8A, 0x2C, 0xE7, 0xA8, 0x06, 0x06, 0x01, 0x17, 0xE7,
+	0x01, 0x00, 0xE7, 0xAD, 0x06, 0x19, 0x01, 0x0D, 0xE7, 0xAD, 0x01, 0x04,
+	0x09, 0x26, 0xE7, 0x01, 0x02, 0x09, 0xE7, 0x44, 0x06, 0x03, 0x01, 0x03,
+	0xE6, 0x45, 0x06, 0x03, 0x01, 0x01, 0xE6, 0xAF, 0x26, 0x06, 0x15, 0x01,
+	0x0A, 0xE7, 0x01, 0x04, 0x09, 0x26, 0xE7, 0x61, 0xE7, 0x42, 0x26, 0x06,
+	0x04, 0x36, 0xE7, 0x04, 0x79, 0x25, 0x04, 0x01, 0x25, 0xAA, 0x06, 0x0A,
+	0x01, 0x0B, 0xE7, 0x01, 0x02, 0xE7, 0x01, 0x82, 0x00, 0xE7, 0x27, 0x26,
+	0x06, 0x1F, 0x01, 0x10, 0xE7, 0x01, 0x04, 0x09, 0x26, 0xE7, 0x61, 0xE7,
+	0x89, 0x2C, 0x01, 0x00, 0xA6, 0x0F, 0x06, 0x0A, 0x26, 0x1E, 0x26, 0xE9,
+	0x88, 0x46, 0xE3, 0x5E, 0x04, 0x72, 0x62, 0x04, 0x01, 0x25, 0x02, 0x01,
+	0x5A, 0x05, 0x11, 0x01, 0x15, 0xE7, 0x02, 0x01, 0x26, 0xE7, 0x26, 0x06,
+	0x06, 0x5F, 0x01, 0x00, 0xE9, 0x04, 0x77, 0x25, 0x00, 0x00, 0x01, 0x10,
+	0xE9, 0x7C, 0x2C, 0x26, 0xD6, 0x06, 0x0C, 0xB3, 0x23, 0x26, 0x60, 0xE8,
+	0x26, 0xE7, 0x88, 0x46, 0xE3, 0x04, 0x0D, 0x26, 0xD4, 0x46, 0xB3, 0x22,
+	0x26, 0x5E, 0xE8, 0x26, 0xE9, 0x88, 0x46, 0xE3, 0x00, 0x00, 0xA2, 0x01,
+	0x14, 0xE9, 0x01, 0x0C, 0xE8, 0x88, 0x01, 0x0C, 0xE3, 0x00, 0x00, 0x53,
+	0x26, 0x01, 0x00, 0x0E, 0x06, 0x02, 0x62, 0x00, 0xD8, 0x25, 0x04, 0x73,
+	0x00, 0x26, 0xE7, 0xE3, 0x00, 0x00, 0x26, 0xE9, 0xE3, 0x00, 0x01, 0x03,
+	0x00, 0x43, 0x25, 0x26, 0x01, 0x10, 0x17, 0x06, 0x06, 0x01, 0x04, 0xE9,
+	0x02, 0x00, 0xE9, 0x26, 0x01, 0x08, 0x17, 0x06, 0x06, 0x01, 0x03, 0xE9,
+	0x02, 0x00, 0xE9, 0x26, 0x01, 0x20, 0x17, 0x06, 0x06, 0x01, 0x05, 0xE9,
+	0x02, 0x00, 0xE9, 0x26, 0x01, 0x80, 0x40, 0x17, 0x06, 0x06, 0x01, 0x06,
+	0xE9, 0x02, 0x00, 0xE9, 0x01, 0x04, 0x17, 0x06, 0x06, 0x01, 0x02, 0xE9,
+	0x02, 0x00, 0xE9, 0x00, 0x00, 0x26, 0x01, 0x08, 0x51, 0xE9, 0xE9, 0x00,
+	0x00, 0x26, 0x01, 0x10, 0x51, 0xE9, 0xE7, 0x00, 0x00, 0x26, 0x54, 0x06,
+	0x02, 0x25, 0x00, 0xD8, 0x25, 0x04, 0x76
 };
 
 static const uint16_t t0_caddr[] = {
@@ -769,114 +838,123 @@ static const uint16_t t0_caddr[] = {
 	116,
 	120,
 	124,
-	129,
-	134,
-	139,
-	144,
-	149,
-	154,
-	159,
-	164,
-	169,
-	174,
-	179,
-	184,
-	189,
-	194,
-	199,
-	204,
-	209,
-	214,
-	219,
-	224,
-	229,
-	234,
-	239,
-	244,
-	249,
-	254,
-	259,
-	264,
-	269,
-	274,
-	279,
-	284,
-	289,
-	294,
+	128,
+	133,
+	138,
+	143,
+	148,
+	153,
+	158,
+	163,
+	168,
+	173,
+	178,
+	183,
+	188,
+	193,
+	198,
+	203,
+	208,
+	213,
+	218,
+	223,
+	228,
+	233,
+	238,
+	243,
+	248,
+	253,
+	258,
+	263,
+	268,
+	273,
+	278,
+	283,
+	288,
+	293,
+	298,
 	303,
-	316,
-	320,
-	345,
-	351,
+	308,
+	313,
+	322,
+	335,
+	339,
+	364,
 	370,
-	381,
-	422,
-	542,
-	546,
-	611,
-	626,
-	637,
-	655,
-	684,
-	694,
-	730,
-	740,
-	818,
-	832,
-	838,
-	897,
-	916,
-	951,
-	1000,
-	1076,
-	1103,
-	1134,
-	1145,
-	1497,
-	1644,
-	1668,
-	1884,
-	1898,
-	1907,
-	1911,
-	2006,
-	2027,
-	2083,
-	2090,
-	2101,
-	2117,
-	2123,
-	2134,
-	2169,
-	2181,
-	2187,
-	2202,
-	2218,
-	2411,
-	2420,
-	2433,
-	2442,
-	2449,
-	2459,
-	2565,
-	2590,
-	2603,
-	2619,
-	2637,
-	2669,
-	2703,
-	3071,
-	3107,
-	3120,
-	3134,
-	3139,
-	3144,
-	3210,
-	3218,
-	3226
+	389,
+	400,
+	441,
+	561,
+	565,
+	630,
+	634,
+	649,
+	660,
+	677,
+	695,
+	724,
+	734,
+	770,
+	780,
+	865,
+	879,
+	885,
+	944,
+	963,
+	998,
+	1047,
+	1123,
+	1150,
+	1181,
+	1192,
+	1636,
+	1783,
+	1807,
+	2023,
+	2037,
+	2046,
+	2050,
+	2145,
+	2152,
+	2173,
+	2229,
+	2250,
+	2257,
+	2268,
+	2284,
+	2290,
+	2301,
+	2336,
+	2348,
+	2354,
+	2369,
+	2385,
+	2578,
+	2587,
+	2600,
+	2609,
+	2616,
+	2626,
+	2732,
+	2757,
+	2770,
+	2786,
+	2817,
+	2835,
+	2867,
+	2901,
+	3261,
+	3297,
+	3310,
+	3324,
+	3329,
+	3334,
+	3400,
+	3408,
+	3416
 };
 
-#define T0_INTERPRETED   88
+#define T0_INTERPRETED   90
 
 #define T0_ENTER(ip, rp, slot)   do { \
 		const unsigned char *t0_newip; \
@@ -897,7 +975,7 @@ name(void *ctx) \
 	T0_ENTER(t0ctx->ip, t0ctx->rp, slot); \
 }
 
-T0_DEFENTRY(br_ssl_hs_client_init_main, 169)
+T0_DEFENTRY(br_ssl_hs_client_init_main, 177)
 
 #define T0_NEXT(t0ipp)   (*(*(t0ipp)) ++)
 
@@ -1486,6 +1564,37 @@ br_ssl_hs_client_run(void *t0ctx)
 				}
 				break;
 			case 54: {
+				/* next-curve */
+
+	uint32_t x;
+	unsigned u;
+	int id;
+
+	x = T0_POP();
+	id = -1;
+	for (u = 0; u < ENG->curves_num; u ++) {
+		unsigned c;
+
+		c = ENG->curves_buf[u];
+		if (c < 32 && ((x >> c) & 1) != 0) {
+			id = (int)c;
+			break;
+		}
+	}
+	if (id < 0) {
+		if ((x & 0x20000000) != 0) {
+			id = 29;
+		} else {
+			for (id = 0; ((x >> id) & 1) == 0; id ++);
+		}
+	}
+	x &= ~((uint32_t)1 << id);
+	T0_PUSH(x);
+	T0_PUSH(id);
+
+				}
+				break;
+			case 55: {
 				/* not */
 
 	uint32_t a = T0_POP();
@@ -1493,7 +1602,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 55: {
+			case 56: {
 				/* or */
 
 	uint32_t b = T0_POP();
@@ -1502,12 +1611,12 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 56: {
+			case 57: {
 				/* over */
  T0_PUSH(T0_PEEK(1)); 
 				}
 				break;
-			case 57: {
+			case 58: {
 				/* read-chunk-native */
 
 	size_t clen = ENG->hlen_in;
@@ -1531,7 +1640,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 58: {
+			case 59: {
 				/* read8-native */
 
 	if (ENG->hlen_in > 0) {
@@ -1549,7 +1658,27 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 59: {
+			case 60: {
+				/* set-peer-record-size-limit */
+
+	size_t len = T0_POP();
+
+	if (len < ENG->max_frag_len) {
+		br_ssl_engine_new_max_frag_len(ENG, len);
+
+		/*
+		 * The ClientHello has been sent and the next output
+		 * record is empty, so we can also clamp the current
+		 * handshake output chunk.
+		 */
+		if (ENG->hlen_out > len) {
+			ENG->hlen_out = len;
+		}
+	}
+
+				}
+				break;
+			case 61: {
 				/* set-server-curve */
 
 	const br_x509_class *xc;
@@ -1562,7 +1691,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 60: {
+			case 62: {
 				/* set16 */
 
 	size_t addr = (size_t)T0_POP();
@@ -1570,7 +1699,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 61: {
+			case 63: {
 				/* set32 */
 
 	size_t addr = (size_t)T0_POP();
@@ -1578,7 +1707,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 62: {
+			case 64: {
 				/* set8 */
 
 	size_t addr = (size_t)T0_POP();
@@ -1586,7 +1715,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 63: {
+			case 65: {
 				/* strlen */
 
 	void *str = (unsigned char *)ENG + (size_t)T0_POP();
@@ -1594,7 +1723,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 64: {
+			case 66: {
 				/* supported-curves */
 
 	uint32_t x = ENG->iec == NULL ? 0 : ENG->iec->supported_curves;
@@ -1602,7 +1731,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 65: {
+			case 67: {
 				/* supported-hash-functions */
 
 	int i;
@@ -1621,26 +1750,26 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 66: {
+			case 68: {
 				/* supports-ecdsa? */
 
 	T0_PUSHi(-(ENG->iecdsa != 0));
 
 				}
 				break;
-			case 67: {
+			case 69: {
 				/* supports-rsa-sign? */
 
 	T0_PUSHi(-(ENG->irsavrfy != 0));
 
 				}
 				break;
-			case 68: {
+			case 70: {
 				/* swap */
  T0_SWAP(); 
 				}
 				break;
-			case 69: {
+			case 71: {
 				/* switch-aesccm-in */
 
 	int is_client, prf_id;
@@ -1655,7 +1784,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 70: {
+			case 72: {
 				/* switch-aesccm-out */
 
 	int is_client, prf_id;
@@ -1670,7 +1799,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 71: {
+			case 73: {
 				/* switch-aesgcm-in */
 
 	int is_client, prf_id;
@@ -1684,7 +1813,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 72: {
+			case 74: {
 				/* switch-aesgcm-out */
 
 	int is_client, prf_id;
@@ -1698,7 +1827,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 73: {
+			case 75: {
 				/* switch-cbc-in */
 
 	int is_client, prf_id, mac_id, aes;
@@ -1714,7 +1843,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 74: {
+			case 76: {
 				/* switch-cbc-out */
 
 	int is_client, prf_id, mac_id, aes;
@@ -1730,7 +1859,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 75: {
+			case 77: {
 				/* switch-chapol-in */
 
 	int is_client, prf_id;
@@ -1741,7 +1870,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 76: {
+			case 78: {
 				/* switch-chapol-out */
 
 	int is_client, prf_id;
@@ -1752,7 +1881,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 77: {
+			case 79: {
 				/* test-protocol-name */
 
 	size_t len = T0_POP();
@@ -1771,7 +1900,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 78: {
+			case 80: {
 				/* total-chain-length */
 
 	size_t u;
@@ -1785,7 +1914,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 79: {
+			case 81: {
 				/* u>> */
 
 	int c = (int)T0_POPi();
@@ -1794,7 +1923,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 80: {
+			case 82: {
 				/* verify-SKE-sig */
 
 	size_t sig_len = T0_POP();
@@ -1805,7 +1934,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 81: {
+			case 83: {
 				/* write-blob-chunk */
 
 	size_t clen = ENG->hlen_out;
@@ -1829,7 +1958,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 82: {
+			case 84: {
 				/* write8-native */
 
 	unsigned char x;
@@ -1848,7 +1977,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 83: {
+			case 85: {
 				/* x509-append */
 
 	const br_x509_class *xc;
@@ -1860,7 +1989,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 84: {
+			case 86: {
 				/* x509-end-cert */
 
 	const br_x509_class *xc;
@@ -1870,7 +1999,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 85: {
+			case 87: {
 				/* x509-end-chain */
 
 	const br_x509_class *xc;
@@ -1880,7 +2009,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 86: {
+			case 88: {
 				/* x509-start-cert */
 
 	const br_x509_class *xc;
@@ -1890,7 +2019,7 @@ br_ssl_hs_client_run(void *t0ctx)
 
 				}
 				break;
-			case 87: {
+			case 89: {
 				/* x509-start-chain */
 
 	const br_x509_class *xc;
@@ -34,6 +34,56 @@ gen_chapol_init(br_sslrec_chapol_context *cc,
 	cc->ipoly = ipoly;
 	memcpy(cc->key, key, sizeof cc->key);
 	memcpy(cc->iv, iv, sizeof cc->iv);
+	cc->ks = NULL;
+	cc->ks_len = 0;
+	cc->in_started = 0;
+}
+
+/*
+ * ChaCha20 implementation that is given to the Poly1305 implementation
+ * when the keystream for the record was precomputed. The 'key' is then
+ * the record context itself; blocks beyond the precomputed keystream
+ * are computed with the real ChaCha20 implementation.
+ */
+static uint32_t
+keystream_run(const void *key, const void *iv,
+	uint32_t cc, void *data, size_t len)
+{
+	const br_sslrec_chapol_context *ctx;
+	unsigned char *buf;
+	size_t off, klen, u;
+
+	ctx = key;
+	buf = data;
+	off = (size_t)cc << 6;
+	klen = 0;
+	if (off < ctx->ks_len) {
+		klen = ctx->ks_len - off;
+		if (klen > len) {
+			klen = len;
+		}
+		for (u = 0; u < klen; u ++) {
+			buf[u] ^= ctx->ks[off + u];
+		}
+	}
+	if (klen < len) {
+		return ctx->ichacha(ctx->key, iv,
+			cc + (uint32_t)(klen >> 6), buf + klen, len - klen);
+	}
+	return cc + (uint32_t)((len + 63) >> 6);
+}
+
+static void
+make_nonce(const br_sslrec_chapol_context *cc, uint64_t seq,
+	unsigned char *nonce)
+{
+	size_t u;
+
+	memcpy(nonce, cc->iv, 12);
+	for (u = 0; u < 8; u ++) {
+		nonce[11 - u] ^= (unsigned char)seq;
+		seq >>= 8;
+	}
 }
 
 static void
@@ -44,20 +94,21 @@ gen_chapol_process(br_sslrec_chapol_context *cc,
 	unsigned char header[13];
 	unsigned char nonce[12];
 	uint64_t seq;
-	size_t u;
 
 	seq = cc->seq ++;
 	br_enc64be(header, seq);
 	header[8] = (unsigned char)record_type;
 	br_enc16be(header + 9, version);
 	br_enc16be(header + 11, len);
-	memcpy(nonce, cc->iv, 12);
-	for (u = 0; u < 8; u ++) {
-		nonce[11 - u] ^= (unsigned char)seq;
-		seq >>= 8;
+	make_nonce(cc, seq, nonce);
+	if (encrypt && cc->ks_len != 0 && cc->ks_seq == seq) {
+		cc->ipoly(cc, nonce, data, len, header, sizeof header,
+			tag, &keystream_run, encrypt);
+		cc->ks_len = 0;
+	} else {
+		cc->ipoly(cc->key, nonce, data, len, header, sizeof header,
+			tag, cc->ichacha, encrypt);
 	}
-	cc->ipoly(cc->key, nonce, data, len, header, sizeof header,
-		tag, cc->ichacha, encrypt);
 }
 
 static void
@@ -79,6 +130,68 @@ chapol_check_length(const br_sslrec_chapol_context *cc, size_t rlen)
 	return rlen >= 16 && rlen <= (16384 + 16);
 }
 
+/*
+ * Authenticate, then decrypt, the ciphertext of an incoming record up to
+ * 'avail' bytes (out of 'len'). Unless the whole record is there, only
+ * complete ChaCha20 blocks are processed, so that the work can be
+ * resumed later on. This uses the incremental Poly1305 code, whatever
+ * the configured implementation.
+ */
+static void
+in_chapol_step(br_sslrec_chapol_context *cc,
+	int record_type, unsigned version,
+	unsigned char *buf, size_t len, size_t avail)
+{
+	size_t end;
+
+	if (!cc->in_started) {
+		unsigned char header[13];
+		unsigned char pkey[32];
+
+		br_enc64be(header, cc->seq);
+		header[8] = (unsigned char)record_type;
+		br_enc16be(header + 9, version);
+		br_enc16be(header + 11, len);
+		make_nonce(cc, cc->seq, cc->in_nonce);
+		memset(pkey, 0, sizeof pkey);
+		cc->ichacha(cc->key, cc->in_nonce, 0, pkey, sizeof pkey);
+		br_poly1305_ctmul_init(&cc->poly, pkey);
+		br_poly1305_ctmul_update(&cc->poly, header, sizeof header);
+		cc->in_done = 0;
+		cc->in_started = 1;
+	}
+	end = (avail >= len) ? len : (avail & ~(size_t)63);
+	if (end > cc->in_done) {
+		br_poly1305_ctmul_update(&cc->poly,
+			buf + cc->in_done, end - cc->in_done);
+		cc->ichacha(cc->key, cc->in_nonce,
+			1 + (uint32_t)(cc->in_done >> 6),
+			buf + cc->in_done, end - cc->in_done);
+		cc->in_done = end;
+	}
+}
+
+/* see inner.h */
+void
+br_sslrec_in_chapol_update(br_sslrec_chapol_context *cc,
+	int record_type, unsigned version, void *data, size_t len,
+	size_t rlen)
+{
+	/*
+	 * Leave the tag alone, and wait for at least one full block.
+	 */
+	if (rlen < 16) {
+		return;
+	}
+	if (len > rlen - 16) {
+		len = rlen - 16;
+	}
+	if (len < 64 && len < rlen - 16) {
+		return;
+	}
+	in_chapol_step(cc, record_type, version, data, rlen - 16, len);
+}
+
 static unsigned char *
 chapol_decrypt(br_sslrec_chapol_context *cc,
 	int record_type, unsigned version, void *data, size_t *data_len)
@@ -90,7 +203,19 @@ chapol_decrypt(br_sslrec_chapol_context *cc,
 
 	buf = data;
 	len = *data_len - 16;
-	gen_chapol_process(cc, record_type, version, buf, len, tag, 0);
+	if (cc->in_started) {
+		/*
+		 * Part of the record was processed while it was being
+		 * received; finish the same way.
+		 */
+		in_chapol_step(cc, record_type, version, buf, len, len);
+		br_poly1305_ctmul_final(&cc->poly, 13, len, tag);
+		cc->in_started = 0;
+		cc->seq ++;
+	} else {
+		gen_chapol_process(cc, record_type, version,
+			buf, len, tag, 0);
+	}
 	bad = 0;
 	for (u = 0; u < 16; u ++) {
 		bad |= tag[u] ^ buf[len + u];
@@ -141,6 +266,34 @@ chapol_max_plaintext(const br_sslrec_chapol_context *cc,
 	*end = *start + len;
 }
 
+/* see inner.h */
+size_t
+br_sslrec_out_chapol_precompute(br_sslrec_chapol_context *cc,
+	void *buf, size_t len)
+{
+	unsigned char nonce[12];
+
+	/*
+	 * The buffer receives ChaCha20 blocks 0 (the first half of which
+	 * is the Poly1305 key) and 1 onwards (which encrypt the payload).
+	 */
+	if (cc->ks == buf && cc->ks_len != 0 && cc->ks_seq == cc->seq) {
+		return cc->ks_len - 64;
+	}
+	cc->ks_len = 0;
+	len &= ~(size_t)63;
+	if (len < 128) {
+		return 0;
+	}
+	make_nonce(cc, cc->seq, nonce);
+	memset(buf, 0, len);
+	cc->ichacha(cc->key, nonce, 0, buf, len);
+	cc->ks = buf;
+	cc->ks_len = len;
+	cc->ks_seq = cc->seq;
+	return len - 64;
+}
+
 static unsigned char *
 chapol_encrypt(br_sslrec_chapol_context *cc,
 	int record_type, unsigned version, void *data, size_t *data_len)
@@ -42,6 +42,9 @@ gen_gcm_init(br_sslrec_gcm_context *cc,
 	bc_impl->init(&cc->bc.vtable, key, key_len);
 	cc->gh = gh_impl;
 	memcpy(cc->iv, iv, sizeof cc->iv);
+	cc->ks = NULL;
+	cc->ks_len = 0;
+	cc->in_started = 0;
 	memset(cc->h, 0, sizeof cc->h);
 	memset(tmp, 0, sizeof tmp);
 	bc_impl->run(&cc->bc.vtable, tmp, 0, cc->h, sizeof cc->h);
@@ -119,6 +122,64 @@ do_ctr(br_sslrec_gcm_context *cc, const void *nonce, void *data, size_t len,
 	cc->bc.vtable->run(&cc->bc.vtable, iv, 1, xortag, 16);
 }
 
+/*
+ * Decrypt the ciphertext of an incoming record up to 'avail' bytes (out
+ * of 'len'), updating the GHASH value with it first. 'buf' points to the
+ * ciphertext, right after the nonce_explicit. Unless the whole record is
+ * there, only complete blocks are processed, so that the work can be
+ * resumed later on.
+ */
+static void
+in_gcm_step(br_sslrec_gcm_context *cc,
+	int record_type, unsigned version,
+	unsigned char *buf, size_t len, size_t avail)
+{
+	unsigned char iv[12];
+	size_t end;
+
+	if (!cc->in_started) {
+		unsigned char header[13];
+
+		br_enc64be(header, cc->seq);
+		header[8] = (unsigned char)record_type;
+		br_enc16be(header + 9, version);
+		br_enc16be(header + 11, len);
+		memset(cc->y, 0, sizeof cc->y);
+		cc->gh(cc->y, cc->h, header, sizeof header);
+		cc->in_done = 0;
+		cc->in_started = 1;
+	}
+	end = (avail >= len) ? len : (avail & ~(size_t)15);
+	if (end > cc->in_done) {
+		cc->gh(cc->y, cc->h, buf + cc->in_done, end - cc->in_done);
+		memcpy(iv, cc->iv, 4);
+		memcpy(iv + 4, buf - 8, 8);
+		cc->bc.vtable->run(&cc->bc.vtable, iv,
+			2 + (uint32_t)(cc->in_done >> 4),
+			buf + cc->in_done, end - cc->in_done);
+		cc->in_done = end;
+	}
+}
+
+/* see inner.h */
+void
+br_sslrec_in_gcm_update(br_sslrec_gcm_context *cc,
+	int record_type, unsigned version, void *data, size_t len,
+	size_t rlen)
+{
+	/*
+	 * Wait for the nonce_explicit, and leave the tag alone.
+	 */
+	if (len <= 8 || rlen < 24) {
+		return;
+	}
+	if (len > rlen - 16) {
+		len = rlen - 16;
+	}
+	in_gcm_step(cc, record_type, version, (unsigned char *)data + 8,
+		rlen - 24, len - 8);
+}
+
 static unsigned char *
 gcm_decrypt(br_sslrec_gcm_context *cc,
 	int record_type, unsigned version, void *data, size_t *data_len)
@@ -126,12 +187,23 @@ gcm_decrypt(br_sslrec_gcm_context *cc,
 	unsigned char *buf;
 	size_t len, u;
 	uint32_t bad;
-	unsigned char tag[16];
+	unsigned char footer[16], iv[12];
 
+	/*
+	 * Process what br_sslrec_in_gcm_update() did not, then finish
+	 * the tag: lengths, then CTR encryption with counter 1.
+	 */
 	buf = (unsigned char *)data + 8;
 	len = *data_len - 24;
-	do_tag(cc, record_type, version, buf, len, tag);
-	do_ctr(cc, data, buf, len, tag);
+	in_gcm_step(cc, record_type, version, buf, len, len);
+	cc->in_started = 0;
+	cc->seq ++;
+	br_enc64be(footer, (uint64_t)13 << 3);
+	br_enc64be(footer + 8, (uint64_t)len << 3);
+	cc->gh(cc->y, cc->h, footer, sizeof footer);
+	memcpy(iv, cc->iv, 4);
+	memcpy(iv + 4, data, 8);
+	cc->bc.vtable->run(&cc->bc.vtable, iv, 1, cc->y, sizeof cc->y);
 
 	/*
 	 * Compare the computed tag with the value from the record. It
@@ -140,7 +212,7 @@ gcm_decrypt(br_sslrec_gcm_context *cc,
 	 */
 	bad = 0;
 	for (u = 0; u < 16; u ++) {
-		bad |= tag[u] ^ buf[len + u];
+		bad |= cc->y[u] ^ buf[len + u];
 	}
 	if (bad) {
 		return NULL;
@@ -191,6 +263,79 @@ gcm_max_plaintext(const br_sslrec_gcm_context *cc,
 	*end = *start + len;
 }
 
+/* see inner.h */
+size_t
+br_sslrec_out_gcm_precompute(br_sslrec_gcm_context *cc,
+	void *buf, size_t len)
+{
+	unsigned char iv[12];
+
+	/*
+	 * The buffer receives the CTR keystream for counter values 1
+	 * (which masks the tag) and 2 onwards (which encrypt the
+	 * payload), in that order.
+	 */
+	if (cc->ks == buf && cc->ks_len != 0 && cc->ks_seq == cc->seq) {
+		return cc->ks_len - 16;
+	}
+	cc->ks_len = 0;
+	len &= ~(size_t)15;
+	if (len < 32) {
+		return 0;
+	}
+	memcpy(iv, cc->iv, 4);
+	br_enc64be(iv + 4, cc->seq);
+	memset(buf, 0, len);
+	cc->bc.vtable->run(&cc->bc.vtable, iv, 1, buf, len);
+	cc->ks = buf;
+	cc->ks_len = len;
+	cc->ks_seq = cc->seq;
+	return len - 16;
+}
+
+/*
+ * Same as do_ctr(), but use the precomputed keystream if there is one
+ * for this record.
+ */
+static void
+out_ctr(br_sslrec_gcm_context *cc, const void *nonce, void *data, size_t len,
+	void *xortag)
+{
+	unsigned char *buf, *tag;
+	const unsigned char *ks;
+	unsigned char iv[12];
+	size_t u, klen;
+
+	if (cc->ks_len == 0 || cc->ks_seq != cc->seq) {
+		do_ctr(cc, nonce, data, len, xortag);
+		return;
+	}
+	buf = data;
+	tag = xortag;
+	ks = cc->ks;
+	for (u = 0; u < 16; u ++) {
+		tag[u] ^= ks[u];
+	}
+	klen = cc->ks_len - 16;
+	if (klen > len) {
+		klen = len;
+	}
+	for (u = 0; u < klen; u ++) {
+		buf[u] ^= ks[16 + u];
+	}
+	if (klen < len) {
+		/*
+		 * klen is a multiple of 16 here, so the rest starts on
+		 * a block boundary.
+		 */
+		memcpy(iv, cc->iv, 4);
+		memcpy(iv + 4, nonce, 8);
+		cc->bc.vtable->run(&cc->bc.vtable, iv,
+			2 + (uint32_t)(klen >> 4), buf + klen, len - klen);
+	}
+	cc->ks_len = 0;
+}
+
 static unsigned char *
 gcm_encrypt(br_sslrec_gcm_context *cc,
 	int record_type, unsigned version, void *data, size_t *data_len)
@@ -203,7 +348,7 @@ gcm_encrypt(br_sslrec_gcm_context *cc,
 	len = *data_len;
 	memset(tmp, 0, sizeof tmp);
 	br_enc64be(buf - 8, cc->seq);
-	do_ctr(cc, buf - 8, buf, len, tmp);
+	out_ctr(cc, buf - 8, buf, len, tmp);
 	do_tag(cc, record_type, version, buf, len, buf + len);
 	for (u = 0; u < 16; u ++) {
 		buf[len + u] ^= tmp[u];
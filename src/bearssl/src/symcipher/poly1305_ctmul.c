@@ -143,6 +143,68 @@ poly1305_inner(uint32_t *acc, const uint32_t *r, const void *data, size_t len)
 	acc[4] = a4;
 }
 
+/*
+ * Finish the computation: reduce the accumulator and add the 's' value
+ * (16 bytes) to get the tag. The accumulator is modified.
+ */
+static void
+poly1305_finish(uint32_t *acc, const unsigned char *sk, void *tag)
+{
+	uint32_t cc, ctl, hi;
+	uint64_t w;
+	int i;
+
+	/*
+	 * Finalise modular reduction. This is done with carry propagation
+	 * and applying the '2^130 = -5 mod p' rule. Note that the output
+	 * of poly1035_inner() is already mostly reduced, since only
+	 * acc[1] may be (very slightly) above 2^26. A single loop back
+	 * to acc[1] will be enough to make the value fit in 130 bits.
+	 */
+	cc = 0;
+	for (i = 1; i <= 6; i ++) {
+		int j;
+
+		j = (i >= 5) ? i - 5 : i;
+		acc[j] += cc;
+		cc = acc[j] >> 26;
+		acc[j] &= 0x03FFFFFF;
+	}
+
+	/*
+	 * We may still have a value in the 2^130-5..2^130-1 range, in
+	 * which case we must reduce it again. The code below selects,
+	 * in constant-time, between 'acc' and 'acc-p',
+	 */
+	ctl = GT(acc[0], 0x03FFFFFA);
+	for (i = 1; i < 5; i ++) {
+		ctl &= EQ(acc[i], 0x03FFFFFF);
+	}
+	cc = 5;
+	for (i = 0; i < 5; i ++) {
+		uint32_t t;
+
+		t = (acc[i] + cc);
+		cc = t >> 26;
+		t &= 0x03FFFFFF;
+		acc[i] = MUX(ctl, t, acc[i]);
+	}
+
+	/*
+	 * Convert back the accumulator to 32-bit words, and add the
+	 * 's' value (second half of the MAC key). That addition is done
+	 * modulo 2^128.
+	 */
+	w = (uint64_t)acc[0] + ((uint64_t)acc[1] << 26) + br_dec32le(sk);
+	br_enc32le((unsigned char *)tag, (uint32_t)w);
+	w = (w >> 32) + ((uint64_t)acc[2] << 20) + br_dec32le(sk + 4);
+	br_enc32le((unsigned char *)tag + 4, (uint32_t)w);
+	w = (w >> 32) + ((uint64_t)acc[3] << 14) + br_dec32le(sk + 8);
+	br_enc32le((unsigned char *)tag + 8, (uint32_t)w);
+	hi = (uint32_t)(w >> 32) + (acc[4] << 8) + br_dec32le(sk + 12);
+	br_enc32le((unsigned char *)tag + 12, hi);
+}
+
 /* see bearssl_block.h */
 void
 br_poly1305_ctmul_run(const void *key, const void *iv,
@@ -150,9 +212,7 @@ br_poly1305_ctmul_run(const void *key, const void *iv,
 	void *tag, br_chacha20_run ichacha, int encrypt)
 {
 	unsigned char pkey[32], foot[16];
-	uint32_t r[5], acc[5], cc, ctl, hi;
-	uint64_t w;
-	int i;
+	uint32_t r[5], acc[5];
 
 	/*
 	 * Compute the MAC key. The 'r' value is the first 16 bytes of
@@ -201,55 +261,7 @@ br_poly1305_ctmul_run(const void *key, const void *iv,
 	poly1305_inner(acc, r, data, len);
 	poly1305_inner(acc, r, foot, sizeof foot);
 
-	/*
-	 * Finalise modular reduction. This is done with carry propagation
-	 * and applying the '2^130 = -5 mod p' rule. Note that the output
-	 * of poly1035_inner() is already mostly reduced, since only
-	 * acc[1] may be (very slightly) above 2^26. A single loop back
-	 * to acc[1] will be enough to make the value fit in 130 bits.
-	 */
-	cc = 0;
-	for (i = 1; i <= 6; i ++) {
-		int j;
-
-		j = (i >= 5) ? i - 5 : i;
-		acc[j] += cc;
-		cc = acc[j] >> 26;
-		acc[j] &= 0x03FFFFFF;
-	}
-
-	/*
-	 * We may still have a value in the 2^130-5..2^130-1 range, in
-	 * which case we must reduce it again. The code below selects,
-	 * in constant-time, between 'acc' and 'acc-p',
-	 */
-	ctl = GT(acc[0], 0x03FFFFFA);
-	for (i = 1; i < 5; i ++) {
-		ctl &= EQ(acc[i], 0x03FFFFFF);
-	}
-	cc = 5;
-	for (i = 0; i < 5; i ++) {
-		uint32_t t;
-
-		t = (acc[i] + cc);
-		cc = t >> 26;
-		t &= 0x03FFFFFF;
-		acc[i] = MUX(ctl, t, acc[i]);
-	}
-
-	/*
-	 * Convert back the accumulator to 32-bit words, and add the
-	 * 's' value (second half of pkey[]). That addition is done
-	 * modulo 2^128.
-	 */
-	w = (uint64_t)acc[0] + ((uint64_t)acc[1] << 26) + br_dec32le(pkey + 16);
-	br_enc32le((unsigned char *)tag, (uint32_t)w);
-	w = (w >> 32) + ((uint64_t)acc[2] << 20) + br_dec32le(pkey + 20);
-	br_enc32le((unsigned char *)tag + 4, (uint32_t)w);
-	w = (w >> 32) + ((uint64_t)acc[3] << 14) + br_dec32le(pkey + 24);
-	br_enc32le((unsigned char *)tag + 8, (uint32_t)w);
-	hi = (uint32_t)(w >> 32) + (acc[4] << 8) + br_dec32le(pkey + 28);
-	br_enc32le((unsigned char *)tag + 12, hi);
+	poly1305_finish(acc, pkey + 16, tag);
 
 	/*
 	 * If decrypting, then ChaCha20 runs _after_ Poly1305.
@@ -258,3 +270,40 @@ br_poly1305_ctmul_run(const void *key, const void *iv,
 		ichacha(key, iv, 1, data, len);
 	}
 }
+
+/* see inner.h */
+void
+br_poly1305_ctmul_init(br_poly1305_ctmul_state *st, const void *pkey)
+{
+	const unsigned char *k;
+
+	k = pkey;
+	st->r[0] = br_dec32le(k) & 0x03FFFFFF;
+	st->r[1] = (br_dec32le(k +  3) >> 2) & 0x03FFFF03;
+	st->r[2] = (br_dec32le(k +  6) >> 4) & 0x03FFC0FF;
+	st->r[3] = (br_dec32le(k +  9) >> 6) & 0x03F03FFF;
+	st->r[4] = (br_dec32le(k + 12) >> 8) & 0x000FFFFF;
+	memset(st->acc, 0, sizeof st->acc);
+	memcpy(st->s, k + 16, sizeof st->s);
+}
+
+/* see inner.h */
+void
+br_poly1305_ctmul_update(br_poly1305_ctmul_state *st,
+	const void *data, size_t len)
+{
+	poly1305_inner(st->acc, st->r, data, len);
+}
+
+/* see inner.h */
+void
+br_poly1305_ctmul_final(br_poly1305_ctmul_state *st,
+	size_t aad_len, size_t data_len, void *tag)
+{
+	unsigned char foot[16];
+
+	br_enc64le(foot, (uint64_t)aad_len);
+	br_enc64le(foot + 8, (uint64_t)data_len);
+	poly1305_inner(st->acc, st->r, foot, sizeof foot);
+	poly1305_finish(st->acc, st->s, tag);
+}
@@ -1222,7 +1222,21 @@ br_x509_minimal_run(void *t0ctx)
 
 	int id = T0_POPi();
 	size_t len;
-	len = br_multihash_out(&CTX->mhash, id, CTX->tbs_hash);
+	const br_hash_class *hc;
+
+	/*
+	 * A hash output that does not fit in tbs_hash[] (when the
+	 * context was built with a reduced BR_X509_BUFSIZE_HASH) is
+	 * reported as an unsupported hash function.
+	 */
+	hc = br_multihash_getimpl(&CTX->mhash, id);
+	if (hc != NULL && ((hc->desc >> BR_HASHDESC_OUT_OFF)
+		& BR_HASHDESC_OUT_MASK) > sizeof CTX->tbs_hash)
+	{
+		len = 0;
+	} else {
+		len = br_multihash_out(&CTX->mhash, id, CTX->tbs_hash);
+	}
 	T0_PUSH(len);
 
 				}
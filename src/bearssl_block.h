@@ -2533,6 +2533,22 @@ void br_poly1305_ctmul_run(const void *key, const void *iv,
 	void *data, size_t len, const void *aad, size_t aad_len,
 	void *tag, br_chacha20_run ichacha, int encrypt);
 
+/**
+ * \brief State for an incremental Poly1305 computation (mixed 32-bit
+ * multiplications).
+ *
+ * This is used by the SSL record layer to authenticate an incoming
+ * ChaCha20+Poly1305 record while it is still being received. The
+ * contents are opaque and shall not be accessed directly.
+ */
+typedef struct {
+#ifndef BR_DOXYGEN_IGNORE
+	uint32_t r[5];
+	uint32_t acc[5];
+	unsigned char s[16];
+#endif
+} br_poly1305_ctmul_state;
+
 /**
  * \brief ChaCha20+Poly1305 AEAD implementation (pure 32-bit multiplications).
  *
@@ -207,6 +207,11 @@ extern "C" {
     or the client certificate could not be validated. */
 #define BR_ERR_NO_CLIENT_AUTH         29
 
+/** \brief SSL status: server's Extended Master Secret extension is not
+    empty, or the server's use of Extended Master Secret when resuming a
+    session does not match the original session. */
+#define BR_ERR_BAD_EMS                30
+
 /** \brief SSL status: I/O error or premature close on underlying
     transport stream. This error code is set only by the simplified
     I/O API ("br_sslio_*"). */
@@ -585,6 +590,12 @@ typedef struct {
 	br_ghash gh;
 	unsigned char iv[4];
 	unsigned char h[16];
+	const unsigned char *ks;
+	size_t ks_len;
+	uint64_t ks_seq;
+	unsigned char y[16];
+	size_t in_done;
+	unsigned char in_started;
 #endif
 } br_sslrec_gcm_context;
 
@@ -685,6 +696,13 @@ typedef struct {
 	unsigned char iv[12];
 	br_chacha20_run ichacha;
 	br_poly1305_run ipoly;
+	const unsigned char *ks;
+	size_t ks_len;
+	uint64_t ks_seq;
+	br_poly1305_ctmul_state poly;
+	unsigned char in_nonce[12];
+	size_t in_done;
+	unsigned char in_started;
 #endif
 } br_sslrec_chapol_context;
 
@@ -818,15 +836,30 @@ typedef struct {
 	uint16_t cipher_suite;
 	/** \brief Master secret. */
 	unsigned char master_secret[48];
+	/** \brief Non-zero if the master secret was computed with the
+	    Extended Master Secret extension (RFC 7627). */
+	unsigned char extended_master_secret;
 } br_ssl_session_parameters;
 
 #ifndef BR_DOXYGEN_IGNORE
 /*
  * Maximum number of cipher suites supported by a client or server.
  */
+#ifndef BR_MAX_CIPHER_SUITES
 #define BR_MAX_CIPHER_SUITES   48
 #endif
 
+/*
+ * Size of the engine pad. It receives RSA signatures and encrypted
+ * pre-master secrets (as large as the largest supported RSA modulus),
+ * and some other values of up to 255 bytes, so it must be at least
+ * 256 bytes.
+ */
+#ifndef BR_SSL_BUFSIZE_PAD
+#define BR_SSL_BUFSIZE_PAD   512
+#endif
+#endif
+
 /**
  * \brief Context structure for SSL engine.
  *
@@ -866,6 +899,13 @@ typedef struct {
 	unsigned char log_max_frag_len;
 	unsigned char peer_log_max_frag_len;
 
+	/*
+	 * Largest record plaintext that the input buffer is guaranteed
+	 * to hold; advertised with the Record Size Limit extension
+	 * (RFC 8449) when lower than the protocol maximum (16384).
+	 */
+	uint16_t record_size_limit;
+
 	/*
 	 * Buffering management registers.
 	 */
@@ -960,6 +1000,13 @@ typedef struct {
 	uint16_t suites_buf[BR_MAX_CIPHER_SUITES];
 	unsigned char suites_num;
 
+	/*
+	 * Preferred order of the curves advertised by a client (curve
+	 * IDs, most preferred first).
+	 */
+	unsigned char curves_buf[8];
+	unsigned char curves_num;
+
 	/*
 	 * For clients, the server name to send as a SNI extension. For
 	 * servers, the name received in the SNI extension (if any).
@@ -995,6 +1042,20 @@ typedef struct {
 	unsigned char reneg;
 	unsigned char saved_finished[24];
 
+	/*
+	 * Set by br_ssl_client_wake(): the handshake handler then
+	 * switches to the restored security parameters instead of
+	 * performing a handshake.
+	 */
+	unsigned char wake;
+
+	/*
+	 * Caller-provided buffer for keystream precomputed ahead of the
+	 * next outgoing record (see br_ssl_engine_precompute_keystream()).
+	 */
+	unsigned char *ks_buf;
+	size_t ks_buf_len;
+
 	/*
 	 * Behavioural flags.
 	 */
@@ -1004,8 +1065,9 @@ typedef struct {
 	 * Context variables for the handshake processor. The 'pad' must
 	 * be large enough to accommodate an RSA-encrypted pre-master
 	 * secret, or an RSA signature; since we want to support up to
-	 * RSA-4096, this means at least 512 bytes. (Other pad usages
-	 * require its length to be at least 256.)
+	 * RSA-4096, this means at least 512 bytes by default (see
+	 * BR_SSL_BUFSIZE_PAD). (Other pad usages require its length to
+	 * be at least 256.)
 	 */
 	struct {
 		uint32_t *dp;
@@ -1014,7 +1076,7 @@ typedef struct {
 	} cpu;
 	uint32_t dp_stack[32];
 	uint32_t rp_stack[32];
-	unsigned char pad[512];
+	unsigned char pad[BR_SSL_BUFSIZE_PAD];
 	unsigned char *hbuf_in, *hbuf_out, *saved_hbuf_out;
 	size_t hlen_in, hlen_out;
 	void (*hsrun)(void *ctx);
@@ -1276,6 +1338,45 @@ br_ssl_engine_set_versions(br_ssl_engine_context *cc,
 void br_ssl_engine_set_suites(br_ssl_engine_context *cc,
 	const uint16_t *suites, size_t suites_num);
 
+/**
+ * \brief Set the preferred order of elliptic curves advertised by a client.
+ *
+ * A client sends the curves supported by its EC implementation in
+ * the "supported curves" extension of its ClientHello. The curves in
+ * this list come first, in the order given; other supported curves
+ * follow in the default order (Curve25519, then increasing curve IDs).
+ * Curves that the EC implementation does not support are ignored. At
+ * most 8 curves are kept; an empty list restores the default order.
+ *
+ * \param cc           SSL engine context.
+ * \param curves       curve identifiers, most preferred first.
+ * \param curves_num   number of curve identifiers.
+ */
+static inline void
+br_ssl_engine_set_curves_order(br_ssl_engine_context *cc,
+	const unsigned char *curves, size_t curves_num)
+{
+	if (curves_num > sizeof cc->curves_buf) {
+		curves_num = sizeof cc->curves_buf;
+	}
+	memcpy(cc->curves_buf, curves, curves_num);
+	cc->curves_num = (unsigned char)curves_num;
+}
+
+/**
+ * \brief Get the list of cipher suites advertised by this context.
+ *
+ * \param cc    SSL engine context.
+ * \param num   receives the number of cipher suites.
+ * \return  the cipher suites, in order of preference.
+ */
+static inline const uint16_t *
+br_ssl_engine_get_suites(const br_ssl_engine_context *cc, size_t *num)
+{
+	*num = cc->suites_num;
+	return cc->suites_buf;
+}
+
 /**
  * \brief Set the X.509 engine.
  *
@@ -1941,6 +2042,114 @@ br_ssl_engine_set_session_parameters(br_ssl_engine_context *cc,
 	memcpy(&cc->session, pp, sizeof *pp);
 }
 
+/**
+ * \brief State of an idle connection, saved by `br_ssl_engine_hibernate()`.
+ *
+ * This structure holds what is needed to continue an established
+ * connection on the same transport: the session parameters and random
+ * values (from which the traffic keys and IVs are derived), the record
+ * sequence numbers, the CBC chaining IVs, and the values used for secure
+ * renegotiation and fragment length. It is a few hundred bytes, while the
+ * engine context and its buffers take several kilobytes.
+ *
+ * Like the session parameters, this structure contains the master secret
+ * and must be handled with great care.
+ */
+typedef struct {
+	/** \brief Session parameters (version, cipher suite, master secret). */
+	br_ssl_session_parameters session;
+	/** \brief Client random value from the handshake. */
+	unsigned char client_random[32];
+	/** \brief Server random value from the handshake. */
+	unsigned char server_random[32];
+	/** \brief Sequence number of the next incoming record. */
+	uint64_t seq_in;
+	/** \brief Sequence number of the next outgoing record. */
+	uint64_t seq_out;
+	/** \brief CBC chaining value for incoming records (TLS 1.0 only). */
+	unsigned char iv_in[16];
+	/** \brief CBC chaining value for outgoing records (TLS 1.0 only). */
+	unsigned char iv_out[16];
+	/** \brief "Finished" values, for secure renegotiation. */
+	unsigned char saved_finished[24];
+	/** \brief Secure renegotiation support of the peer. */
+	unsigned char reneg;
+	/** \brief Maximum plaintext length of outgoing records. */
+	uint16_t max_frag_len;
+	/** \brief Protocol selected with ALPN (see `br_ssl_engine_get_selected_protocol()`). */
+	uint16_t selected_protocol;
+} br_ssl_hibernation;
+
+/**
+ * \brief Save the state of an idle connection.
+ *
+ * This function copies the state of an established connection into the
+ * provided structure, so that the connection can later be continued
+ * with `br_ssl_client_wake()`, possibly in another context, without a
+ * new handshake. The connection must be idle: the handshake is complete,
+ * no record is partially received or waiting to be sent, and no
+ * application data is buffered in either direction. Moreover, the
+ * transport must not be used by anything else until the connection is
+ * woken up again.
+ *
+ * After a successful call, the keys are erased from the context and
+ * the engine is closed (without error and without sending a close_notify),
+ * so that it cannot send a record that would reuse a saved sequence
+ * number. It may be reset for a new connection.
+ *
+ * \param cc   SSL engine context.
+ * \param hb   destination structure.
+ * \return  1 on success, 0 if the connection is not idle.
+ */
+int br_ssl_engine_hibernate(br_ssl_engine_context *cc,
+	br_ssl_hibernation *hb);
+
+/**
+ * \brief Set the buffer for precomputed keystream.
+ *
+ * With AES/GCM and ChaCha20+Poly1305, the keystream that encrypts an
+ * outgoing record depends only on the traffic key and the record
+ * sequence number, so it can be computed before the data is known.
+ * This buffer receives that keystream when
+ * `br_ssl_engine_precompute_keystream()` is called; the next record
+ * then only needs an XOR and the MAC for the bytes it covers.
+ *
+ * The buffer must remain valid as long as it is set. Use a `NULL`
+ * buffer (or a zero length) to disable precomputation. Any keystream
+ * already computed into the previous buffer is discarded, so that
+ * buffer may be released as soon as this function returns.
+ *
+ * \param cc    SSL engine context.
+ * \param buf   keystream buffer (or `NULL`).
+ * \param len   buffer length (in bytes).
+ */
+void br_ssl_engine_set_keystream_buffer(br_ssl_engine_context *cc,
+	void *buf, size_t len);
+
+/**
+ * \brief Precompute keystream for the next outgoing record.
+ *
+ * This function is meant to be called while the application is idle.
+ * It fills the buffer set with `br_ssl_engine_set_keystream_buffer()`
+ * with the keystream of the next outgoing record, unless this was
+ * already done for that record. Part of the buffer holds values that
+ * do not depend on the record length (the tag mask for GCM, the
+ * Poly1305 key for ChaCha20), so the number of payload bytes covered
+ * is somewhat less than the buffer length: the buffer length is rounded
+ * down to a multiple of 16 (GCM) or 64 (ChaCha20) bytes, then 16 or 64
+ * bytes are reserved. Payload bytes beyond that range are encrypted
+ * normally.
+ *
+ * Precomputation applies only once outgoing records are encrypted with
+ * AES/GCM or ChaCha20+Poly1305; for other cipher suites, or before the
+ * handshake switches to encryption, this function does nothing.
+ *
+ * \param cc   SSL engine context.
+ * \return  the number of payload bytes of the next record that are
+ * covered by precomputed keystream (0 if none).
+ */
+size_t br_ssl_engine_precompute_keystream(br_ssl_engine_context *cc);
+
 /**
  * \brief Get identifier for the curve used for key exchange.
  *
@@ -2862,6 +3071,34 @@ br_ssl_client_set_min_clienthello_len(br_ssl_client_context *cc, uint16_t len)
 int br_ssl_client_reset(br_ssl_client_context *cc,
 	const char *server_name, int resume_session);
 
+/**
+ * \brief Continue a connection saved with `br_ssl_engine_hibernate()`.
+ *
+ * This function prepares the client context like `br_ssl_client_reset()`,
+ * but instead of starting a handshake, the engine switches directly to
+ * the security parameters saved in `hb`, and is ready for application
+ * data on the same transport. The context must be configured with the
+ * cipher suite implementations and the buffer that were used when the
+ * connection was established (typically, the same initialisation code
+ * is used). The server certificate is not validated again.
+ *
+ * The `server_name` is only remembered for later renegotiations; it may
+ * be `NULL`.
+ *
+ * A saved state can be used only once: waking up twice from the same
+ * state would encrypt different records with the same keys and sequence
+ * numbers (hence the same nonces). This function therefore erases `hb`
+ * on every call, successful or not, and fails with `BR_ERR_BAD_PARAM`
+ * if it was already erased.
+ *
+ * \param cc            client context.
+ * \param server_name   target server name, or `NULL`.
+ * \param hb            saved connection state (erased).
+ * \return  0 on failure, 1 on success.
+ */
+int br_ssl_client_wake(br_ssl_client_context *cc,
+	const char *server_name, br_ssl_hibernation *hb);
+
 /**
  * \brief Forget any session in the context.
  *
@@ -28,6 +28,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "SSLClientConfig.h"
 #include "bearssl_ec.h"
 #include "bearssl_hash.h"
 #include "bearssl_rsa.h"
@@ -551,10 +552,23 @@ void br_x509_knownkey_init_ec(br_x509_knownkey_context *ctx,
  * NIST P-521 (the largest curve we care to support), a public key is
  * encoded over 133 bytes only.
  */
+#ifndef BR_X509_BUFSIZE_KEY
 #define BR_X509_BUFSIZE_KEY   520
+#endif
+#ifndef BR_X509_BUFSIZE_SIG
 #define BR_X509_BUFSIZE_SIG   512
 #endif
 
+/*
+ * Size of the buffers for certificate and DN hashes (largest hash
+ * output). Hash functions with a larger output are treated as not
+ * supported for certificate signatures.
+ */
+#ifndef BR_X509_BUFSIZE_HASH
+#define BR_X509_BUFSIZE_HASH   64
+#endif
+#endif
+
 /**
  * \brief Type for receiving a name element.
  *
@@ -705,7 +719,7 @@ typedef struct {
 	 */
 	unsigned char do_mhash;
 	br_multihash_context mhash;
-	unsigned char tbs_hash[64];
+	unsigned char tbs_hash[BR_X509_BUFSIZE_HASH];
 
 	/*
 	 * Simple hasher for the subject/issuer DN.
@@ -713,9 +727,9 @@ typedef struct {
 	unsigned char do_dn_hash;
 	const br_hash_class *dn_hash_impl;
 	br_hash_compat_context dn_hash;
-	unsigned char current_dn_hash[64];
-	unsigned char next_dn_hash[64];
-	unsigned char saved_dn_hash[64];
+	unsigned char current_dn_hash[BR_X509_BUFSIZE_HASH];
+	unsigned char next_dn_hash[BR_X509_BUFSIZE_HASH];
+	unsigned char saved_dn_hash[BR_X509_BUFSIZE_HASH];
 
 	/*
 	 * Name elements to gather.
@@ -53,7 +53,9 @@
  * no more than 23833 bits). RSA key sizes beyond 3072 bits don't make a
  * lot of sense anyway.
  */
+#ifndef BR_MAX_RSA_SIZE
 #define BR_MAX_RSA_SIZE   4096
+#endif
 
 /*
  * Minimum size for a RSA modulus (in bits); this value is used only to
@@ -2241,6 +2243,65 @@ int br_ssl_engine_init_rand(br_ssl_engine_context *cc);
 void br_ssl_engine_hs_reset(br_ssl_engine_context *cc,
 	void (*hsinit)(void *), void (*hsrun)(void *));
 
+/*
+ * Restore the record layer state of a hibernated connection, after the
+ * handshake handler has switched to its security parameters. Returned
+ * value is 1 on success, 0 on error.
+ */
+int br_ssl_engine_wake_records(br_ssl_engine_context *cc,
+	const br_ssl_hibernation *hb);
+
+/*
+ * Incremental Poly1305 for ChaCha20+Poly1305, with the same code as
+ * br_poly1305_ctmul_run(). The state is initialised with the 32-byte
+ * MAC key (the first ChaCha20 block).
+ */
+void br_poly1305_ctmul_init(br_poly1305_ctmul_state *st, const void *pkey);
+
+/*
+ * Process some AAD or ciphertext bytes, right-padded with zeros to a
+ * multiple of 16. The AAD, then the ciphertext, may each be given over
+ * several calls, but all calls except the last one for each must have
+ * a length multiple of 16: otherwise the padding lands in the middle
+ * of the data, and the tag is wrong.
+ */
+void br_poly1305_ctmul_update(br_poly1305_ctmul_state *st,
+	const void *data, size_t len);
+
+/*
+ * Add the lengths of the AAD and ciphertext, and compute the 16-byte
+ * tag.
+ */
+void br_poly1305_ctmul_final(br_poly1305_ctmul_state *st,
+	size_t aad_len, size_t data_len, void *tag);
+
+/*
+ * Process the first 'len' bytes of an incoming GCM or ChaCha20+Poly1305
+ * record, whose payload will be 'rlen' bytes long in total, while the
+ * rest of the record is still being received. Only whole blocks are
+ * processed; the record layer remembers how far it went, and its
+ * decrypt() function completes the work and verifies the tag once the
+ * record is complete. Bytes that were processed are decrypted in place,
+ * but must not be used until decrypt() succeeds.
+ */
+void br_sslrec_in_gcm_update(br_sslrec_gcm_context *cc,
+	int record_type, unsigned version, void *data, size_t len,
+	size_t rlen);
+void br_sslrec_in_chapol_update(br_sslrec_chapol_context *cc,
+	int record_type, unsigned version, void *data, size_t len,
+	size_t rlen);
+
+/*
+ * Compute into 'buf' the keystream for the next record encrypted with
+ * the provided GCM or ChaCha20+Poly1305 output context, and remember it
+ * for that record. Returned value is the number of payload bytes that
+ * the keystream covers (0 if the buffer is too small).
+ */
+size_t br_sslrec_out_gcm_precompute(br_sslrec_gcm_context *cc,
+	void *buf, size_t len);
+size_t br_sslrec_out_chapol_precompute(br_sslrec_chapol_context *cc,
+	void *buf, size_t len);
+
 /*
  * Get the PRF to use for this context, for the provided PRF hash
  * function ID.
@@ -2251,6 +2312,9 @@ br_tls_prf_impl br_ssl_engine_get_PRF(br_ssl_engine_context *cc, int prf_id);
  * Consume the provided pre-master secret and compute the corresponding
  * master secret. The 'prf_id' is the ID of the hash function to use
  * with the TLS 1.2 PRF (ignored if the version is TLS 1.0 or 1.1).
+ * If the session uses the Extended Master Secret (RFC 7627), the
+ * session hash is taken from the running handshake hash, which must
+ * then include the ClientKeyExchange message.
  */
 void br_ssl_engine_compute_master(br_ssl_engine_context *cc,
 	int prf_id, const void *pms, size_t len);